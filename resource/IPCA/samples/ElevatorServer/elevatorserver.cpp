@@ -30,16 +30,28 @@ using namespace std::placeholders;
 // of other devices which the server trusts
 static char CredFile[] = "ElevatorServerSecurityDB.dat";
 
-FILE* server_fopen(const char *path, const char *mode)
+/**
+ * Map the security database, and the journal and commit files named after it,
+ * onto CredFile.
+ */
+static std::string server_path(const char *path)
 {
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
-    {
-        return fopen(CredFile, mode);
-    }
-    else
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    if (0 == strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
     {
-        return fopen(path, mode);
+        return std::string(CredFile) + (path + dbNameLen);
     }
+    return path;
+}
+
+FILE* server_fopen(const char *path, const char *mode)
+{
+    return fopen(server_path(path).c_str(), mode);
+}
+
+int server_unlink(const char *path)
+{
+    return unlink(server_path(path).c_str());
 }
 
 //
@@ -180,7 +192,7 @@ bool CopyStringToBuffer(const std::string& source, char* dest, size_t destSize)
 }
 
 // Initialize Persistent Storage for security database
-OCPersistentStorage ps = {server_fopen, fread, fwrite, fclose, unlink};
+OCPersistentStorage ps = {server_fopen, fread, fwrite, fclose, server_unlink, true};
 
 bool ElevatorServer::Start(const std::string& elevatorName)
 {
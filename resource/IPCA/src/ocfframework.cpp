@@ -56,7 +56,16 @@ FILE* server_fopen(const char *path, const char *mode)
     return fopen(filePath.c_str(), mode);
 }
 
-OCPersistentStorage ps = {server_fopen, fread, fwrite, fclose, unlink};
+int server_unlink(const char *path)
+{
+    // The journal and commit files are kept next to the database, under g_psPath.
+    std::string filePath(g_psPath);
+    filePath.append(path);
+
+    return unlink(filePath.c_str());
+}
+
+OCPersistentStorage ps = {server_fopen, fread, fwrite, fclose, server_unlink, true};
 
 OCFFramework::OCFFramework() :
     m_isStarted(false),
@@ -72,6 +72,23 @@ bool oc_atomic_cmpxchg(volatile int32_t *destination, int32_t oldValue, int32_t
  */
 int32_t oc_atomic_or(volatile int32_t *destination, int32_t value);
 
+/**
+ * Exchange a pointer atomically, with a full memory barrier.
+ *
+ * @param[in] destination    Pointer to the target variable.
+ * @param[in] value          The new value to write into *destination.
+ * @return void*             The value *destination held before.
+ */
+void *oc_atomic_exchange_ptr(void * volatile *destination, void *value);
+
+/**
+ * Read a pointer atomically, with a full memory barrier.
+ *
+ * @param[in] source         Pointer to the variable to read.
+ * @return void*             The value of *source.
+ */
+void *oc_atomic_load_ptr(void * volatile *source);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif /* __cplusplus */
@@ -47,4 +47,14 @@ bool oc_atomic_cmpxchg(volatile int32_t *destination, int32_t oldValue, int32_t
 int32_t oc_atomic_or(volatile int32_t *destination, int32_t value)
 {
     return  __sync_or_and_fetch(destination, value);
-}
\ No newline at end of file
+}
+
+void *oc_atomic_exchange_ptr(void * volatile *destination, void *value)
+{
+    return __atomic_exchange_n(destination, value, __ATOMIC_SEQ_CST);
+}
+
+void *oc_atomic_load_ptr(void * volatile *source)
+{
+    return __atomic_load_n(source, __ATOMIC_SEQ_CST);
+}
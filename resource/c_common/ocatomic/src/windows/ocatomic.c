@@ -52,4 +52,14 @@ bool oc_atomic_cmpxchg(volatile int32_t *destination, int32_t oldValue, int32_t
 int32_t oc_atomic_or(volatile int32_t *destination, int32_t value)
 {
     return InterlockedOr((volatile long*)destination, value);
-}
\ No newline at end of file
+}
+
+void *oc_atomic_exchange_ptr(void * volatile *destination, void *value)
+{
+    return InterlockedExchangePointer(destination, value);
+}
+
+void *oc_atomic_load_ptr(void * volatile *source)
+{
+    return InterlockedCompareExchangePointer(source, NULL, NULL);
+}
@@ -505,6 +505,8 @@ typedef struct
     CAURI_t resourceUri;        /**< Resource URI information **/
     CARemoteId_t identity;      /**< endpoint identity */
     CADataType_t dataType;      /**< data type */
+    bool hasBlock2Num;          /**< block2Num is set. Used by block-wise transfer only. */
+    uint32_t block2Num;         /**< Block2 number a queued block-wise message carries */
 } CAInfo_t;
 
 /**
@@ -553,23 +555,6 @@ typedef struct
     uint16_t port;      /**< socket port */
 } CASocket_t;
 
-#define HISTORYSIZE (4)
-
-typedef struct
-{
-    CATransportFlags_t flags;
-    uint16_t messageId;
-    char token[CA_MAX_TOKEN_LEN];
-    uint8_t tokenLength;
-    uint32_t ifindex;
-} CAHistoryItem_t;
-
-typedef struct
-{
-    int nextIndex;
-    CAHistoryItem_t items[HISTORYSIZE];
-} CAHistory_t;
-
 /**
  * Hold interface index for keeping track of comings and goings.
  */
@@ -650,7 +635,8 @@ typedef struct
 
     struct calayer
     {
-        CAHistory_t requestHistory;  /**< filter IP family in requests */
+        size_t dupCacheSize;        /**< duplicate message cache entries, 0 for default */
+        uint32_t dupCacheLifetime;  /**< duplicate message cache lifetime in seconds, 0 for default */
     } ca;
 
 #ifdef TCP_ADAPTER
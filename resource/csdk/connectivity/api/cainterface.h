@@ -32,6 +32,7 @@
  */
 #include "cacommon.h"
 #include "casecurityinterface.h"
+#include "ocevent.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -231,6 +232,23 @@ CATransportAdapter_t CAGetSelectedNetwork();
  */
 CAResult_t CAHandleRequestResponse();
 
+/**
+ * Register an event to be signaled whenever a received message is waiting to
+ * be delivered by ::CAHandleRequestResponse, so the caller can sleep on the
+ * event instead of polling. Several events may be registered; all of them are
+ * signaled.
+ * @param[in]   event    event to signal.
+ * @return  ::CA_STATUS_OK or an error if the event could not be registered.
+ */
+CAResult_t CARegisterProcessEvent(oc_event event);
+
+/**
+ * Stop signaling an event registered with ::CARegisterProcessEvent. Other
+ * registered events are not affected.
+ * @param[in]   event    event to stop signaling.
+ */
+void CAUnregisterProcessEvent(oc_event event);
+
 #ifdef RA_ADAPTER
 /**
  * Set Remote Access information for XMPP Client.
@@ -183,6 +183,16 @@ typedef void (*CAgetPkixInfoHandler)(PkiInfo_t * inf);
  */
 CAResult_t CAregisterPkixInfoHandler(CAgetPkixInfoHandler getPkixInfoHandler);
 
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+/**
+ * Tell the SSL adapter the PKIX related info may have changed.
+ * The adapter keeps the certificates, key and CRL it parsed from the info, and only calls
+ * the registered ::CAgetPkixInfoHandler again for the next handshake after this call.
+ * It has to be called whenever the own certificate, the trusted CAs or the CRL change.
+ */
+void CAinvalidatePkixInfo(void);
+#endif
+
 /**
  * Select the cipher suite for dtls handshake.
  *
@@ -52,10 +52,29 @@ typedef struct ca_thread_pool
     struct ca_thread_pool_details_t* details;
 }*ca_thread_pool_t;
 
+/**
+ * Counters kept by a thread pool since it was created.
+ */
+typedef struct
+{
+    uint64_t tasksQueued;               /**< Tasks accepted by ca_thread_pool_add_task. */
+    uint64_t tasksCompleted;            /**< Tasks which have returned. */
+    size_t queueLength;                 /**< Tasks waiting for a worker right now. */
+    size_t maxQueueLength;              /**< Largest queueLength seen. */
+    size_t threads;                     /**< Worker threads started so far. */
+    uint64_t totalDispatchLatencyUs;    /**< Sum of the time tasks waited in the queue. */
+    uint64_t maxDispatchLatencyUs;      /**< Longest time a task waited in the queue. */
+    uint64_t totalRunTimeUs;            /**< Sum of the run time of completed tasks. */
+    uint64_t maxRunTimeUs;              /**< Longest run time of a completed task. */
+} ca_thread_pool_stats_t;
+
 /**
  * This function creates a newly allocated thread pool.
  *
- * @param num_of_threads The number of worker thread used in this pool.
+ * Worker threads are started as tasks arrive, up to num_of_threads, and are
+ * reused for later tasks. Tasks run in the order they were added.
+ *
+ * @param num_of_threads The maximum number of worker threads used in this pool.
  * @param thread_pool_handle Handle to newly create thread pool.
  * @return Error code, CA_STATUS_OK if success, else error number.
  */
@@ -74,9 +93,21 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
 CAResult_t ca_thread_pool_add_task(ca_thread_pool_t thread_pool, ca_thread_func method,
                     void *data);
 
+/**
+ * This function copies the pool's counters.
+ *
+ * @param thread_pool The thread pool structure.
+ * @param stats Filled with the current counters.
+ *
+ * @return CA_STATUS_OK on success.
+ * @return CA_STATUS_INVALID_PARAM if either argument is NULL.
+ */
+CAResult_t ca_thread_pool_get_stats(ca_thread_pool_t thread_pool, ca_thread_pool_stats_t *stats);
+
 /**
  * This function stops all the worker threads (stop & exit). And frees all the allocated memory.
  * Function will return only after joining all threads executing the currently scheduled tasks.
+ * Tasks still waiting in the queue are discarded without being run.
  *
  * @param thread_pool The thread pool structure.
  */
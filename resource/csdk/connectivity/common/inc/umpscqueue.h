@@ -0,0 +1,115 @@
+/******************************************************************
+ *
+ * Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file contains the APIs for a multi-producer, single-consumer queue.
+ * Any number of threads may add messages without taking a lock. Messages
+ * must be removed by one thread at a time; callers with more than one
+ * consumer have to serialize them themselves.
+ */
+
+#ifndef U_MPSC_QUEUE_H_
+#define U_MPSC_QUEUE_H_
+
+#include "cacommon.h"
+#include "uqueue.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+typedef struct u_mpsc_queue_element_t u_mpsc_queue_element;
+
+/**
+ * Queue element format.
+ */
+struct u_mpsc_queue_element_t
+{
+    /** Queued message; must stay the first member. */
+    u_queue_message_t message;
+    /** Pointer to next queue element, written by producers. */
+    u_mpsc_queue_element * volatile next;
+};
+
+/**
+ * Queue structure.
+ */
+typedef struct u_mpsc_queue_t
+{
+    /** Element added last, swapped by producers. */
+    u_mpsc_queue_element * volatile tail;
+    /** Element removed last, only used by the consumer. */
+    u_mpsc_queue_element *head;
+    /** Placeholder head of an empty queue. */
+    u_mpsc_queue_element stub;
+    /** Number of messages in Queue. */
+    volatile int32_t count;
+} u_mpsc_queue_t;
+
+/**
+ * API to creates queue and initializes the elements.
+ * @return  u_mpsc_queue_t pointer if Success, NULL otherwise.
+ */
+u_mpsc_queue_t *u_mpsc_queue_create();
+
+/**
+ * Deletes the queue. Elements still queued are freed, the data they point
+ * to is not.
+ * @param queue pointer to queue.
+ * @return ::CA_STATUS_OK if Success, ::CA_STATUS_FAILED otherwise.
+ */
+CAResult_t u_mpsc_queue_delete(u_mpsc_queue_t *queue);
+
+/**
+ * Adds message at the end of the queue. Safe to call from any thread.
+ * @param queue pointer to queue.
+ * @param msg pointer to the data to queue.
+ * @param size size of the data.
+ * @return ::CA_STATUS_OK if Success, ::CA_STATUS_FAILED otherwise.
+ */
+CAResult_t u_mpsc_queue_add_element(u_mpsc_queue_t *queue, void *msg, uint32_t size);
+
+/**
+ * Removes the first message in the queue. Must only be called by the consumer.
+ * The returned message is released with OICFree().
+ *
+ * @note NULL may also be returned for a short time while a producer is between
+ *       reserving its place and linking its element, in which case
+ *       u_mpsc_queue_get_size() is already non-zero.
+ *
+ * @param queue pointer to queue.
+ * @return pointer to Message if Success, NULL otherwise.
+ */
+u_queue_message_t *u_mpsc_queue_get_element(u_mpsc_queue_t *queue);
+
+/**
+ * @param queue pointer to queue.
+ * @return number of elements in queue.
+ */
+uint32_t u_mpsc_queue_get_size(u_mpsc_queue_t *queue);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* U_MPSC_QUEUE_H_ */
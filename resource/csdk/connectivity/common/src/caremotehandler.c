@@ -324,6 +324,8 @@ CAResult_t CACloneInfo(const CAInfo_t *info, CAInfo_t *clone)
 
     clone->messageId = info->messageId;
     clone->type = info->type;
+    clone->hasBlock2Num = info->hasBlock2Num;
+    clone->block2Num = info->block2Num;
 
     return CA_STATUS_OK;
 
@@ -35,51 +35,94 @@
 #include "cathreadpool.h"
 #include "experimental/logger.h"
 #include "oic_malloc.h"
-#include "uarraylist.h"
+#include "oic_time.h"
 #include "octhread.h"
 #include "platform_features.h"
 
 #define TAG PCF("OIC_CA_UTHREADPOOL")
 
 /**
- * empty struct to represent the details.  This implementation has no data
- * that it needs to keep track of, so it only uses NULL for the internal value.
+ * A task waiting in the pool's work queue.
  */
-typedef struct ca_thread_pool_details_t
+typedef struct ca_thread_pool_task_t
 {
-    u_arraylist_t* threads_list;
-    oc_mutex list_lock;
-} ca_thread_pool_details_t;
+    ca_thread_func func;
+    void* data;
+    uint64_t queuedTime;
+    struct ca_thread_pool_task_t* next;
+} ca_thread_pool_task_t;
 
 /**
- * struct to wrap the pthreads callback properly.  The function pointer for
- * pthreads requires a void* return value, however u_thread_func is a void.
+ * Workers are started on demand, up to max_threads, and then kept until the
+ * pool is freed. All of them take tasks from one FIFO queue.
  */
-typedef struct ca_thread_pool_callback_info_t
+typedef struct ca_thread_pool_details_t
 {
-    ca_thread_func func;
-    void* data;
-} ca_thread_pool_callback_info_t;
+    oc_mutex lock;
+    oc_cond cond;                   /**< signaled when a task is queued or the pool stops */
+    ca_thread_pool_task_t* head;
+    ca_thread_pool_task_t* tail;
+    oc_thread* threads;
+    size_t max_threads;
+    size_t num_threads;
+    size_t idle_threads;
+    bool stopping;
+    ca_thread_pool_stats_t stats;
+} ca_thread_pool_details_t;
 
-typedef struct ca_thread_pool_thread_info_t
+static void* ca_thread_pool_worker(void* data)
 {
-    oc_thread thread;
-} ca_thread_pool_thread_info_t;
+    ca_thread_pool_details_t* details = (ca_thread_pool_details_t*)data;
+
+    oc_mutex_lock(details->lock);
+    while (true)
+    {
+        while (!details->head && !details->stopping)
+        {
+            details->idle_threads++;
+            oc_cond_wait(details->cond, details->lock);
+            details->idle_threads--;
+        }
+
+        // Tasks still queued when the pool stops are left for ca_thread_pool_free to discard.
+        if (details->stopping)
+        {
+            break;
+        }
+        ca_thread_pool_task_t* task = details->head;
+        details->head = task->next;
+        if (!details->head)
+        {
+            details->tail = NULL;
+        }
+        details->stats.queueLength--;
+
+        uint64_t start = OICGetCurrentTime(TIME_IN_US);
+        uint64_t latency = start - task->queuedTime;
+        details->stats.totalDispatchLatencyUs += latency;
+        if (latency > details->stats.maxDispatchLatencyUs)
+        {
+            details->stats.maxDispatchLatencyUs = latency;
+        }
+        oc_mutex_unlock(details->lock);
+
+        task->func(task->data);
+        OICFree(task);
+
+        uint64_t runTime = OICGetCurrentTime(TIME_IN_US) - start;
+        oc_mutex_lock(details->lock);
+        details->stats.tasksCompleted++;
+        details->stats.totalRunTimeUs += runTime;
+        if (runTime > details->stats.maxRunTimeUs)
+        {
+            details->stats.maxRunTimeUs = runTime;
+        }
+    }
+    oc_mutex_unlock(details->lock);
 
-// passthrough function to convert the pthreads call to a u_thread_func call
-void* ca_thread_pool_pthreads_delegate(void* data)
-{
-    ca_thread_pool_callback_info_t* info = (ca_thread_pool_callback_info_t*)data;
-    info->func(info->data);
-    OICFree(info);
     return NULL;
 }
 
-// this implementation doesn't do a thread pool, so this function is essentially
-// a no-op besides creating a valid ca_thread_pool_t object.  It was determined after
-// reading through the existing implementation that the thread-pooling was unnecessary
-// for the posix platforms.  Behavior shouldn't be changed since previously num_of_threads
-// was greater than the number of requested threads.
 CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_pool)
 {
     OIC_LOG(DEBUG, TAG, "IN");
@@ -104,8 +147,9 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    (*thread_pool)->details = OICMalloc(sizeof(struct ca_thread_pool_details_t));
-    if(!(*thread_pool)->details)
+    ca_thread_pool_details_t* details = OICCalloc(1, sizeof(struct ca_thread_pool_details_t));
+    (*thread_pool)->details = details;
+    if(!details)
     {
         OIC_LOG(ERROR, TAG, "Failed to allocate for thread-pool details");
         OICFree(*thread_pool);
@@ -113,23 +157,14 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    (*thread_pool)->details->list_lock = oc_mutex_new();
+    details->max_threads = (size_t)num_of_threads;
+    details->threads = OICCalloc(details->max_threads, sizeof(oc_thread));
+    details->lock = oc_mutex_new();
+    details->cond = oc_cond_new();
 
-    if(!(*thread_pool)->details->list_lock)
+    if(!details->threads || !details->lock || !details->cond)
     {
-        OIC_LOG(ERROR, TAG, "Failed to create thread-pool mutex");
-        goto exit;
-    }
-
-    (*thread_pool)->details->threads_list = u_arraylist_create();
-
-    if(!(*thread_pool)->details->threads_list)
-    {
-        OIC_LOG(ERROR, TAG, "Failed to create thread-pool list");
-        if(!oc_mutex_free((*thread_pool)->details->list_lock))
-        {
-            OIC_LOG(ERROR, TAG, "Failed to free thread-pool mutex");
-        }
+        OIC_LOG(ERROR, TAG, "Failed to create thread-pool resources");
         goto exit;
     }
 
@@ -137,7 +172,16 @@ CAResult_t ca_thread_pool_init(int32_t num_of_threads, ca_thread_pool_t *thread_
     return CA_STATUS_OK;
 
 exit:
-    OICFree((*thread_pool)->details);
+    if (details->lock)
+    {
+        oc_mutex_free(details->lock);
+    }
+    if (details->cond)
+    {
+        oc_cond_free(details->cond);
+    }
+    OICFree(details->threads);
+    OICFree(details);
     OICFree(*thread_pool);
     *thread_pool = NULL;
     return CA_STATUS_FAILED;
@@ -154,56 +198,95 @@ CAResult_t ca_thread_pool_add_task(ca_thread_pool_t thread_pool, ca_thread_func
         return CA_STATUS_INVALID_PARAM;
     }
 
-    ca_thread_pool_callback_info_t* info = OICMalloc(sizeof(ca_thread_pool_callback_info_t));
-    if(!info)
+    ca_thread_pool_task_t* task = OICMalloc(sizeof(ca_thread_pool_task_t));
+    if(!task)
     {
         OIC_LOG(ERROR, TAG, "Failed to allocate for memory wrapper");
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    info->func = method;
-    info->data = data;
+    task->func = method;
+    task->data = data;
+    task->next = NULL;
+    task->queuedTime = OICGetCurrentTime(TIME_IN_US);
 
-    ca_thread_pool_thread_info_t *threadInfo =
-            (ca_thread_pool_thread_info_t *) OICCalloc(1, sizeof(ca_thread_pool_thread_info_t));
-    if (!threadInfo)
-    {
-        OIC_LOG(ERROR, TAG, "Memory allocation failed");
-        OICFree(info);
-        return CA_STATUS_FAILED;
-    }
+    ca_thread_pool_details_t* details = thread_pool->details;
+    oc_mutex_lock(details->lock);
 
-    oc_mutex_lock(thread_pool->details->list_lock);
-    bool addResult = u_arraylist_add(thread_pool->details->threads_list, (void*) threadInfo);
-    if (!addResult)
+    if (details->stopping)
     {
-        // Note that this is considered non-fatal.
-        oc_mutex_unlock(thread_pool->details->list_lock);
-        OIC_LOG(ERROR, TAG, "Arraylist add failed");
-        OICFree(info);
-        OICFree(threadInfo);
+        oc_mutex_unlock(details->lock);
+        OIC_LOG(ERROR, TAG, "thread pool is being freed");
+        OICFree(task);
         return CA_STATUS_FAILED;
     }
 
-    int thrRet = oc_thread_new(&threadInfo->thread, ca_thread_pool_pthreads_delegate, info);
-    if (thrRet != 0)
+    // A woken worker stays counted as idle until it takes its task, so the queued
+    // tasks already have a claim on the idle workers. Start another worker when
+    // none is left for this task and the pool may still grow.
+    if (details->stats.queueLength >= details->idle_threads &&
+        details->num_threads < details->max_threads)
     {
-        size_t index = 0;
-        if (u_arraylist_get_index(thread_pool->details->threads_list, threadInfo, &index))
+        OCThreadResult_t thrRet = oc_thread_new(&details->threads[details->num_threads],
+                                                ca_thread_pool_worker, details);
+        if (OC_THREAD_SUCCESS == thrRet)
         {
-            u_arraylist_remove(thread_pool->details->threads_list, index);
+            details->num_threads++;
         }
-        oc_mutex_unlock(thread_pool->details->list_lock);
-        OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", thrRet);
-        OICFree(info);
-        return CA_STATUS_FAILED;
+        else if (0 == details->num_threads)
+        {
+            oc_mutex_unlock(details->lock);
+            OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", thrRet);
+            OICFree(task);
+            return CA_STATUS_FAILED;
+        }
+        else
+        {
+            // Non-fatal: one of the existing workers will pick the task up.
+            OIC_LOG_V(ERROR, TAG, "Thread start failed with error %d", thrRet);
+        }
+    }
+
+    if (details->tail)
+    {
+        details->tail->next = task;
+    }
+    else
+    {
+        details->head = task;
+    }
+    details->tail = task;
+
+    details->stats.tasksQueued++;
+    details->stats.queueLength++;
+    if (details->stats.queueLength > details->stats.maxQueueLength)
+    {
+        details->stats.maxQueueLength = details->stats.queueLength;
     }
-    oc_mutex_unlock(thread_pool->details->list_lock);
+
+    oc_cond_signal(details->cond);
+    oc_mutex_unlock(details->lock);
 
     OIC_LOG(DEBUG, TAG, "OUT");
     return CA_STATUS_OK;
 }
 
+CAResult_t ca_thread_pool_get_stats(ca_thread_pool_t thread_pool, ca_thread_pool_stats_t *stats)
+{
+    if (!thread_pool || !stats)
+    {
+        OIC_LOG(ERROR, TAG, "thread_pool or stats was NULL");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    oc_mutex_lock(thread_pool->details->lock);
+    *stats = thread_pool->details->stats;
+    stats->threads = thread_pool->details->num_threads;
+    oc_mutex_unlock(thread_pool->details->lock);
+
+    return CA_STATUS_OK;
+}
+
 void ca_thread_pool_free(ca_thread_pool_t thread_pool)
 {
     OIC_LOG(DEBUG, TAG, "IN");
@@ -214,29 +297,36 @@ void ca_thread_pool_free(ca_thread_pool_t thread_pool)
         return;
     }
 
-    oc_mutex_lock(thread_pool->details->list_lock);
+    ca_thread_pool_details_t* details = thread_pool->details;
+
+    oc_mutex_lock(details->lock);
+    details->stopping = true;
+    oc_cond_broadcast(details->cond);
+    oc_mutex_unlock(details->lock);
 
-    for (size_t i = 0; i < u_arraylist_length(thread_pool->details->threads_list); ++i)
+    // No thread can be added once stopping is set, so num_threads is stable.
+    for (size_t i = 0; i < details->num_threads; ++i)
     {
-        ca_thread_pool_thread_info_t *threadInfo = (ca_thread_pool_thread_info_t *)
-                u_arraylist_get(thread_pool->details->threads_list, i);
-        if (threadInfo)
-        {
-            if (threadInfo->thread)
-            {
-                oc_thread_wait(threadInfo->thread);
-                oc_thread_free(threadInfo->thread);
-            }
-            OICFree(threadInfo);
-        }
+        oc_thread_wait(details->threads[i]);
+        oc_thread_free(details->threads[i]);
     }
 
-    u_arraylist_free(&(thread_pool->details->threads_list));
+    OIC_LOG_V(DEBUG, TAG, "%" PRIu64 " tasks on %" PRIuPTR " threads, max queue length %" PRIuPTR
+              ", %" PRIuPTR " tasks discarded",
+              details->stats.tasksCompleted, details->num_threads,
+              details->stats.maxQueueLength, details->stats.queueLength);
 
-    oc_mutex_unlock(thread_pool->details->list_lock);
-    oc_mutex_free(thread_pool->details->list_lock);
+    while (details->head)
+    {
+        ca_thread_pool_task_t* task = details->head;
+        details->head = task->next;
+        OICFree(task);
+    }
 
-    OICFree(thread_pool->details);
+    oc_cond_free(details->cond);
+    oc_mutex_free(details->lock);
+    OICFree(details->threads);
+    OICFree(details);
     OICFree(thread_pool);
 
     OIC_LOG(DEBUG, TAG, "OUT");
@@ -0,0 +1,162 @@
+/******************************************************************
+ *
+ * Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/*
+ * Intrusive linked-list queue after Dmitry Vyukov's non-blocking MPSC queue.
+ * A producer swaps itself in as the new tail and then links the previous tail
+ * to it; the consumer follows the next pointers from a stub element.
+ */
+
+#include "umpscqueue.h"
+
+#include <stddef.h>
+#include "experimental/logger.h"
+#include "oic_malloc.h"
+#include "ocatomic.h"
+
+#define TAG "OIC_UMPSCQUEUE"
+
+static void u_mpsc_queue_push(u_mpsc_queue_t *queue, u_mpsc_queue_element *element)
+{
+    element->next = NULL;
+    u_mpsc_queue_element *prev = (u_mpsc_queue_element *)
+        oc_atomic_exchange_ptr((void * volatile *)&queue->tail, element);
+    // Until this store the consumer can not reach element, nor anything added after it.
+    oc_atomic_exchange_ptr((void * volatile *)&prev->next, element);
+}
+
+static u_mpsc_queue_element *u_mpsc_queue_next(u_mpsc_queue_element *element)
+{
+    return (u_mpsc_queue_element *) oc_atomic_load_ptr((void * volatile *)&element->next);
+}
+
+u_mpsc_queue_t *u_mpsc_queue_create()
+{
+    u_mpsc_queue_t *queue = (u_mpsc_queue_t *) OICCalloc(1, sizeof(u_mpsc_queue_t));
+    if (NULL == queue)
+    {
+        OIC_LOG(DEBUG, TAG, "QueueCreate FAIL");
+        return NULL;
+    }
+
+    queue->head = &queue->stub;
+    queue->tail = &queue->stub;
+
+    return queue;
+}
+
+CAResult_t u_mpsc_queue_delete(u_mpsc_queue_t *queue)
+{
+    if (NULL == queue)
+    {
+        OIC_LOG(DEBUG, TAG, "QueueDelete FAIL, Invalid Queue");
+        return CA_STATUS_FAILED;
+    }
+
+    u_queue_message_t *message = NULL;
+    while (NULL != (message = u_mpsc_queue_get_element(queue)))
+    {
+        OICFree(message);
+    }
+
+    OICFree(queue);
+    return CA_STATUS_OK;
+}
+
+CAResult_t u_mpsc_queue_add_element(u_mpsc_queue_t *queue, void *msg, uint32_t size)
+{
+    if (NULL == queue)
+    {
+        OIC_LOG(DEBUG, TAG, "QueueAddElement FAIL, Invalid Queue");
+        return CA_STATUS_FAILED;
+    }
+
+    u_mpsc_queue_element *element =
+        (u_mpsc_queue_element *) OICMalloc(sizeof(u_mpsc_queue_element));
+    if (NULL == element)
+    {
+        OIC_LOG(DEBUG, TAG, "QueueAddElement FAIL, memory allocation failed");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    element->message.msg = msg;
+    element->message.size = size;
+
+    // Counted first so that a consumer never sees an empty queue while an
+    // element is being linked.
+    oc_atomic_increment(&queue->count);
+    u_mpsc_queue_push(queue, element);
+
+    return CA_STATUS_OK;
+}
+
+u_queue_message_t *u_mpsc_queue_get_element(u_mpsc_queue_t *queue)
+{
+    if (NULL == queue)
+    {
+        OIC_LOG(DEBUG, TAG, "QueueGetElement FAIL, Invalid Queue");
+        return NULL;
+    }
+
+    u_mpsc_queue_element *head = queue->head;
+    u_mpsc_queue_element *next = u_mpsc_queue_next(head);
+
+    if (&queue->stub == head)
+    {
+        if (NULL == next)
+        {
+            return NULL;
+        }
+        queue->head = next;
+        head = next;
+        next = u_mpsc_queue_next(next);
+    }
+
+    if (NULL == next)
+    {
+        // head is the last linked element. Unless a producer is still linking
+        // a later one, put the stub behind it so head can be handed out.
+        if (head != oc_atomic_load_ptr((void * volatile *)&queue->tail))
+        {
+            return NULL;
+        }
+        u_mpsc_queue_push(queue, &queue->stub);
+        next = u_mpsc_queue_next(head);
+        if (NULL == next)
+        {
+            return NULL;
+        }
+    }
+
+    queue->head = next;
+    oc_atomic_decrement(&queue->count);
+    return &head->message;
+}
+
+uint32_t u_mpsc_queue_get_size(u_mpsc_queue_t *queue)
+{
+    if (NULL == queue)
+    {
+        OIC_LOG(DEBUG, TAG, "QueueGetSize FAIL, Invalid Queue");
+        return 0;
+    }
+
+    return (uint32_t) oc_atomic_add(&queue->count, 0);
+}
@@ -29,6 +29,7 @@
 #include <stdint.h>
 
 #include <coap/coap.h>
+#include <coap/uthash.h>
 #include "cathreadpool.h"
 #include "octhread.h"
 #include "uarraylist.h"
@@ -64,8 +65,8 @@ typedef struct
     /** callback function for received message. **/
     CAReceiveThreadFunc receivedThreadFunc;
 
-    /** array list on which the thread is operating. **/
-    u_arraylist_t *dataList;
+    /** hash table of block data on which the thread is operating, keyed by blockDataId. **/
+    struct CABlockData *dataIndex;
 
     /** data list mutex for synchronization. **/
     oc_mutex blockDataListMutex;
@@ -78,6 +79,9 @@ typedef struct
 
     /** mulitcast data list mutex for synchronization. **/
     oc_mutex multicastDataListMutex;
+
+    /** number of Block2 requests a client keeps in flight, 1 for stop-and-wait. **/
+    size_t block2WindowSize;
 } CABlockWiseContext_t;
 
 /**
@@ -89,10 +93,15 @@ typedef struct
     size_t idLength;                   /**< length of blockData ID. */
 } CABlockDataID_t;
 
+/**
+ * Maximum number of Block2 requests kept in flight by one transfer.
+ */
+#define CA_MAX_BLOCK2_WINDOW 16
+
 /**
  * Block Data Set.
  */
-typedef struct
+typedef struct CABlockData
 {
     coap_block_t block1;                /**< block1 option. */
     coap_block_t block2;                /**< block2 option. */
@@ -100,8 +109,13 @@ typedef struct
     CABlockDataID_t* blockDataId;        /**< ID set of CABlockData. */
     CAData_t *sentData;                 /**< sent request or response data information. */
     CAPayload_t payload;                /**< payload buffer. */
+    size_t payloadCapacity;             /**< allocated size of the payload buffer. */
     size_t payloadLength;               /**< the total payload length to be received. */
     size_t receivedPayloadLen;          /**< currently received payload length. */
+    uint8_t *block2Received;            /**< bitmap of received blocks in window mode. */
+    uint32_t block2Total;               /**< number of blocks in window mode, 0 otherwise. */
+    uint32_t block2Requested;           /**< highest block requested in window mode. */
+    UT_hash_handle hh;                  /**< handle in dataIndex. */
 } CABlockData_t;
 
 /**
@@ -158,6 +172,16 @@ CAResult_t CAInitBlockWiseMutexVariables();
  */
 void CATerminateBlockWiseMutexVariables();
 
+/**
+ * Set how many Block2 requests are pipelined when receiving a blockwise response.
+ * Pipelining starts once the first block with a Size2 option has arrived; later
+ * blocks are requested up to windowSize at a time and placed by block number.
+ * The default of 1 keeps the stop-and-wait exchange of RFC 7959.
+ * @param[in]   windowSize    requests in flight, 1 to ::CA_MAX_BLOCK2_WINDOW.
+ * @return ::CA_STATUS_OK or ::CA_STATUS_INVALID_PARAM.
+ */
+CAResult_t CASetBlock2WindowSize(size_t windowSize);
+
 /**
  * Pass the bulk data. if block-wise transfer process need,
  *          bulk data will be sent to block messages.
@@ -318,7 +342,7 @@ CAResult_t CASetMoreBitFromBlock(size_t payloadLen, coap_block_t *block);
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAAddBlockOption(coap_pdu_t **pdu, const CAInfo_t *info,
-                            const CAEndpoint_t *endpoint, coap_list_t **options);
+                            const CAEndpoint_t *endpoint, CAOptionList_t *options);
 
 /**
  * Write the block option2 in pdu binary data.
@@ -329,7 +353,7 @@ CAResult_t CAAddBlockOption(coap_pdu_t **pdu, const CAInfo_t *info,
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t dataLength,
-                             const CABlockDataID_t *blockID, coap_list_t **options);
+                             const CABlockDataID_t *blockID, CAOptionList_t *options);
 
 /**
  * Write the block option1 in pdu binary data.
@@ -340,7 +364,7 @@ CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAAddBlockOption1(coap_pdu_t **pdu, const CAInfo_t *info, size_t dataLength,
-                             const CABlockDataID_t *blockID, coap_list_t **options);
+                             const CABlockDataID_t *blockID, CAOptionList_t *options);
 
 /**
  * Add the block option in option list.
@@ -350,7 +374,7 @@ CAResult_t CAAddBlockOption1(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAAddBlockOptionImpl(coap_block_t *block, uint8_t blockType,
-                                coap_list_t **options);
+                                CAOptionList_t *options);
 
 /**
  * Add the option list in pdu data.
@@ -358,7 +382,7 @@ CAResult_t CAAddBlockOptionImpl(coap_block_t *block, uint8_t blockType,
  * @param[out]  options   option list.
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
-CAResult_t CAAddOptionToPDU(coap_pdu_t *pdu, coap_list_t **options);
+CAResult_t CAAddOptionToPDU(coap_pdu_t *pdu, CAOptionList_t *options);
 
 /**
  * Add the size option in pdu data.
@@ -368,7 +392,7 @@ CAResult_t CAAddOptionToPDU(coap_pdu_t *pdu, coap_list_t **options);
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAAddBlockSizeOption(coap_pdu_t *pdu, uint16_t sizeType, size_t dataLength,
-                                coap_list_t **options);
+                                CAOptionList_t *options);
 
 /**
  * Get the size option from pdu data.
@@ -0,0 +1,79 @@
+/* ****************************************************************
+ *
+ * Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file contains the cache used to detect duplicate received messages.
+ */
+
+#ifndef CA_DUPLICATE_CACHE_H_
+#define CA_DUPLICATE_CACHE_H_
+
+#include <stdint.h>
+
+#include "cacommon.h"
+
+/** EXCHANGE_LIFETIME is 247 sec(CoAP). **/
+#define DEFAULT_EXCHANGE_LIFETIME_SEC       247
+
+/** default maximum number of remembered messages. **/
+#define DEFAULT_DUPLICATE_CACHE_SIZE        128
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Initializes the duplicate message cache.
+ * @param[in]   capacity        maximum number of remembered messages.
+ *                              if 0, DEFAULT_DUPLICATE_CACHE_SIZE is used.
+ * @param[in]   lifetime        seconds a message is remembered.
+ *                              if 0, DEFAULT_EXCHANGE_LIFETIME_SEC is used.
+ * @return  ::CA_STATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAInitializeDuplicateCache(size_t capacity, uint32_t lifetime);
+
+/**
+ * Terminates the duplicate message cache and releases all entries.
+ */
+void CATerminateDuplicateCache();
+
+/**
+ * Records a received message and reports whether it was already seen within
+ * the cache lifetime. Messages are matched by message id, token and remote
+ * address and port. The copy of an IP multicast message arriving over the
+ * other IP family on the same interface is also reported as a duplicate.
+ * TCP is reliable and has no message id, so it is never reported.
+ * @param[in]   endpoint        remote endpoint the message came from.
+ * @param[in]   messageId       coap PDU message id.
+ * @param[in]   token           coap PDU token.
+ * @param[in]   tokenLength     token length.
+ * @return  true if the message is a duplicate, false otherwise.
+ */
+bool CAIsDuplicateMessage(const CAEndpoint_t *endpoint, uint16_t messageId,
+                          const CAToken_t token, uint8_t tokenLength);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* CA_DUPLICATE_CACHE_H_ */
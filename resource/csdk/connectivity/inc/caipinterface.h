@@ -150,6 +150,52 @@ void CAIPSendData(CAEndpoint_t *endpoint,
                   size_t dataLength,
                   bool isMulticast);
 
+/**
+ * API to send unicast UDP data from the send queue thread. On Linux the datagram
+ * is only queued, together with others, until CAIPFlushSendData() sends them with
+ * one sendmmsg(); elsewhere it is sent at once. @p data and @p endpoint must stay
+ * valid until then.
+ *
+ * @param[in]  endpoint          complete network address to send to.
+ * @param[in]  data              Data to be send.
+ * @param[in]  dataLength        Length of data in bytes.
+ */
+void CAIPSendDataDeferred(CAEndpoint_t *endpoint,
+                          const void *data,
+                          size_t dataLength);
+
+/**
+ * Sends the datagrams queued by CAIPSendDataDeferred().
+ */
+void CAIPFlushSendData();
+
+/**
+ * Batched datagram I/O counters of the IP adapter. They only count on platforms
+ * with recvmmsg()/sendmmsg().
+ */
+typedef struct
+{
+    uint64_t recvCalls;         /**< recvmmsg() calls that returned datagrams. */
+    uint64_t recvDatagrams;     /**< Datagrams returned by them. */
+    uint32_t recvMaxBatch;      /**< Most datagrams returned by one recvmmsg(). */
+    uint64_t sendCalls;         /**< sendmmsg() calls that sent datagrams. */
+    uint64_t sendDatagrams;     /**< Datagrams sent by them. */
+    uint32_t sendMaxBatch;      /**< Most datagrams sent by one sendmmsg(). */
+} CAIPBatchStats_t;
+
+/**
+ * Get the batched datagram I/O counters. The copy is not synchronized with the
+ * sending and receiving threads.
+ *
+ * @param[out] stats    Counters since start or the last reset.
+ */
+void CAIPGetBatchStats(CAIPBatchStats_t *stats);
+
+/**
+ * Reset the batched datagram I/O counters.
+ */
+void CAIPResetBatchStats();
+
 /**
  * Get IP adapter connection state.
  *
@@ -27,6 +27,7 @@
 #define CA_MESSAGE_HANDLER_H_
 
 #include "cacommon.h"
+#include "ocevent.h"
 #include <coap/coap.h>
 
 #define CA_MEMORY_ALLOC_CHECK(arg) { if (NULL == arg) {OIC_LOG(ERROR, TAG, "Out of memory"); \
@@ -103,12 +104,29 @@ void CASetNetworkMonitorCallback(CANetworkMonitorCallback nwMonitorHandler);
  * @param[in] data    send data.
  */
 void CAAddDataToSendThread(CAData_t *data);
+#endif
 
+#ifndef SINGLE_THREAD
 /**
  * Add the data to the receive queue thread to notify received data.
  * @param[in] data    received data.
  */
 void CAAddDataToReceiveThread(CAData_t *data);
+
+/**
+ * Register an event to signal whenever received data is waiting for
+ * ::CAHandleRequestResponseCallbacks. Every registered event is signaled.
+ * @param[in] event   event to signal.
+ * @return  ::CA_STATUS_OK or an error if no more events can be registered.
+ */
+CAResult_t CARegisterMessageHandlerEvent(oc_event event);
+
+/**
+ * Stop signaling an event registered with ::CARegisterMessageHandlerEvent.
+ * The event is not signaled any more once this returns.
+ * @param[in] event   event to stop signaling.
+ */
+void CAUnregisterMessageHandlerEvent(oc_event event);
 #endif
 
 #ifdef __cplusplus
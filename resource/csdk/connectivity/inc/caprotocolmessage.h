@@ -54,15 +54,54 @@ typedef uint32_t code_t;
 static const uint8_t PAYLOAD_MARKER = 1;
 #endif
 
+/** Number of options a ::CAOptionList_t keeps without allocating. */
+#define CA_OPTION_LIST_INLINE_COUNT 16
+
+/** Option values up to this length are copied into the list. */
+#define CA_OPTION_INLINE_VALUE_SIZE 4
+
+/**
+ * CoAP option waiting to be written to a pdu.
+ */
+typedef struct
+{
+    uint16_t key;                                   /**< option number. */
+    uint16_t length;                                /**< length of the value. */
+    const uint8_t *data;                            /**< value, NULL if kept in value. */
+    uint8_t value[CA_OPTION_INLINE_VALUE_SIZE];     /**< short values. */
+} CAOption_t;
+
+/**
+ * Options of one message, sorted by option number.
+ *
+ * The list lives on the stack of the sender. Short values are copied into it
+ * and URI segments are split into its own buffer; longer header option values
+ * are referenced from the ::CAInfo_t they came from, which therefore has to
+ * outlive the list. Only lists with more than ::CA_OPTION_LIST_INLINE_COUNT
+ * options allocate.
+ */
+typedef struct
+{
+    CAOption_t *options;                            /**< inlineOptions or heap array. */
+    size_t count;                                   /**< number of options. */
+    size_t capacity;                                /**< room in options. */
+    CAOption_t inlineOptions[CA_OPTION_LIST_INLINE_COUNT];
+    size_t uriLength;                               /**< used part of uriBuffer. */
+    uint8_t uriBuffer[2 * CA_MAX_URI_LENGTH];       /**< encoded URI-Path/Query segments. */
+} CAOptionList_t;
+
 /**
  * generates pdu structure from the given information.
  * @param[in]   code                 code of the pdu packet.
  * @param[in]   info                 pdu information.
  * @param[in]   endpoint             endpoint information.
+ * @param[out]  optlist              initialized option list, filled with the options
+ *                                   of the message.
+ * @param[out]  transport            transport type of the pdu.
  * @return  generated pdu.
  */
 coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_t *endpoint,
-                          coap_list_t **optlist, coap_transport_t *transport);
+                          CAOptionList_t *optlist, coap_transport_t *transport);
 
 /**
  * extracts request information from received pdu.
@@ -103,7 +142,7 @@ CAResult_t CAGetErrorInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endp
  * @return  generated pdu.
  */
 coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
-                              const CAEndpoint_t *endpoint, coap_list_t *options,
+                              const CAEndpoint_t *endpoint, const CAOptionList_t *options,
                               coap_transport_t *transport);
 
 /**
@@ -112,7 +151,7 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
  * @param[out]   options             options information.
  * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
  */
-CAResult_t CAParseURI(const char *uriInfo, coap_list_t **options);
+CAResult_t CAParseURI(const char *uriInfo, CAOptionList_t *options);
 
 /**
  * Helper that uses libcoap to parse either the path or the parameters of a URI
@@ -126,7 +165,7 @@ CAResult_t CAParseURI(const char *uriInfo, coap_list_t **options);
  * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAParseUriPartial(const unsigned char *str, size_t length, uint16_t target,
-                             coap_list_t **optlist);
+                             CAOptionList_t *optlist);
 
 /**
  * create option list from header information in the info.
@@ -135,7 +174,7 @@ CAResult_t CAParseUriPartial(const unsigned char *str, size_t length, uint16_t t
  * @param[out]  optlist              options information.
  * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
  */
-CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, coap_list_t **optlist);
+CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, CAOptionList_t *optlist);
 
 /**
  * Helper to parse content format and accept format header options
@@ -150,25 +189,50 @@ CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, coap_list_t **
  */
 
 CAResult_t CAParsePayloadFormatHeadOption(uint16_t formatOption, CAPayloadFormat_t format,
-        uint16_t versionOption, uint16_t version, coap_list_t **optlist);
+        uint16_t versionOption, uint16_t version, CAOptionList_t *optlist);
 
 /**
- * creates option node from key length and data.
- * @param[in]   key                  key for the that needs to be sent.
- * @param[in]   length               length of the data that needs to be sent.
- * @param[in]   data                 data that needs to be sent.
- * @return  created list.
+ * initializes an empty option list.
+ * @param[out]  optlist              option list.
+ */
+void CAInitOptionList(CAOptionList_t *optlist);
+
+/**
+ * releases the memory of an option list and empties it.
+ * @param[in]   optlist              option list.
+ */
+void CAClearOptionList(CAOptionList_t *optlist);
+
+/**
+ * adds an option in order of option number. Options with the same number keep
+ * the order they were added in. Values of options with variable length integer
+ * format are shrunk to their shortest encoding.
+ * @param[in,out] optlist            option list.
+ * @param[in]   key                  option number.
+ * @param[in]   length               length of the value.
+ * @param[in]   data                 value, referenced if longer than
+ *                                   ::CA_OPTION_INLINE_VALUE_SIZE.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAAddOptionToList(CAOptionList_t *optlist, uint16_t key, uint32_t length,
+                             const uint8_t *data);
+
+/**
+ * writes the options of the list into the pdu.
+ * @param[in,out] pdu                pdu without options or payload yet.
+ * @param[in]   optlist              option list.
+ * @param[in]   transport            transport type of the pdu.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
  */
-coap_list_t *CACreateNewOptionNode(uint16_t key, uint32_t length, const char *data);
+CAResult_t CAWriteOptionListToPDU(coap_pdu_t *pdu, const CAOptionList_t *optlist,
+                                  coap_transport_t transport);
 
 /**
- * order the inserted options.
- * need to replace queue head if new node has to be added before the existing queue head.
- * @param[in]   a                    option 1 for insertion.
- * @param[in]   b                    option 2 for insertion.
- * @return  0 or 1.
+ * gets the value of an option in the list.
+ * @param[in]   option               option of a ::CAOptionList_t.
+ * @return  value of the option.
  */
-int CAOrderOpts(void *a, void *b);
+const uint8_t *CAGetOptionValue(const CAOption_t *option);
 
 /**
  * number of options count.
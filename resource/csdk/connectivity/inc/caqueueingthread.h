@@ -31,7 +31,7 @@
 
 #include "cathreadpool.h"
 #include "octhread.h"
-#include "uqueue.h"
+#include "umpscqueue.h"
 #include "cacommon.h"
 #ifdef __cplusplus
 extern "C"
@@ -44,6 +44,9 @@ typedef void (*CAThreadTask)(void *threadData);
 /** Data destroy function. **/
 typedef void (*CADataDestroyFunction)(void *data, uint32_t size);
 
+/** Function called once a batch of data has been processed. **/
+typedef void (*CABatchDoneFunction)();
+
 typedef struct
 {
     /** Thread pool of the thread started. **/
@@ -56,10 +59,14 @@ typedef struct
     CAThreadTask threadTask;
     /** Data destroy function. **/
     CADataDestroyFunction destroy;
+    /** Called after each batch, before its data is destroyed. May be NULL. **/
+    CABatchDoneFunction batchDone;
     /** Variable to inform the thread to stop. **/
     bool isStop;
-    /** Que on which the thread is operating. **/
-    u_queue_t *dataQueue;
+    /** Que on which the thread is operating. Producers add to it without locking. **/
+    u_mpsc_queue_t *dataQueue;
+    /** Set while the thread is waiting on threadCond for data. **/
+    volatile int32_t isWaiting;
 } CAQueueingThread_t;
 
 /**
@@ -73,6 +80,17 @@ typedef struct
 CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool_t handle,
                                       CAThreadTask task, CADataDestroyFunction destroy);
 
+/**
+ * Set a function the thread calls after each batch of data it took from the queue.
+ * The data of the batch is destroyed only after this function returns, so tasks
+ * may keep pointers into it until then. Must be set before the thread is started.
+ * @param[in]   thread       thread data for each thread.
+ * @param[in]   batchDone    function to be called after each batch, or NULL.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadSetBatchDone(CAQueueingThread_t *thread,
+                                        CABatchDoneFunction batchDone);
+
 /**
  * Start the queuing thread.
  * @param[in]   thread        thread data that needs to be started.
@@ -82,6 +100,7 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread);
 
 /**
  * Add queuing thread data for new thread.
+ * Does not take threadMutex unless the thread is waiting for data.
  * @param[in]   thread       thread data for new thread control.
  * @param[in]   data         data that needs to be given for each thread.
  * @param[in]   size         length of the data.
@@ -47,6 +47,9 @@
 /** check period is 1 sec. **/
 #define RETRANSMISSION_CHECK_PERIOD_SEC     1
 
+/** pending retransmission entry, private to caretransmission.c. **/
+struct CARetransmissionData;
+
 /** retransmission data send method type. **/
 typedef CAResult_t (*CADataSendMethod_t)(const CAEndpoint_t *endpoint,
                                          const void *pdu,
@@ -91,9 +94,12 @@ typedef struct
     /** Variable to inform the thread to stop. **/
     bool isStop;
 
-    /** array list on which the thread is operating. **/
+    /** array list on which the thread is operating, kept as a min-heap by next send time. **/
     u_arraylist_t *dataList;
 
+    /** hash index of dataList by message id and transport type. **/
+    struct CARetransmissionData *dataIndex;
+
 } CARetransmission_t;
 
 #ifdef __cplusplus
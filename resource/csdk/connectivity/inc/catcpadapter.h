@@ -30,6 +30,7 @@
 #include "cathreadpool.h"
 #include "cainterface.h"
 #include <coap/pdu.h>
+#include <coap/uthash.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -54,6 +55,15 @@ typedef enum
     DISCONNECTED
 } CATCPConnectionState_t;
 
+/**
+ * Hash key identifying a TCP session by remote address and port.
+ */
+typedef struct
+{
+    char addr[MAX_ADDR_STR_SIZE_CA];    /**< remote address, zero padded */
+    uint16_t port;                      /**< remote port */
+} CATCPSessionKey_t;
+
 /**
  * TCP Session Information for IPv4/IPv6 TCP transport
  */
@@ -70,6 +80,11 @@ typedef struct CATCPSessionInfo_t
     CATCPConnectionState_t state;       /**< current tcp session state */
     bool isClient;                      /**< Host Mode of Operation. */
     struct CATCPSessionInfo_t *next;    /**< Linked list; for multiple session list. */
+    struct CATCPSessionInfo_t *prev;    /**< Linked list; for O(1) removal from the list. */
+    struct CATCPSessionInfo_t *epNext;  /**< Other sessions with the same address and port. */
+    CATCPSessionKey_t key;              /**< endpoint index key */
+    UT_hash_handle hhFd;                /**< handle in the session index by fd */
+    UT_hash_handle hhEp;                /**< handle in the session index by endpoint */
 } CATCPSessionInfo_t;
 
 /**
@@ -37,6 +37,8 @@
 #include "experimental/byte_array.h"
 #include "octhread.h"
 #include "octimer.h"
+#include "ocatomic.h"
+#include <coap/uthash.h>
 
 // headers required for mbed TLS
 #include "mbedtls/platform.h"
@@ -47,6 +49,10 @@
 #include "mbedtls/ssl_internal.h"
 #include "mbedtls/net_sockets.h"
 #include "mbedtls/oid.h"
+#include "mbedtls/ssl_cache.h"
+#ifdef MBEDTLS_SSL_SESSION_TICKETS
+#include "mbedtls/ssl_ticket.h"
+#endif
 #ifdef __WITH_DTLS__
 #include "mbedtls/timing.h"
 #include "mbedtls/ssl_cookie.h"
@@ -129,6 +135,16 @@
  * @brief TLS client and server random bytes length
  */
 #define RANDOM_LEN (32)
+/**
+ * @def SSL_SESSION_TIMEOUT
+ * @brief Seconds a session may be resumed after its full handshake
+ */
+#define SSL_SESSION_TIMEOUT (3600)
+/**
+ * @def SSL_SESSION_CACHE_SIZE
+ * @brief Maximum number of sessions kept for resumption, per role
+ */
+#define SSL_SESSION_CACHE_SIZE (32)
 /**
  * @def SHA384_MAC_KEY_LENGTH
  * @brief MAC key length for SHA384 cipher suites
@@ -353,13 +369,40 @@ typedef struct TlsCallBacks
     CAErrorHandleCallback errorCallback;    /**< Callback used to pass error to upper layer. */
 } SslCallbacks_t;
 
+/**
+ * Key of the peer list and of the saved client sessions. Must be zeroed before it is
+ * filled, see GetSslPeerKey().
+ */
+typedef struct SslPeerKey
+{
+    CATransportAdapter_t adapter;
+    uint16_t port;                      /**< 0 for BLE, whose peers are matched by address only */
+    char addr[MAX_ADDR_STR_SIZE_CA];
+} SslPeerKey_t;
+
+/**
+ * Data structure for holding a client session kept for resumption.
+ */
+typedef struct SslSavedSession
+{
+    SslPeerKey_t key;
+    mbedtls_ssl_session session;
+    UT_hash_handle hh;
+} SslSavedSession_t;
+
 /**
  * Data structure for holding the mbedTLS interface related info.
  */
 typedef struct SslContext
 {
-    u_arraylist_t *peerList;         /**< peer list which holds the mapping between
+    struct SslEndPoint *peerList;    /**< peer hash which holds the mapping between
                                               peer id, it's n/w address and mbedTLS context. */
+    SslSavedSession_t *savedSessions; /**< sessions to offer when connecting to a peer again,
+                                              in the order they were saved. */
+    mbedtls_ssl_cache_context sessionCache; /**< sessions the server side may resume. */
+#ifdef MBEDTLS_SSL_SESSION_TICKETS
+    mbedtls_ssl_ticket_context ticketCtx;
+#endif
     mbedtls_entropy_context entropy;
     mbedtls_ctr_drbg_context rnd;
     mbedtls_x509_crt ca;
@@ -374,6 +417,13 @@ typedef struct SslContext
     SslCipher_t cipher;
     SslCallbacks_t adapterCallbacks[MAX_SUPPORTED_ADAPTERS];
     mbedtls_x509_crl crl;
+    bool pkixOwnCert;                /**< crt and pkey hold a usable own certificate. */
+    bool pkixCrl;                    /**< crl holds a parsed CRL. */
+    int pkixResult;                  /**< InitPKIX() result for the loaded PKIX info. */
+    int32_t pkixGeneration;          /**< g_pkixInfoGeneration ca, crt, pkey and crl were
+                                          loaded at, 0 if never loaded. */
+    int32_t pkixTlsConfGeneration;   /**< generation the TLS configs were set up with. */
+    int32_t pkixDtlsConfGeneration;  /**< generation the DTLS configs were set up with. */
     bool cipherFlag[2];
     int selectedCipher;
 
@@ -407,6 +457,13 @@ static CAgetCredentialTypesHandler g_getCredentialTypesCallback = NULL;
  */
 static CAgetPkixInfoHandler g_getPkixInfoCallback = NULL;
 
+/**
+ * @var g_pkixInfoGeneration
+ *
+ * @brief bumped whenever the info g_getPkixInfoCallback provides may have changed
+ */
+static volatile int32_t g_pkixInfoGeneration = 1;
+
 /**
  * @var g_dtlsContextMutex
  * @brief Mutex to synchronize access to g_caSslContext and g_sslCallback.
@@ -447,9 +504,12 @@ typedef struct SslEndPoint
     SslRecBuf_t recBuf;
     uint8_t master[MASTER_SECRET_LEN];
     uint8_t random[2*RANDOM_LEN];
+    bool resumed;                       /**< session was resumed, random is not set */
 #ifdef __WITH_DTLS__
     mbedtls_timing_delay_context timer;
 #endif // __WITH_DTLS__
+    SslPeerKey_t key;
+    UT_hash_handle hh;
 } SslEndPoint_t;
 
 void CAsetPskCredentialsCallback(CAgetPskCredentialsHandler credCallback)
@@ -464,6 +524,28 @@ void CAsetPkixInfoCallback(CAgetPkixInfoHandler infoCallback)
 {
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
     g_getPkixInfoCallback = infoCallback;
+    oc_atomic_increment(&g_pkixInfoGeneration);
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+}
+
+static void FlushResumableSessions(void);
+
+void CAinvalidatePkixInfo(void)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    oc_atomic_increment(&g_pkixInfoGeneration);
+
+    // A resumed session skips the chain and CRL checks, so sessions established
+    // with the old credentials must not be resumed.
+    if (NULL != g_sslContextMutex)
+    {
+        oc_mutex_lock(g_sslContextMutex);
+        if (NULL != g_caSslContext)
+        {
+            FlushResumableSessions();
+        }
+        oc_mutex_unlock(g_sslContextMutex);
+    }
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
 
@@ -708,8 +790,8 @@ static void DeInitPkixInfo(PkiInfo_t * inf)
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
 
-//Loads PKIX related information from SRM
-static int InitPKIX(CATransportAdapter_t adapter)
+//Loads PKIX related information from SRM and parses it into g_caSslContext
+static int LoadPKIX(void)
 {
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
     VERIFY_NON_NULL_RET(g_getPkixInfoCallback, NET_SSL_TAG, "PKIX info callback is NULL", -1);
@@ -738,12 +820,9 @@ static int InitPKIX(CATransportAdapter_t adapter)
     mbedtls_pk_init(&g_caSslContext->pkey);
     mbedtls_x509_crl_init(&g_caSslContext->crl);
 
-    mbedtls_ssl_config * serverConf = (adapter == CA_ADAPTER_IP ||
-                                   adapter == CA_ADAPTER_GATT_BTLE ?
-                                   &g_caSslContext->serverDtlsConf : &g_caSslContext->serverTlsConf);
-    mbedtls_ssl_config * clientConf = (adapter == CA_ADAPTER_IP ||
-                                   adapter == CA_ADAPTER_GATT_BTLE ?
-                                   &g_caSslContext->clientDtlsConf : &g_caSslContext->clientTlsConf);
+    g_caSslContext->pkixOwnCert = false;
+    g_caSslContext->pkixCrl = false;
+
     // optional
     int ret;
     int errNum;
@@ -765,6 +844,73 @@ static int InitPKIX(CATransportAdapter_t adapter)
         OIC_LOG(WARNING, NET_SSL_TAG, "Key parsing error");
         goto required;
     }
+    g_caSslContext->pkixOwnCert = true;
+
+    required:
+    count = ParseChain(&g_caSslContext->ca, pkiInfo.ca.data, pkiInfo.ca.len, &errNum);
+    if(0 >= count)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "CA chain parsing error");
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        DeInitPkixInfo(&pkiInfo);
+        return -1;
+    }
+    if(0 != errNum)
+    {
+        OIC_LOG_V(WARNING, NET_SSL_TAG, "CA chain parsing warning: %d certs failed to parse", errNum);
+    }
+
+    ret = mbedtls_x509_crl_parse_der(&g_caSslContext->crl, pkiInfo.crl.data, pkiInfo.crl.len);
+    if(0 != ret)
+    {
+        OIC_LOG(WARNING, NET_SSL_TAG, "CRL parsing error");
+    }
+    else
+    {
+        g_caSslContext->pkixCrl = true;
+    }
+
+    DeInitPkixInfo(&pkiInfo);
+
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+    return 0;
+}
+
+//Configures the configs of the adapter with the PKIX material, loading it again if it changed
+static int InitPKIX(CATransportAdapter_t adapter)
+{
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
+    VERIFY_NON_NULL_RET(g_getPkixInfoCallback, NET_SSL_TAG, "PKIX info callback is NULL", -1);
+    VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", -1);
+
+    bool isDtls = (adapter == CA_ADAPTER_IP || adapter == CA_ADAPTER_GATT_BTLE);
+    int32_t *confGeneration = (isDtls ? &g_caSslContext->pkixDtlsConfGeneration :
+                                        &g_caSslContext->pkixTlsConfGeneration);
+    // Read before the callback runs, so a change made while loading is picked up next time.
+    int32_t generation = oc_atomic_add(&g_pkixInfoGeneration, 0);
+
+    if (generation == *confGeneration)
+    {
+        OIC_LOG(DEBUG, NET_SSL_TAG, "PKIX info unchanged, using parsed copy");
+        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
+        return g_caSslContext->pkixResult;
+    }
+
+    if (generation != g_caSslContext->pkixGeneration)
+    {
+        g_caSslContext->pkixResult = LoadPKIX();
+        g_caSslContext->pkixGeneration = generation;
+    }
+
+    mbedtls_ssl_config * serverConf = (isDtls ? &g_caSslContext->serverDtlsConf :
+                                                &g_caSslContext->serverTlsConf);
+    mbedtls_ssl_config * clientConf = (isDtls ? &g_caSslContext->clientDtlsConf :
+                                                &g_caSslContext->clientTlsConf);
+    int ret;
+    if (!g_caSslContext->pkixOwnCert)
+    {
+        goto required;
+    }
 
     ret = mbedtls_ssl_conf_own_cert(serverConf, &g_caSslContext->crt, &g_caSslContext->pkey);
     if (0 != ret)
@@ -796,35 +942,15 @@ static int InitPKIX(CATransportAdapter_t adapter)
     }
 
     required:
-    count = ParseChain(&g_caSslContext->ca, pkiInfo.ca.data, pkiInfo.ca.len, &errNum);
-    if(0 >= count)
+    if (0 == g_caSslContext->pkixResult)
     {
-        OIC_LOG(ERROR, NET_SSL_TAG, "CA chain parsing error");
-        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-        DeInitPkixInfo(&pkiInfo);
-        return -1;
-    }
-    if(0 != errNum)
-    {
-        OIC_LOG_V(WARNING, NET_SSL_TAG, "CA chain parsing warning: %d certs failed to parse", errNum);
+        CONF_SSL(clientConf, serverConf, mbedtls_ssl_conf_ca_chain, &g_caSslContext->ca,
+                 g_caSslContext->pkixCrl ? &g_caSslContext->crl : NULL);
     }
-
-    ret = mbedtls_x509_crl_parse_der(&g_caSslContext->crl, pkiInfo.crl.data, pkiInfo.crl.len);
-    if(0 != ret)
-    {
-        OIC_LOG(WARNING, NET_SSL_TAG, "CRL parsing error");
-        CONF_SSL(clientConf, serverConf, mbedtls_ssl_conf_ca_chain, &g_caSslContext->ca, NULL);
-    }
-    else
-    {
-        CONF_SSL(clientConf, serverConf, mbedtls_ssl_conf_ca_chain,
-                 &g_caSslContext->ca, &g_caSslContext->crl);
-    }
-
-    DeInitPkixInfo(&pkiInfo);
+    *confGeneration = generation;
 
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-    return 0;
+    return g_caSslContext->pkixResult;
 }
 
 /*
@@ -868,6 +994,20 @@ static int GetPskCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
     OIC_LOG_V(WARNING, NET_SSL_TAG, "Out %s", __func__);
     return -1;
 }
+/**
+ * Fills the peer list key for endpoint.
+ *
+ * @param[in]  endpoint    remote address
+ * @param[out] key    key to fill
+ */
+static void GetSslPeerKey(const CAEndpoint_t *endpoint, SslPeerKey_t *key)
+{
+    memset(key, 0, sizeof(*key));
+    key->adapter = endpoint->adapter;
+    key->port = (CA_ADAPTER_GATT_BTLE == endpoint->adapter) ? 0 : endpoint->port;
+    strncpy(key->addr, endpoint->addr, sizeof(key->addr));
+}
+
 /**
  * Gets session corresponding for endpoint.
  *
@@ -877,8 +1017,6 @@ static int GetPskCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
  */
 static SslEndPoint_t *GetSslPeer(const CAEndpoint_t *peer)
 {
-    size_t listIndex = 0;
-    size_t listLength = 0;
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "In %s", __func__);
 
     oc_mutex_assert_owner(g_sslContextMutex, true);
@@ -886,31 +1024,17 @@ static SslEndPoint_t *GetSslPeer(const CAEndpoint_t *peer)
     VERIFY_NON_NULL_RET(peer, NET_SSL_TAG, "TLS peer is NULL", NULL);
     VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", NULL);
 
+    SslPeerKey_t key;
+    GetSslPeerKey(peer, &key);
+
     SslEndPoint_t *tep = NULL;
-    listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (listIndex = 0; listIndex < listLength; listIndex++)
+    HASH_FIND(hh, g_caSslContext->peerList, &key, sizeof(key), tep);
+    if (NULL == tep)
     {
-        tep = (SslEndPoint_t *) u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
-
-        OIC_LOG_V(DEBUG, NET_SSL_TAG, "Compare [%s:%d] and [%s:%d] for %d adapter",
-                  peer->addr, peer->port, tep->sep.endpoint.addr, tep->sep.endpoint.port,
-                  peer->adapter);
-
-        if((peer->adapter == tep->sep.endpoint.adapter)
-                && (0 == strncmp(peer->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA))
-                && (peer->port == tep->sep.endpoint.port || CA_ADAPTER_GATT_BTLE == peer->adapter))
-        {
-            OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-            return tep;
-        }
+        OIC_LOG(DEBUG, NET_SSL_TAG, "Return NULL");
     }
-    OIC_LOG(DEBUG, NET_SSL_TAG, "Return NULL");
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
-    return NULL;
+    return tep;
 }
 
 /**
@@ -1105,6 +1229,31 @@ static void DeleteSslEndPoint(SslEndPoint_t * tep)
     OICFree(tep);
     OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
 }
+/**
+ * Adds endpoint session to list.
+ *
+ * @param[in]  tep    endpoint with session info
+ *
+ * @return  true on success, false if there is a session for the address already
+ */
+static bool AddPeerToList(SslEndPoint_t * tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    VERIFY_NON_NULL_RET(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL", false);
+    VERIFY_NON_NULL_RET(tep, NET_SSL_TAG, "tep", false);
+
+    SslEndPoint_t * existing = NULL;
+    GetSslPeerKey(&tep->sep.endpoint, &tep->key);
+    HASH_FIND(hh, g_caSslContext->peerList, &tep->key, sizeof(tep->key), existing);
+    if (NULL != existing)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session for the address exists already");
+        return false;
+    }
+    HASH_ADD(hh, g_caSslContext->peerList, key, sizeof(tep->key), tep);
+    return true;
+}
 /**
  * Removes endpoint session from list.
  *
@@ -1117,24 +1266,188 @@ static void RemovePeerFromList(CAEndpoint_t * endpoint)
     VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
     VERIFY_NON_NULL_VOID(endpoint, NET_SSL_TAG, "endpoint");
 
-    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (size_t listIndex = 0; listIndex < listLength; listIndex++)
+    SslEndPoint_t * tep = GetSslPeer(endpoint);
+    if (NULL != tep)
     {
-        SslEndPoint_t * tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
-        if(0 == strncmp(endpoint->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA)
-                && (endpoint->port == tep->sep.endpoint.port))
-        {
-            u_arraylist_remove(g_caSslContext->peerList, listIndex);
-            DeleteSslEndPoint(tep);
-            return;
-        }
+        HASH_DELETE(hh, g_caSslContext->peerList, tep);
+        DeleteSslEndPoint(tep);
+    }
+}
+
+/**
+ * Checks whether sessions negotiated with a ciphersuite may be resumed. PSK and
+ * anonymous ciphersuites are used for ownership transfer and bind the peer's
+ * identity during the handshake only, so they always take a full handshake.
+ *
+ * @param[in]  ciphersuite    negotiated ciphersuite
+ *
+ * @return  true if the session may be cached
+ */
+static bool IsResumableCipherSuite(int ciphersuite)
+{
+    return (MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256 != ciphersuite &&
+            MBEDTLS_TLS_ECDH_ANON_WITH_AES_128_CBC_SHA256 != ciphersuite);
+}
+
+/**
+ * Server session cache store callback, skips sessions that must not be resumed.
+ */
+static int SetCachedSession(void * cache, const mbedtls_ssl_session * session)
+{
+    if (!IsResumableCipherSuite(session->ciphersuite))
+    {
+        return 0;
+    }
+    return mbedtls_ssl_cache_set(cache, session);
+}
+
+#ifdef MBEDTLS_SSL_SESSION_TICKETS
+/**
+ * Session ticket write callback, skips sessions that must not be resumed.
+ */
+static int WriteSessionTicket(void * ticket, const mbedtls_ssl_session * session,
+                              unsigned char * start, const unsigned char * end,
+                              size_t * tlen, uint32_t * lifetime)
+{
+    if (!IsResumableCipherSuite(session->ciphersuite))
+    {
+        return MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+    }
+    return mbedtls_ssl_ticket_write(ticket, session, start, end, tlen, lifetime);
+}
+#endif
+
+/**
+ * Frees a saved client session.
+ *
+ * @param[in]  saved    session to free, already removed from the saved sessions
+ */
+static void DeleteSavedSession(SslSavedSession_t * saved)
+{
+    mbedtls_ssl_session_free(&saved->session);
+    OICFree(saved);
+}
+
+/**
+ * Saves the session of a completed client handshake so that the next
+ * connection to the same address can resume it.
+ *
+ * @param[in]  tep    endpoint with session info
+ */
+static void SaveClientSession(SslEndPoint_t * tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    SslSavedSession_t * saved = NULL;
+    HASH_FIND(hh, g_caSslContext->savedSessions, &tep->key, sizeof(tep->key), saved);
+    if (NULL != saved)
+    {
+        HASH_DELETE(hh, g_caSslContext->savedSessions, saved);
+        DeleteSavedSession(saved);
+    }
+    else if (SSL_SESSION_CACHE_SIZE <= HASH_COUNT(g_caSslContext->savedSessions))
+    {
+        // The head of the hash is the session saved first.
+        saved = g_caSslContext->savedSessions;
+        HASH_DELETE(hh, g_caSslContext->savedSessions, saved);
+        DeleteSavedSession(saved);
+    }
+
+    saved = (SslSavedSession_t *) OICCalloc(1, sizeof(SslSavedSession_t));
+    if (NULL == saved)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Malloc failed!");
+        return;
+    }
+    mbedtls_ssl_session_init(&saved->session);
+    if (0 != mbedtls_ssl_get_session(&tep->ssl, &saved->session))
+    {
+        OIC_LOG(WARNING, NET_SSL_TAG, "Failed to save session");
+        DeleteSavedSession(saved);
+        return;
+    }
+    saved->key = tep->key;
+    HASH_ADD(hh, g_caSslContext->savedSessions, key, sizeof(saved->key), saved);
+}
+
+/**
+ * Offers the session saved for the address of a new client endpoint.
+ *
+ * @param[in]  tep    endpoint added to the peer list, before its handshake
+ */
+static void RestoreClientSession(SslEndPoint_t * tep)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    SslSavedSession_t * saved = NULL;
+    HASH_FIND(hh, g_caSslContext->savedSessions, &tep->key, sizeof(tep->key), saved);
+    if (NULL != saved && 0 != mbedtls_ssl_set_session(&tep->ssl, &saved->session))
+    {
+        OIC_LOG(WARNING, NET_SSL_TAG, "Failed to restore session");
+    }
+}
+
+/**
+ * Forgets the session saved for endpoint.
+ *
+ * @param[in]  endpoint    remote address
+ */
+static void RemoveClientSession(const CAEndpoint_t * endpoint)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    SslPeerKey_t key;
+    GetSslPeerKey(endpoint, &key);
+
+    SslSavedSession_t * saved = NULL;
+    HASH_FIND(hh, g_caSslContext->savedSessions, &key, sizeof(key), saved);
+    if (NULL != saved)
+    {
+        HASH_DELETE(hh, g_caSslContext->savedSessions, saved);
+        DeleteSavedSession(saved);
+    }
+}
+
+/**
+ * Deletes all saved client sessions.
+ */
+static void DeleteSavedSessions()
+{
+    SslSavedSession_t * saved = NULL;
+    SslSavedSession_t * tmp = NULL;
+    HASH_ITER(hh, g_caSslContext->savedSessions, saved, tmp)
+    {
+        HASH_DELETE(hh, g_caSslContext->savedSessions, saved);
+        DeleteSavedSession(saved);
     }
 }
 
+/**
+ * Drops every session the client or the server side could resume, including
+ * the session tickets issued so far.
+ */
+static void FlushResumableSessions(void)
+{
+    oc_mutex_assert_owner(g_sslContextMutex, true);
+
+    DeleteSavedSessions();
+    mbedtls_ssl_cache_free(&g_caSslContext->sessionCache);
+    mbedtls_ssl_cache_init(&g_caSslContext->sessionCache);
+    mbedtls_ssl_cache_set_timeout(&g_caSslContext->sessionCache, SSL_SESSION_TIMEOUT);
+    mbedtls_ssl_cache_set_max_entries(&g_caSslContext->sessionCache, SSL_SESSION_CACHE_SIZE);
+#ifdef MBEDTLS_SSL_SESSION_TICKETS
+    // New ticket keys make the tickets already handed out unreadable.
+    mbedtls_ssl_ticket_free(&g_caSslContext->ticketCtx);
+    mbedtls_ssl_ticket_init(&g_caSslContext->ticketCtx);
+    if (0 != mbedtls_ssl_ticket_setup(&g_caSslContext->ticketCtx, mbedtls_ctr_drbg_random,
+                                      &g_caSslContext->rnd, MBEDTLS_CIPHER_AES_128_GCM,
+                                      SSL_SESSION_TIMEOUT))
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session ticket setup failed!");
+    }
+#endif
+}
+
  /**
   * Checks handshake result. Removes peer from list and sends alert
   * if handshake failed.
@@ -1200,6 +1513,8 @@ static bool checkSslOperation(SslEndPoint_t*  peer,
             }
         }
 
+        // Do not offer a session again that the peer failed to resume.
+        RemoveClientSession(&removedEndpoint);
         RemovePeerFromList(&removedEndpoint);
 
         oc_mutex_unlock(g_sslContextMutex);
@@ -1218,14 +1533,10 @@ static void DeletePeerList()
 
     VERIFY_NON_NULL_VOID(g_caSslContext, NET_SSL_TAG, "SSL Context is NULL");
 
-    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    for (size_t listIndex = 0; listIndex < listLength; listIndex++)
+    SslEndPoint_t * tep = NULL;
+    SslEndPoint_t * tmp = NULL;
+    HASH_ITER(hh, g_caSslContext->peerList, tep, tmp)
     {
-        SslEndPoint_t * tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList, listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
         if (MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
         {
             int ret = 0;
@@ -1235,9 +1546,9 @@ static void DeletePeerList()
             }
             while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);
         }
+        HASH_DELETE(hh, g_caSslContext->peerList, tep);
         DeleteSslEndPoint(tep);
     }
-    u_arraylist_free(&g_caSslContext->peerList);
 }
 
 CAResult_t CAcloseSslConnection(const CAEndpoint_t *endpoint)
@@ -1285,16 +1596,12 @@ void CAcloseSslConnectionAll(CATransportAdapter_t transportType)
         return;
     }
 
-    size_t listLength = u_arraylist_length(g_caSslContext->peerList);
-    OIC_LOG_V(DEBUG, NET_SSL_TAG,
-            "Required transport [%d], peer count [%" PRIuPTR "]", transportType, listLength);
-    for (size_t i = listLength; i > 0; i--)
+    OIC_LOG_V(DEBUG, NET_SSL_TAG, "Required transport [%d], peer count [%u]",
+              transportType, HASH_COUNT(g_caSslContext->peerList));
+    SslEndPoint_t *tep = NULL;
+    SslEndPoint_t *tmp = NULL;
+    HASH_ITER(hh, g_caSslContext->peerList, tep, tmp)
     {
-        SslEndPoint_t *tep = (SslEndPoint_t *)u_arraylist_get(g_caSslContext->peerList, i - 1);
-        if (NULL == tep)
-        {
-            continue;
-        }
         OIC_LOG_V(DEBUG, NET_SSL_TAG, "SSL Connection [%s:%d], Transport [%d]",
                   tep->sep.endpoint.addr, tep->sep.endpoint.port, tep->sep.endpoint.adapter);
 
@@ -1314,7 +1621,7 @@ void CAcloseSslConnectionAll(CATransportAdapter_t transportType)
         while (MBEDTLS_ERR_SSL_WANT_WRITE == ret);*/
 
         // delete from list
-        u_arraylist_remove(g_caSslContext->peerList, i - 1);
+        HASH_DELETE(hh, g_caSslContext->peerList, tep);
         DeleteSslEndPoint(tep);
     }
     oc_mutex_unlock(g_sslContextMutex);
@@ -1555,15 +1862,20 @@ static SslEndPoint_t * InitiateTlsHandshake(const CAEndpoint_t *endpoint)
     }
 
     oc_mutex_lock(g_sslContextMutex);
-    ret = u_arraylist_add(g_caSslContext->peerList, (void *) tep);
-    if (!ret)
+    if (!AddPeerToList(tep))
     {
         oc_mutex_unlock(g_sslContextMutex);
-        OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
+        OIC_LOG(ERROR, NET_SSL_TAG, "AddPeerToList failed!");
         DeleteSslEndPoint(tep);
         return NULL;
     }
 
+    // A preferred ciphersuite is selected for ownership transfer, which needs a full handshake.
+    if (SSL_CIPHER_MAX == g_caSslContext->cipher)
+    {
+        RestoreClientSession(tep);
+    }
+
     while (MBEDTLS_SSL_HANDSHAKE_OVER > tep->ssl.state)
     {
         ret = mbedtls_ssl_handshake_step(&tep->ssl);
@@ -1619,10 +1931,17 @@ void CAdeinitSslAdapter()
 
     // Clear all lists
     DeletePeerList();
+    DeleteSavedSessions();
+    mbedtls_ssl_cache_free(&g_caSslContext->sessionCache);
+#ifdef MBEDTLS_SSL_SESSION_TICKETS
+    mbedtls_ssl_ticket_free(&g_caSslContext->ticketCtx);
+#endif
 
     // De-initialize mbedTLS
+    mbedtls_x509_crt_free(&g_caSslContext->ca);
     mbedtls_x509_crt_free(&g_caSslContext->crt);
     mbedtls_pk_free(&g_caSslContext->pkey);
+    mbedtls_x509_crl_free(&g_caSslContext->crl);
 #ifdef __WITH_TLS__
     mbedtls_ssl_config_free(&g_caSslContext->clientTlsConf);
     mbedtls_ssl_config_free(&g_caSslContext->serverTlsConf);
@@ -1670,6 +1989,16 @@ static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
     mbedtls_ssl_conf_curves(conf, curve[ADAPTER_CURVE_SECP256R1]);
     mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_REQUIRED);
 
+    if (MBEDTLS_SSL_IS_SERVER == mode)
+    {
+        mbedtls_ssl_conf_session_cache(conf, &g_caSslContext->sessionCache,
+                                       mbedtls_ssl_cache_get, SetCachedSession);
+#ifdef MBEDTLS_SSL_SESSION_TICKETS
+        mbedtls_ssl_conf_session_tickets_cb(conf, WriteSessionTicket, mbedtls_ssl_ticket_parse,
+                                            &g_caSslContext->ticketCtx);
+#endif
+    }
+
 #ifdef __WITH_DTLS__
     if (MBEDTLS_SSL_TRANSPORT_DATAGRAM == transport &&
             MBEDTLS_SSL_IS_SERVER == mode)
@@ -1697,9 +2026,8 @@ static int InitConfig(mbedtls_ssl_config * conf, int transport, int mode)
  */
 static void StartRetransmit(void *ctx)
 {
-    size_t listIndex = 0;
-    size_t listLength = 0;
     SslEndPoint_t *tep = NULL;
+    SslEndPoint_t *tmp = NULL;
     OC_UNUSED(ctx);
 
     oc_mutex_lock(g_sslContextMutex);
@@ -1715,12 +2043,9 @@ static void StartRetransmit(void *ctx)
         //clear previous timer
         unregisterTimer(g_caSslContext->timerId);
 
-        listLength = u_arraylist_length(g_caSslContext->peerList);
-        for (listIndex = 0; listIndex < listLength; listIndex++)
+        HASH_ITER(hh, g_caSslContext->peerList, tep, tmp)
         {
-            tep = (SslEndPoint_t *) u_arraylist_get(g_caSslContext->peerList, listIndex);
-            if (NULL == tep
-                || (tep->ssl.conf && MBEDTLS_SSL_TRANSPORT_STREAM == tep->ssl.conf->transport)
+            if ((tep->ssl.conf && MBEDTLS_SSL_TRANSPORT_STREAM == tep->ssl.conf->transport)
                 || MBEDTLS_SSL_HANDSHAKE_OVER == tep->ssl.state)
             {
                 continue;
@@ -1778,20 +2103,6 @@ CAResult_t CAinitSslAdapter()
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    // Create peer list
-    g_caSslContext->peerList = u_arraylist_create();
-
-    if(NULL == g_caSslContext->peerList)
-    {
-        OIC_LOG(ERROR, NET_SSL_TAG, "peerList initialization failed!");
-        OICFree(g_caSslContext);
-        g_caSslContext = NULL;
-        oc_mutex_unlock(g_sslContextMutex);
-        oc_mutex_free(g_sslContextMutex);
-        g_sslContextMutex = NULL;
-        return CA_STATUS_FAILED;
-    }
-
     /* Initialize TLS library
      */
 #if !defined(NDEBUG) || defined(TB_LOG)
@@ -1820,6 +2131,24 @@ CAResult_t CAinitSslAdapter()
     }
     mbedtls_ctr_drbg_set_prediction_resistance(&g_caSslContext->rnd, MBEDTLS_CTR_DRBG_PR_ON);
 
+    /* Session resumption
+     */
+    mbedtls_ssl_cache_init(&g_caSslContext->sessionCache);
+    mbedtls_ssl_cache_set_timeout(&g_caSslContext->sessionCache, SSL_SESSION_TIMEOUT);
+    mbedtls_ssl_cache_set_max_entries(&g_caSslContext->sessionCache, SSL_SESSION_CACHE_SIZE);
+#ifdef MBEDTLS_SSL_SESSION_TICKETS
+    mbedtls_ssl_ticket_init(&g_caSslContext->ticketCtx);
+    if (0 != mbedtls_ssl_ticket_setup(&g_caSslContext->ticketCtx, mbedtls_ctr_drbg_random,
+                                      &g_caSslContext->rnd, MBEDTLS_CIPHER_AES_128_GCM,
+                                      SSL_SESSION_TIMEOUT))
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session ticket setup failed!");
+        oc_mutex_unlock(g_sslContextMutex);
+        CAdeinitSslAdapter();
+        return CA_STATUS_FAILED;
+    }
+#endif
+
 #ifdef __WITH_TLS__
     if (0 != InitConfig(&g_caSslContext->clientTlsConf,
                         MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_IS_CLIENT))
@@ -2144,10 +2473,9 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
             return CA_STATUS_FAILED;
         }
 
-        ret = u_arraylist_add(g_caSslContext->peerList, (void *) peer);
-        if (!ret)
+        if (!AddPeerToList(peer))
         {
-            OIC_LOG(ERROR, NET_SSL_TAG, "u_arraylist_add failed!");
+            OIC_LOG(ERROR, NET_SSL_TAG, "AddPeerToList failed!");
             DeleteSslEndPoint(peer);
             oc_mutex_unlock(g_sslContextMutex);
             return CA_STATUS_FAILED;
@@ -2217,6 +2545,7 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
 
         if (MBEDTLS_SSL_CLIENT_CHANGE_CIPHER_SPEC == peer->ssl.state)
         {
+            peer->resumed = (0 != peer->ssl.handshake->resume);
             memcpy(peer->master, peer->ssl.session_negotiate->master, sizeof(peer->master));
             g_caSslContext->selectedCipher = peer->ssl.session_negotiate->ciphersuite;
         }
@@ -2236,8 +2565,7 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
 
             int selectedCipher = peer->ssl.session->ciphersuite;
             OIC_LOG_V(DEBUG, NET_SSL_TAG, "(D)TLS Session is connected via ciphersuite [0x%x]", selectedCipher);
-            if (MBEDTLS_TLS_ECDHE_PSK_WITH_AES_128_CBC_SHA256 != selectedCipher &&
-                MBEDTLS_TLS_ECDH_ANON_WITH_AES_128_CBC_SHA256 != selectedCipher)
+            if (IsResumableCipherSuite(selectedCipher))
             {
                 const mbedtls_x509_crt * peerCert = mbedtls_ssl_get_peer_cert(&peer->ssl);
                 const mbedtls_x509_name * name = NULL;
@@ -2359,6 +2687,12 @@ CAResult_t CAdecryptSsl(const CASecureEndpoint_t *sep, uint8_t *data, size_t dat
                 peer->sep.publicKeyLength = 0;
             }
 
+            if (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint &&
+                !peer->resumed && IsResumableCipherSuite(selectedCipher))
+            {
+                SaveClientSession(peer);
+            }
+
             oc_mutex_unlock(g_sslContextMutex);
             OIC_LOG_V(DEBUG, NET_SSL_TAG, "Out %s", __func__);
             return CA_STATUS_OK;
@@ -2699,6 +3033,12 @@ CAResult_t CAsslGenerateOwnerPsk(const CAEndpoint_t *endpoint,
         oc_mutex_unlock(g_sslContextMutex);
         return CA_STATUS_FAILED;
     }
+    if (tep->resumed)
+    {
+        OIC_LOG(ERROR, NET_SSL_TAG, "Session was resumed, handshake random is not available");
+        oc_mutex_unlock(g_sslContextMutex);
+        return CA_STATUS_FAILED;
+    }
 
     // keyBlockLen set up according to OIC 1.1 Security Specification Section 7.3.2
     int macKeyLen = 0;
@@ -3853,32 +3853,42 @@ static void CALERemoveSendQueueData(CAQueueingThread_t *queueHandle, oc_mutex mu
     VERIFY_NON_NULL_VOID(address, CALEADAPTER_TAG, "address");
 
     oc_mutex_lock(mutex);
-    while (u_queue_get_size(queueHandle->dataQueue) > 0)
+    // threadMutex keeps the queueing thread from taking data meanwhile.
+    // Data for other devices is put back at the end of the queue.
+    oc_mutex_lock(queueHandle->threadMutex);
+    uint32_t count = u_mpsc_queue_get_size(queueHandle->dataQueue);
+    for (uint32_t i = 0; i < count; i++)
     {
         OIC_LOG(DEBUG, CALEADAPTER_TAG, "get data from queue");
-        u_queue_message_t *message = u_queue_get_element(queueHandle->dataQueue);
-        if (NULL != message)
+        u_queue_message_t *message = u_mpsc_queue_get_element(queueHandle->dataQueue);
+        if (NULL == message)
         {
-            CALEData_t *bleData = (CALEData_t *) message->msg;
-            if (bleData && bleData->remoteEndpoint)
+            break;
+        }
+
+        CALEData_t *bleData = (CALEData_t *) message->msg;
+        if (bleData && bleData->remoteEndpoint &&
+            !strcasecmp(bleData->remoteEndpoint->addr, address))
+        {
+            OIC_LOG(DEBUG, CALEADAPTER_TAG, "found the message of disconnected device");
+            if (NULL != queueHandle->destroy)
             {
-                if (!strcasecmp(bleData->remoteEndpoint->addr, address))
-                {
-                    OIC_LOG(DEBUG, CALEADAPTER_TAG, "found the message of disconnected device");
-                    if (NULL != queueHandle->destroy)
-                    {
-                        queueHandle->destroy(message->msg, message->size);
-                    }
-                    else
-                    {
-                        OICFree(message->msg);
-                    }
-
-                    OICFree(message);
-                }
+                queueHandle->destroy(message->msg, message->size);
+            }
+            else
+            {
+                OICFree(message->msg);
             }
         }
+        else if (CA_STATUS_OK != u_mpsc_queue_add_element(queueHandle->dataQueue,
+                                                          message->msg, message->size))
+        {
+            OIC_LOG(ERROR, CALEADAPTER_TAG, "failed to requeue data of other device");
+        }
+
+        OICFree(message);
     }
+    oc_mutex_unlock(queueHandle->threadMutex);
     oc_mutex_unlock(mutex);
 }
 
@@ -57,8 +57,9 @@
 // context for block-wise transfer
 static CABlockWiseContext_t g_context = { .sendThreadFunc = NULL,
                                           .receivedThreadFunc = NULL,
-                                          .dataList = NULL,
-                                          .multicastDataList = NULL };
+                                          .dataIndex = NULL,
+                                          .multicastDataList = NULL,
+                                          .block2WindowSize = 1 };
 
 static bool CACheckPayloadLength(const CAData_t *sendData)
 {
@@ -77,6 +78,70 @@ static bool CACheckPayloadLength(const CAData_t *sendData)
     return true;
 }
 
+/**
+ * Look up the block data of a transfer. Caller must hold blockDataListMutex.
+ */
+static CABlockData_t *CAFindBlockData(const CABlockDataID_t *blockID)
+{
+    if (!blockID->id)
+    {
+        return NULL;
+    }
+
+    CABlockData_t *currData = NULL;
+    HASH_FIND(hh, g_context.dataIndex, blockID->id, blockID->idLength, currData);
+    return currData;
+}
+
+static void CADestroyBlockData(CABlockData_t *data)
+{
+    if (data->sentData)
+    {
+        CADestroyDataSet(data->sentData);
+    }
+    CADestroyBlockID(data->blockDataId);
+    OICFree(data->payload);
+    OICFree(data->block2Received);
+    OICFree(data);
+}
+
+/**
+ * Make room for length bytes of reassembled payload. The buffer is allocated once
+ * for the total announced by a Size1/Size2 option, and grows geometrically otherwise.
+ */
+static CAResult_t CAReserveBlockPayload(CABlockData_t *currData, size_t length)
+{
+    if (length <= currData->payloadCapacity)
+    {
+        return CA_STATUS_OK;
+    }
+
+    size_t capacity = currData->payloadCapacity * 2;
+    if (currData->payloadLength >= length)
+    {
+        capacity = currData->payloadLength;
+    }
+    else if (capacity < length)
+    {
+        capacity = length;
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "allocate %" PRIuPTR " bytes for the received payload", capacity);
+    CAPayload_t newPayload = OICRealloc(currData->payload, capacity);
+    if (NULL == newPayload)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    currData->payload = newPayload;
+    currData->payloadCapacity = capacity;
+    return CA_STATUS_OK;
+}
+
+static CAResult_t CAReceiveLastBlockImpl(const CABlockDataID_t *blockID,
+                                         const CAData_t *receivedData, bool movePayload);
+
 CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
                                          CAReceiveThreadFunc receivedThreadFunc)
 {
@@ -93,11 +158,6 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
         g_context.receivedThreadFunc = receivedThreadFunc;
     }
 
-    if (!g_context.dataList)
-    {
-        g_context.dataList = u_arraylist_create();
-    }
-
     if (!g_context.multicastDataList)
     {
         g_context.multicastDataList = u_arraylist_create();
@@ -106,8 +166,6 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
     CAResult_t res = CAInitBlockWiseMutexVariables();
     if (CA_STATUS_OK != res)
     {
-        u_arraylist_free(&g_context.dataList);
-        g_context.dataList = NULL;
         u_arraylist_free(&g_context.multicastDataList);
         g_context.multicastDataList = NULL;
         OIC_LOG(ERROR, TAG, "init has failed");
@@ -120,10 +178,9 @@ CAResult_t CATerminateBlockWiseTransfer()
 {
     OIC_LOG(DEBUG, TAG, "CATerminateBlockWiseTransfer");
 
-    if (g_context.dataList)
+    if (g_context.dataIndex)
     {
         CARemoveAllBlockDataFromList();
-        u_arraylist_free(&g_context.dataList);
     }
 
     if (g_context.multicastDataList)
@@ -194,6 +251,18 @@ void CATerminateBlockWiseMutexVariables()
     }
 }
 
+CAResult_t CASetBlock2WindowSize(size_t windowSize)
+{
+    if (1 > windowSize || CA_MAX_BLOCK2_WINDOW < windowSize)
+    {
+        OIC_LOG_V(ERROR, TAG, "window size %" PRIuPTR " is out of range", windowSize);
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    g_context.block2WindowSize = windowSize;
+    return CA_STATUS_OK;
+}
+
 CAResult_t CASendBlockWiseData(const CAData_t *sendData)
 {
     VERIFY_NON_NULL(sendData, TAG, "sendData");
@@ -294,7 +363,14 @@ CAResult_t CASendBlockWiseData(const CAData_t *sendData)
     return res;
 }
 
-CAResult_t CAAddSendThreadQueue(const CAData_t *sendData, const CABlockDataID_t *blockID)
+/**
+ * Queue a copy of sendData. For a Block2 transfer the copy also carries the
+ * current block number: the sender builds the message later from the shared
+ * block data, which may have moved on by then when several blocks of one
+ * transfer are in flight.
+ */
+static CAResult_t CAAddSendThreadQueueImpl(const CAData_t *sendData,
+                                           const CABlockDataID_t *blockID, bool setBlock2Num)
 {
     VERIFY_NON_NULL(sendData, TAG, "sendData");
     VERIFY_NON_NULL(blockID, TAG, "blockID");
@@ -307,6 +383,32 @@ CAResult_t CAAddSendThreadQueue(const CAData_t *sendData, const CABlockDataID_t
         return CA_STATUS_FAILED;
     }
 
+    CAInfo_t *info = NULL;
+    if (cloneData->requestInfo)
+    {
+        info = &cloneData->requestInfo->info;
+    }
+    else if (cloneData->responseInfo)
+    {
+        info = &cloneData->responseInfo->info;
+    }
+
+    if (info)
+    {
+        info->hasBlock2Num = false;
+    }
+    if (setBlock2Num && info)
+    {
+        oc_mutex_lock(g_context.blockDataListMutex);
+        CABlockData_t *currData = CAFindBlockData(blockID);
+        if (currData && COAP_OPTION_BLOCK2 == currData->type)
+        {
+            info->hasBlock2Num = true;
+            info->block2Num = currData->block2.num;
+        }
+        oc_mutex_unlock(g_context.blockDataListMutex);
+    }
+
     if (g_context.sendThreadFunc)
     {
         oc_mutex_lock(g_context.blockDataSenderMutex);
@@ -320,6 +422,17 @@ CAResult_t CAAddSendThreadQueue(const CAData_t *sendData, const CABlockDataID_t
     return CA_STATUS_OK;
 }
 
+CAResult_t CAAddSendThreadQueue(const CAData_t *sendData, const CABlockDataID_t *blockID)
+{
+    return CAAddSendThreadQueueImpl(sendData, blockID, false);
+}
+
+static CAResult_t CAAddBlock2SendThreadQueue(const CAData_t *sendData,
+                                             const CABlockDataID_t *blockID)
+{
+    return CAAddSendThreadQueueImpl(sendData, blockID, true);
+}
+
 CAResult_t CACheckBlockOptionType(CABlockData_t *currData)
 {
     VERIFY_NON_NULL(currData, TAG, "currData");
@@ -546,7 +659,7 @@ CAResult_t CAProcessNextStep(const coap_pdu_t *pdu, const CAData_t *receivedData
                                 CA_MSG_ACKNOWLEDGE : CA_MSG_NONCONFIRM;
                 data->responseInfo->info.messageId = pdu->transport_hdr->udp.id;
 
-                res = CAAddSendThreadQueue(data, blockID);
+                res = CAAddBlock2SendThreadQueue(data, blockID);
                 if (CA_STATUS_OK != res)
                 {
                     OIC_LOG(ERROR, TAG, "add has failed");
@@ -567,8 +680,9 @@ CAResult_t CAProcessNextStep(const coap_pdu_t *pdu, const CAData_t *receivedData
             break;
 
         case CA_OPTION2_LAST_BLOCK:
-            // process last block and send upper layer
-            res = CAReceiveLastBlock(blockID, receivedData);
+            // process last block and send upper layer, the transfer ends here
+            // so its buffer is handed over instead of copied.
+            res = CAReceiveLastBlockImpl(blockID, receivedData, true);
             if (CA_STATUS_OK != res)
             {
                 OIC_LOG(ERROR, TAG, "receive has failed");
@@ -711,7 +825,7 @@ CAResult_t CASendBlockMessage(const coap_pdu_t *pdu, CAMessageType_t msgType,
     }
 
     // add data to send thread
-    CAResult_t res = CAAddSendThreadQueue(data, blockID);
+    CAResult_t res = CAAddBlock2SendThreadQueue(data, blockID);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "add has failed");
@@ -821,6 +935,7 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
     {
         OICFree(data->payload);
         data->payload = NULL;
+        data->payloadCapacity = 0;
         data->payloadLength = 0;
         data->receivedPayloadLen = 0;
         data->block1.num = 0;
@@ -830,7 +945,42 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
     return CA_STATUS_OK;
 }
 
-CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *receivedData)
+/**
+ * Hand the reassembled payload of a finished transfer over to data without copying it.
+ */
+static void CAMovePayloadToCAData(const CABlockDataID_t *blockID, CAData_t *data)
+{
+    CAInfo_t *info = NULL;
+    if (data->requestInfo)
+    {
+        info = &data->requestInfo->info;
+    }
+    else if (data->responseInfo)
+    {
+        info = &data->responseInfo->info;
+    }
+    else
+    {
+        OIC_LOG(ERROR, TAG, "data has no info to carry the payload");
+        return;
+    }
+
+    oc_mutex_lock(g_context.blockDataListMutex);
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData && currData->payload)
+    {
+        OICFree(info->payload);
+        info->payload = currData->payload;
+        info->payloadSize = currData->receivedPayloadLen;
+        currData->payload = NULL;
+        currData->payloadCapacity = 0;
+        currData->receivedPayloadLen = 0;
+    }
+    oc_mutex_unlock(g_context.blockDataListMutex);
+}
+
+static CAResult_t CAReceiveLastBlockImpl(const CABlockDataID_t *blockID,
+                                         const CAData_t *receivedData, bool movePayload)
 {
     VERIFY_NON_NULL(blockID, TAG, "blockID");
     VERIFY_NON_NULL(receivedData, TAG, "receivedData");
@@ -844,16 +994,23 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *re
     }
 
     // update payload
-    size_t fullPayloadLen = 0;
-    CAPayload_t fullPayload = CAGetPayloadFromBlockDataList(blockID, &fullPayloadLen);
-    if (fullPayload)
+    if (movePayload)
     {
-        CAResult_t res = CAUpdatePayloadToCAData(cloneData, fullPayload, fullPayloadLen);
-        if (CA_STATUS_OK != res)
+        CAMovePayloadToCAData(blockID, cloneData);
+    }
+    else
+    {
+        size_t fullPayloadLen = 0;
+        CAPayload_t fullPayload = CAGetPayloadFromBlockDataList(blockID, &fullPayloadLen);
+        if (fullPayload)
         {
-            OIC_LOG(ERROR, TAG, "update has failed");
-            CADestroyDataSet(cloneData);
-            return res;
+            CAResult_t res = CAUpdatePayloadToCAData(cloneData, fullPayload, fullPayloadLen);
+            if (CA_STATUS_OK != res)
+            {
+                OIC_LOG(ERROR, TAG, "update has failed");
+                CADestroyDataSet(cloneData);
+                return res;
+            }
         }
     }
 
@@ -869,6 +1026,11 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *re
     return CA_STATUS_OK;
 }
 
+CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *receivedData)
+{
+    return CAReceiveLastBlockImpl(blockID, receivedData, false);
+}
+
 static CABlockData_t* CACheckTheExistOfBlockData(const CABlockDataID_t* blockDataID,
                                                  coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                                                  uint16_t blockType)
@@ -1071,6 +1233,151 @@ exit:
     return res;
 }
 
+#define BLOCK2_RECEIVED(data, unit) ((data)->block2Received[(unit) >> 3] & (1 << ((unit) & 7)))
+
+/**
+ * Request the next Block2 unit that has neither been requested nor received.
+ */
+static CAResult_t CARequestNextBlock2(const coap_pdu_t *pdu, CABlockData_t *data,
+                                      const CABlockDataID_t *blockID)
+{
+    while (data->block2Requested + 1 < data->block2Total)
+    {
+        data->block2Requested++;
+        if (!BLOCK2_RECEIVED(data, data->block2Requested))
+        {
+            data->block2.num = data->block2Requested;
+            data->block2.m = 0;
+
+            // the response has been acknowledged already, if it needed to be
+            return CASendBlockMessage(pdu, CA_MSG_ACKNOWLEDGE, blockID);
+        }
+    }
+    return CA_STATUS_OK;
+}
+
+/**
+ * Switch a transfer to window mode after its first blocks were received in order
+ * and the next one has been requested. Only possible when Size2 told the total.
+ */
+static CAResult_t CAStartBlock2Window(const coap_pdu_t *pdu, CABlockData_t *data,
+                                      const CABlockDataID_t *blockID)
+{
+    size_t unit = BLOCK_SIZE(data->block2.szx);
+    if (1 >= g_context.block2WindowSize || data->block2Total || !data->sentData->requestInfo
+        || data->payloadLength <= data->receivedPayloadLen
+        || data->receivedPayloadLen != (size_t) data->block2.num * unit)
+    {
+        return CA_STATUS_OK;
+    }
+
+    size_t total = (data->payloadLength + unit - 1) / unit;
+    if (UINT32_MAX < total)
+    {
+        return CA_STATUS_OK;
+    }
+
+    CAResult_t res = CAReserveBlockPayload(data, data->payloadLength);
+    if (CA_STATUS_OK != res)
+    {
+        return res;
+    }
+
+    data->block2Received = (uint8_t *) OICCalloc((total + 7) / 8, 1);
+    if (!data->block2Received)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+    for (uint32_t i = 0; i < data->block2.num; i++)
+    {
+        data->block2Received[i >> 3] |= (uint8_t) (1 << (i & 7));
+    }
+    data->block2Total = (uint32_t) total;
+    data->block2Requested = data->block2.num;
+
+    OIC_LOG_V(DEBUG, TAG, "pipeline %" PRIuPTR " of %u blocks", g_context.block2WindowSize,
+              data->block2Total);
+
+    for (size_t i = 1; i < g_context.block2WindowSize; i++)
+    {
+        res = CARequestNextBlock2(pdu, data, blockID);
+        if (CA_STATUS_OK != res)
+        {
+            return res;
+        }
+    }
+    return CA_STATUS_OK;
+}
+
+/**
+ * Place a Block2 response of a windowed transfer by its block number, request the
+ * next block and deliver the payload once every block has arrived.
+ */
+static CAResult_t CAReceiveBlock2InWindow(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
+                                          const CAData_t *receivedData, coap_block_t block,
+                                          CABlockData_t *data, const CABlockDataID_t *blockID)
+{
+    if (CA_MSG_CONFIRM == pdu->transport_hdr->udp.type)
+    {
+        CASendDirectEmptyResponse(endpoint, pdu->transport_hdr->udp.id);
+    }
+
+    uint32_t responseCode = CA_RESPONSE_CODE(pdu->transport_hdr->udp.code);
+    if (CA_REQUEST_ENTITY_INCOMPLETE == responseCode || CA_REQUEST_ENTITY_TOO_LARGE == responseCode
+        || block.szx < data->block2.szx)
+    {
+        OIC_LOG(ERROR, TAG, "block can't be placed in the window");
+        return CA_STATUS_FAILED;
+    }
+
+    size_t blockPayloadLen = 0;
+    CAPayload_t blockPayload = CAGetPayloadInfo(receivedData, &blockPayloadLen);
+    size_t offset = (size_t) block.num << (block.szx + BLOCK_NUMBER_IDX);
+    if (!blockPayload || offset >= data->payloadLength
+        || blockPayloadLen > data->payloadLength - offset
+        || (block.m && blockPayloadLen != (size_t) BLOCK_SIZE(block.szx))
+        || (!block.m && blockPayloadLen != data->payloadLength - offset))
+    {
+        OIC_LOG(ERROR, TAG, "block doesn't match the total payload length");
+        return CA_STATUS_FAILED;
+    }
+
+    memcpy(data->payload + offset, blockPayload, blockPayloadLen);
+
+    // a block may span several units if the server kept a larger block size
+    size_t unit = BLOCK_SIZE(data->block2.szx);
+    size_t newUnits = 0;
+    for (size_t i = offset / unit; i < (offset + blockPayloadLen + unit - 1) / unit; i++)
+    {
+        if (!BLOCK2_RECEIVED(data, i))
+        {
+            data->block2Received[i >> 3] |= (uint8_t) (1 << (i & 7));
+            size_t left = data->payloadLength - i * unit;
+            data->receivedPayloadLen += (left < unit) ? left : unit;
+            newUnits++;
+        }
+    }
+    OIC_LOG_V(DEBUG, TAG, "received %" PRIuPTR " of %" PRIuPTR " bytes",
+              data->receivedPayloadLen, data->payloadLength);
+
+    if (data->receivedPayloadLen == data->payloadLength)
+    {
+        return CAProcessNextStep(pdu, receivedData, CA_OPTION2_LAST_BLOCK, blockID);
+    }
+
+    // keep the window full, a duplicate does not free a slot
+    for (size_t i = 0; i < newUnits; i++)
+    {
+        CAResult_t res = CARequestNextBlock2(pdu, data, blockID);
+        if (CA_STATUS_OK != res)
+        {
+            return res;
+        }
+    }
+    return CA_STATUS_OK;
+}
+
 // TODO make pdu const after libcoap is updated to support that.
 CAResult_t CASetNextBlockOption2(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                                  const CAData_t *receivedData, coap_block_t block,
@@ -1153,6 +1460,19 @@ CAResult_t CASetNextBlockOption2(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                 goto exit;
             }
         }
+        else if (data->block2Total)
+        {
+            // received response in a pipelined transfer
+            res = CAReceiveBlock2InWindow(pdu, endpoint, receivedData, block, data, blockDataID);
+            if (CA_STATUS_OK != res)
+            {
+                OIC_LOG(ERROR, TAG, "receive has failed");
+                goto exit;
+            }
+
+            CADestroyBlockID(blockDataID);
+            return CA_STATUS_OK;
+        }
         else
         {
             // received message type is response
@@ -1222,6 +1542,16 @@ CAResult_t CASetNextBlockOption2(coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
         goto exit;
     }
 
+    if (CA_OPTION2_RESPONSE == blockWiseStatus)
+    {
+        res = CAStartBlock2Window(pdu, data, blockDataID);
+        if (CA_STATUS_OK != res)
+        {
+            OIC_LOG(ERROR, TAG, "pipelining has failed");
+            goto exit;
+        }
+    }
+
     CADestroyBlockID(blockDataID);
     return CA_STATUS_OK;
 
@@ -1457,7 +1787,7 @@ CAResult_t CAUpdateMessageId(coap_pdu_t *pdu, const CABlockDataID_t *blockID)
 }
 
 CAResult_t CAAddBlockOption(coap_pdu_t **pdu, const CAInfo_t *info,
-                            const CAEndpoint_t *endpoint, coap_list_t **options)
+                            const CAEndpoint_t *endpoint, CAOptionList_t *options)
 {
     OIC_LOG(DEBUG, TAG, "IN-AddBlockOption");
     VERIFY_NON_NULL(pdu, TAG, "pdu");
@@ -1521,25 +1851,12 @@ CAResult_t CAAddBlockOption(coap_pdu_t **pdu, const CAInfo_t *info,
         OIC_LOG(DEBUG, TAG, "no BLOCK option");
 
         // in case it is not large data, add option list to pdu.
-        if (*options)
+        res = CAAddOptionToPDU(*pdu, options);
+        if (CA_STATUS_OK != res)
         {
-            for (coap_list_t *opt = *options; opt; opt = opt->next)
-            {
-                OIC_LOG_V(DEBUG, TAG, "[%s] opt will be added.",
-                          COAP_OPTION_DATA(*(coap_option *) opt->data));
-                OIC_LOG_V(DEBUG, TAG, "[%d] pdu length", (*pdu)->length);
-
-                if (0 == coap_add_option(*pdu, COAP_OPTION_KEY(*(coap_option *) opt->data),
-                                         COAP_OPTION_LENGTH(*(coap_option *) opt->data),
-                                         COAP_OPTION_DATA(*(coap_option *) opt->data)))
-                {
-                    OIC_LOG(ERROR, TAG, "coap_add_option has failed");
-                    res = CA_STATUS_FAILED;
-                    goto exit;
-                }
-            }
+            OIC_LOG(ERROR, TAG, "coap_add_option has failed");
+            goto exit;
         }
-        OIC_LOG_V(DEBUG, TAG, "[%d] pdu length after option", (*pdu)->length);
 
         // if response data is so large. it have to send as block transfer
         if (!coap_add_data(*pdu, dataLength, (const unsigned char*)info->payload))
@@ -1578,7 +1895,7 @@ exit:
 }
 
 CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t dataLength,
-                             const CABlockDataID_t *blockID, coap_list_t **options)
+                             const CABlockDataID_t *blockID, CAOptionList_t *options)
 {
     OIC_LOG(DEBUG, TAG, "IN-AddBlockOption2");
     VERIFY_NON_NULL(pdu, TAG, "pdu");
@@ -1598,14 +1915,26 @@ CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
         return CA_STATUS_FAILED;
     }
 
+    // use the block number this message was queued for, if it was recorded
+    coap_block_t block = *block2;
+    bool isQueued = info->hasBlock2Num;
+    if (isQueued)
+    {
+        block.num = info->block2Num;
+    }
+
     CAResult_t res = CA_STATUS_OK;
     uint32_t code = (*pdu)->transport_hdr->udp.code;
     if (CA_GET != code && CA_POST != code && CA_PUT != code && CA_DELETE != code)
     {
-        CASetMoreBitFromBlock(dataLength, block2);
+        CASetMoreBitFromBlock(dataLength, &block);
+        if (!isQueued || block.num == block2->num)
+        {
+            block2->m = block.m;
+        }
 
         // if block number is 0, add size2 option
-        if (0 == block2->num)
+        if (0 == block.num)
         {
             res = CAAddBlockSizeOption(*pdu, COAP_OPTION_SIZE2, dataLength, options);
             if (CA_STATUS_OK != res)
@@ -1615,7 +1944,7 @@ CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
             }
         }
 
-        res = CAAddBlockOptionImpl(block2, COAP_OPTION_BLOCK2, options);
+        res = CAAddBlockOptionImpl(&block, COAP_OPTION_BLOCK2, options);
         if (CA_STATUS_OK != res)
         {
             OIC_LOG(ERROR, TAG, "add has failed");
@@ -1642,18 +1971,18 @@ CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
             goto exit;
         }
 
-        assert(block2->szx <= UINT8_MAX);
+        assert(block.szx <= UINT8_MAX);
         if (!coap_add_block(*pdu, (unsigned int)dataLength,
                             (const unsigned char *) info->payload,
-                            block2->num, (unsigned char)block2->szx))
+                            block.num, (unsigned char)block.szx))
         {
             OIC_LOG(ERROR, TAG, "Data length is smaller than the start index");
             return CA_STATUS_FAILED;
         }
 
-        CALogBlockInfo(block2);
+        CALogBlockInfo(&block);
 
-        if (!block2->m)
+        if (!block.m)
         {
             // if sent message is last response block message, remove data
             CARemoveBlockDataFromList(blockID);
@@ -1662,7 +1991,7 @@ CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
     else
     {
         OIC_LOG(DEBUG, TAG, "option2, not response msg");
-        res = CAAddBlockOptionImpl(block2, COAP_OPTION_BLOCK2, options);
+        res = CAAddBlockOptionImpl(&block, COAP_OPTION_BLOCK2, options);
         if (CA_STATUS_OK != res)
         {
             OIC_LOG(ERROR, TAG, "add has failed");
@@ -1675,7 +2004,7 @@ CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
             OIC_LOG(ERROR, TAG, "add has failed");
             goto exit;
         }
-        CALogBlockInfo(block2);
+        CALogBlockInfo(&block);
     }
 
     return CA_STATUS_OK;
@@ -1686,7 +2015,7 @@ exit:
 }
 
 CAResult_t CAAddBlockOption1(coap_pdu_t **pdu, const CAInfo_t *info, size_t dataLength,
-                             const CABlockDataID_t *blockID, coap_list_t **options)
+                             const CABlockDataID_t *blockID, CAOptionList_t *options)
 {
     OIC_LOG(DEBUG, TAG, "IN-AddBlockOption1");
     VERIFY_NON_NULL(pdu, TAG, "pdu");
@@ -1810,7 +2139,7 @@ exit:
 }
 
 CAResult_t CAAddBlockOptionImpl(coap_block_t *block, uint8_t blockType,
-                                coap_list_t **options)
+                                CAOptionList_t *options)
 {
     OIC_LOG(DEBUG, TAG, "IN-AddBlockOptionImpl");
     VERIFY_NON_NULL(block, TAG, "block");
@@ -1822,10 +2151,7 @@ CAResult_t CAAddBlockOptionImpl(coap_block_t *block, uint8_t blockType,
                                                        | (block->m << BLOCK_M_BIT_IDX)
                                                        | block->szx));
 
-    int ret = coap_insert(options,
-                          CACreateNewOptionNode(blockType, optionLength, (char *) buf),
-                          CAOrderOpts);
-    if (ret <= 0)
+    if (CA_STATUS_OK != CAAddOptionToList(options, blockType, optionLength, buf))
     {
         return CA_STATUS_INVALID_PARAM;
     }
@@ -1834,34 +2160,14 @@ CAResult_t CAAddBlockOptionImpl(coap_block_t *block, uint8_t blockType,
     return CA_STATUS_OK;
 }
 
-CAResult_t CAAddOptionToPDU(coap_pdu_t *pdu, coap_list_t **options)
+CAResult_t CAAddOptionToPDU(coap_pdu_t *pdu, CAOptionList_t *options)
 {
     // after adding the block option to option list, add option list to pdu.
-    if (*options)
-    {
-        for (coap_list_t *opt = *options; opt; opt = opt->next)
-        {
-            OIC_LOG_V(DEBUG, TAG, "[%s] opt will be added.",
-                      COAP_OPTION_DATA(*(coap_option *) opt->data));
-
-            OIC_LOG_V(DEBUG, TAG, "[%d] pdu length", pdu->length);
-            size_t ret = coap_add_option(pdu, COAP_OPTION_KEY(*(coap_option *) opt->data),
-                                         COAP_OPTION_LENGTH(*(coap_option *) opt->data),
-                                         COAP_OPTION_DATA(*(coap_option *) opt->data));
-            if (!ret)
-            {
-                return CA_STATUS_FAILED;
-            }
-        }
-    }
-
-    OIC_LOG_V(DEBUG, TAG, "[%d] pdu length after option", pdu->length);
-
-    return CA_STATUS_OK;
+    return CAWriteOptionListToPDU(pdu, options, COAP_UDP);
 }
 
 CAResult_t CAAddBlockSizeOption(coap_pdu_t *pdu, uint16_t sizeType, size_t dataLength,
-                                coap_list_t **options)
+                                CAOptionList_t *options)
 {
     OIC_LOG(DEBUG, TAG, "IN-CAAddBlockSizeOption");
     VERIFY_NON_NULL(pdu, TAG, "pdu");
@@ -1878,10 +2184,7 @@ CAResult_t CAAddBlockSizeOption(coap_pdu_t *pdu, uint16_t sizeType, size_t dataL
     unsigned int optionLength = coap_encode_var_bytes(value,
                                                       (unsigned int)dataLength);
 
-    int ret = coap_insert(options,
-                          CACreateNewOptionNode(sizeType, optionLength, (char *) value),
-                          CAOrderOpts);
-    if (ret <= 0)
+    if (CA_STATUS_OK != CAAddOptionToList(options, sizeType, optionLength, value))
     {
         return CA_STATUS_INVALID_PARAM;
     }
@@ -2059,46 +2362,21 @@ CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *received
     size_t prePayloadLen = currData->receivedPayloadLen;
     if (blockPayload)
     {
-        if (currData->payloadLength)
+        if (isSizeOption)
         {
-            // in case the block message has the size option
-            // allocate the memory for the total payload
-            if (isSizeOption)
-            {
-                CAPayload_t prePayload = currData->payload;
-
-                OIC_LOG(DEBUG, TAG, "allocate memory for the total payload");
-                currData->payload = (CAPayload_t) OICCalloc(1, currData->payloadLength);
-                if (NULL == currData->payload)
-                {
-                    OIC_LOG(ERROR, TAG, "out of memory");
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy(currData->payload, prePayload, prePayloadLen);
-                OICFree(prePayload);
-            }
-
-            // update the total payload
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+            OIC_LOG_V(DEBUG, TAG, "total payload will be %" PRIuPTR " bytes",
+                      currData->payloadLength);
         }
-        else
-        {
-            OIC_LOG(DEBUG, TAG, "allocate memory for the received block payload");
 
-            size_t totalPayloadLen = prePayloadLen + blockPayloadLen;
-            CAPayload_t newPayload = OICRealloc(currData->payload, totalPayloadLen);
-            if (NULL == newPayload)
-            {
-                OIC_LOG(ERROR, TAG, "out of memory");
-                return CA_MEMORY_ALLOC_FAILED;
-            }
-
-            // update the total payload
-            memset(newPayload + prePayloadLen, 0, blockPayloadLen);
-            currData->payload = newPayload;
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+        CAResult_t res = CAReserveBlockPayload(currData, prePayloadLen + blockPayloadLen);
+        if (CA_STATUS_OK != res)
+        {
+            return res;
         }
 
+        // update the total payload
+        memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+
         // update received payload length
         currData->receivedPayloadLen += blockPayloadLen;
 
@@ -2356,17 +2634,13 @@ CAResult_t CAUpdateBlockOptionType(const CABlockDataID_t *blockID, uint16_t bloc
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            currData->type = blockType;
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
-            return CA_STATUS_OK;
-        }
+        currData->type = blockType;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
+        return CA_STATUS_OK;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2381,16 +2655,13 @@ uint16_t CAGetBlockOptionType(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
-            return currData->type;
-        }
+        uint16_t type = currData->type;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
+        return type;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2404,15 +2675,11 @@ CAData_t *CAGetDataSetFromBlockDataList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData->sentData;
-        }
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        return currData->sentData;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2427,17 +2694,13 @@ CABlockData_t *CAUpdateDataSetFromBlockDataList(const CABlockDataID_t *blockID,
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            CADestroyDataSet(currData->sentData);
-            currData->sentData = CACloneCAData(sendData);
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
+        CADestroyDataSet(currData->sentData);
+        currData->sentData = CACloneCAData(sendData);
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        return currData;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2454,15 +2717,10 @@ CAResult_t CAGetTokenFromBlockDataList(const coap_pdu_t *pdu, const CAEndpoint_t
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = NULL;
+    CABlockData_t *tmp = NULL;
+    HASH_ITER(hh, g_context.dataIndex, currData, tmp)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (NULL == currData)
-        {
-            continue;
-        }
-
         if (NULL != currData->sentData && NULL != currData->sentData->requestInfo)
         {
             if (pdu->transport_hdr->udp.id == currData->sentData->requestInfo->info.messageId &&
@@ -2534,19 +2792,10 @@ CABlockData_t *CAGetBlockDataFromBlockDataList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
-    {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
-    }
+    CABlockData_t *currData = CAFindBlockData(blockID);
     oc_mutex_unlock(g_context.blockDataListMutex);
 
-    return NULL;
+    return currData;
 }
 
 coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockType)
@@ -2556,23 +2805,20 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockTyp
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
+        if (COAP_OPTION_BLOCK2 == blockType)
         {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
-            if (COAP_OPTION_BLOCK2 == blockType)
-            {
-                return &currData->block2;
-            }
-            else if (COAP_OPTION_BLOCK1 == blockType)
-            {
-                return &currData->block1;
-            }
+            return &currData->block2;
+        }
+        else if (COAP_OPTION_BLOCK1 == blockType)
+        {
+            return &currData->block1;
         }
+        return NULL;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2589,17 +2835,14 @@ CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            *fullPayloadLen = currData->receivedPayloadLen;
-            OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
-            return currData->payload;
-        }
+        *fullPayloadLen = currData->receivedPayloadLen;
+        CAPayload_t payload = currData->payload;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
+        return payload;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2667,16 +2910,16 @@ CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    bool res = u_arraylist_add(g_context.dataList, (void *) data);
-    if (!res)
+    // A new message with the same token to the same peer starts a new transfer.
+    CABlockData_t *oldData = CAFindBlockData(blockDataID);
+    if (oldData)
     {
-        OIC_LOG(ERROR, TAG, "add has failed");
-        CADestroyBlockID(data->blockDataId);
-        CADestroyDataSet(data->sentData);
-        OICFree(data);
-        oc_mutex_unlock(g_context.blockDataListMutex);
-        return NULL;
+        OIC_LOG(DEBUG, TAG, "replace the block data with the same ID");
+        HASH_DELETE(hh, g_context.dataIndex, oldData);
+        CADestroyBlockData(oldData);
     }
+    HASH_ADD_KEYPTR(hh, g_context.dataIndex, blockDataID->id, blockDataID->idLength, data);
+
     oc_mutex_unlock(g_context.blockDataListMutex);
 
     OIC_LOG(DEBUG, TAG, "OUT-CreateBlockData");
@@ -2690,28 +2933,11 @@ CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *removedData = CAFindBlockData(blockID);
+    if (removedData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i);
-            if (!removedData)
-            {
-                OIC_LOG(ERROR, TAG, "data is NULL");
-                oc_mutex_unlock(g_context.blockDataListMutex);
-                return CA_STATUS_FAILED;
-            }
-
-            // destroy memory
-            CADestroyDataSet(removedData->sentData);
-            CADestroyBlockID(removedData->blockDataId);
-            OICFree(removedData->payload);
-            OICFree(removedData);
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return CA_STATUS_OK;
-        }
+        HASH_DELETE(hh, g_context.dataIndex, removedData);
+        CADestroyBlockData(removedData);
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2724,21 +2950,12 @@ CAResult_t CARemoveAllBlockDataFromList()
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = len; i > 0; i--)
+    CABlockData_t *removedData = NULL;
+    CABlockData_t *tmp = NULL;
+    HASH_ITER(hh, g_context.dataIndex, removedData, tmp)
     {
-        CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i - 1);
-        if (removedData)
-        {
-            // destroy memory
-            if (removedData->sentData)
-            {
-                CADestroyDataSet(removedData->sentData);
-            }
-            CADestroyBlockID(removedData->blockDataId);
-            OICFree(removedData->payload);
-            OICFree(removedData);
-        }
+        HASH_DELETE(hh, g_context.dataIndex, removedData);
+        CADestroyBlockData(removedData);
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -505,6 +505,25 @@ CAResult_t CAHandleRequestResponse()
     return CA_STATUS_OK;
 }
 
+CAResult_t CARegisterProcessEvent(oc_event event)
+{
+#ifndef SINGLE_THREAD
+    return CARegisterMessageHandlerEvent(event);
+#else
+    (void)event;
+    return CA_NOT_SUPPORTED;
+#endif
+}
+
+void CAUnregisterProcessEvent(oc_event event)
+{
+#ifndef SINGLE_THREAD
+    CAUnregisterMessageHandlerEvent(event);
+#else
+    (void)event;
+#endif
+}
+
 CAResult_t CASelectCipherSuite(const uint16_t cipher, CATransportAdapter_t adapter)
 {
     (void)(adapter); // prevent unused-parameter warning when building release variant
@@ -0,0 +1,251 @@
+/* ****************************************************************
+ *
+ * Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <string.h>
+
+#include "caduplicatecache.h"
+#include "octhread.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "oic_time.h"
+#include "experimental/logger.h"
+#include <coap/uthash.h>
+#include <coap/utlist.h>
+
+#define TAG "OIC_CA_DUP_CACHE"
+
+typedef struct
+{
+    CATransportAdapter_t adapter;           /**< transport type */
+    char addr[MAX_ADDR_STR_SIZE_CA];        /**< remote address */
+    uint16_t port;                          /**< remote port */
+    uint16_t messageId;                     /**< coap PDU message id */
+    uint8_t tokenLength;                    /**< token length */
+    char token[CA_MAX_TOKEN_LEN];           /**< token */
+} CADuplicateKey_t;
+
+/** key matching the copy of an IP message received over the other family. **/
+typedef struct
+{
+    uint32_t ifindex;                       /**< interface index */
+    CATransportFlags_t family;              /**< CA_IPV4 or CA_IPV6 */
+    uint16_t messageId;                     /**< coap PDU message id */
+    uint8_t tokenLength;                    /**< token length */
+    char token[CA_MAX_TOKEN_LEN];           /**< token */
+} CADuplicateFamilyKey_t;
+
+typedef struct CADuplicateEntry
+{
+    CADuplicateKey_t key;                   /**< hash key, zero padded */
+    CADuplicateFamilyKey_t familyKey;       /**< hash key, zero padded, IP only */
+    uint64_t expiry;                        /**< milliseconds */
+    struct CADuplicateEntry *prev;          /**< oldest first list */
+    struct CADuplicateEntry *next;          /**< oldest first list */
+    UT_hash_handle hh;                      /**< handle in g_cacheIndex */
+    UT_hash_handle hhFamily;                /**< handle in g_familyIndex, IP only */
+} CADuplicateEntry_t;
+
+static const uint64_t MSECS_PER_SEC = 1000;
+
+/** mutex for the cache, messages are received on several adapter threads. **/
+static oc_mutex g_cacheMutex = NULL;
+
+/** entries by key. **/
+static CADuplicateEntry_t *g_cacheIndex = NULL;
+
+/** IP entries by family key. **/
+static CADuplicateEntry_t *g_familyIndex = NULL;
+
+/** entries in insertion order; the lifetime is fixed so this is also expiry order. **/
+static CADuplicateEntry_t *g_cacheList = NULL;
+
+static size_t g_cacheSize = 0;
+static size_t g_cacheCapacity = DEFAULT_DUPLICATE_CACHE_SIZE;
+static uint64_t g_cacheLifetime = DEFAULT_EXCHANGE_LIFETIME_SEC * 1000;
+
+static void CARemoveDuplicateEntry(CADuplicateEntry_t *entry)
+{
+    HASH_DELETE(hh, g_cacheIndex, entry);
+    if (CA_ADAPTER_IP == entry->key.adapter)
+    {
+        HASH_DELETE(hhFamily, g_familyIndex, entry);
+    }
+    DL_DELETE(g_cacheList, entry);
+    OICFree(entry);
+    g_cacheSize--;
+}
+
+static void CAClearDuplicateCache()
+{
+    CADuplicateEntry_t *entry = NULL;
+    CADuplicateEntry_t *tmp = NULL;
+    DL_FOREACH_SAFE(g_cacheList, entry, tmp)
+    {
+        CARemoveDuplicateEntry(entry);
+    }
+}
+
+CAResult_t CAInitializeDuplicateCache(size_t capacity, uint32_t lifetime)
+{
+    if (!g_cacheMutex)
+    {
+        g_cacheMutex = oc_mutex_new();
+        if (!g_cacheMutex)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to create mutex!");
+            return CA_STATUS_FAILED;
+        }
+    }
+
+    oc_mutex_lock(g_cacheMutex);
+    CAClearDuplicateCache();
+    g_cacheCapacity = capacity ? capacity : DEFAULT_DUPLICATE_CACHE_SIZE;
+    g_cacheLifetime = (lifetime ? lifetime : DEFAULT_EXCHANGE_LIFETIME_SEC) * MSECS_PER_SEC;
+    oc_mutex_unlock(g_cacheMutex);
+
+    OIC_LOG_V(DEBUG, TAG, "capacity=%" PRIuPTR ", lifetime=%" PRIu64 "ms",
+              g_cacheCapacity, g_cacheLifetime);
+    return CA_STATUS_OK;
+}
+
+void CATerminateDuplicateCache()
+{
+    if (!g_cacheMutex)
+    {
+        return;
+    }
+
+    oc_mutex_lock(g_cacheMutex);
+    CAClearDuplicateCache();
+    oc_mutex_unlock(g_cacheMutex);
+
+    oc_mutex_free(g_cacheMutex);
+    g_cacheMutex = NULL;
+}
+
+bool CAIsDuplicateMessage(const CAEndpoint_t *endpoint, uint16_t messageId,
+                          const CAToken_t token, uint8_t tokenLength)
+{
+    if (!endpoint)
+    {
+        return true;
+    }
+    if (CA_ADAPTER_TCP == endpoint->adapter || !g_cacheMutex)
+    {
+        return false;
+    }
+
+    if (tokenLength > CA_MAX_TOKEN_LEN)
+    {
+        /*
+         * If token length is more than CA_MAX_TOKEN_LEN,
+         * we compare the first CA_MAX_TOKEN_LEN bytes only.
+         */
+        tokenLength = CA_MAX_TOKEN_LEN;
+    }
+
+    // a message is identified by its message id and the remote endpoint (RFC 7252 4.5).
+    CADuplicateKey_t key;
+    memset(&key, 0, sizeof (key));
+    key.adapter = endpoint->adapter;
+    OICStrcpy(key.addr, sizeof (key.addr), endpoint->addr);
+    key.port = endpoint->port;
+    key.messageId = messageId;
+    if (token && tokenLength)
+    {
+        memcpy(key.token, token, tokenLength);
+        key.tokenLength = tokenLength;
+    }
+
+    // the other IP family delivers the same multicast message with another address,
+    // so it is matched by interface, message id and token instead.
+    CADuplicateFamilyKey_t familyKey;
+    memset(&familyKey, 0, sizeof (familyKey));
+    bool isIP = (CA_ADAPTER_IP == endpoint->adapter);
+    if (isIP)
+    {
+        familyKey.ifindex = endpoint->ifindex;
+        familyKey.family = endpoint->flags & CA_IPFAMILY_MASK;
+        familyKey.messageId = key.messageId;
+        familyKey.tokenLength = key.tokenLength;
+        memcpy(familyKey.token, key.token, sizeof (familyKey.token));
+    }
+
+    oc_mutex_lock(g_cacheMutex);
+
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_MS);
+
+    // #1. forget messages older than the lifetime.
+    while (g_cacheList && g_cacheList->expiry <= currentTime)
+    {
+        CARemoveDuplicateEntry(g_cacheList);
+    }
+
+    // #2. look up the message.
+    CADuplicateEntry_t *entry = NULL;
+    HASH_FIND(hh, g_cacheIndex, &key, sizeof (key), entry);
+    if (!entry && isIP && familyKey.family && (CA_IPFAMILY_MASK != familyKey.family))
+    {
+        CADuplicateFamilyKey_t otherKey = familyKey;
+        otherKey.family = familyKey.family ^ CA_IPFAMILY_MASK;
+        HASH_FIND(hhFamily, g_familyIndex, &otherKey, sizeof (otherKey), entry);
+    }
+    if (entry)
+    {
+        oc_mutex_unlock(g_cacheMutex);
+        if (CA_ADAPTER_IP == endpoint->adapter)
+        {
+            OIC_LOG_V(INFO, TAG, "IPv%c duplicate message ignored",
+                      (endpoint->flags & CA_IPV6) ? '6' : '4');
+        }
+        else
+        {
+            OIC_LOG_V(INFO, TAG, "duplicate message ignored, msgid=%d", messageId);
+        }
+        return true;
+    }
+
+    // #3. remember it, evicting the oldest message when full.
+    if (g_cacheSize >= g_cacheCapacity)
+    {
+        CARemoveDuplicateEntry(g_cacheList);
+    }
+
+    entry = (CADuplicateEntry_t *) OICMalloc(sizeof (*entry));
+    if (!entry)
+    {
+        oc_mutex_unlock(g_cacheMutex);
+        OIC_LOG(ERROR, TAG, "memory error");
+        return false;
+    }
+    entry->key = key;
+    entry->familyKey = familyKey;
+    entry->expiry = currentTime + g_cacheLifetime;
+    HASH_ADD(hh, g_cacheIndex, key, sizeof (entry->key), entry);
+    if (isIP)
+    {
+        HASH_ADD(hhFamily, g_familyIndex, familyKey, sizeof (entry->familyKey), entry);
+    }
+    DL_APPEND(g_cacheList, entry);
+    g_cacheSize++;
+
+    oc_mutex_unlock(g_cacheMutex);
+    return false;
+}
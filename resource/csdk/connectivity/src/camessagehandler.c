@@ -37,6 +37,7 @@
 #include "caadapterutils.h"
 #include "cainterfacecontroller.h"
 #include "caretransmission.h"
+#include "caduplicatecache.h"
 #include "oic_string.h"
 
 #ifdef WITH_BWT
@@ -44,7 +45,8 @@
 #endif
 
 #ifndef  SINGLE_THREAD
-#include "uqueue.h"
+#include "umpscqueue.h"
+#include "ocatomic.h"
 #include "cathreadpool.h" /* for thread pool */
 #include "caqueueingthread.h"
 
@@ -53,6 +55,7 @@
 #endif
 #define SINGLE_HANDLE
 #define MAX_THREAD_POOL_SIZE    20
+#define MAX_PROCESS_EVENTS      4
 
 // thread pool handle
 static ca_thread_pool_t g_threadPoolHandle = NULL;
@@ -61,6 +64,12 @@ static ca_thread_pool_t g_threadPoolHandle = NULL;
 static CAQueueingThread_t g_sendThread;
 static CAQueueingThread_t g_receiveThread;
 
+// events signaled whenever g_receiveThread has data for CAHandleRequestResponseCallbacks.
+// written under g_receiveThread.threadMutex and kept packed, so the receivers can
+// check g_processEvents[0] atomically before taking the lock.
+static oc_event g_processEvents[MAX_PROCESS_EVENTS];
+static size_t g_processEventCount = 0;
+
 #else
 #define CA_MAX_RT_ARRAY_SIZE    3
 #endif  // SINGLE_THREAD
@@ -91,8 +100,6 @@ static void CAProcessReceivedData(CAData_t *data);
 #endif
 static void CADestroyData(void *data, uint32_t size);
 static void CALogPayloadInfo(CAInfo_t *info);
-static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *endpoint, uint16_t id,
-                                CAToken_t token, uint8_t tokenLength);
 
 /**
  * print send / receive message of CoAP.
@@ -109,6 +116,22 @@ void CAAddDataToSendThread(CAData_t *data)
     // add thread
     CAQueueingThreadAddData(&g_sendThread, data, sizeof(CAData_t));
 }
+#endif
+
+#ifndef SINGLE_THREAD
+static void CASignalProcessEvents(void)
+{
+    for (size_t i = 0; i < g_processEventCount; i++)
+    {
+        oc_event_signal(g_processEvents[i]);
+    }
+}
+
+static void CASetProcessEvent(size_t index, oc_event event)
+{
+    // the first slot is also read without the lock.
+    oc_atomic_exchange_ptr((void * volatile *)&g_processEvents[index], event);
+}
 
 void CAAddDataToReceiveThread(CAData_t *data)
 {
@@ -116,6 +139,81 @@ void CAAddDataToReceiveThread(CAData_t *data)
 
     // add thread
     CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+
+    // wake up whoever is waiting to call CAHandleRequestResponse, only if someone is.
+    // the queue was updated with a full barrier, so a concurrent
+    // CARegisterMessageHandlerEvent either is seen here or sees the new message.
+    if (oc_atomic_load_ptr((void * volatile *)&g_processEvents[0]))
+    {
+        // the lock keeps the events alive until they are signaled.
+        oc_mutex_lock(g_receiveThread.threadMutex);
+        CASignalProcessEvents();
+        oc_mutex_unlock(g_receiveThread.threadMutex);
+    }
+}
+
+CAResult_t CARegisterMessageHandlerEvent(oc_event event)
+{
+    VERIFY_NON_NULL(event, TAG, "event");
+
+    CAResult_t res = CA_STATUS_OK;
+    if (g_receiveThread.threadMutex)
+    {
+        oc_mutex_lock(g_receiveThread.threadMutex);
+    }
+
+    for (size_t i = 0; i < g_processEventCount; i++)
+    {
+        if (g_processEvents[i] == event)
+        {
+            goto exit;
+        }
+    }
+
+    if (MAX_PROCESS_EVENTS == g_processEventCount)
+    {
+        OIC_LOG(ERROR, TAG, "too many process events");
+        res = CA_STATUS_FAILED;
+        goto exit;
+    }
+    CASetProcessEvent(g_processEventCount++, event);
+
+    if (g_receiveThread.dataQueue && (0 < u_mpsc_queue_get_size(g_receiveThread.dataQueue)))
+    {
+        oc_event_signal(event);
+    }
+
+exit:
+    if (g_receiveThread.threadMutex)
+    {
+        oc_mutex_unlock(g_receiveThread.threadMutex);
+    }
+    return res;
+}
+
+void CAUnregisterMessageHandlerEvent(oc_event event)
+{
+    if (g_receiveThread.threadMutex)
+    {
+        oc_mutex_lock(g_receiveThread.threadMutex);
+    }
+
+    for (size_t i = 0; i < g_processEventCount; i++)
+    {
+        if (g_processEvents[i] == event)
+        {
+            // move the last event into the hole to keep the array packed.
+            g_processEventCount--;
+            CASetProcessEvent(i, g_processEvents[g_processEventCount]);
+            CASetProcessEvent(g_processEventCount, NULL);
+            break;
+        }
+    }
+
+    if (g_receiveThread.threadMutex)
+    {
+        oc_mutex_unlock(g_receiveThread.threadMutex);
+    }
 }
 #endif
 
@@ -203,8 +301,8 @@ static CAData_t* CAGenerateHandlerData(const CAEndpoint_t *endpoint,
         }
 
         if ((reqInfo->info.type != CA_MSG_CONFIRM) &&
-            CADropSecondMessage(&caglobals.ca.requestHistory, endpoint, reqInfo->info.messageId,
-                                reqInfo->info.token, reqInfo->info.tokenLength))
+            CAIsDuplicateMessage(endpoint, reqInfo->info.messageId,
+                                 reqInfo->info.token, reqInfo->info.tokenLength))
         {
             OIC_LOG(INFO, TAG, "Second Request with same Token, Drop it");
             CADestroyRequestInfoInternal(reqInfo);
@@ -334,7 +432,7 @@ static void CATimeoutCallback(const CAEndpoint_t *endpoint, const void *pdu, uin
 #ifdef SINGLE_THREAD
     CAProcessReceivedData(cadata);
 #else
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAAddDataToReceiveThread(cadata);
 #endif
 }
 
@@ -438,9 +536,10 @@ static CAResult_t CAProcessMulticastData(const CAData_t *data)
 
     coap_pdu_t *pdu = NULL;
     CAInfo_t *info = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
     coap_transport_t transport = COAP_UDP;
     CAResult_t res = CA_SEND_FAILED;
+    CAInitOptionList(&options);
 
     if (!data->requestInfo && !data->responseInfo)
     {
@@ -468,7 +567,7 @@ static CAResult_t CAProcessMulticastData(const CAData_t *data)
     {
         OIC_LOG(ERROR,TAG,"Failed to generate multicast PDU");
         CASendErrorInfo(data->remoteEndpoint, info, CA_SEND_FAILED);
-        coap_delete_list(options);
+        CAClearOptionList(&options);
         return res;
     }
 
@@ -494,13 +593,13 @@ static CAResult_t CAProcessMulticastData(const CAData_t *data)
         goto exit;
     }
 
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
     return res;
 
 exit:
     CAErrorHandler(data->remoteEndpoint, pdu->transport_hdr, pdu->length, res);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
     return res;
 }
@@ -516,7 +615,8 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
 
     coap_pdu_t *pdu = NULL;
     CAInfo_t *info = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     if (SEND_TYPE_UNICAST == type)
@@ -573,7 +673,7 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
                     {
                         OIC_LOG(INFO, TAG, "to write block option has failed");
                         CAErrorHandler(data->remoteEndpoint, pdu->transport_hdr, pdu->length, res);
-                        coap_delete_list(options);
+                        CAClearOptionList(&options);
                         coap_delete_pdu(pdu);
                         return res;
                     }
@@ -588,7 +688,7 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
             {
                 OIC_LOG_V(ERROR, TAG, "send failed:%d", res);
                 CAErrorHandler(data->remoteEndpoint, pdu->transport_hdr, pdu->length, res);
-                coap_delete_list(options);
+                CAClearOptionList(&options);
                 coap_delete_pdu(pdu);
                 return res;
             }
@@ -613,19 +713,20 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
                 {
                     //when retransmission not supported this will return CA_NOT_SUPPORTED, ignore
                     OIC_LOG_V(INFO, TAG, "retransmission is not enabled due to error, res : %d", res);
-                    coap_delete_list(options);
+                    CAClearOptionList(&options);
                     coap_delete_pdu(pdu);
                     return res;
                 }
             }
 
-            coap_delete_list(options);
+            CAClearOptionList(&options);
             coap_delete_pdu(pdu);
         }
         else
         {
             OIC_LOG(ERROR,TAG,"Failed to generate unicast PDU");
             CASendErrorInfo(data->remoteEndpoint, info, CA_SEND_FAILED);
+            CAClearOptionList(&options);
             return CA_SEND_FAILED;
         }
     }
@@ -677,64 +778,6 @@ static void CASendThreadProcess(void *threadData)
 }
 #endif
 
-/*
- * If a second message arrives with the same message ID, token and the other address
- * family, drop it.  Typically, IPv6 beats IPv4, so the IPv4 message is dropped.
- */
-static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *ep, uint16_t id,
-                                CAToken_t token, uint8_t tokenLength)
-{
-    if (!ep)
-    {
-        return true;
-    }
-    if (ep->adapter != CA_ADAPTER_IP)
-    {
-        return false;
-    }
-
-    if (tokenLength > CA_MAX_TOKEN_LEN)
-    {
-        /*
-         * If token length is more than CA_MAX_TOKEN_LEN,
-         * we compare the first CA_MAX_TOKEN_LEN bytes only.
-         */
-        tokenLength = CA_MAX_TOKEN_LEN;
-    }
-
-    bool ret = false;
-    CATransportFlags_t familyFlags = ep->flags & CA_IPFAMILY_MASK;
-
-    for (size_t i = 0; i < sizeof(history->items) / sizeof(history->items[0]); i++)
-    {
-        CAHistoryItem_t *item = &(history->items[i]);
-        if (id == item->messageId && tokenLength == item->tokenLength
-            && ep->ifindex == item->ifindex && memcmp(item->token, token, tokenLength) == 0)
-        {
-            OIC_LOG_V(INFO, TAG, "IPv%c duplicate message ignored",
-                      familyFlags & CA_IPV6 ? '6' : '4');
-            ret = true;
-            break;
-        }
-    }
-
-    history->items[history->nextIndex].flags = familyFlags;
-    history->items[history->nextIndex].messageId = id;
-    history->items[history->nextIndex].ifindex = ep->ifindex;
-    if (token && tokenLength)
-    {
-        memcpy(history->items[history->nextIndex].token, token, tokenLength);
-        history->items[history->nextIndex].tokenLength = tokenLength;
-    }
-
-    if (++history->nextIndex >= HISTORYSIZE)
-    {
-        history->nextIndex = 0;
-    }
-
-    return ret;
-}
-
 static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
                                      const void *data, size_t dataLen)
 {
@@ -828,7 +871,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
         if (CA_NOT_SUPPORTED == res || CA_REQUEST_TIMEOUT == res)
         {
             OIC_LOG(DEBUG, TAG, "this message does not have block option");
-            CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+            CAAddDataToReceiveThread(cadata);
         }
         else
         {
@@ -838,7 +881,7 @@ static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
     else
 #endif
     {
-        CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+        CAAddDataToReceiveThread(cadata);
     }
 #endif // SINGLE_THREAD
 
@@ -864,7 +907,13 @@ void CAHandleRequestResponseCallbacks()
 
     oc_mutex_lock(g_receiveThread.threadMutex);
 
-    u_queue_message_t *item = u_queue_get_element(g_receiveThread.dataQueue);
+    u_queue_message_t *item = u_mpsc_queue_get_element(g_receiveThread.dataQueue);
+
+    // only one message is handled per call, so keep the waiters awake while more are queued
+    if (0 < u_mpsc_queue_get_size(g_receiveThread.dataQueue))
+    {
+        CASignalProcessEvents();
+    }
 
     oc_mutex_unlock(g_receiveThread.threadMutex);
 
@@ -1025,7 +1074,7 @@ CAResult_t CADetachSendMessage(const CAEndpoint_t *endpoint, const void *sendMsg
     {
         OIC_LOG(DEBUG, TAG,
                 "This is a loopback message. Transfer it to the receive queue directly");
-        CAQueueingThreadAddData(&g_receiveThread, data, sizeof(CAData_t));
+        CAAddDataToReceiveThread(data);
         return CA_STATUS_OK;
     }
 #ifdef WITH_BWT
@@ -1073,6 +1122,15 @@ CAResult_t CAInitializeMessageHandler(CATransportAdapter_t transportType)
     CASetPacketReceivedCallback(CAReceivedPacketCallback);
     CASetErrorHandleCallback(CAErrorHandler);
 
+    // duplicate message cache initialize
+    CAResult_t dupRes = CAInitializeDuplicateCache(caglobals.ca.dupCacheSize,
+                                                   caglobals.ca.dupCacheLifetime);
+    if (CA_STATUS_OK != dupRes)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to Initialize duplicate message cache.");
+        return dupRes;
+    }
+
 #ifndef SINGLE_THREAD
     // create thread pool
     CAResult_t res = ca_thread_pool_init(MAX_THREAD_POOL_SIZE, &g_threadPoolHandle);
@@ -1209,6 +1267,10 @@ void CATerminateMessageHandler()
     CARetransmissionDestroy(&g_retransmissionContext);
     CAQueueingThreadDestroy(&g_sendThread);
     CAQueueingThreadDestroy(&g_receiveThread);
+    while (0 < g_processEventCount)
+    {
+        CASetProcessEvent(--g_processEventCount, NULL);
+    }
 
     // terminate interface adapters by controller
     CATerminateAdapters();
@@ -1220,6 +1282,8 @@ void CATerminateMessageHandler()
     CARetransmissionStop(&g_retransmissionContext);
     CARetransmissionDestroy(&g_retransmissionContext);
 #endif // SINGLE_THREAD
+
+    CATerminateDuplicateCache();
 }
 
 static void CALogPayloadInfo(CAInfo_t *info)
@@ -1325,7 +1389,7 @@ void CAErrorHandler(const CAEndpoint_t *endpoint,
 
     cadata->errorInfo->result = result;
 
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAAddDataToReceiveThread(cadata);
     coap_delete_pdu(pdu);
 #else
     (void)result;
@@ -1378,7 +1442,7 @@ static void CASendErrorInfo(const CAEndpoint_t *endpoint, const CAInfo_t *info,
     cadata->errorInfo = errorInfo;
     cadata->dataType = CA_ERROR_DATA;
 
-    CAQueueingThreadAddData(&g_receiveThread, cadata, sizeof(CAData_t));
+    CAAddDataToReceiveThread(cadata);
 #endif
     OIC_LOG(DEBUG, TAG, "CASendErrorInfo OUT");
 }
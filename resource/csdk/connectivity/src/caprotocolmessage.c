@@ -99,7 +99,7 @@ CAResult_t CAGetErrorInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endp
 }
 
 coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_t *endpoint,
-                          coap_list_t **optlist, coap_transport_t *transport)
+                          CAOptionList_t *optlist, coap_transport_t *transport)
 {
     VERIFY_NON_NULL_RET(info, TAG, "info", NULL);
     VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint", NULL);
@@ -146,25 +146,16 @@ coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_
                 return NULL;
             }
 
-            size_t uriLength = length + sizeof(COAP_URI_HEADER);
-            char *coapUri = (char *) OICCalloc(1, uriLength);
-            if (NULL == coapUri)
-            {
-                OIC_LOG(ERROR, TAG, "out of memory");
-                return NULL;
-            }
-            OICStrcat(coapUri, uriLength, COAP_URI_HEADER);
-            OICStrcat(coapUri, uriLength, info->resourceUri);
+            char coapUri[CA_MAX_URI_LENGTH + sizeof(COAP_URI_HEADER)];
+            OICStrcpy(coapUri, sizeof(coapUri), COAP_URI_HEADER);
+            OICStrcat(coapUri, sizeof(coapUri), info->resourceUri);
 
             // parsing options in URI
             CAResult_t res = CAParseURI(coapUri, optlist);
             if (CA_STATUS_OK != res)
             {
-                OICFree(coapUri);
                 return NULL;
             }
-
-            OICFree(coapUri);
         }
         // parsing options in HeadOption
         CAResult_t ret = CAParseHeadOption(code, info, optlist);
@@ -173,7 +164,7 @@ coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_
             return NULL;
         }
 
-        pdu = CAGeneratePDUImpl((code_t) code, info, endpoint, *optlist, transport);
+        pdu = CAGeneratePDUImpl((code_t) code, info, endpoint, optlist, transport);
         if (NULL == pdu)
         {
             OIC_LOG(ERROR, TAG, "pdu NULL");
@@ -255,7 +246,7 @@ exit:
 }
 
 coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
-                              const CAEndpoint_t *endpoint, coap_list_t *options,
+                              const CAEndpoint_t *endpoint, const CAOptionList_t *options,
                               coap_transport_t *transport)
 {
     VERIFY_NON_NULL_RET(info, TAG, "info", NULL);
@@ -272,16 +263,16 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
         if (options)
         {
             unsigned short prevOptNumber = 0;
-            for (coap_list_t *opt = options; opt; opt = opt->next)
+            for (size_t i = 0; i < options->count; i++)
             {
-                unsigned short curOptNumber = COAP_OPTION_KEY(*(coap_option *) opt->data);
+                unsigned short curOptNumber = options->options[i].key;
                 if (prevOptNumber > curOptNumber)
                 {
                     OIC_LOG(ERROR, TAG, "option list is wrong");
                     return NULL;
                 }
 
-                size_t optValueLen = COAP_OPTION_LENGTH(*(coap_option *) opt->data);
+                size_t optValueLen = options->options[i].length;
                 size_t optLength = coap_get_opt_header_length(curOptNumber - prevOptNumber, optValueLen);
                 if (0 == optLength)
                 {
@@ -379,27 +370,12 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
     }
 #endif
 
-    if (options)
+    if (options && CA_STATUS_OK != CAWriteOptionListToPDU(pdu, options, *transport))
     {
-        for (coap_list_t *opt = options; opt; opt = opt->next)
-        {
-            OIC_LOG_V(DEBUG, TAG, "[%s] opt will be added.",
-                      COAP_OPTION_DATA(*(coap_option *) opt->data));
-
-            OIC_LOG_V(DEBUG, TAG, "[%d] pdu length", pdu->length);
-            if (0 == coap_add_option2(pdu, COAP_OPTION_KEY(*(coap_option *) opt->data),
-                                      COAP_OPTION_LENGTH(*(coap_option *) opt->data),
-                                      COAP_OPTION_DATA(*(coap_option *) opt->data), *transport))
-            {
-                OIC_LOG(ERROR, TAG, "coap_add_option2 has failed");
-                coap_delete_pdu(pdu);
-                return NULL;
-            }
-        }
+        coap_delete_pdu(pdu);
+        return NULL;
     }
 
-    OIC_LOG_V(DEBUG, TAG, "[%d] pdu length after option", pdu->length);
-
     if ((NULL != info->payload) && (0 < info->payloadSize))
     {
         OIC_LOG(DEBUG, TAG, "payload is added");
@@ -410,7 +386,7 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
     return pdu;
 }
 
-CAResult_t CAParseURI(const char *uriInfo, coap_list_t **optlist)
+CAResult_t CAParseURI(const char *uriInfo, CAOptionList_t *optlist)
 {
     VERIFY_NON_NULL(uriInfo, TAG, "uriInfo");
     VERIFY_NON_NULL(optlist, TAG, "optlist");
@@ -422,14 +398,11 @@ CAResult_t CAParseURI(const char *uriInfo, coap_list_t **optlist)
     if (uri.port != COAP_DEFAULT_PORT)
     {
         unsigned char portbuf[CA_ENCODE_BUFFER_SIZE] = { 0 };
-        int ret = coap_insert(optlist,
-                              CACreateNewOptionNode(COAP_OPTION_URI_PORT,
-                                                    coap_encode_var_bytes(portbuf, uri.port),
-                                                    (char *)portbuf),
-                              CAOrderOpts);
-        if (ret <= 0)
+        CAResult_t ret = CAAddOptionToList(optlist, COAP_OPTION_URI_PORT,
+                                           coap_encode_var_bytes(portbuf, uri.port), portbuf);
+        if (CA_STATUS_OK != ret)
         {
-            return CA_STATUS_INVALID_PARAM;
+            return ret;
         }
     }
 
@@ -459,7 +432,7 @@ CAResult_t CAParseURI(const char *uriInfo, coap_list_t **optlist)
 }
 
 CAResult_t CAParseUriPartial(const unsigned char *str, size_t length, uint16_t target,
-                             coap_list_t **optlist)
+                             CAOptionList_t *optlist)
 {
     VERIFY_NON_NULL(optlist, TAG, "optlist");
 
@@ -471,26 +444,30 @@ CAResult_t CAParseUriPartial(const unsigned char *str, size_t length, uint16_t t
     }
     else if (str && length)
     {
-        unsigned char uriBuffer[CA_MAX_URI_LENGTH] = { 0 };
+        // the segments are split into the list's own buffer and referenced from there.
+        unsigned char *uriBuffer = optlist->uriBuffer + optlist->uriLength;
+        size_t bufferSize = sizeof(optlist->uriBuffer) - optlist->uriLength;
         unsigned char *pBuf = uriBuffer;
-        size_t unusedBufferSize = sizeof(uriBuffer);
+        size_t unusedBufferSize = bufferSize;
         int res = (target == COAP_OPTION_URI_PATH) ? coap_split_path(str, length, pBuf, &unusedBufferSize) :
                                                      coap_split_query(str, length, pBuf, &unusedBufferSize);
 
         if (res > 0)
         {
-            assert(unusedBufferSize < sizeof(uriBuffer));
-            size_t usedBufferSize = sizeof(uriBuffer) - unusedBufferSize;
+            // coap_split_path() leaves the used size in the last argument,
+            // coap_split_query() the unused one.
+            size_t usedBufferSize = (target == COAP_OPTION_URI_PATH) ?
+                                    unusedBufferSize : bufferSize - unusedBufferSize;
+            assert(usedBufferSize <= bufferSize);
+            optlist->uriLength += usedBufferSize;
             size_t prevIdx = 0;
             while (res--)
             {
-                int ret = coap_insert(optlist,
-                                      CACreateNewOptionNode(target, COAP_OPT_LENGTH(pBuf),
-                                                            (char *)COAP_OPT_VALUE(pBuf)),
-                                      CAOrderOpts);
-                if (ret <= 0)
+                CAResult_t ret = CAAddOptionToList(optlist, target, COAP_OPT_LENGTH(pBuf),
+                                                   COAP_OPT_VALUE(pBuf));
+                if (CA_STATUS_OK != ret)
                 {
-                    return CA_STATUS_INVALID_PARAM;
+                    return ret;
                 }
 
                 size_t optSize = COAP_OPT_SIZE(pBuf);
@@ -518,7 +495,7 @@ CAResult_t CAParseUriPartial(const unsigned char *str, size_t length, uint16_t t
     return CA_STATUS_OK;
 }
 
-CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, coap_list_t **optlist)
+CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, CAOptionList_t *optlist)
 {
     (void)code;
     VERIFY_NON_NULL_RET(info, TAG, "info", CA_STATUS_INVALID_PARAM);
@@ -555,11 +532,9 @@ CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, coap_list_t **
             default:
                 OIC_LOG_V(DEBUG, TAG, "Head opt ID[%d], length[%d]", id,
                     (info->options + i)->optionLength);
-                int ret = coap_insert(optlist,
-                                      CACreateNewOptionNode(id, (info->options + i)->optionLength,
-                                                            (info->options + i)->optionData),
-                                      CAOrderOpts);
-                if (ret <= 0)
+                if (CA_STATUS_OK != CAAddOptionToList(optlist, id,
+                                                      (info->options + i)->optionLength,
+                                                      (const uint8_t *) (info->options + i)->optionData))
                 {
                     return CA_STATUS_INVALID_PARAM;
                 }
@@ -581,38 +556,32 @@ CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, coap_list_t **
 }
 
 CAResult_t CAParsePayloadFormatHeadOption(uint16_t formatOption, CAPayloadFormat_t format,
-        uint16_t versionOption, uint16_t version, coap_list_t **optlist)
+        uint16_t versionOption, uint16_t version, CAOptionList_t *optlist)
 {
-    coap_list_t* encodeNode = NULL;
-    coap_list_t* versionNode = NULL;
     uint8_t encodeBuf[CA_ENCODE_BUFFER_SIZE] = { 0 };
     uint8_t versionBuf[CA_ENCODE_BUFFER_SIZE] = { 0 };
+    unsigned int encodeLength = 0;
 
     switch (format)
     {
         case CA_FORMAT_APPLICATION_CBOR:
-            encodeNode = CACreateNewOptionNode(formatOption,
-                    coap_encode_var_bytes(encodeBuf,
-                            (unsigned short) COAP_MEDIATYPE_APPLICATION_CBOR), (char *) encodeBuf);
+            encodeLength = coap_encode_var_bytes(encodeBuf,
+                    (unsigned short) COAP_MEDIATYPE_APPLICATION_CBOR);
             break;
         case CA_FORMAT_APPLICATION_VND_OCF_CBOR:
-            encodeNode = CACreateNewOptionNode(formatOption,
-                    coap_encode_var_bytes(encodeBuf,
-                            (unsigned short) COAP_MEDIATYPE_APPLICATION_VND_OCF_CBOR),
-                    (char *) encodeBuf);
+            encodeLength = coap_encode_var_bytes(encodeBuf,
+                    (unsigned short) COAP_MEDIATYPE_APPLICATION_VND_OCF_CBOR);
             break;
         default:
             OIC_LOG_V(ERROR, TAG, "Format option:[%d] not supported", format);
+            OIC_LOG(ERROR, TAG, "Format option not created");
+            return CA_STATUS_INVALID_PARAM;
     }
-    if (!encodeNode)
-    {
-        OIC_LOG(ERROR, TAG, "Format option not created");
-        return CA_STATUS_INVALID_PARAM;
-    }
-    int ret = coap_insert(optlist, encodeNode, CAOrderOpts);
-    if (0 >= ret)
+
+    // Both options are short enough to be copied, so nothing has to be undone
+    // if the second one fails.
+    if (CA_STATUS_OK != CAAddOptionToList(optlist, formatOption, encodeLength, encodeBuf))
     {
-        coap_delete(encodeNode);
         OIC_LOG(ERROR, TAG, "Format option not inserted in header");
         return CA_STATUS_INVALID_PARAM;
     }
@@ -621,20 +590,10 @@ CAResult_t CAParsePayloadFormatHeadOption(uint16_t formatOption, CAPayloadFormat
          CA_OPTION_CONTENT_VERSION == versionOption) &&
         CA_FORMAT_APPLICATION_VND_OCF_CBOR == format)
     {
-        versionNode = CACreateNewOptionNode(versionOption,
-                coap_encode_var_bytes(versionBuf, version), (char *) versionBuf);
-
-        if (!versionNode)
-        {
-            OIC_LOG(ERROR, TAG, "Version option not created");
-            coap_delete(encodeNode);
-            return CA_STATUS_INVALID_PARAM;
-        }
-        ret = coap_insert(optlist, versionNode, CAOrderOpts);
-        if (0 >= ret)
+        if (CA_STATUS_OK != CAAddOptionToList(optlist, versionOption,
+                                              coap_encode_var_bytes(versionBuf, version),
+                                              versionBuf))
         {
-            coap_delete(versionNode);
-            coap_delete(encodeNode);
             OIC_LOG(ERROR, TAG, "Content version option not inserted in header");
             return CA_STATUS_INVALID_PARAM;
         }
@@ -642,24 +601,88 @@ CAResult_t CAParsePayloadFormatHeadOption(uint16_t formatOption, CAPayloadFormat
     return CA_STATUS_OK;
 }
 
-coap_list_t *CACreateNewOptionNode(uint16_t key, uint32_t length, const char *data)
+void CAInitOptionList(CAOptionList_t *optlist)
 {
-    VERIFY_NON_NULL_RET(data, TAG, "data", NULL);
+    if (optlist)
+    {
+        optlist->options = optlist->inlineOptions;
+        optlist->count = 0;
+        optlist->capacity = CA_OPTION_LIST_INLINE_COUNT;
+        optlist->uriLength = 0;
+    }
+}
+
+void CAClearOptionList(CAOptionList_t *optlist)
+{
+    if (optlist)
+    {
+        if (optlist->options != optlist->inlineOptions)
+        {
+            OICFree(optlist->options);
+        }
+        CAInitOptionList(optlist);
+    }
+}
+
+static CAResult_t CAGrowOptionList(CAOptionList_t *optlist)
+{
+    size_t capacity = optlist->capacity * 2;
+    CAOption_t *options = NULL;
+    if (optlist->options == optlist->inlineOptions)
+    {
+        options = (CAOption_t *) OICMalloc(capacity * sizeof(CAOption_t));
+        if (options)
+        {
+            memcpy(options, optlist->inlineOptions, optlist->count * sizeof(CAOption_t));
+        }
+    }
+    else
+    {
+        options = (CAOption_t *) OICRealloc(optlist->options, capacity * sizeof(CAOption_t));
+    }
 
-    coap_option *option = coap_malloc(sizeof(coap_option) + length + 1);
-    if (!option)
+    if (!options)
     {
         OIC_LOG(ERROR, TAG, "Out of memory");
-        return NULL;
+        return CA_MEMORY_ALLOC_FAILED;
     }
-    memset(option, 0, sizeof(coap_option) + length + 1);
 
-    COAP_OPTION_KEY(*option) = key;
+    optlist->options = options;
+    optlist->capacity = capacity;
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAAddOptionToList(CAOptionList_t *optlist, uint16_t key, uint32_t length,
+                             const uint8_t *data)
+{
+    VERIFY_NON_NULL(optlist, TAG, "optlist");
+    VERIFY_NON_NULL(data, TAG, "data");
+    VERIFY_TRUE((length <= UINT16_MAX), TAG, "length");
+
+    if (optlist->count == optlist->capacity)
+    {
+        CAResult_t res = CAGrowOptionList(optlist);
+        if (CA_STATUS_OK != res)
+        {
+            return res;
+        }
+    }
+
+    // Keep the list sorted: move every option with a larger number up by one.
+    size_t idx = optlist->count;
+    while (idx > 0 && optlist->options[idx - 1].key > key)
+    {
+        optlist->options[idx] = optlist->options[idx - 1];
+        idx--;
+    }
+
+    CAOption_t *option = &optlist->options[idx];
+    option->key = key;
 
     coap_option_def_t* def = coap_opt_def(key);
     if (NULL != def && coap_is_var_bytes(def))
     {
-       if (length > def->max)
+        if (length > def->max)
         {
             // make sure we shrink the value so it fits the coap option definition
             // by truncating the value, disregard the leading bytes.
@@ -670,42 +693,53 @@ coap_list_t *CACreateNewOptionNode(uint16_t key, uint32_t length, const char *da
         }
         // Shrink the encoding length to a minimum size for coap
         // options that support variable length encoding.
-         COAP_OPTION_LENGTH(*option) = coap_encode_var_bytes(
-                COAP_OPTION_DATA(*option),
+        option->length = (uint16_t) coap_encode_var_bytes(option->value,
                 coap_decode_var_bytes((unsigned char *)data, length));
+        option->data = NULL;
     }
-    else
+    else if (length <= CA_OPTION_INLINE_VALUE_SIZE)
     {
-        COAP_OPTION_LENGTH(*option) = length;
-        memcpy(COAP_OPTION_DATA(*option), data, length);
+        option->length = (uint16_t) length;
+        memcpy(option->value, data, length);
+        option->data = NULL;
     }
-
-    /* we can pass NULL here as delete function since option is released automatically  */
-    coap_list_t *node = coap_new_listnode(option, NULL);
-
-    if (!node)
+    else
     {
-        OIC_LOG(ERROR, TAG, "node is NULL");
-        coap_free(option);
-        return NULL;
+        option->length = (uint16_t) length;
+        option->data = data;
     }
 
-    return node;
+    optlist->count++;
+    return CA_STATUS_OK;
 }
 
-int CAOrderOpts(void *a, void *b)
+const uint8_t *CAGetOptionValue(const CAOption_t *option)
 {
-    if (!a || !b)
-    {
-        return a < b ? -1 : 1;
-    }
+    return option->data ? option->data : option->value;
+}
 
-    if (COAP_OPTION_KEY(*(coap_option *) a) < COAP_OPTION_KEY(*(coap_option * ) b))
+CAResult_t CAWriteOptionListToPDU(coap_pdu_t *pdu, const CAOptionList_t *optlist,
+                                  coap_transport_t transport)
+{
+    VERIFY_NON_NULL(pdu, TAG, "pdu");
+    VERIFY_NON_NULL(optlist, TAG, "optlist");
+
+    for (size_t i = 0; i < optlist->count; i++)
     {
-        return -1;
+        const CAOption_t *option = &optlist->options[i];
+        OIC_LOG_V(DEBUG, TAG, "[%d] opt will be added, [%d] pdu length",
+                  option->key, pdu->length);
+
+        if (0 == coap_add_option2(pdu, option->key, option->length,
+                                  CAGetOptionValue(option), transport))
+        {
+            OIC_LOG(ERROR, TAG, "coap_add_option2 has failed");
+            return CA_STATUS_FAILED;
+        }
     }
 
-    return COAP_OPTION_KEY(*(coap_option *) a) == COAP_OPTION_KEY(*(coap_option * ) b);
+    OIC_LOG_V(DEBUG, TAG, "[%d] pdu length after option", pdu->length);
+    return CA_STATUS_OK;
 }
 
 CAResult_t CAGetOptionCount(coap_opt_iterator_t opt_iter, uint8_t *optionCount)
@@ -812,11 +846,9 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
     }
 
     coap_opt_t *option = NULL;
-    char *optionResult = (char *)OICCalloc(1, CA_MAX_URI_LENGTH * sizeof(char));
-    if (NULL == optionResult)
-    {
-        goto exit;
-    }
+    char optionResult[CA_MAX_URI_LENGTH] = { 0 };
+    // every option is decoded into the same buffer, no option outlives the loop.
+    char buf[COAP_MAX_PDU_SIZE];
 
     uint32_t idx = 0;
     uint32_t optionLength = 0;
@@ -826,15 +858,9 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
 
     while ((option = coap_option_next(&opt_iter)))
     {
-        char *buf = (char *)OICCalloc(1, COAP_MAX_PDU_SIZE * sizeof(char));
-        if (NULL == buf)
-        {
-            goto exit;
-        }
-
         uint32_t bufLength =
             CAGetOptionData(opt_iter.type, (uint8_t *)(COAP_OPT_VALUE(option)),
-                    COAP_OPT_LENGTH(option), (uint8_t *)buf, COAP_MAX_PDU_SIZE);
+                    COAP_OPT_LENGTH(option), (uint8_t *)buf, sizeof(buf));
         if (bufLength)
         {
             OIC_LOG_V(DEBUG, TAG, "COAP URI element : %s", buf);
@@ -853,7 +879,6 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                     }
                     else
                     {
-                        OICFree(buf);
                         goto exit;
                     }
                 }
@@ -869,7 +894,6 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                         }
                         else
                         {
-                            OICFree(buf);
                             goto exit;
                         }
                     }
@@ -886,7 +910,6 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                             }
                             else
                             {
-                                OICFree(buf);
                                 goto exit;
                             }
                         }
@@ -900,7 +923,6 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                             }
                             else
                             {
-                                OICFree(buf);
                                 goto exit;
                             }
                         }
@@ -913,7 +935,6 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                     }
                     else
                     {
-                        OICFree(buf);
                         goto exit;
                     }
                 }
@@ -1021,7 +1042,6 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
                 }
             }
         }
-        OICFree(buf);
     } // while
 
     unsigned char* token = NULL;
@@ -1037,7 +1057,6 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
         {
             OIC_LOG(ERROR, TAG, "Out of memory");
             OICFree(outInfo->options);
-            OICFree(optionResult);
             return CA_MEMORY_ALLOC_FAILED;
         }
         memcpy(outInfo->token, token, token_length);
@@ -1058,7 +1077,6 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
             OIC_LOG(ERROR, TAG, "Out of memory");
             OICFree(outInfo->options);
             OICFree(outInfo->token);
-            OICFree(optionResult);
             return CA_MEMORY_ALLOC_FAILED;
         }
         memcpy(outInfo->payload, pdu->data, dataSize);
@@ -1075,7 +1093,6 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
             OIC_LOG(ERROR, TAG, "Out of memory");
             OICFree(outInfo->options);
             OICFree(outInfo->token);
-            OICFree(optionResult);
             return CA_MEMORY_ALLOC_FAILED;
         }
     }
@@ -1092,18 +1109,15 @@ CAResult_t CAGetInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endpoint,
             OIC_LOG(ERROR, TAG, "Out of memory");
             OICFree(outInfo->options);
             OICFree(outInfo->token);
-            OICFree(optionResult);
             return CA_MEMORY_ALLOC_FAILED;
         }
     }
-    OICFree(optionResult);
     OIC_LOG(INFO, TAG, "OUT - CAGetInfoFromPDU");
     return CA_STATUS_OK;
 
 exit:
     OIC_LOG(ERROR, TAG, "buffer too small");
     OICFree(outInfo->options);
-    OICFree(optionResult);
     return CA_STATUS_FAILED;
 }
 
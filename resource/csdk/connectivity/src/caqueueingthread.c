@@ -31,10 +31,28 @@
 
 #include "caqueueingthread.h"
 #include "oic_malloc.h"
+#include "ocatomic.h"
 #include "experimental/logger.h"
 
 #define TAG PCF("OIC_CA_QING")
 
+/** Messages taken from the queue per lock of threadMutex. **/
+#define CA_QUEUEING_THREAD_BATCH_SIZE 16
+
+static void CAQueueingThreadDestroyMessage(CAQueueingThread_t *thread, u_queue_message_t *message)
+{
+    if (NULL != thread->destroy)
+    {
+        thread->destroy(message->msg, message->size);
+    }
+    else
+    {
+        OICFree(message->msg);
+    }
+
+    OICFree(message);
+}
+
 static void CAQueueingThreadBaseRoutine(void *threadValue)
 {
     OIC_LOG(DEBUG, TAG, "message handler main thread start..");
@@ -47,20 +65,28 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
         return;
     }
 
+    u_queue_message_t *batch[CA_QUEUEING_THREAD_BATCH_SIZE];
+
     while (!thread->isStop)
     {
         // mutex lock
         oc_mutex_lock(thread->threadMutex);
 
-        // if queue is empty, thread will wait
-        if (!thread->isStop && u_queue_get_size(thread->dataQueue) <= 0)
+        // if queue is empty, thread will wait. Producers only signal while isWaiting
+        // is set, and they count their data before checking it.
+        if (!thread->isStop && 0 == u_mpsc_queue_get_size(thread->dataQueue))
         {
-            OIC_LOG(DEBUG, TAG, "wait..");
+            oc_atomic_increment(&thread->isWaiting);
+            if (0 == u_mpsc_queue_get_size(thread->dataQueue))
+            {
+                OIC_LOG(DEBUG, TAG, "wait..");
 
-            // wait
-            oc_cond_wait(thread->threadCond, thread->threadMutex);
+                // wait
+                oc_cond_wait(thread->threadCond, thread->threadMutex);
 
-            OIC_LOG(DEBUG, TAG, "wake up..");
+                OIC_LOG(DEBUG, TAG, "wake up..");
+            }
+            oc_atomic_decrement(&thread->isWaiting);
         }
 
         // check stop flag
@@ -71,29 +97,39 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
             continue;
         }
 
-        // get data
-        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
+        // get everything queued so far, up to the batch size
+        size_t count = 0;
+        while (count < CA_QUEUEING_THREAD_BATCH_SIZE)
+        {
+            u_queue_message_t *message = u_mpsc_queue_get_element(thread->dataQueue);
+            if (NULL == message)
+            {
+                break;
+            }
+            batch[count++] = message;
+        }
         // mutex unlock
         oc_mutex_unlock(thread->threadMutex);
-        if (NULL == message)
+
+        for (size_t i = 0; i < count; i++)
         {
-            continue;
+            // process data, unless the thread was stopped meanwhile
+            if (!thread->isStop)
+            {
+                thread->threadTask(batch[i]->msg);
+            }
         }
 
-        // process data
-        thread->threadTask(message->msg);
-
-        // free
-        if (NULL != thread->destroy)
+        if (thread->batchDone && count)
         {
-            thread->destroy(message->msg, message->size);
+            thread->batchDone();
         }
-        else
+
+        // free
+        for (size_t i = 0; i < count; i++)
         {
-            OICFree(message->msg);
+            CAQueueingThreadDestroyMessage(thread, batch[i]);
         }
-
-        OICFree(message);
     }
 
     oc_mutex_lock(thread->threadMutex);
@@ -122,12 +158,14 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
 
     // set send thread data
     thread->threadPool = handle;
-    thread->dataQueue = u_queue_create();
+    thread->dataQueue = u_mpsc_queue_create();
     thread->threadMutex = oc_mutex_new();
     thread->threadCond = oc_cond_new();
     thread->isStop = true;
+    thread->isWaiting = 0;
     thread->threadTask = task;
     thread->destroy = destroy;
+    thread->batchDone = NULL;
     if (NULL == thread->dataQueue || NULL == thread->threadMutex || NULL == thread->threadCond)
     {
         goto ERROR_MEM_FAILURE;
@@ -138,7 +176,7 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
 ERROR_MEM_FAILURE:
     if (thread->dataQueue)
     {
-        u_queue_delete(thread->dataQueue);
+        u_mpsc_queue_delete(thread->dataQueue);
         thread->dataQueue = NULL;
     }
     if (thread->threadMutex)
@@ -154,6 +192,19 @@ ERROR_MEM_FAILURE:
     return CA_MEMORY_ALLOC_FAILED;
 }
 
+CAResult_t CAQueueingThreadSetBatchDone(CAQueueingThread_t *thread,
+                                        CABatchDoneFunction batchDone)
+{
+    if (NULL == thread)
+    {
+        OIC_LOG(ERROR, TAG, "thread instance is empty..");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    thread->batchDone = batchDone;
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread)
 {
     if (NULL == thread)
@@ -209,29 +260,21 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
         return CA_STATUS_INVALID_PARAM;
     }
 
-    // create thread data
-    u_queue_message_t *message = (u_queue_message_t *) OICMalloc(sizeof(u_queue_message_t));
-
-    if (NULL == message)
+    // add thread data into queue
+    CAResult_t res = u_mpsc_queue_add_element(thread->dataQueue, data, size);
+    if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "memory error!!");
-        return CA_MEMORY_ALLOC_FAILED;
+        return res;
     }
 
-    message->msg = data;
-    message->size = size;
-
-    // mutex lock
-    oc_mutex_lock(thread->threadMutex);
-
-    // add thread data into list
-    u_queue_add_element(thread->dataQueue, message);
-
-    // notity the thread
-    oc_cond_signal(thread->threadCond);
-
-    // mutex unlock
-    oc_mutex_unlock(thread->threadMutex);
+    // notify the thread, only if it is waiting for data
+    if (oc_atomic_add(&thread->isWaiting, 0))
+    {
+        oc_mutex_lock(thread->threadMutex);
+        oc_cond_signal(thread->threadCond);
+        oc_mutex_unlock(thread->threadMutex);
+    }
 
     return CA_STATUS_OK;
 }
@@ -250,28 +293,13 @@ CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
     oc_mutex_lock(thread->threadMutex);
 
     // remove all remained list data.
-    while (u_queue_get_size(thread->dataQueue) > 0)
+    u_queue_message_t *message = NULL;
+    while (NULL != (message = u_mpsc_queue_get_element(thread->dataQueue)))
     {
-        // get data
-        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
-
-        // free
-        if (NULL != message)
-        {
-            if (NULL != thread->destroy)
-            {
-                thread->destroy(message->msg, message->size);
-            }
-            else
-            {
-                OICFree(message->msg);
-            }
-
-            OICFree(message);
-        }
+        CAQueueingThreadDestroyMessage(thread, message);
     }
 
-    u_queue_delete(thread->dataQueue);
+    u_mpsc_queue_delete(thread->dataQueue);
     thread->dataQueue = NULL;
 
     // mutex unlock
@@ -72,21 +72,26 @@
 #include "oic_time.h"
 #include "experimental/ocrandom.h"
 #include "experimental/logger.h"
+#include <coap/uthash.h>
 
 #define TAG "OIC_CA_RETRANS"
 
-typedef struct
+typedef struct CARetransmissionData
 {
     uint64_t timeStamp;                 /**< last sent time. microseconds */
 #ifndef SINGLE_THREAD
     uint64_t timeout;                   /**< timeout value. microseconds */
 #endif
+    uint64_t nextTime;                  /**< next retransmission time. microseconds */
+    size_t heapIndex;                   /**< position in dataList */
+    uint64_t key;                       /**< dataIndex key; transport type and message id */
     uint8_t triedCount;                 /**< retransmission count */
     uint16_t messageId;                 /**< coap PDU message id */
     CADataType_t dataType;              /**< data Type (Request/Response) */
     CAEndpoint_t *endpoint;             /**< remote endpoint */
     void *pdu;                          /**< coap PDU */
     uint32_t size;                      /**< coap PDU size */
+    UT_hash_handle hh;                  /**< handle in dataIndex */
 } CARetransmissionData_t;
 
 static const uint64_t USECS_PER_SEC = 1000000;
@@ -141,36 +146,128 @@ CAResult_t CARetransmissionStart(CARetransmission_t *context)
 #endif
 
 /**
- * @brief   check timeout routine
- * @param   currentTime     [IN]microseconds
+ * @brief   calculate the time the data is due for its next retransmission
  * @param   retData         [IN]retransmission data
- * @return  true if the timeout period has elapsed, false otherwise
+ * @return  microseconds
  */
-static bool CACheckTimeout(uint64_t currentTime, CARetransmissionData_t *retData)
+static uint64_t CAGetNextRetransmissionTime(const CARetransmissionData_t *retData)
 {
 #ifndef SINGLE_THREAD
-    // #1. calculate timeout
     uint64_t milliTimeoutValue = retData->timeout / USECS_PER_MSEC;
     uint64_t timeout = (milliTimeoutValue << retData->triedCount) * USECS_PER_MSEC;
+#else
+    uint64_t timeout = (2 << retData->triedCount) * (uint64_t) USECS_PER_SEC;
+#endif
+    return retData->timeStamp + timeout;
+}
+
+/**
+ * @brief   dataIndex key of a message
+ * @param   adapter         [IN]transport type
+ * @param   messageId       [IN]coap PDU message id
+ * @return  key
+ */
+static uint64_t CAGetRetransmissionKey(CATransportAdapter_t adapter, uint16_t messageId)
+{
+    return ((uint64_t) adapter << 16) | messageId;
+}
 
-    if (currentTime >= retData->timeStamp + timeout)
+static CARetransmissionData_t *CAHeapGet(const u_arraylist_t *list, size_t index)
+{
+    return (CARetransmissionData_t *) list->data[index];
+}
+
+static void CAHeapSwap(u_arraylist_t *list, size_t a, size_t b)
+{
+    void *tmp = list->data[a];
+    list->data[a] = list->data[b];
+    list->data[b] = tmp;
+    CAHeapGet(list, a)->heapIndex = a;
+    CAHeapGet(list, b)->heapIndex = b;
+}
+
+static void CAHeapSiftUp(u_arraylist_t *list, size_t index)
+{
+    while (index > 0)
     {
-        OIC_LOG_V(DEBUG, TAG, "%" PRIu64 " microseconds time out!!, tried count(%d)",
-                  timeout, retData->triedCount);
-        return true;
+        size_t parent = (index - 1) / 2;
+        if (CAHeapGet(list, parent)->nextTime <= CAHeapGet(list, index)->nextTime)
+        {
+            break;
+        }
+        CAHeapSwap(list, parent, index);
+        index = parent;
     }
-#else
-    // #1. calculate timeout
-    uint64_t timeOut = (2 << retData->triedCount) * (uint64_t) USECS_PER_SEC;
+}
 
-    if (currentTime >= retData->timeStamp + timeOut)
+static void CAHeapSiftDown(u_arraylist_t *list, size_t index)
+{
+    size_t len = u_arraylist_length(list);
+    for (;;)
     {
-        OIC_LOG_V(DEBUG, TAG, "timeout=%d, tried cnt=%d",
-                  (2 << retData->triedCount), retData->triedCount);
-        return true;
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+
+        if (left < len && CAHeapGet(list, left)->nextTime < CAHeapGet(list, smallest)->nextTime)
+        {
+            smallest = left;
+        }
+        if (right < len && CAHeapGet(list, right)->nextTime < CAHeapGet(list, smallest)->nextTime)
+        {
+            smallest = right;
+        }
+        if (smallest == index)
+        {
+            break;
+        }
+        CAHeapSwap(list, smallest, index);
+        index = smallest;
+    }
+}
+
+/**
+ * @brief   add the data to dataList and dataIndex. caller must hold threadMutex.
+ * @param   context         [IN]context for retransmission
+ * @param   retData         [IN]retransmission data
+ * @return  true on success
+ */
+static bool CAAddRetransmissionData(CARetransmission_t *context, CARetransmissionData_t *retData)
+{
+    if (!u_arraylist_add(context->dataList, (void *) retData))
+    {
+        return false;
+    }
+
+    retData->heapIndex = u_arraylist_length(context->dataList) - 1;
+    CAHeapSiftUp(context->dataList, retData->heapIndex);
+    HASH_ADD(hh, context->dataIndex, key, sizeof(retData->key), retData);
+    return true;
+}
+
+/**
+ * @brief   remove the data from dataList and dataIndex. caller must hold threadMutex.
+ * @param   context         [IN]context for retransmission
+ * @param   retData         [IN]retransmission data
+ */
+static void CARemoveRetransmissionData(CARetransmission_t *context,
+                                       CARetransmissionData_t *retData)
+{
+    HASH_DELETE(hh, context->dataIndex, retData);
+
+    size_t index = retData->heapIndex;
+    size_t last = u_arraylist_length(context->dataList) - 1;
+    if (index != last)
+    {
+        CAHeapSwap(context->dataList, index, last);
+    }
+    u_arraylist_remove(context->dataList, last);
+
+    if (index < last)
+    {
+        CAHeapSiftDown(context->dataList, index);
+        CAHeapSiftUp(context->dataList, index);
     }
-#endif
-    return false;
 }
 
 static void CACheckRetransmissionList(CARetransmission_t *context)
@@ -184,21 +281,20 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
     // mutex lock
     oc_mutex_lock(context->threadMutex);
 
-    size_t len = u_arraylist_length(context->dataList);
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
 
-    for (size_t i = 0; i < len; i++)
+    // only the head of dataList can be due; stop at the first one that is not.
+    while (0 < u_arraylist_length(context->dataList))
     {
-        CARetransmissionData_t *retData = u_arraylist_get(context->dataList, i);
+        CARetransmissionData_t *retData = CAHeapGet(context->dataList, 0);
 
-        if (NULL == retData)
+        if (retData->triedCount < context->config.tryingCount)
         {
-            continue;
-        }
-
-        uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+            if (currentTime < retData->nextTime)
+            {
+                break;
+            }
 
-        if (CACheckTimeout(currentTime, retData))
-        {
             // #2. if time's up, send the data.
             if (NULL != context->dataSendMethod)
             {
@@ -216,33 +312,27 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
         // #4. if tried count is max, remove the retransmission data from list.
         if (retData->triedCount >= context->config.tryingCount)
         {
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
-            {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
-                // mutex unlock
-                oc_mutex_unlock(context->threadMutex);
-                return;
-            }
+            CARemoveRetransmissionData(context, retData);
             OIC_LOG_V(DEBUG, TAG, "max trying count, remove RTCON data,"
-                      "msgid=%d", removedData->messageId);
+                      "msgid=%d", retData->messageId);
 
             // callback for retransmit timeout
             if (NULL != context->timeoutCallback)
             {
-                context->timeoutCallback(removedData->endpoint, removedData->pdu,
-                                         removedData->size);
+                context->timeoutCallback(retData->endpoint, retData->pdu,
+                                         retData->size);
             }
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
+            CAFreeEndpoint(retData->endpoint);
+            OICFree(retData->pdu);
 
-            OICFree(removedData);
-
-            // modify loop value.
-            len = u_arraylist_length(context->dataList);
-            --i;
+            OICFree(retData);
+            continue;
         }
+
+        // #5. reschedule.
+        retData->nextTime = CAGetNextRetransmissionTime(retData);
+        CAHeapSiftDown(context->dataList, 0);
     }
 
     // mutex unlock
@@ -288,13 +378,19 @@ void CARetransmissionBaseRoutine(void *threadValue)
         }
         else if (!context->isStop)
         {
-            // check each RETRANSMISSION_CHECK_PERIOD_SEC time.
-            OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds",
-                      RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC);
+            // sleep until the earliest retransmission is due.
+            uint64_t nextTime = CAHeapGet(context->dataList, 0)->nextTime;
+            uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
 
-            // wait
-            uint64_t absTime = RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC;
-            oc_cond_wait_for(context->threadCond, context->threadMutex, absTime );
+            if (nextTime > currentTime)
+            {
+                OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds",
+                          nextTime - currentTime);
+
+                // wait
+                oc_cond_wait_for(context->threadCond, context->threadMutex,
+                                 nextTime - currentTime);
+            }
         }
         else
         {
@@ -361,6 +457,7 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
     context->config = cfg;
     context->isStop = false;
     context->dataList = u_arraylist_create();
+    context->dataIndex = NULL;
 
     return CA_STATUS_OK;
 }
@@ -432,52 +529,55 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
 #endif
     retData->triedCount = 0;
     retData->messageId = messageId;
+    retData->key = CAGetRetransmissionKey(endpoint->adapter, messageId);
     retData->endpoint = remoteEndpoint;
     retData->pdu = pduData;
     retData->size = size;
     retData->dataType = dataType;
-#ifndef SINGLE_THREAD
+    retData->nextTime = (0 < context->config.tryingCount) ?
+                            CAGetNextRetransmissionTime(retData) : retData->timeStamp;
+
     // mutex lock
     oc_mutex_lock(context->threadMutex);
 
-    size_t len = u_arraylist_length(context->dataList);
-
     // #3. add data into list
-    for (size_t i = 0; i < len; i++)
+    CARetransmissionData_t *currData = NULL;
+    HASH_FIND(hh, context->dataIndex, &retData->key, sizeof(retData->key), currData);
+    if (NULL != currData)
     {
-        CARetransmissionData_t *currData = u_arraylist_get(context->dataList, i);
+        OIC_LOG(ERROR, TAG, "Duplicate message ID");
 
-        if (NULL == currData)
-        {
-            continue;
-        }
+        // mutex unlock
+        oc_mutex_unlock(context->threadMutex);
 
-        // found index
-        if (NULL != currData->endpoint && currData->messageId == messageId
-            && (currData->endpoint->adapter == endpoint->adapter))
-        {
-            OIC_LOG(ERROR, TAG, "Duplicate message ID");
+        OICFree(retData);
+        OICFree(pduData);
+        CAFreeEndpoint(remoteEndpoint);
+        return CA_STATUS_FAILED;
+    }
 
-            // mutex unlock
-            oc_mutex_unlock(context->threadMutex);
+    if (!CAAddRetransmissionData(context, retData))
+    {
+        OIC_LOG(ERROR, TAG, "memory error");
 
-            OICFree(retData);
-            OICFree(pduData);
-            OICFree(remoteEndpoint);
-            return CA_STATUS_FAILED;
-        }
-    }
+        // mutex unlock
+        oc_mutex_unlock(context->threadMutex);
 
-    u_arraylist_add(context->dataList, (void *) retData);
+        OICFree(retData);
+        OICFree(pduData);
+        CAFreeEndpoint(remoteEndpoint);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
 
+#ifndef SINGLE_THREAD
     // notify the thread
     oc_cond_signal(context->threadCond);
 
     // mutex unlock
     oc_mutex_unlock(context->threadMutex);
-
 #else
-    u_arraylist_add(context->dataList, (void *) retData);
+    // mutex unlock
+    oc_mutex_unlock(context->threadMutex);
 
     CACheckRetransmissionList(context);
 #endif
@@ -517,75 +617,55 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
         return CA_STATUS_OK;
     }
 
+    uint64_t key = CAGetRetransmissionKey(endpoint->adapter, messageId);
+
     // mutex lock
     oc_mutex_lock(context->threadMutex);
-    size_t len = u_arraylist_length(context->dataList);
 
-    for (size_t i = 0; i < len; i++)
-    {
-        CARetransmissionData_t *retData = (CARetransmissionData_t *) u_arraylist_get(
-                context->dataList, i);
+    CARetransmissionData_t *retData = NULL;
+    HASH_FIND(hh, context->dataIndex, &key, sizeof(key), retData);
 
-        if (NULL == retData)
+    // found index
+    if (NULL != retData)
+    {
+        // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
+        // if retransmission was finish..token will be unavailable.
+        if (CA_EMPTY == code)
         {
-            continue;
-        }
+            OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
 
-        // found index
-        if (NULL != retData->endpoint && retData->messageId == messageId
-            && (retData->endpoint->adapter == endpoint->adapter))
-        {
-            // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
-            // if retransmission was finish..token will be unavailable.
-            if (CA_EMPTY == CAGetCodeFromPduBinaryData(pdu, size))
+            if (NULL == retData->pdu)
             {
-                OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
-
-                if (NULL == retData->pdu)
-                {
-                    OIC_LOG(ERROR, TAG, "retData->pdu is null");
-                    OICFree(retData);
-                    // mutex unlock
-                    oc_mutex_unlock(context->threadMutex);
-
-                    return CA_STATUS_FAILED;
-                }
-
-                // copy PDU data
-                (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
-                if ((*retransmissionPdu) == NULL)
-                {
-                    OICFree(retData);
-                    OIC_LOG(ERROR, TAG, "memory error");
-
-                    // mutex unlock
-                    oc_mutex_unlock(context->threadMutex);
-
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy((*retransmissionPdu), retData->pdu, retData->size);
+                OIC_LOG(ERROR, TAG, "retData->pdu is null");
+
+                // mutex unlock
+                oc_mutex_unlock(context->threadMutex);
+
+                return CA_STATUS_FAILED;
             }
 
-            // #2. remove data from list
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
+            // copy PDU data
+            (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
+            if ((*retransmissionPdu) == NULL)
             {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
+                OIC_LOG(ERROR, TAG, "memory error");
 
                 // mutex unlock
                 oc_mutex_unlock(context->threadMutex);
 
-                return CA_STATUS_FAILED;
+                return CA_MEMORY_ALLOC_FAILED;
             }
+            memcpy((*retransmissionPdu), retData->pdu, retData->size);
+        }
 
-            OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
+        // #2. remove data from list
+        CARemoveRetransmissionData(context, retData);
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-            OICFree(removedData);
+        OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
 
-            break;
-        }
+        CAFreeEndpoint(retData->endpoint);
+        OICFree(retData->pdu);
+        OICFree(retData);
     }
 
     // mutex unlock
@@ -633,6 +713,7 @@ CAResult_t CARetransmissionDestroy(CARetransmission_t *context)
     OIC_LOG(DEBUG, TAG, "retransmission context destroy..");
 
     oc_mutex_lock(context->threadMutex);
+    HASH_CLEAR(hh, context->dataIndex);
     size_t len = u_arraylist_length(context->dataList);
     for (size_t i = 0; i < len; i++)
     {
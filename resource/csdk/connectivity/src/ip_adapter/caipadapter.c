@@ -145,6 +145,9 @@ CAResult_t CAIPInitializeQueueHandles()
         return CA_STATUS_FAILED;
     }
 
+    // Unicast datagrams of one batch go out together once it is processed.
+    CAQueueingThreadSetBatchDone(g_sendQueueHandle, CAIPFlushSendData);
+
     return CA_STATUS_OK;
 }
 
@@ -570,6 +573,7 @@ void CAIPSendDataThread(void *threadData)
     {
         //Processing for sending multicast
         OIC_LOG(DEBUG, TAG, "Send Multicast Data is called");
+        CAIPFlushSendData();
         CAIPSendData(ipData->remoteEndpoint, ipData->data, ipData->dataLen, true);
     }
     else
@@ -579,6 +583,8 @@ void CAIPSendDataThread(void *threadData)
         if (ipData->remoteEndpoint && ipData->remoteEndpoint->flags & CA_SECURE)
         {
             OIC_LOG(DEBUG, TAG, "DTLS encrypt called");
+            // Records are sent at once, keep them behind what is already queued.
+            CAIPFlushSendData();
             CAResult_t result = CAencryptSsl(ipData->remoteEndpoint, ipData->data, ipData->dataLen);
             if (CA_STATUS_OK != result)
             {
@@ -589,10 +595,10 @@ void CAIPSendDataThread(void *threadData)
         else
         {
             OIC_LOG(DEBUG, TAG, "Send Unicast Data is called");
-            CAIPSendData(ipData->remoteEndpoint, ipData->data, ipData->dataLen, false);
+            CAIPSendDataDeferred(ipData->remoteEndpoint, ipData->data, ipData->dataLen);
         }
 #else
-        CAIPSendData(ipData->remoteEndpoint, ipData->data, ipData->dataLen, false);
+        CAIPSendDataDeferred(ipData->remoteEndpoint, ipData->data, ipData->dataLen);
 #endif
     }
 }
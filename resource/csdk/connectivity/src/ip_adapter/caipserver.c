@@ -60,6 +60,13 @@
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
 #endif
+#if defined(WITH_EPOLL) && defined(HAVE_SYS_EPOLL_H)
+#define CA_IP_USE_EPOLL
+#include <sys/epoll.h>
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+#endif
 
 #include <coap/pdu.h>
 #include <inttypes.h>
@@ -90,6 +97,36 @@
 
 #define SELECT_TIMEOUT 1     // select() seconds (and termination latency)
 
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+/*
+ * Move datagrams with recvmmsg()/sendmmsg(), several per system call.
+ */
+#define CA_IP_USE_MMSG
+
+/*
+ * Maximum number of datagrams read by a single recvmmsg() call.
+ */
+#define CA_IP_RECV_BATCH 8
+
+/*
+ * Maximum number of datagrams written by a single sendmmsg() call.
+ */
+#define CA_IP_SEND_BATCH 16
+#endif
+
+#ifdef CA_IP_USE_EPOLL
+/*
+ * Maximum number of ready events fetched by a single epoll_wait() call.
+ * 8 data sockets + netlink + shutdown.
+ */
+#define EPOLL_MAX_EVENTS 10
+
+/*
+ * epoll instance used by the receive thread, or -1 when falling back to select().
+ */
+static int g_epollFd = -1;
+#endif
+
 #define IPv4_MULTICAST     "224.0.1.187"
 static struct in_addr IPv4MulticastAddress = { 0 };
 
@@ -153,9 +190,44 @@ static CAIPErrorHandleCallback g_ipErrorHandler = NULL;
 
 static CAIPPacketReceivedCallback g_packetReceivedCallback = NULL;
 
+/*
+ * Receive counters are only written by the receive thread, send counters by
+ * whichever thread sends.
+ */
+static CAIPBatchStats_t g_batchStats;
+
+#ifdef CA_IP_USE_MMSG
+/*
+ * Datagrams for one sendmmsg() call. The data is referenced, not copied.
+ */
+typedef struct
+{
+    CASocketFd_t fd;
+    size_t count;
+    struct mmsghdr msgs[CA_IP_SEND_BATCH];
+    struct iovec iovs[CA_IP_SEND_BATCH];
+    struct sockaddr_storage addrs[CA_IP_SEND_BATCH];
+    union
+    {
+        struct cmsghdr cmsg;
+        unsigned char data[CMSG_SPACE(sizeof (struct in6_pktinfo))];
+    } controls[CA_IP_SEND_BATCH];
+    const CAEndpoint_t *endpoints[CA_IP_SEND_BATCH];
+} CAIPSendBatch_t;
+
+/*
+ * Unicast datagrams deferred by CAIPSendDataDeferred(), only used by the send thread.
+ */
+static CAIPSendBatch_t g_unicastBatch = { .fd = OC_INVALID_SOCKET };
+#endif
+
 static void CAFindReadyMessage();
 #if !defined(WSA_WAIT_EVENT_0)
 static void CASelectReturned(fd_set *readFds, int ret);
+static void CAHandleNetlinkEvent();
+#ifdef CA_IP_USE_EPOLL
+static void CAEpollFindReadyMessage();
+#endif
 #else
 static void CAEventReturned(CASocketFd_t socket);
 #endif
@@ -167,9 +239,21 @@ static void CACloseFDs()
 #if !defined(WSA_WAIT_EVENT_0)
     if (caglobals.ip.shutdownFds[0] != -1)
     {
+        if (caglobals.ip.shutdownFds[1] == caglobals.ip.shutdownFds[0])
+        {
+            // eventfd: one descriptor serves as both ends
+            caglobals.ip.shutdownFds[1] = -1;
+        }
         close(caglobals.ip.shutdownFds[0]);
         caglobals.ip.shutdownFds[0] = -1;
     }
+#ifdef CA_IP_USE_EPOLL
+    if (g_epollFd != -1)
+    {
+        close(g_epollFd);
+        g_epollFd = -1;
+    }
+#endif
 #endif
     CADeInitializeIPGlobals();
 }
@@ -210,6 +294,14 @@ static void CAReceiveHandler(void *data)
 
 static void CAFindReadyMessage()
 {
+#ifdef CA_IP_USE_EPOLL
+    if (g_epollFd != -1)
+    {
+        CAEpollFindReadyMessage();
+        return;
+    }
+#endif
+
     fd_set readFds;
     struct timeval timeout;
 
@@ -277,23 +369,7 @@ static void CASelectReturned(fd_set *readFds, int ret)
         else ISSET(m4s, readFds, CA_MULTICAST | CA_IPV4 | CA_SECURE)
         else if ((caglobals.ip.netlinkFd != OC_INVALID_SOCKET) && FD_ISSET(caglobals.ip.netlinkFd, readFds))
         {
-#if NETWORK_INTERFACE_CHANGED_LOGGING
-            OIC_LOG_V(DEBUG, TAG, "Netlink event detected");
-#endif
-            u_arraylist_t *iflist = CAFindInterfaceChange();
-            if (iflist)
-            {
-                size_t listLength = u_arraylist_length(iflist);
-                for (size_t i = 0; i < listLength; i++)
-                {
-                    CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
-                    if (ifitem)
-                    {
-                        CAProcessNewInterface(ifitem);
-                    }
-                }
-                u_arraylist_destroy(iflist);
-            }
+            CAHandleNetlinkEvent();
             break;
         }
         else if (FD_ISSET(caglobals.ip.shutdownFds[0], readFds))
@@ -315,6 +391,139 @@ static void CASelectReturned(fd_set *readFds, int ret)
     }
 }
 
+static void CAHandleNetlinkEvent()
+{
+#if NETWORK_INTERFACE_CHANGED_LOGGING
+    OIC_LOG_V(DEBUG, TAG, "Netlink event detected");
+#endif
+    u_arraylist_t *iflist = CAFindInterfaceChange();
+    if (iflist)
+    {
+        size_t listLength = u_arraylist_length(iflist);
+        for (size_t i = 0; i < listLength; i++)
+        {
+            CAInterface_t *ifitem = (CAInterface_t *)u_arraylist_get(iflist, i);
+            if (ifitem)
+            {
+                CAProcessNewInterface(ifitem);
+            }
+        }
+        u_arraylist_destroy(iflist);
+    }
+}
+
+#ifdef CA_IP_USE_EPOLL
+
+/*
+ * The epoll user data holds the socket in the low 32 bits and its transport
+ * flags in the high 32 bits, so a ready event is dispatched without scanning
+ * the socket table.
+ */
+#define EPOLL_DATA(FD, FLAGS)   (((uint64_t)(uint32_t)(FLAGS) << 32) | (uint32_t)(FD))
+#define EPOLL_DATA_FD(DATA)     ((CASocketFd_t)(uint32_t)((DATA) & 0xFFFFFFFF))
+#define EPOLL_DATA_FLAGS(DATA)  ((CATransportFlags_t)((DATA) >> 32))
+
+static bool CAEpollAdd(CASocketFd_t fd, CATransportFlags_t flags, uint32_t events)
+{
+    if (OC_INVALID_SOCKET == fd)
+    {
+        return true;
+    }
+
+    struct epoll_event ev = { .events = events, .data.u64 = EPOLL_DATA(fd, flags) };
+    if (-1 == epoll_ctl(g_epollFd, EPOLL_CTL_ADD, fd, &ev))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl(%d) failed: %s", fd, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+// Data sockets are edge-triggered and drained by CAEpollFindReadyMessage().
+#define EPOLL_ADD(TYPE, FLAGS) \
+    CAEpollAdd(caglobals.ip.TYPE.fd, (FLAGS), EPOLLIN | EPOLLET)
+
+static void CAInitializeEpoll()
+{
+    OIC_LOG_V(DEBUG, TAG, "IN %s", __func__);
+
+    g_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == g_epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed: %s (using select)", strerror(errno));
+        return;
+    }
+
+    bool ok = EPOLL_ADD(u6,  CA_IPV6)
+           && EPOLL_ADD(u6s, CA_IPV6 | CA_SECURE)
+           && EPOLL_ADD(u4,  CA_IPV4)
+           && EPOLL_ADD(u4s, CA_IPV4 | CA_SECURE)
+           && EPOLL_ADD(m6,  CA_MULTICAST | CA_IPV6)
+           && EPOLL_ADD(m6s, CA_MULTICAST | CA_IPV6 | CA_SECURE)
+           && EPOLL_ADD(m4,  CA_MULTICAST | CA_IPV4)
+           && EPOLL_ADD(m4s, CA_MULTICAST | CA_IPV4 | CA_SECURE)
+           // netlink and shutdown handlers consume one event per wakeup: level-triggered
+           && CAEpollAdd(caglobals.ip.netlinkFd, CA_DEFAULT_FLAGS, EPOLLIN)
+           && CAEpollAdd(caglobals.ip.shutdownFds[0], CA_DEFAULT_FLAGS, EPOLLIN);
+
+    if (!ok)
+    {
+        close(g_epollFd);
+        g_epollFd = -1;
+        OIC_LOG(ERROR, TAG, "epoll registration failed (using select)");
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "OUT %s", __func__);
+}
+
+static void CAEpollFindReadyMessage()
+{
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    int timeout = (caglobals.ip.selectTimeout == -1) ? -1 : caglobals.ip.selectTimeout * 1000;
+
+    int ret = epoll_wait(g_epollFd, events, EPOLL_MAX_EVENTS, timeout);
+
+    if (caglobals.ip.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+
+    if (0 > ret)
+    {
+        if (EINTR != errno)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", CAIPS_GET_ERROR);
+        }
+        return;
+    }
+
+    for (int i = 0; (i < ret) && !caglobals.ip.terminate; i++)
+    {
+        CASocketFd_t fd = EPOLL_DATA_FD(events[i].data.u64);
+
+        if (fd == caglobals.ip.shutdownFds[0])
+        {
+            char buf[10] = {0};
+            (void)read(caglobals.ip.shutdownFds[0], buf, sizeof (buf));
+        }
+        else if (fd == caglobals.ip.netlinkFd)
+        {
+            CAHandleNetlinkEvent();
+        }
+        else
+        {
+            // Edge-triggered: keep reading until the socket would block.
+            CATransportFlags_t flags = EPOLL_DATA_FLAGS(events[i].data.u64);
+            while (!caglobals.ip.terminate && (CA_RECEIVE_FAILED != CAReceiveMessage(fd, flags)))
+            {
+            }
+        }
+    }
+}
+
+#endif // CA_IP_USE_EPOLL
+
 #else // if defined(WSA_WAIT_EVENT_0)
 
 #define PUSH_HANDLE(HANDLE, ARRAY, INDEX) \
@@ -559,9 +768,149 @@ void CADeInitializeIPGlobals()
     CAUnregisterForAddressChanges();
 }
 
+static void CAHandleReceivedMessage(CATransportFlags_t flags, char *recvBuffer, size_t recvLen,
+                                    struct sockaddr_storage *srcAddr, int namelen,
+                                    unsigned char *pktinfo)
+{
+    CASecureEndpoint_t sep = {.endpoint = {.adapter = CA_ADAPTER_IP, .flags = flags}};
+
+    if (flags & CA_IPV6)
+    {
+        sep.endpoint.ifindex = ((struct in6_pktinfo *)pktinfo)->ipi6_ifindex;
+
+        if (flags & CA_MULTICAST)
+        {
+            struct in6_addr *addr = &(((struct in6_pktinfo *)pktinfo)->ipi6_addr);
+            unsigned char topbits = ((unsigned char *)addr)[0];
+            if (topbits != 0xff)
+            {
+                sep.endpoint.flags &= ~CA_MULTICAST;
+            }
+        }
+    }
+    else
+    {
+        sep.endpoint.ifindex = ((struct in_pktinfo *)pktinfo)->ipi_ifindex;
+
+        if (flags & CA_MULTICAST)
+        {
+            struct in_addr *addr = &((struct in_pktinfo *)pktinfo)->ipi_addr;
+            uint32_t host = ntohl(addr->s_addr);
+            unsigned char topbits = ((unsigned char *)&host)[3];
+            if (topbits < 224 || topbits > 239)
+            {
+                sep.endpoint.flags &= ~CA_MULTICAST;
+            }
+        }
+    }
+
+    CAConvertAddrToName(srcAddr, namelen, sep.endpoint.addr, &sep.endpoint.port);
+
+    if (flags & CA_SECURE)
+    {
+#ifdef __WITH_DTLS__
+#ifdef TB_LOG
+        int decryptResult =
+#endif
+        CAdecryptSsl(&sep, (uint8_t *)recvBuffer, (size_t)recvLen);
+        OIC_LOG_V(DEBUG, TAG, "CAdecryptSsl returns [%d]", decryptResult);
+#else
+        OIC_LOG(ERROR, TAG, "Encrypted message but no DTLS");
+#endif // __WITH_DTLS__
+    }
+    else
+    {
+        if (g_packetReceivedCallback)
+        {
+            g_packetReceivedCallback(&sep, recvBuffer, (size_t)recvLen);
+        }
+    }
+}
+
+#ifdef CA_IP_USE_MMSG
+static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
+{
+    // Only the receive thread reads, so one set of buffers is enough. Not
+    // zero-filled: only the first msg_len bytes of each are ever read.
+    static char recvBuffers[CA_IP_RECV_BATCH][RECV_MSG_BUF_LEN];
+    struct sockaddr_storage srcAddrs[CA_IP_RECV_BATCH];
+    struct iovec iovs[CA_IP_RECV_BATCH];
+    struct mmsghdr msgs[CA_IP_RECV_BATCH];
+    union control
+    {
+        struct cmsghdr cmsg;
+        unsigned char data[CMSG_SPACE(sizeof (struct in6_pktinfo))];
+    } cmsgs[CA_IP_RECV_BATCH];
+
+    int namelen = sizeof (struct sockaddr_in);
+    int level = IPPROTO_IP;
+    int type = IP_PKTINFO;
+    if (flags & CA_IPV6)
+    {
+        namelen = sizeof (struct sockaddr_in6);
+        level = IPPROTO_IPV6;
+        type = IPV6_PKTINFO;
+    }
+
+    for (size_t i = 0; i < CA_IP_RECV_BATCH; i++)
+    {
+        iovs[i].iov_base = recvBuffers[i];
+        iovs[i].iov_len = sizeof (recvBuffers[i]);
+        msgs[i].msg_hdr = (struct msghdr) { .msg_name = &srcAddrs[i],
+                                            .msg_namelen = namelen,
+                                            .msg_iov = &iovs[i],
+                                            .msg_iovlen = 1,
+                                            .msg_control = &cmsgs[i],
+                                            .msg_controllen = CMSG_SPACE(sizeof (struct in6_pktinfo)) };
+        msgs[i].msg_len = 0;
+    }
+
+    // Never block: the epoll receive loop drains each socket until EAGAIN.
+    int count = recvmmsg(fd, msgs, CA_IP_RECV_BATCH, MSG_DONTWAIT, NULL);
+    if (0 >= count)
+    {
+        if ((0 > count) && (EAGAIN != errno) && (EWOULDBLOCK != errno))
+        {
+            OIC_LOG_V(ERROR, TAG, "recvmmsg failed %s", strerror(errno));
+        }
+        return CA_RECEIVE_FAILED;
+    }
+
+    g_batchStats.recvCalls++;
+    g_batchStats.recvDatagrams += (uint64_t)count;
+    if ((uint32_t)count > g_batchStats.recvMaxBatch)
+    {
+        g_batchStats.recvMaxBatch = (uint32_t)count;
+    }
+
+    for (int i = 0; (i < count) && !caglobals.ip.terminate; i++)
+    {
+        unsigned char *pktinfo = NULL;
+        for (struct cmsghdr *cmp = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmp != NULL;
+             cmp = CMSG_NXTHDR(&msgs[i].msg_hdr, cmp))
+        {
+            if (cmp->cmsg_level == level && cmp->cmsg_type == type)
+            {
+                pktinfo = CMSG_DATA(cmp);
+            }
+        }
+        if (!pktinfo)
+        {
+            OIC_LOG(ERROR, TAG, "pktinfo is null");
+            continue;
+        }
+
+        CAHandleReceivedMessage(flags, recvBuffers[i], msgs[i].msg_len,
+                                &srcAddrs[i], namelen, pktinfo);
+    }
+
+    return CA_STATUS_OK;
+}
+#else
 static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
 {
-    char recvBuffer[RECV_MSG_BUF_LEN] = {0};
+    // Not zero-filled: only the first recvLen bytes are ever read.
+    char recvBuffer[RECV_MSG_BUF_LEN];
     int level = 0;
     int type = 0;
     int namelen = 0;
@@ -599,11 +948,15 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
                           .msg_control = &cmsg,
                           .msg_controllen = CMSG_SPACE(len) };
 
-    ssize_t recvLen = recvmsg(fd, &msg, flags);
+    // Never block: the epoll receive loop drains each socket until EAGAIN.
+    ssize_t recvLen = recvmsg(fd, &msg, MSG_DONTWAIT);
     if (OC_SOCKET_ERROR == recvLen)
     {
-        OIC_LOG_V(ERROR, TAG, "Recvfrom failed %s", strerror(errno));
-        return CA_STATUS_FAILED;
+        if ((EAGAIN != errno) && (EWOULDBLOCK != errno))
+        {
+            OIC_LOG_V(ERROR, TAG, "Recvfrom failed %s", strerror(errno));
+        }
+        return CA_RECEIVE_FAILED;
     }
 
     for (cmp = CMSG_FIRSTHDR(&msg); cmp != NULL; cmp = CMSG_NXTHDR(&msg, cmp))
@@ -667,62 +1020,10 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
         return CA_STATUS_FAILED;
     }
 
-    CASecureEndpoint_t sep = {.endpoint = {.adapter = CA_ADAPTER_IP, .flags = flags}};
-
-    if (flags & CA_IPV6)
-    {
-        sep.endpoint.ifindex = ((struct in6_pktinfo *)pktinfo)->ipi6_ifindex;
-
-        if (flags & CA_MULTICAST)
-        {
-            struct in6_addr *addr = &(((struct in6_pktinfo *)pktinfo)->ipi6_addr);
-            unsigned char topbits = ((unsigned char *)addr)[0];
-            if (topbits != 0xff)
-            {
-                sep.endpoint.flags &= ~CA_MULTICAST;
-            }
-        }
-    }
-    else
-    {
-        sep.endpoint.ifindex = ((struct in_pktinfo *)pktinfo)->ipi_ifindex;
-
-        if (flags & CA_MULTICAST)
-        {
-            struct in_addr *addr = &((struct in_pktinfo *)pktinfo)->ipi_addr;
-            uint32_t host = ntohl(addr->s_addr);
-            unsigned char topbits = ((unsigned char *)&host)[3];
-            if (topbits < 224 || topbits > 239)
-            {
-                sep.endpoint.flags &= ~CA_MULTICAST;
-            }
-        }
-    }
-
-    CAConvertAddrToName(&srcAddr, namelen, sep.endpoint.addr, &sep.endpoint.port);
-
-    if (flags & CA_SECURE)
-    {
-#ifdef __WITH_DTLS__
-#ifdef TB_LOG
-        int decryptResult =
-#endif
-        CAdecryptSsl(&sep, (uint8_t *)recvBuffer, recvLen);
-        OIC_LOG_V(DEBUG, TAG, "CAdecryptSsl returns [%d]", decryptResult);
-#else
-        OIC_LOG(ERROR, TAG, "Encrypted message but no DTLS");
-#endif // __WITH_DTLS__
-    }
-    else
-    {
-        if (g_packetReceivedCallback)
-        {
-            g_packetReceivedCallback(&sep, recvBuffer, recvLen);
-        }
-    }
-
+    CAHandleReceivedMessage(flags, recvBuffer, (size_t)recvLen, &srcAddr, namelen, pktinfo);
     return CA_STATUS_OK;
 }
+#endif // CA_IP_USE_MMSG
 
 void CAIPPullData()
 {
@@ -897,6 +1198,16 @@ static void CAInitializeFastShutdownMechanism()
     {
         ret = 0;
     }
+#elif defined(CA_IP_USE_EPOLL) && defined(HAVE_SYS_EVENTFD_H)
+    // a single eventfd serves as both ends of the wakeup channel
+    ret = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (-1 != ret)
+    {
+        caglobals.ip.shutdownFds[0] = ret;
+        caglobals.ip.shutdownFds[1] = ret;
+        CHECKFD(caglobals.ip.shutdownFds[0]);
+        ret = 0;
+    }
 #elif defined(HAVE_PIPE2)
     ret = pipe2(caglobals.ip.shutdownFds, O_CLOEXEC);
     CHECKFD(caglobals.ip.shutdownFds[0]);
@@ -1007,6 +1318,11 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
     // create source of network address change notifications
     CARegisterForAddressChanges();
 
+#ifdef CA_IP_USE_EPOLL
+    // register all sockets with epoll; on failure the receive thread uses select()
+    CAInitializeEpoll();
+#endif
+
     caglobals.ip.selectTimeout = CAGetPollingInterval(caglobals.ip.selectTimeout);
 
     res = CAIPStartListenServer();
@@ -1036,7 +1352,15 @@ void CAIPStopServer()
 #if !defined(WSA_WAIT_EVENT_0)
     if (caglobals.ip.shutdownFds[1] != -1)
     {
-        close(caglobals.ip.shutdownFds[1]);
+        if (caglobals.ip.shutdownFds[1] == caglobals.ip.shutdownFds[0])
+        {
+            // eventfd is not closed here; the receive thread owns it
+            CAWakeUpForChange();
+        }
+        else
+        {
+            close(caglobals.ip.shutdownFds[1]);
+        }
         caglobals.ip.shutdownFds[1] = -1;
         // receive thread will stop immediately
     }
@@ -1067,7 +1391,15 @@ void CAWakeUpForChange()
         ssize_t len = 0;
         do
         {
-            len = write(caglobals.ip.shutdownFds[1], "w", 1);
+            if (caglobals.ip.shutdownFds[1] == caglobals.ip.shutdownFds[0])
+            {
+                uint64_t one = 1; // eventfd counter increment
+                len = write(caglobals.ip.shutdownFds[1], &one, sizeof (one));
+            }
+            else
+            {
+                len = write(caglobals.ip.shutdownFds[1], "w", 1);
+            }
         } while ((len == -1) && (errno == EINTR));
         if ((len == -1) && (errno != EINTR) && (errno != EPIPE))
         {
@@ -1402,6 +1734,121 @@ static void sendData(CASocketFd_t fd, const CAEndpoint_t *endpoint,
 #endif
 }
 
+#ifdef CA_IP_USE_MMSG
+static void CAIPSendBatch(CAIPSendBatch_t *batch, const char *cast)
+{
+    (void)cast;  // eliminates release warning
+
+    size_t sent = 0;
+    while (sent < batch->count)
+    {
+        int ret = sendmmsg(batch->fd, &batch->msgs[sent], (unsigned int)(batch->count - sent), 0);
+        if (OC_SOCKET_ERROR == ret)
+        {
+            int err = errno;
+            if (EINTR == err)
+            {
+                continue;
+            }
+            // Only the first datagram is known to have failed, go on with the rest.
+            const CAEndpoint_t *endpoint = batch->endpoints[sent];
+            if (g_ipErrorHandler)
+            {
+                g_ipErrorHandler(endpoint, batch->iovs[sent].iov_base,
+                                 batch->iovs[sent].iov_len, CA_SEND_FAILED);
+            }
+            OIC_LOG_V(ERROR, TAG, "%s sendmmsg failed: %s", cast, strerror(err));
+            CALogSendStateInfo(endpoint->adapter, endpoint->addr, endpoint->port,
+                               OC_SOCKET_ERROR, false, strerror(err));
+            sent++;
+            continue;
+        }
+        if (0 == ret)
+        {
+            break;
+        }
+
+        g_batchStats.sendCalls++;
+        g_batchStats.sendDatagrams += (uint64_t)ret;
+        if ((uint32_t)ret > g_batchStats.sendMaxBatch)
+        {
+            g_batchStats.sendMaxBatch = (uint32_t)ret;
+        }
+
+        for (size_t i = sent; i < sent + (size_t)ret; i++)
+        {
+            const CAEndpoint_t *endpoint = batch->endpoints[i];
+            OIC_LOG_V(INFO, TAG, "%s sendmmsg is successful: %u bytes", cast, batch->msgs[i].msg_len);
+            CALogSendStateInfo(endpoint->adapter, endpoint->addr, endpoint->port,
+                               batch->msgs[i].msg_len, true, NULL);
+        }
+        sent += (size_t)ret;
+    }
+    batch->count = 0;
+}
+
+/*
+ * Adds a datagram to batch, sending what is batched first if it is full or for
+ * another socket. A non-zero ifindex selects the outgoing interface.
+ */
+static void CAIPAddToBatch(CAIPSendBatch_t *batch, CASocketFd_t fd,
+                           const CAEndpoint_t *endpoint, const void *data, size_t dlen,
+                           uint32_t ifindex, const char *cast)
+{
+    if (batch->count && ((batch->fd != fd) || (CA_IP_SEND_BATCH == batch->count)))
+    {
+        CAIPSendBatch(batch, cast);
+    }
+
+    size_t i = batch->count++;
+    batch->fd = fd;
+    batch->endpoints[i] = endpoint;
+
+    struct sockaddr_storage *sock = &batch->addrs[i];
+    memset(sock, 0, sizeof (*sock));
+    CAConvertNameToAddr(endpoint->addr, endpoint->port, sock);
+
+    batch->iovs[i].iov_base = (void *)data;
+    batch->iovs[i].iov_len = dlen;
+
+    struct msghdr *msg = &batch->msgs[i].msg_hdr;
+    *msg = (struct msghdr) { .msg_name = sock,
+                             .msg_namelen = (AF_INET6 == sock->ss_family) ?
+                                            sizeof (struct sockaddr_in6) :
+                                            sizeof (struct sockaddr_in),
+                             .msg_iov = &batch->iovs[i],
+                             .msg_iovlen = 1 };
+    batch->msgs[i].msg_len = 0;
+
+    if (!ifindex)
+    {
+        return;
+    }
+
+    msg->msg_control = &batch->controls[i];
+    if (AF_INET6 == sock->ss_family)
+    {
+        struct in6_pktinfo info = { .ipi6_ifindex = ifindex };
+        msg->msg_controllen = CMSG_SPACE(sizeof (info));
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+        cmsg->cmsg_level = IPPROTO_IPV6;
+        cmsg->cmsg_type = IPV6_PKTINFO;
+        cmsg->cmsg_len = CMSG_LEN(sizeof (info));
+        memcpy(CMSG_DATA(cmsg), &info, sizeof (info));
+    }
+    else
+    {
+        struct in_pktinfo info = { .ipi_ifindex = (int)ifindex };
+        msg->msg_controllen = CMSG_SPACE(sizeof (info));
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+        cmsg->cmsg_level = IPPROTO_IP;
+        cmsg->cmsg_type = IP_PKTINFO;
+        cmsg->cmsg_len = CMSG_LEN(sizeof (info));
+        memcpy(CMSG_DATA(cmsg), &info, sizeof (info));
+    }
+}
+#endif // CA_IP_USE_MMSG
+
 static void sendMulticastData6(const u_arraylist_t *iflist,
                                CAEndpoint_t *endpoint,
                                const void *data, size_t datalen)
@@ -1421,6 +1868,10 @@ static void sendMulticastData6(const u_arraylist_t *iflist,
     }
     OICStrcpy(endpoint->addr, sizeof(endpoint->addr), ipv6mcname);
     CASocketFd_t fd = caglobals.ip.u6.fd;
+#ifdef CA_IP_USE_MMSG
+    // One datagram per interface, picked by IPV6_PKTINFO instead of IPV6_MULTICAST_IF.
+    CAIPSendBatch_t batch = { .fd = fd };
+#endif
 
     size_t len = u_arraylist_length(iflist);
     for (size_t i = 0; i < len; i++)
@@ -1439,6 +1890,9 @@ static void sendMulticastData6(const u_arraylist_t *iflist,
             continue;
         }
 
+#ifdef CA_IP_USE_MMSG
+        CAIPAddToBatch(&batch, fd, endpoint, data, datalen, ifitem->index, "multicast");
+#else
         int index = ifitem->index;
         if (setsockopt(fd, IPPROTO_IPV6, IPV6_MULTICAST_IF, OPTVAL_T(&index), sizeof (index)))
         {
@@ -1446,7 +1900,11 @@ static void sendMulticastData6(const u_arraylist_t *iflist,
             return;
         }
         sendData(fd, endpoint, data, datalen, "multicast", "ipv6");
+#endif
     }
+#ifdef CA_IP_USE_MMSG
+    CAIPSendBatch(&batch, "multicast");
+#endif
 }
 
 static void sendMulticastData4(const u_arraylist_t *iflist,
@@ -1455,7 +1913,10 @@ static void sendMulticastData4(const u_arraylist_t *iflist,
 {
     VERIFY_NON_NULL_VOID(endpoint, TAG, "endpoint is NULL");
 
-#if defined(USE_IP_MREQN)
+#if defined(CA_IP_USE_MMSG)
+    // One datagram per interface, picked by IP_PKTINFO instead of IP_MULTICAST_IF.
+    CAIPSendBatch_t batch = { .fd = caglobals.ip.u4.fd };
+#elif defined(USE_IP_MREQN)
     struct ip_mreqn mreq = { .imr_multiaddr = IPv4MulticastAddress,
                              .imr_address.s_addr = htonl(INADDR_ANY),
                              .imr_ifindex = 0};
@@ -1483,6 +1944,9 @@ static void sendMulticastData4(const u_arraylist_t *iflist,
         {
             continue;
         }
+#if defined(CA_IP_USE_MMSG)
+        CAIPAddToBatch(&batch, fd, endpoint, data, datalen, ifitem->index, "multicast");
+#else
 #if defined(USE_IP_MREQN)
         mreq.imr_ifindex = ifitem->index;
 #else
@@ -1494,7 +1958,24 @@ static void sendMulticastData4(const u_arraylist_t *iflist,
                     CAIPS_GET_ERROR);
         }
         sendData(fd, endpoint, data, datalen, "multicast", "ipv4");
+#endif // CA_IP_USE_MMSG
+    }
+#if defined(CA_IP_USE_MMSG)
+    CAIPSendBatch(&batch, "multicast");
+#endif
+}
+
+static CASocketFd_t CAIPUnicastFd(bool isSecure, bool isIPv6)
+{
+#ifdef __WITH_DTLS__
+    if (isSecure)
+    {
+        return isIPv6 ? caglobals.ip.u6s.fd : caglobals.ip.u4s.fd;
     }
+#else
+    (void)isSecure;
+#endif
+    return isIPv6 ? caglobals.ip.u6.fd : caglobals.ip.u4.fd;
 }
 
 void CAIPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen,
@@ -1534,26 +2015,65 @@ void CAIPSendData(CAEndpoint_t *endpoint, const void *data, size_t datalen,
             endpoint->port = isSecure ? CA_SECURE_COAP : CA_COAP;
         }
 
-        CASocketFd_t fd;
         if (caglobals.ip.ipv6enabled && (endpoint->flags & CA_IPV6))
         {
-            fd = isSecure ? caglobals.ip.u6s.fd : caglobals.ip.u6.fd;
-#ifndef __WITH_DTLS__
-            fd = caglobals.ip.u6.fd;
-#endif
-            sendData(fd, endpoint, data, datalen, "unicast", "ipv6");
+            sendData(CAIPUnicastFd(isSecure, true), endpoint, data, datalen, "unicast", "ipv6");
         }
         if (caglobals.ip.ipv4enabled && (endpoint->flags & CA_IPV4))
         {
-            fd = isSecure ? caglobals.ip.u4s.fd : caglobals.ip.u4.fd;
-#ifndef __WITH_DTLS__
-            fd = caglobals.ip.u4.fd;
-#endif
-            sendData(fd, endpoint, data, datalen, "unicast", "ipv4");
+            sendData(CAIPUnicastFd(isSecure, false), endpoint, data, datalen, "unicast", "ipv4");
         }
     }
 }
 
+void CAIPSendDataDeferred(CAEndpoint_t *endpoint, const void *data, size_t datalen)
+{
+#ifdef CA_IP_USE_MMSG
+    VERIFY_NON_NULL_VOID(endpoint, TAG, "endpoint is NULL");
+    VERIFY_NON_NULL_VOID(data, TAG, "data is NULL");
+
+    bool isSecure = (endpoint->flags & CA_SECURE) != 0;
+    if (!endpoint->port)    // unicast discovery
+    {
+        endpoint->port = isSecure ? CA_SECURE_COAP : CA_COAP;
+    }
+
+    if (caglobals.ip.ipv6enabled && (endpoint->flags & CA_IPV6))
+    {
+        CAIPAddToBatch(&g_unicastBatch, CAIPUnicastFd(isSecure, true), endpoint,
+                       data, datalen, 0, "unicast");
+    }
+    if (caglobals.ip.ipv4enabled && (endpoint->flags & CA_IPV4))
+    {
+        CAIPAddToBatch(&g_unicastBatch, CAIPUnicastFd(isSecure, false), endpoint,
+                       data, datalen, 0, "unicast");
+    }
+#else
+    CAIPSendData(endpoint, data, datalen, false);
+#endif
+}
+
+void CAIPFlushSendData()
+{
+#ifdef CA_IP_USE_MMSG
+    if (g_unicastBatch.count)
+    {
+        CAIPSendBatch(&g_unicastBatch, "unicast");
+    }
+#endif
+}
+
+void CAIPGetBatchStats(CAIPBatchStats_t *stats)
+{
+    VERIFY_NON_NULL_VOID(stats, TAG, "stats is NULL");
+    *stats = g_batchStats;
+}
+
+void CAIPResetBatchStats()
+{
+    memset(&g_batchStats, 0, sizeof (g_batchStats));
+}
+
 CAResult_t CAGetIPInterfaceInformation(CAEndpoint_t **info, size_t *size)
 {
     VERIFY_NON_NULL(info, TAG, "info is NULL");
@@ -57,6 +57,11 @@
 #include <netdb.h>
 #endif
 
+#if defined(WITH_EPOLL) && defined(HAVE_SYS_EPOLL_H)
+#define CA_TCP_USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #include "catcpinterface.h"
 #include "caipnwmonitor.h"
 #include "caadapterutils.h"
@@ -118,6 +123,28 @@ static CATCPConnectionHandleCallback g_connectionCallback = NULL;
  */
 static CATCPSessionInfo_t *g_sessionList = NULL;
 
+/**
+ * Index of g_sessionList by socket descriptor.
+ */
+static CATCPSessionInfo_t *g_sessionFdIndex = NULL;
+
+/**
+ * Index of g_sessionList by remote address and port.
+ */
+static CATCPSessionInfo_t *g_sessionEpIndex = NULL;
+
+#ifdef CA_TCP_USE_EPOLL
+/**
+ * Maximum number of ready events fetched by a single epoll_wait() call.
+ */
+#define EPOLL_MAX_EVENTS 64
+
+/**
+ * epoll instance used by the receive thread, or -1 when using select().
+ */
+static int g_epollFd = -1;
+#endif
+
 static CAResult_t CATCPCreateMutex(void);
 static void CATCPDestroyMutex(void);
 static CAResult_t CATCPCreateCond(void);
@@ -133,6 +160,13 @@ static void CASocketEventReturned(CASocketFd_t socket, long networkEvents);
 static CAResult_t CAReceiveMessage(CATCPSessionInfo_t *svritem);
 static void CAReceiveHandler(void *data);
 static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem);
+static void CATCPAddSession(CATCPSessionInfo_t *svritem);
+static void CATCPRemoveSession(CATCPSessionInfo_t *svritem);
+static void CATCPRegisterSessionFd(CATCPSessionInfo_t *svritem);
+static CATCPSessionInfo_t *CATCPFindSessionByEndpoint(const CAEndpoint_t *endpoint);
+#ifdef CA_TCP_USE_EPOLL
+static void CAEpollFindReadyMessage();
+#endif
 
 #if defined(WSA_WAIT_EVENT_0)
 #define CHECKFD(FD)
@@ -207,6 +241,187 @@ static CAResult_t CATCPCreateCond(void)
     return CA_STATUS_OK;
 }
 
+/**
+ * Build the endpoint index key of a session.
+ *
+ * @param[in]  endpoint  remote endpoint.
+ * @param[out] key       zero padded key.
+ */
+static void CATCPMakeSessionKey(const CAEndpoint_t *endpoint, CATCPSessionKey_t *key)
+{
+    memset(key, 0, sizeof (*key));
+    OICStrcpy(key->addr, sizeof (key->addr), endpoint->addr);
+    key->port = endpoint->port;
+}
+
+/**
+ * Add a session to the endpoint index. Sessions sharing an address and port
+ * are chained behind the indexed one through epNext.
+ * Caller must hold g_mutexObjectList.
+ */
+static void CATCPIndexSessionEndpoint(CATCPSessionInfo_t *svritem)
+{
+    CATCPMakeSessionKey(&svritem->sep.endpoint, &svritem->key);
+
+    CATCPSessionInfo_t *head = NULL;
+    HASH_FIND(hhEp, g_sessionEpIndex, &svritem->key, sizeof (svritem->key), head);
+    if (head)
+    {
+        svritem->epNext = head->epNext;
+        head->epNext = svritem;
+    }
+    else
+    {
+        svritem->epNext = NULL;
+        HASH_ADD(hhEp, g_sessionEpIndex, key, sizeof (svritem->key), svritem);
+    }
+}
+
+/**
+ * Remove a session from the endpoint index.
+ * Caller must hold g_mutexObjectList.
+ */
+static void CATCPUnindexSessionEndpoint(CATCPSessionInfo_t *svritem)
+{
+    CATCPSessionInfo_t *head = NULL;
+    HASH_FIND(hhEp, g_sessionEpIndex, &svritem->key, sizeof (svritem->key), head);
+    if (head == svritem)
+    {
+        HASH_DELETE(hhEp, g_sessionEpIndex, svritem);
+        if (svritem->epNext)
+        {
+            CATCPSessionInfo_t *next = svritem->epNext;
+            HASH_ADD(hhEp, g_sessionEpIndex, key, sizeof (next->key), next);
+        }
+    }
+    else if (head)
+    {
+        for (CATCPSessionInfo_t *prev = head; prev->epNext; prev = prev->epNext)
+        {
+            if (prev->epNext == svritem)
+            {
+                prev->epNext = svritem->epNext;
+                break;
+            }
+        }
+    }
+    svritem->epNext = NULL;
+}
+
+/**
+ * Add a connected session's socket to the fd index and the epoll set.
+ * Caller must hold g_mutexObjectList.
+ */
+static void CATCPIndexSessionFd(CATCPSessionInfo_t *svritem)
+{
+    if (CONNECTED != svritem->state || OC_INVALID_SOCKET == svritem->fd)
+    {
+        return;
+    }
+
+    CATCPSessionInfo_t *found = NULL;
+    HASH_FIND(hhFd, g_sessionFdIndex, &svritem->fd, sizeof (svritem->fd), found);
+    if (found)
+    {
+        return;
+    }
+    HASH_ADD(hhFd, g_sessionFdIndex, fd, sizeof (svritem->fd), svritem);
+
+#ifdef CA_TCP_USE_EPOLL
+    if (-1 != g_epollFd)
+    {
+        struct epoll_event ev = { .events = EPOLLIN, .data.fd = svritem->fd };
+        if (-1 == epoll_ctl(g_epollFd, EPOLL_CTL_ADD, svritem->fd, &ev))
+        {
+            OIC_LOG_V(ERROR, TAG, "epoll_ctl(%d) failed: %s", svritem->fd, strerror(errno));
+        }
+    }
+#endif
+}
+
+/**
+ * Remove a session's socket from the fd index and the epoll set.
+ * Caller must hold g_mutexObjectList.
+ */
+static void CATCPUnindexSessionFd(CATCPSessionInfo_t *svritem)
+{
+    if (OC_INVALID_SOCKET == svritem->fd)
+    {
+        return;
+    }
+
+    CATCPSessionInfo_t *found = NULL;
+    HASH_FIND(hhFd, g_sessionFdIndex, &svritem->fd, sizeof (svritem->fd), found);
+    if (found != svritem)
+    {
+        return;
+    }
+    HASH_DELETE(hhFd, g_sessionFdIndex, svritem);
+
+#ifdef CA_TCP_USE_EPOLL
+    if (-1 != g_epollFd)
+    {
+        // the socket is about to be closed, so a failure here is harmless
+        (void)epoll_ctl(g_epollFd, EPOLL_CTL_DEL, svritem->fd, NULL);
+    }
+#endif
+}
+
+/**
+ * Append a session to g_sessionList and index it.
+ */
+static void CATCPAddSession(CATCPSessionInfo_t *svritem)
+{
+    oc_mutex_lock(g_mutexObjectList);
+    DL_APPEND(g_sessionList, svritem);
+    CATCPIndexSessionEndpoint(svritem);
+    CATCPIndexSessionFd(svritem);
+    oc_mutex_unlock(g_mutexObjectList);
+}
+
+/**
+ * Unlink a session from g_sessionList and its indexes. The session itself
+ * is released with CADisconnectTCPSession().
+ * Caller must hold g_mutexObjectList.
+ */
+static void CATCPRemoveSession(CATCPSessionInfo_t *svritem)
+{
+    CATCPUnindexSessionFd(svritem);
+    CATCPUnindexSessionEndpoint(svritem);
+    DL_DELETE(g_sessionList, svritem);
+}
+
+/**
+ * Index the socket of a client session once it is connected.
+ */
+static void CATCPRegisterSessionFd(CATCPSessionInfo_t *svritem)
+{
+    oc_mutex_lock(g_mutexObjectList);
+    CATCPIndexSessionFd(svritem);
+    oc_mutex_unlock(g_mutexObjectList);
+}
+
+/**
+ * Find a session by remote endpoint.
+ * Caller must hold g_mutexObjectList.
+ */
+static CATCPSessionInfo_t *CATCPFindSessionByEndpoint(const CAEndpoint_t *endpoint)
+{
+    CATCPSessionKey_t key;
+    CATCPMakeSessionKey(endpoint, &key);
+
+    CATCPSessionInfo_t *session = NULL;
+    HASH_FIND(hhEp, g_sessionEpIndex, &key, sizeof (key), session);
+    for (; session; session = session->epNext)
+    {
+        if (session->sep.endpoint.flags & endpoint->flags)
+        {
+            return session;
+        }
+    }
+    return NULL;
+}
+
 static void CAReceiveHandler(void *data)
 {
     (void)data;
@@ -228,6 +443,14 @@ static void CAReceiveHandler(void *data)
 
 static void CAFindReadyMessage()
 {
+#ifdef CA_TCP_USE_EPOLL
+    if (-1 != g_epollFd)
+    {
+        CAEpollFindReadyMessage();
+        return;
+    }
+#endif
+
     fd_set readFds;
     struct timeval timeout = { .tv_sec = caglobals.tcp.selectTimeout };
 
@@ -247,7 +470,7 @@ static void CAFindReadyMessage()
     }
 
     CATCPSessionInfo_t *session = NULL;
-    LL_FOREACH(g_sessionList, session)
+    DL_FOREACH(g_sessionList, session)
     {
         if (session && session->fd != OC_INVALID_SOCKET && session->state == CONNECTED)
         {
@@ -321,7 +544,7 @@ static void CASelectReturned(fd_set *readFds)
         oc_mutex_lock(g_mutexObjectList);
         CATCPSessionInfo_t *session = NULL;
         CATCPSessionInfo_t *tmp = NULL;
-        LL_FOREACH_SAFE(g_sessionList, session, tmp)
+        DL_FOREACH_SAFE(g_sessionList, session, tmp)
         {
             if (session && session->fd != OC_INVALID_SOCKET)
             {
@@ -337,7 +560,7 @@ static void CASelectReturned(fd_set *readFds)
                             OIC_LOG(ERROR, TAG, "Failed to close TLS session");
                         }
 #endif
-                        LL_DELETE(g_sessionList, session);
+                        CATCPRemoveSession(session);
                         CADisconnectTCPSession(session);
                         oc_mutex_unlock(g_mutexObjectList);
                         return;
@@ -349,6 +572,138 @@ static void CASelectReturned(fd_set *readFds)
     }
 }
 
+#ifdef CA_TCP_USE_EPOLL
+
+/**
+ * Create the epoll instance and register the accept sockets, the wakeup
+ * pipes and any session that is already connected. On failure the
+ * receive thread keeps using select().
+ */
+static void CAInitializeEpoll()
+{
+    g_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == g_epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed: %s (using select)", strerror(errno));
+        return;
+    }
+
+    CASocketFd_t fds[] = { caglobals.tcp.ipv4.fd, caglobals.tcp.ipv4s.fd,
+                           caglobals.tcp.ipv6.fd, caglobals.tcp.ipv6s.fd,
+                           caglobals.tcp.shutdownFds[0], caglobals.tcp.connectionFds[0] };
+
+    for (size_t i = 0; i < sizeof (fds) / sizeof (fds[0]); i++)
+    {
+        if (OC_INVALID_SOCKET == fds[i])
+        {
+            continue;
+        }
+        struct epoll_event ev = { .events = EPOLLIN, .data.fd = fds[i] };
+        if (-1 == epoll_ctl(g_epollFd, EPOLL_CTL_ADD, fds[i], &ev))
+        {
+            OIC_LOG_V(ERROR, TAG, "epoll_ctl(%d) failed: %s (using select)",
+                      fds[i], strerror(errno));
+            close(g_epollFd);
+            g_epollFd = -1;
+            return;
+        }
+    }
+
+    oc_mutex_lock(g_mutexObjectList);
+    CATCPSessionInfo_t *session = NULL;
+    for (session = g_sessionFdIndex; session; session = session->hhFd.next)
+    {
+        struct epoll_event ev = { .events = EPOLLIN, .data.fd = session->fd };
+        (void)epoll_ctl(g_epollFd, EPOLL_CTL_ADD, session->fd, &ev);
+    }
+    oc_mutex_unlock(g_mutexObjectList);
+}
+
+/**
+ * Handle a readable session socket. Level-triggered, so one read per event
+ * is enough: epoll reports the socket again while data remains.
+ */
+static void CAEpollSessionReady(CASocketFd_t fd)
+{
+    oc_mutex_lock(g_mutexObjectList);
+    CATCPSessionInfo_t *session = NULL;
+    HASH_FIND(hhFd, g_sessionFdIndex, &fd, sizeof (fd), session);
+    if (session && CA_STATUS_OK != CAReceiveMessage(session))
+    {
+        //disconnect session and clean-up data if any error occurs
+#ifdef __WITH_TLS__
+        if (CA_STATUS_OK != CAcloseSslConnection(&session->sep.endpoint))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to close TLS session");
+        }
+#endif
+        CATCPRemoveSession(session);
+        CADisconnectTCPSession(session);
+    }
+    oc_mutex_unlock(g_mutexObjectList);
+}
+
+static void CAEpollFindReadyMessage()
+{
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    int ret = epoll_wait(g_epollFd, events, EPOLL_MAX_EVENTS,
+                         caglobals.tcp.selectTimeout * 1000);
+
+    if (caglobals.tcp.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+
+    if (0 > ret)
+    {
+        if (EINTR != errno)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+        }
+        return;
+    }
+
+    for (int i = 0; (i < ret) && !caglobals.tcp.terminate; i++)
+    {
+        CASocketFd_t fd = events[i].data.fd;
+
+        if (fd == caglobals.tcp.ipv4.fd)
+        {
+            CAAcceptConnection(CA_IPV4, &caglobals.tcp.ipv4);
+        }
+        else if (fd == caglobals.tcp.ipv4s.fd)
+        {
+            CAAcceptConnection(CA_IPV4 | CA_SECURE, &caglobals.tcp.ipv4s);
+        }
+        else if (fd == caglobals.tcp.ipv6.fd)
+        {
+            CAAcceptConnection(CA_IPV6, &caglobals.tcp.ipv6);
+        }
+        else if (fd == caglobals.tcp.ipv6s.fd)
+        {
+            CAAcceptConnection(CA_IPV6 | CA_SECURE, &caglobals.tcp.ipv6s);
+        }
+        else if (fd == caglobals.tcp.connectionFds[0])
+        {
+            // client sessions register themselves; just consume the notification.
+            char buf[MAX_ADDR_STR_SIZE_CA] = {0};
+            (void)read(caglobals.tcp.connectionFds[0], buf, sizeof (buf));
+        }
+        else if (fd == caglobals.tcp.shutdownFds[0])
+        {
+            // shutdown pipe was closed; terminate flag is already set.
+            continue;
+        }
+        else
+        {
+            CAEpollSessionReady(fd);
+        }
+    }
+}
+
+#endif // CA_TCP_USE_EPOLL
+
 #else // if defined(WSA_WAIT_EVENT_0)
 
 /**
@@ -449,7 +804,7 @@ static void CAFindReadyMessage()
     while (!caglobals.tcp.terminate)
     {
         CATCPSessionInfo_t *session = NULL;
-        LL_FOREACH(g_sessionList, session)
+        DL_FOREACH(g_sessionList, session)
         {
             if (session && OC_INVALID_SOCKET != session->fd && (arraySize < EVENT_ARRAY_SIZE))
             {
@@ -537,7 +892,7 @@ static void CASocketEventReturned(CASocketFd_t s, long networkEvents)
         oc_mutex_lock(g_mutexObjectList);
         CATCPSessionInfo_t *session = NULL;
         CATCPSessionInfo_t *tmp = NULL;
-        LL_FOREACH_SAFE(g_sessionList, session, tmp)
+        DL_FOREACH_SAFE(g_sessionList, session, tmp)
         {
             if (session && (session->fd == s))
             {
@@ -551,7 +906,7 @@ static void CASocketEventReturned(CASocketFd_t s, long networkEvents)
                         OIC_LOG(ERROR, TAG, "Failed to close TLS session");
                     }
 #endif
-                    LL_DELETE(g_sessionList, session);
+                    CATCPRemoveSession(session);
                     CADisconnectTCPSession(session);
                     oc_mutex_unlock(g_mutexObjectList);
                     return;
@@ -595,9 +950,7 @@ static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
         CAConvertAddrToName((struct sockaddr_storage *)&clientaddr, clientlen,
                             svritem->sep.endpoint.addr, &svritem->sep.endpoint.port);
 
-        oc_mutex_lock(g_mutexObjectList);
-        LL_APPEND(g_sessionList, svritem);
-        oc_mutex_unlock(g_mutexObjectList);
+        CATCPAddSession(svritem);
 
         CHECKFD(sockfd);
 
@@ -920,6 +1273,7 @@ static CAResult_t CATCPCreateSocket(int family, CATCPSessionInfo_t *svritem)
     OIC_LOG(DEBUG, TAG, "connect socket success");
     svritem->state = CONNECTED;
     CHECKFD(svritem->fd);
+    CATCPRegisterSessionFd(svritem);
 #if !defined(WSA_WAIT_EVENT_0)
     ssize_t len = CAWakeUpForReadFdsUpdate(svritem->sep.endpoint.addr);
     if (-1 == len)
@@ -1122,6 +1476,10 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
     CHECKFD(caglobals.tcp.connectionFds[1]);
 #endif
 
+#ifdef CA_TCP_USE_EPOLL
+    CAInitializeEpoll();
+#endif
+
     caglobals.tcp.terminate = false;
     res = ca_thread_pool_add_task(threadPool, CAReceiveHandler, NULL);
     if (CA_STATUS_OK != res)
@@ -1190,6 +1548,14 @@ void CATCPStopServer(void)
     caglobals.tcp.shutdownFds[0] = OC_INVALID_SOCKET;
 #endif
 
+#ifdef CA_TCP_USE_EPOLL
+    if (-1 != g_epollFd)
+    {
+        close(g_epollFd);
+        g_epollFd = -1;
+    }
+#endif
+
     // mutex unlock
     oc_mutex_unlock(g_mutexObjectList);
 
@@ -1444,9 +1810,7 @@ CASocketFd_t CAConnectTCPSession(const CAEndpoint_t *endpoint)
     svritem->isClient = true;
 
     // #2. add TCP connection info to list
-    oc_mutex_lock(g_mutexObjectList);
-    LL_APPEND(g_sessionList, svritem);
-    oc_mutex_unlock(g_mutexObjectList);
+    CATCPAddSession(svritem);
 
     // #3. create the socket and connect to TCP server
     int family = (svritem->sep.endpoint.flags & CA_IPV6) ? AF_INET6 : AF_INET;
@@ -1500,11 +1864,13 @@ void CATCPDisconnectAll(void)
     oc_mutex_lock(g_mutexObjectList);
     CATCPSessionInfo_t *session = NULL;
     CATCPSessionInfo_t *tmp = NULL;
-    LL_FOREACH_SAFE(g_sessionList, session, tmp)
+    HASH_CLEAR(hhFd, g_sessionFdIndex);
+    HASH_CLEAR(hhEp, g_sessionEpIndex);
+    DL_FOREACH_SAFE(g_sessionList, session, tmp)
     {
         if (session)
         {
-            LL_DELETE(g_sessionList, session);
+            DL_DELETE(g_sessionList, session);
             // disconnect session from remote device.
             CADisconnectTCPSession(session);
         }
@@ -1526,21 +1892,12 @@ CATCPSessionInfo_t *CAGetTCPSessionInfoFromEndpoint(const CAEndpoint_t *endpoint
     OIC_LOG_V(DEBUG, TAG, "Looking for [%s:%d]", endpoint->addr, endpoint->port);
 
     // get connection info from list
-    CATCPSessionInfo_t *session = NULL;
-    LL_FOREACH(g_sessionList, session)
-    {
-        if (!strncmp(session->sep.endpoint.addr, endpoint->addr,
-                     sizeof(session->sep.endpoint.addr))
-                && (session->sep.endpoint.port == endpoint->port)
-                && (session->sep.endpoint.flags & endpoint->flags))
-        {
-            OIC_LOG(DEBUG, TAG, "Found in session list");
-            return session;
-        }
-    }
+    oc_mutex_lock(g_mutexObjectList);
+    CATCPSessionInfo_t *session = CATCPFindSessionByEndpoint(endpoint);
+    oc_mutex_unlock(g_mutexObjectList);
 
-    OIC_LOG(DEBUG, TAG, "Session not found");
-    return NULL;
+    OIC_LOG(DEBUG, TAG, session ? "Found in session list" : "Session not found");
+    return session;
 }
 
 CASocketFd_t CAGetSocketFDFromEndpoint(const CAEndpoint_t *endpoint)
@@ -1551,23 +1908,12 @@ CASocketFd_t CAGetSocketFDFromEndpoint(const CAEndpoint_t *endpoint)
 
     // get connection info from list.
     oc_mutex_lock(g_mutexObjectList);
-    CATCPSessionInfo_t *session = NULL;
-    LL_FOREACH(g_sessionList, session)
-    {
-        if (!strncmp(session->sep.endpoint.addr, endpoint->addr,
-                     sizeof(session->sep.endpoint.addr))
-                && (session->sep.endpoint.port == endpoint->port)
-                && (session->sep.endpoint.flags & endpoint->flags))
-        {
-            oc_mutex_unlock(g_mutexObjectList);
-            OIC_LOG(DEBUG, TAG, "Found in session list");
-            return session->fd;
-        }
-    }
-
+    CATCPSessionInfo_t *session = CATCPFindSessionByEndpoint(endpoint);
+    CASocketFd_t fd = session ? session->fd : OC_INVALID_SOCKET;
     oc_mutex_unlock(g_mutexObjectList);
-    OIC_LOG(DEBUG, TAG, "Session not found");
-    return OC_INVALID_SOCKET;
+
+    OIC_LOG(DEBUG, TAG, session ? "Found in session list" : "Session not found");
+    return fd;
 }
 
 CAResult_t CASearchAndDeleteTCPSession(const CAEndpoint_t *endpoint)
@@ -1577,23 +1923,15 @@ CAResult_t CASearchAndDeleteTCPSession(const CAEndpoint_t *endpoint)
     OIC_LOG_V(DEBUG, TAG, "Looking for [%s:%d]", endpoint->addr, endpoint->port);
 
     // get connection info from list
-    CATCPSessionInfo_t *session = NULL;
-    CATCPSessionInfo_t *tmp = NULL;
-
     oc_mutex_lock(g_mutexObjectList);
-    LL_FOREACH_SAFE(g_sessionList, session, tmp)
+    CATCPSessionInfo_t *session = CATCPFindSessionByEndpoint(endpoint);
+    if (session)
     {
-        if (!strncmp(session->sep.endpoint.addr, endpoint->addr,
-                     sizeof(session->sep.endpoint.addr))
-                && (session->sep.endpoint.port == endpoint->port)
-                && (session->sep.endpoint.flags & endpoint->flags))
-        {
-            OIC_LOG(DEBUG, TAG, "Found in session list");
-            LL_DELETE(g_sessionList, session);
-            CADisconnectTCPSession(session);
-            oc_mutex_unlock(g_mutexObjectList);
-            return CA_STATUS_OK;
-        }
+        OIC_LOG(DEBUG, TAG, "Found in session list");
+        CATCPRemoveSession(session);
+        CADisconnectTCPSession(session);
+        oc_mutex_unlock(g_mutexObjectList);
+        return CA_STATUS_OK;
     }
     oc_mutex_unlock(g_mutexObjectList);
 
@@ -28,6 +28,11 @@
 #include "cautilinterface.h"
 #include "cacommon.h"
 #include "cablockwisetransfer.h"
+#include "oic_malloc.h"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
 
 #define LARGE_PAYLOAD_LENGTH    1024
 
@@ -50,7 +55,8 @@ TEST_F(CABlockTransferTests, CACreateNewDataSetTest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -89,7 +95,7 @@ TEST_F(CABlockTransferTests, CACreateNewDataSetTest)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -103,7 +109,8 @@ TEST_F(CABlockTransferTests, CARemoveBlockDataFromListWithSeed)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -142,7 +149,7 @@ TEST_F(CABlockTransferTests, CARemoveBlockDataFromListWithSeed)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -156,7 +163,8 @@ TEST_F(CABlockTransferTests, CAGetBlockDataFromBlockDataListTest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -185,7 +193,7 @@ TEST_F(CABlockTransferTests, CAGetBlockDataFromBlockDataListTest)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -199,7 +207,8 @@ TEST_F(CABlockTransferTests, CAGetPayloadFromBlockDataListTest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -232,7 +241,7 @@ TEST_F(CABlockTransferTests, CAGetPayloadFromBlockDataListTest)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -247,7 +256,8 @@ TEST_F(CABlockTransferTests, CAAddBlockOptionTest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -272,7 +282,7 @@ TEST_F(CABlockTransferTests, CAAddBlockOptionTest)
 
     EXPECT_EQ(CA_STATUS_OK, CAAddBlockOption(&pdu, &requestData, tempRep, &options));
 
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -287,7 +297,8 @@ TEST_F(CABlockTransferTests, CAAddBlockOption1InRequest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -327,7 +338,7 @@ TEST_F(CABlockTransferTests, CAAddBlockOption1InRequest)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -342,7 +353,8 @@ TEST_F(CABlockTransferTests, CAAddBlockOption1InResponse)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -383,7 +395,7 @@ TEST_F(CABlockTransferTests, CAAddBlockOption1InResponse)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -398,7 +410,8 @@ TEST_F(CABlockTransferTests, CAAddBlockOption2InResponse)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -439,7 +452,7 @@ TEST_F(CABlockTransferTests, CAAddBlockOption2InResponse)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -447,6 +460,60 @@ TEST_F(CABlockTransferTests, CAAddBlockOption2InResponse)
     free(responseData.payload);
 }
 
+// A queued Block2 message carries its own block number; building it neither
+// depends on nor changes the block the transfer is at.
+TEST_F(CABlockTransferTests, CAAddBlockOption2UsesQueuedBlockNumber)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CAOptionList_t options;
+    CAInitOptionList(&options);
+    coap_transport_t transport = COAP_UDP;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    std::vector<uint8_t> body(4 * LARGE_PAYLOAD_LENGTH, '1');
+    CAInfo_t responseData;
+    memset(&responseData, 0, sizeof(CAInfo_t));
+    responseData.token = tempToken;
+    responseData.tokenLength = CA_MAX_TOKEN_LEN;
+    responseData.type = CA_MSG_NONCONFIRM;
+    responseData.messageId = 1;
+    responseData.payload = &body[0];
+    responseData.payloadSize = body.size();
+
+    coap_pdu_t *pdu = CAGeneratePDU(CA_CONTENT, &responseData, tempRep, &options, &transport);
+    ASSERT_TRUE(pdu != NULL);
+    CAData_t *cadata = CACreateNewDataSet(pdu, tempRep);
+    ASSERT_TRUE(cadata != NULL);
+    CABlockData_t *currData = CACreateNewBlockData(cadata);
+    ASSERT_TRUE(currData != NULL);
+    EXPECT_EQ(CA_STATUS_OK, CAUpdateBlockOptionType(currData->blockDataId, COAP_OPTION_BLOCK2));
+    CAClearOptionList(&options);
+    coap_delete_pdu(pdu);
+
+    responseData.hasBlock2Num = true;
+    responseData.block2Num = 2;
+    pdu = CAGeneratePDU(CA_CONTENT, &responseData, tempRep, &options, &transport);
+    ASSERT_TRUE(pdu != NULL);
+    EXPECT_EQ(CA_STATUS_OK, CAAddBlockOption2(&pdu, &responseData, responseData.payloadSize,
+                                              currData->blockDataId, &options));
+
+    coap_block_t block = { 0, 0, 0 };
+    EXPECT_TRUE(coap_get_block(pdu, COAP_OPTION_BLOCK2, &block));
+    EXPECT_EQ(2u, block.num);
+    EXPECT_EQ(0u, currData->block2.num);
+
+    CADestroyDataSet(cadata);
+    CAClearOptionList(&options);
+    coap_delete_pdu(pdu);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
 // request and block option1
 TEST_F(CABlockTransferTests, CAAddBlockOption2InRequest)
 {
@@ -454,7 +521,8 @@ TEST_F(CABlockTransferTests, CAAddBlockOption2InRequest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -494,7 +562,7 @@ TEST_F(CABlockTransferTests, CAAddBlockOption2InRequest)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -508,7 +576,8 @@ TEST_F(CABlockTransferTests, CAGetBlockSizeOptionFromPduTest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -526,7 +595,7 @@ TEST_F(CABlockTransferTests, CAGetBlockSizeOptionFromPduTest)
     EXPECT_FALSE(CAIsPayloadLengthInPduWithBlockSizeOption(pdu, COAP_OPTION_SIZE1,
                                                            &totalPayloadLen));
 
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -540,7 +609,8 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption1WithRequest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -564,7 +634,7 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption1WithRequest)
     EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption1(pdu, tempRep, cadata, block, pdu->length));
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -578,7 +648,8 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption1WithResponse)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -603,7 +674,7 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption1WithResponse)
     EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption1(pdu, tempRep, cadata, block, pdu->length));
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -617,7 +688,8 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption2WithRequest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -641,7 +713,7 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption2WithRequest)
     EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption2(pdu, tempRep, cadata, block, pdu->length));
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -655,7 +727,8 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption2WithResponse)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -680,7 +753,7 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption2WithResponse)
     EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption2(pdu, tempRep, cadata, block, pdu->length));
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -764,3 +837,280 @@ TEST_F(CABlockTransferTests, CAUpdatePayloadToCADataWithResponse)
     CADestroyToken(tempToken);
     CADestroyEndpoint(tempRep);
 }
+
+TEST_F(CABlockTransferTests, CAUpdatePayloadDataAllocatesOnceWithSizeOption)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    coap_pdu_t *pdu = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
+    coap_transport_t transport = COAP_UDP;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CAInfo_t requestData;
+    memset(&requestData, 0, sizeof(CAInfo_t));
+    requestData.token = tempToken;
+    requestData.tokenLength = CA_MAX_TOKEN_LEN;
+    requestData.type = CA_MSG_NONCONFIRM;
+
+    pdu = CAGeneratePDU(CA_GET, &requestData, tempRep, &options, &transport);
+
+    CAData_t *cadata = CACreateNewDataSet(pdu, tempRep);
+    EXPECT_TRUE(cadata != NULL);
+
+    CABlockData_t *currData = CACreateNewBlockData(cadata);
+    EXPECT_TRUE(currData != NULL);
+
+    if (currData)
+    {
+        const size_t blocks = 4;
+        std::vector<uint8_t> body(blocks * LARGE_PAYLOAD_LENGTH);
+        for (size_t i = 0; i < body.size(); i++)
+        {
+            body[i] = (uint8_t) (i * 7);
+        }
+
+        CAResponseInfo_t responseInfo;
+        memset(&responseInfo, 0, sizeof(CAResponseInfo_t));
+        responseInfo.result = CA_CONTENT;
+
+        CAData_t received;
+        memset(&received, 0, sizeof(CAData_t));
+        received.type = SEND_TYPE_UNICAST;
+        received.remoteEndpoint = tempRep;
+        received.responseInfo = &responseInfo;
+        received.dataType = CA_RESPONSE_DATA;
+
+        // Size2 announced the total, so the first block allocates all of it.
+        currData->payloadLength = body.size();
+        CAPayload_t buffer = NULL;
+        for (size_t i = 0; i < blocks; i++)
+        {
+            responseInfo.info.payload = &body[i * LARGE_PAYLOAD_LENGTH];
+            responseInfo.info.payloadSize = LARGE_PAYLOAD_LENGTH;
+            EXPECT_EQ(CA_STATUS_OK, CAUpdatePayloadData(currData, &received, CA_BLOCK_UNKNOWN,
+                                                        0 == i, COAP_OPTION_BLOCK2));
+            if (0 == i)
+            {
+                buffer = currData->payload;
+            }
+            EXPECT_EQ(buffer, currData->payload);
+            EXPECT_EQ(body.size(), currData->payloadCapacity);
+        }
+        EXPECT_EQ(body.size(), currData->receivedPayloadLen);
+        EXPECT_EQ(0, memcmp(&body[0], currData->payload, body.size()));
+
+        // Without it, the buffer grows geometrically.
+        OICFree(currData->payload);
+        currData->payload = NULL;
+        currData->payloadCapacity = 0;
+        currData->payloadLength = 0;
+        currData->receivedPayloadLen = 0;
+        size_t reallocs = 0;
+        for (size_t i = 0; i < blocks; i++)
+        {
+            size_t capacity = currData->payloadCapacity;
+            responseInfo.info.payload = &body[i * LARGE_PAYLOAD_LENGTH];
+            responseInfo.info.payloadSize = LARGE_PAYLOAD_LENGTH;
+            EXPECT_EQ(CA_STATUS_OK, CAUpdatePayloadData(currData, &received, CA_BLOCK_UNKNOWN,
+                                                        false, COAP_OPTION_BLOCK2));
+            reallocs += (capacity != currData->payloadCapacity) ? 1 : 0;
+        }
+        EXPECT_EQ(3u, reallocs);
+        EXPECT_EQ(0, memcmp(&body[0], currData->payload, body.size()));
+
+        EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(currData->blockDataId));
+    }
+
+    CADestroyDataSet(cadata);
+    CAClearOptionList(&options);
+    coap_delete_pdu(pdu);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
+TEST_F(CABlockTransferTests, CASetNextBlockOption2WithPipelinedResponses)
+{
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CASetBlock2WindowSize(0));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CASetBlock2WindowSize(CA_MAX_BLOCK2_WINDOW + 1));
+    ASSERT_EQ(CA_STATUS_OK, CASetBlock2WindowSize(4));
+
+    const size_t blocks = 8;
+    const size_t blockSize = LARGE_PAYLOAD_LENGTH;
+    std::vector<uint8_t> body(blocks * blockSize);
+    for (size_t i = 0; i < body.size(); i++)
+    {
+        body[i] = (uint8_t) (i * 7);
+    }
+
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CAOptionList_t options;
+    CAInitOptionList(&options);
+    coap_transport_t transport = COAP_UDP;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CAHeaderOption_t size2;
+    memset(&size2, 0, sizeof(CAHeaderOption_t));
+    size2.protocolID = CA_COAP_ID;
+    size2.optionID = COAP_OPTION_SIZE2;
+    size2.optionLength = 2;
+    size2.optionData[0] = (char) ((body.size() >> 8) & 0xFF);
+    size2.optionData[1] = (char) (body.size() & 0xFF);
+
+    CAInfo_t responseData;
+    memset(&responseData, 0, sizeof(CAInfo_t));
+    responseData.token = tempToken;
+    responseData.tokenLength = CA_MAX_TOKEN_LEN;
+    responseData.type = CA_MSG_NONCONFIRM;
+    responseData.messageId = 1;
+    responseData.options = &size2;
+    responseData.numOptions = 1;
+
+    coap_pdu_t *pdu = CAGeneratePDU(CA_CONTENT, &responseData, tempRep, &options, &transport);
+    ASSERT_TRUE(pdu != NULL);
+    // Size2 lets the client lay out the whole body and open the window.
+    ASSERT_EQ(CA_STATUS_OK, CAAddOptionToPDU(pdu, &options));
+
+    CAResponseInfo_t responseInfo;
+    memset(&responseInfo, 0, sizeof(CAResponseInfo_t));
+    responseInfo.result = CA_CONTENT;
+    responseInfo.info = responseData;
+    responseInfo.info.payloadSize = blockSize;
+
+    CAData_t received;
+    memset(&received, 0, sizeof(CAData_t));
+    received.type = SEND_TYPE_UNICAST;
+    received.remoteEndpoint = tempRep;
+    received.responseInfo = &responseInfo;
+    received.dataType = CA_RESPONSE_DATA;
+
+    CABlockDataID_t *blockID = CACreateBlockDatablockId(tempToken, CA_MAX_TOKEN_LEN,
+                                                        tempRep->addr, tempRep->port);
+    ASSERT_TRUE(blockID != NULL);
+
+    // Block 0 arrives in order, then blocks 1 to 4 are in flight.
+    coap_block_t block = { 0, 1, CA_DEFAULT_BLOCK_SIZE };
+    responseInfo.info.payload = &body[0];
+    EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption2(pdu, tempRep, &received, block,
+                                                  blockSize + pdu->length));
+
+    CABlockData_t *currData = CAGetBlockDataFromBlockDataList(blockID);
+    ASSERT_TRUE(currData != NULL);
+    EXPECT_EQ(blocks, currData->block2Total);
+    EXPECT_EQ(4u, currData->block2Requested);
+    EXPECT_EQ(body.size(), currData->payloadCapacity);
+
+    // The rest in any order; a duplicate of block 3 requests nothing new.
+    const unsigned int order[] = { 3, 1, 2, 3, 5, 4, 7 };
+    for (unsigned int num : order)
+    {
+        block.num = num;
+        block.m = (num + 1 < blocks) ? 1 : 0;
+        responseInfo.info.payload = &body[num * blockSize];
+        EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption2(pdu, tempRep, &received, block,
+                                                      blockSize + pdu->length));
+    }
+    EXPECT_EQ(7u, currData->block2Requested);
+    EXPECT_EQ(7 * blockSize, currData->receivedPayloadLen);
+    EXPECT_EQ(0, memcmp(&body[0], currData->payload, 6 * blockSize));
+    EXPECT_EQ(0, memcmp(&body[7 * blockSize], currData->payload + 7 * blockSize, blockSize));
+
+    // The last missing block completes the transfer.
+    block.num = 6;
+    block.m = 1;
+    responseInfo.info.payload = &body[6 * blockSize];
+    EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption2(pdu, tempRep, &received, block,
+                                                  blockSize + pdu->length));
+    EXPECT_TRUE(NULL == CAGetBlockDataFromBlockDataList(blockID));
+
+    EXPECT_EQ(CA_STATUS_OK, CASetBlock2WindowSize(1));
+    CADestroyBlockID(blockID);
+    CAClearOptionList(&options);
+    coap_delete_pdu(pdu);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
+// Lookups of many concurrent transfers by ID, compared with the linear scan of
+// the list they were kept in before.
+TEST_F(CABlockTransferTests, BlockDataLookupBenchmark)
+{
+    const size_t transfers = 2000;
+
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    char token[CA_MAX_TOKEN_LEN] = { 0 };
+    CARequestInfo_t requestInfo;
+    memset(&requestInfo, 0, sizeof(CARequestInfo_t));
+    requestInfo.method = CA_GET;
+    requestInfo.info.type = CA_MSG_CONFIRM;
+    requestInfo.info.token = token;
+    requestInfo.info.tokenLength = CA_MAX_TOKEN_LEN;
+
+    CAData_t cadata;
+    memset(&cadata, 0, sizeof(CAData_t));
+    cadata.type = SEND_TYPE_UNICAST;
+    cadata.remoteEndpoint = tempRep;
+    cadata.requestInfo = &requestInfo;
+    cadata.dataType = CA_REQUEST_DATA;
+
+    std::vector<CABlockData_t *> list;
+    for (size_t i = 0; i < transfers; i++)
+    {
+        memcpy(token, &i, sizeof(i));
+        CABlockData_t *currData = CACreateNewBlockData(&cadata);
+        ASSERT_TRUE(currData != NULL);
+        list.push_back(currData);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t found = 0;
+    for (size_t i = 0; i < transfers; i++)
+    {
+        for (size_t j = 0; j < list.size(); j++)
+        {
+            if (CABlockidMatches(list[j], list[i]->blockDataId))
+            {
+                found++;
+                break;
+            }
+        }
+    }
+    auto scanUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(transfers, found);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < transfers; i++)
+    {
+        EXPECT_EQ(list[i], CAGetBlockDataFromBlockDataList(list[i]->blockDataId));
+    }
+    auto indexUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[ BENCH    ] " << transfers << " transfer lookups: list scan " << scanUs
+              << " us, hash index " << indexUs << " us" << std::endl;
+
+    for (size_t i = 0; i < transfers; i++)
+    {
+        CAToken_t seed = (CAToken_t) list[i]->blockDataId->id;
+        CABlockDataID_t *blockID = CACreateBlockDatablockId(seed, CA_MAX_TOKEN_LEN,
+                                                            tempRep->addr, tempRep->port);
+        EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(blockID));
+        EXPECT_TRUE(NULL == CAGetBlockDataFromBlockDataList(blockID));
+        CADestroyBlockID(blockID);
+    }
+
+    CADestroyEndpoint(tempRep);
+}
@@ -0,0 +1,162 @@
+//******************************************************************
+//
+// Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+#include <gtest/gtest.h>
+
+#include <iostream>
+
+#include "caduplicatecache.h"
+#include "oic_string.h"
+#include "oic_time.h"
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#define BENCH_MESSAGES      100000
+#define BENCH_CACHE_SIZE    4096
+
+static char g_token[] = "token01";
+
+static CAEndpoint_t makeEndpoint(CATransportAdapter_t adapter, CATransportFlags_t flags,
+                                 const char *addr, uint32_t ifindex)
+{
+    CAEndpoint_t ep = CAEndpoint_t();
+    ep.adapter = adapter;
+    ep.flags = flags;
+    ep.ifindex = ifindex;
+    OICStrcpy(ep.addr, sizeof(ep.addr), addr);
+    return ep;
+}
+
+class DuplicateCacheTest : public testing::Test
+{
+protected:
+    virtual void TearDown()
+    {
+        CATerminateDuplicateCache();
+    }
+};
+
+TEST_F(DuplicateCacheTest, OtherIPFamilyIsDuplicate)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAInitializeDuplicateCache(0, 0));
+
+    CAEndpoint_t ipv6 = makeEndpoint(CA_ADAPTER_IP, CA_IPV6, "fe80::1", 2);
+    CAEndpoint_t ipv4 = makeEndpoint(CA_ADAPTER_IP, CA_IPV4, "192.168.0.1", 2);
+    CAEndpoint_t other = makeEndpoint(CA_ADAPTER_IP, CA_IPV4, "192.168.1.1", 3);
+
+    EXPECT_FALSE(CAIsDuplicateMessage(&ipv6, 100, g_token, sizeof(g_token) - 1));
+    EXPECT_TRUE(CAIsDuplicateMessage(&ipv4, 100, g_token, sizeof(g_token) - 1));
+    EXPECT_FALSE(CAIsDuplicateMessage(&other, 100, g_token, sizeof(g_token) - 1));
+    EXPECT_FALSE(CAIsDuplicateMessage(&ipv4, 101, g_token, sizeof(g_token) - 1));
+    EXPECT_FALSE(CAIsDuplicateMessage(&ipv4, 100, g_token, 3));
+}
+
+TEST_F(DuplicateCacheTest, IPMatchesAddressAndPort)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAInitializeDuplicateCache(0, 0));
+
+    CAEndpoint_t peer1 = makeEndpoint(CA_ADAPTER_IP, CA_IPV4, "192.168.0.1", 2);
+    CAEndpoint_t peer2 = makeEndpoint(CA_ADAPTER_IP, CA_IPV4, "192.168.0.2", 2);
+    peer1.port = 5683;
+    peer2.port = 5683;
+    CAEndpoint_t otherPort = peer1;
+    otherPort.port = 5684;
+
+    EXPECT_FALSE(CAIsDuplicateMessage(&peer1, 100, g_token, sizeof(g_token) - 1));
+    EXPECT_TRUE(CAIsDuplicateMessage(&peer1, 100, g_token, sizeof(g_token) - 1));
+    EXPECT_FALSE(CAIsDuplicateMessage(&peer2, 100, g_token, sizeof(g_token) - 1));
+    EXPECT_FALSE(CAIsDuplicateMessage(&otherPort, 100, g_token, sizeof(g_token) - 1));
+    EXPECT_TRUE(CAIsDuplicateMessage(&peer2, 100, g_token, sizeof(g_token) - 1));
+}
+
+TEST_F(DuplicateCacheTest, NonIPMatchesAddress)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAInitializeDuplicateCache(0, 0));
+
+    CAEndpoint_t le1 = makeEndpoint(CA_ADAPTER_GATT_BTLE, CA_DEFAULT_FLAGS, "00:11:22:33:44:55", 0);
+    CAEndpoint_t le2 = makeEndpoint(CA_ADAPTER_GATT_BTLE, CA_DEFAULT_FLAGS, "00:11:22:33:44:66", 0);
+
+    EXPECT_FALSE(CAIsDuplicateMessage(&le1, 7, g_token, sizeof(g_token) - 1));
+    EXPECT_TRUE(CAIsDuplicateMessage(&le1, 7, g_token, sizeof(g_token) - 1));
+    EXPECT_FALSE(CAIsDuplicateMessage(&le2, 7, g_token, sizeof(g_token) - 1));
+}
+
+TEST_F(DuplicateCacheTest, TCPIsNeverDuplicate)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAInitializeDuplicateCache(0, 0));
+
+    CAEndpoint_t tcp = makeEndpoint(CA_ADAPTER_TCP, CA_IPV4, "192.168.0.1", 0);
+
+    EXPECT_FALSE(CAIsDuplicateMessage(&tcp, 0, g_token, sizeof(g_token) - 1));
+    EXPECT_FALSE(CAIsDuplicateMessage(&tcp, 0, g_token, sizeof(g_token) - 1));
+}
+
+TEST_F(DuplicateCacheTest, OldestIsEvictedWhenFull)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAInitializeDuplicateCache(2, 0));
+
+    CAEndpoint_t ep = makeEndpoint(CA_ADAPTER_IP, CA_IPV4, "192.168.0.1", 1);
+
+    EXPECT_FALSE(CAIsDuplicateMessage(&ep, 1, NULL, 0));
+    EXPECT_FALSE(CAIsDuplicateMessage(&ep, 2, NULL, 0));
+    EXPECT_FALSE(CAIsDuplicateMessage(&ep, 3, NULL, 0));
+    EXPECT_TRUE(CAIsDuplicateMessage(&ep, 3, NULL, 0));
+    EXPECT_FALSE(CAIsDuplicateMessage(&ep, 1, NULL, 0));
+}
+
+TEST_F(DuplicateCacheTest, EntryExpiresAfterLifetime)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAInitializeDuplicateCache(0, 1));
+
+    CAEndpoint_t ep = makeEndpoint(CA_ADAPTER_IP, CA_IPV4, "192.168.0.1", 1);
+
+    EXPECT_FALSE(CAIsDuplicateMessage(&ep, 1, g_token, sizeof(g_token) - 1));
+    EXPECT_TRUE(CAIsDuplicateMessage(&ep, 1, g_token, sizeof(g_token) - 1));
+    usleep(1100 * 1000);
+    EXPECT_FALSE(CAIsDuplicateMessage(&ep, 1, g_token, sizeof(g_token) - 1));
+}
+
+// Measures the per-message cost of duplicate detection with a large cache.
+TEST_F(DuplicateCacheTest, LookupBenchmark)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAInitializeDuplicateCache(BENCH_CACHE_SIZE, 0));
+
+    CAEndpoint_t ep = makeEndpoint(CA_ADAPTER_IP, CA_IPV6, "fe80::1", 1);
+
+    uint32_t duplicates = 0;
+    uint64_t start = OICGetCurrentTime(TIME_IN_US);
+    for (uint32_t i = 0; i < BENCH_MESSAGES; i++)
+    {
+        // every message is seen twice in a row, as with dual-stack multicast
+        if (CAIsDuplicateMessage(&ep, (uint16_t)(i / 2), g_token, sizeof(g_token) - 1))
+        {
+            duplicates++;
+        }
+    }
+    uint64_t elapsed = OICGetCurrentTime(TIME_IN_US) - start;
+
+    EXPECT_EQ(BENCH_MESSAGES / 2, duplicates);
+
+    std::cout << "[ BENCH    ] Duplicate detection: " << BENCH_MESSAGES << " messages in "
+              << elapsed << " us" << std::endl;
+}
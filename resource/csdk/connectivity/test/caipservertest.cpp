@@ -0,0 +1,246 @@
+//******************************************************************
+//
+// Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "caipinterface.h"
+#include "cathreadpool.h"
+#include "oic_time.h"
+
+// Datagrams sent per run and the maximum number allowed in flight, so the
+// loopback socket buffer never overflows and drops skew the result.
+#define BENCH_PACKETS       20000
+#define BENCH_WINDOW        32
+#define BENCH_PAYLOAD_LEN   64
+#define BENCH_TIMEOUT_US    (10 * 1000 * 1000)
+
+static std::atomic<uint32_t> g_received(0);
+
+static void benchPacketReceived(const CASecureEndpoint_t * /*sep*/,
+                                const void * /*data*/, size_t /*dataLength*/)
+{
+    g_received++;
+}
+
+// Measures how many unicast datagrams per second the IP adapter receive thread
+// delivers. Build with WITH_EPOLL=0 and WITH_EPOLL=1 to compare select()/epoll().
+TEST(IPServerTest, ReceiveThroughput)
+{
+    ca_thread_pool_t threadPool = NULL;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &threadPool));
+
+    caglobals.ip.ipv4enabled = true;
+    caglobals.ip.ipv6enabled = false;
+    g_received = 0;
+    CAIPResetBatchStats();
+    CAIPSetPacketReceiveCallback(benchPacketReceived);
+    ASSERT_EQ(CA_STATUS_OK, CAIPStartServer(threadPool));
+
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ASSERT_NE(-1, fd);
+
+    struct sockaddr_in to = sockaddr_in();
+    to.sin_family = AF_INET;
+    to.sin_port = htons(caglobals.ip.u4.port);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    char payload[BENCH_PAYLOAD_LEN] = { 0x40 };
+    uint32_t sent = 0;
+    uint64_t start = OICGetCurrentTime(TIME_IN_US);
+    uint64_t deadline = start + BENCH_TIMEOUT_US;
+
+    while ((g_received < BENCH_PACKETS) && (OICGetCurrentTime(TIME_IN_US) < deadline))
+    {
+        if ((sent < BENCH_PACKETS) && ((sent - g_received) < BENCH_WINDOW))
+        {
+            if (sendto(fd, payload, sizeof(payload), 0,
+                       (struct sockaddr *)&to, sizeof(to)) == (ssize_t)sizeof(payload))
+            {
+                sent++;
+            }
+        }
+    }
+
+    uint64_t elapsed = OICGetCurrentTime(TIME_IN_US) - start;
+    uint32_t received = g_received;
+
+    close(fd);
+    CAIPStopServer();
+    CAIPSetPacketReceiveCallback(NULL);
+    ca_thread_pool_free(threadPool);
+
+    CAIPBatchStats_t stats;
+    CAIPGetBatchStats(&stats);
+
+    std::cout << "[ BENCH    ] IP receive: " << received << " datagrams in "
+              << elapsed << " us (" << (elapsed ? (received * 1000000ULL / elapsed) : 0)
+              << " packets/sec, " << stats.recvCalls << " recvmmsg calls, largest batch "
+              << stats.recvMaxBatch << ")" << std::endl;
+
+    EXPECT_EQ(sent, received);
+}
+
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+#define BATCHED_IO 1
+#endif
+
+#define BURST_PACKETS   32
+
+static std::promise<void> g_firstReceived;
+static std::shared_future<void> g_releaseReceive;
+
+static void blockingPacketReceived(const CASecureEndpoint_t * /*sep*/,
+                                   const void * /*data*/, size_t /*dataLength*/)
+{
+    // Hold the receive thread on the first datagram so the rest pile up.
+    if (0 == g_received++)
+    {
+        g_firstReceived.set_value();
+        g_releaseReceive.wait();
+    }
+}
+
+TEST(IPServerTest, ReceivesBurstInBatches)
+{
+    ca_thread_pool_t threadPool = NULL;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &threadPool));
+
+    caglobals.ip.ipv4enabled = true;
+    caglobals.ip.ipv6enabled = false;
+    g_received = 0;
+    g_firstReceived = std::promise<void>();
+    std::promise<void> release;
+    g_releaseReceive = release.get_future().share();
+    CAIPResetBatchStats();
+    CAIPSetPacketReceiveCallback(blockingPacketReceived);
+    ASSERT_EQ(CA_STATUS_OK, CAIPStartServer(threadPool));
+
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ASSERT_NE(-1, fd);
+
+    struct sockaddr_in to = sockaddr_in();
+    to.sin_family = AF_INET;
+    to.sin_port = htons(caglobals.ip.u4.port);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    char payload[BENCH_PAYLOAD_LEN] = { 0x40 };
+    sendto(fd, payload, sizeof(payload), 0, (struct sockaddr *)&to, sizeof(to));
+    EXPECT_EQ(std::future_status::ready,
+              g_firstReceived.get_future().wait_for(std::chrono::seconds(5)));
+    for (int i = 1; i < BURST_PACKETS; i++)
+    {
+        sendto(fd, payload, sizeof(payload), 0, (struct sockaddr *)&to, sizeof(to));
+    }
+    release.set_value();
+
+    uint64_t deadline = OICGetCurrentTime(TIME_IN_US) + BENCH_TIMEOUT_US;
+    while ((g_received < BURST_PACKETS) && (OICGetCurrentTime(TIME_IN_US) < deadline))
+    {
+        usleep(1000);
+    }
+
+    close(fd);
+    CAIPStopServer();
+    CAIPSetPacketReceiveCallback(NULL);
+    ca_thread_pool_free(threadPool);
+
+    EXPECT_EQ((uint32_t)BURST_PACKETS, g_received);
+
+    CAIPBatchStats_t stats;
+    CAIPGetBatchStats(&stats);
+#ifdef BATCHED_IO
+    EXPECT_EQ((uint64_t)BURST_PACKETS, stats.recvDatagrams);
+    EXPECT_LT(1u, stats.recvMaxBatch);
+    EXPECT_GT((uint64_t)BURST_PACKETS, stats.recvCalls);
+#else
+    EXPECT_EQ(0u, stats.recvCalls);
+#endif
+}
+
+TEST(IPServerTest, DeferredSendsGoOutTogether)
+{
+    ca_thread_pool_t threadPool = NULL;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &threadPool));
+
+    caglobals.ip.ipv4enabled = true;
+    caglobals.ip.ipv6enabled = false;
+    CAIPResetBatchStats();
+    ASSERT_EQ(CA_STATUS_OK, CAIPStartServer(threadPool));
+
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ASSERT_NE(-1, fd);
+    struct sockaddr_in local = sockaddr_in();
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(0, bind(fd, (struct sockaddr *)&local, sizeof(local)));
+    socklen_t localLen = sizeof(local);
+    ASSERT_EQ(0, getsockname(fd, (struct sockaddr *)&local, &localLen));
+    struct timeval timeout = { 5, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    CAEndpoint_t endpoint = CAEndpoint_t();
+    endpoint.adapter = CA_ADAPTER_IP;
+    endpoint.flags = CA_IPV4;
+    strcpy(endpoint.addr, "127.0.0.1");
+    endpoint.port = ntohs(local.sin_port);
+
+    const int count = 10;
+    unsigned char payloads[count][BENCH_PAYLOAD_LEN];
+    for (int i = 0; i < count; i++)
+    {
+        memset(payloads[i], i, sizeof(payloads[i]));
+        CAIPSendDataDeferred(&endpoint, payloads[i], sizeof(payloads[i]));
+    }
+    CAIPFlushSendData();
+
+    // Datagrams arrive in the order they were queued.
+    for (int i = 0; i < count; i++)
+    {
+        unsigned char buffer[BENCH_PAYLOAD_LEN * 2];
+        ASSERT_EQ((ssize_t)BENCH_PAYLOAD_LEN, recv(fd, buffer, sizeof(buffer), 0));
+        EXPECT_EQ(i, buffer[0]);
+    }
+
+    close(fd);
+    CAIPStopServer();
+    ca_thread_pool_free(threadPool);
+
+    CAIPBatchStats_t stats;
+    CAIPGetBatchStats(&stats);
+#ifdef BATCHED_IO
+    EXPECT_EQ(1u, stats.sendCalls);
+    EXPECT_EQ((uint64_t)count, stats.sendDatagrams);
+    EXPECT_EQ((uint32_t)count, stats.sendMaxBatch);
+#else
+    EXPECT_EQ(0u, stats.sendCalls);
+#endif
+}
@@ -27,6 +27,9 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <iostream>
+
 #include "oic_malloc.h"
 #include "caprotocolmessage.h"
 
@@ -49,19 +52,18 @@ public:
  */
 void verifyParsedOptions(CoAPOptionCase const *cases,
 			 size_t numCases,
-			 coap_list_t *optlist)
+			 const CAOptionList_t *optlist)
 {
     size_t index = 0;
-    for (coap_list_t *opt = optlist; opt; opt = opt->next)
+    for (size_t i = 0; i < optlist->count; i++)
     {
-        coap_option *option = (coap_option *) opt->data;
-        EXPECT_TRUE(option != NULL);
+        const CAOption_t *option = &optlist->options[i];
         EXPECT_LT(index, numCases);
-        if (option && (index < numCases))
+        if (index < numCases)
         {
-            unsigned short key = COAP_OPTION_KEY(*option);
-            unsigned int length = COAP_OPTION_LENGTH(*option);
-            std::string dataStr((const char*)COAP_OPTION_DATA(*option), length);
+            unsigned short key = option->key;
+            unsigned int length = option->length;
+            std::string dataStr((const char*)CAGetOptionValue(option), length);
             // First validate the test case:
             EXPECT_EQ(cases[index].length, cases[index].dataStr.length());
 
@@ -91,12 +93,13 @@ TEST(CAProtocolMessage, CAParseURIBase)
     size_t numCases = sizeof(cases) / sizeof(cases[0]);
 
 
-    coap_list_t *optlist = NULL;
+    CAOptionList_t optlist;
+    CAInitOptionList(&optlist);
     CAParseURI(sampleURI, &optlist);
 
 
-    verifyParsedOptions(cases, numCases, optlist);
-    coap_delete_list(optlist);
+    verifyParsedOptions(cases, numCases, &optlist);
+    CAClearOptionList(&optlist);
 }
 
 // Try for multiple URI path components that still total less than 128
@@ -124,12 +127,13 @@ TEST(CAProtocolMessage, CAParseURIManyPath)
     size_t numCases = sizeof(cases) / sizeof(cases[0]);
 
 
-    coap_list_t *optlist = NULL;
+    CAOptionList_t optlist;
+    CAInitOptionList(&optlist);
     CAParseURI(sampleURI, &optlist);
 
 
-    verifyParsedOptions(cases, numCases, optlist);
-    coap_delete_list(optlist);
+    verifyParsedOptions(cases, numCases, &optlist);
+    CAClearOptionList(&optlist);
 }
 
 // Try for multiple URI parameters that still total less than 128
@@ -156,12 +160,13 @@ TEST(CAProtocolMessage, CAParseURIManyParams)
     size_t numCases = sizeof(cases) / sizeof(cases[0]);
 
 
-    coap_list_t *optlist = NULL;
+    CAOptionList_t optlist;
+    CAInitOptionList(&optlist);
     CAParseURI(sampleURI, &optlist);
 
 
-    verifyParsedOptions(cases, numCases, optlist);
-    coap_delete_list(optlist);
+    verifyParsedOptions(cases, numCases, &optlist);
+    CAClearOptionList(&optlist);
 }
 
 // Test that an initial long path component won't hide latter ones.
@@ -183,12 +188,13 @@ TEST(CAProtocolMessage, CAParseURILongPath)
     size_t numCases = sizeof(cases) / sizeof(cases[0]);
 
 
-    coap_list_t *optlist = NULL;
+    CAOptionList_t optlist;
+    CAInitOptionList(&optlist);
     CAParseURI(sampleURI, &optlist);
 
 
-    verifyParsedOptions(cases, numCases, optlist);
-    coap_delete_list(optlist);
+    verifyParsedOptions(cases, numCases, &optlist);
+    CAClearOptionList(&optlist);
 }
 
 TEST(CAProtocolMessage, CAGetTokenFromPDU)
@@ -200,7 +206,8 @@ TEST(CAProtocolMessage, CAGetTokenFromPDU)
     tempRep.port = 5683;
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAInfo_t inData;
@@ -221,7 +228,7 @@ TEST(CAProtocolMessage, CAGetTokenFromPDU)
     EXPECT_EQ(CA_STATUS_OK, CAGetTokenFromPDU(pdu->transport_hdr, &outData, &tempRep));
 
     OICFree(outData.token);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
     coap_delete_pdu(pdu);
 }
 
@@ -234,7 +241,8 @@ TEST(CAProtocolMessage, CAGetInfoFromPDU)
     tempRep.port = 5683;
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAOptionList_t options;
+    CAInitOptionList(&options);
     coap_transport_t transport = COAP_UDP;
 
     CAInfo_t inData;
@@ -258,6 +266,209 @@ TEST(CAProtocolMessage, CAGetInfoFromPDU)
     EXPECT_EQ(CA_STATUS_OK, CAGetInfoFromPDU(pdu, &tempRep, &code, &outData));
 
     OICFree(outData.token);
-    coap_delete_list(options);
+    CAClearOptionList(&options);
+    coap_delete_pdu(pdu);
+}
+
+// Header options and URI segments end up sorted by number, segments in order,
+// also once the list no longer fits its inline storage.
+TEST(CAProtocolMessage, CAOptionListKeepsOptionsSorted)
+{
+    char sampleURI[] = "coap://[::]:5684/a/b/c/d/e/f/g/h/i/j/k/l/m/n/o/p?x=1&y=2";
+
+    CAHeaderOption_t headerOptions[2];
+    memset(headerOptions, 0, sizeof(headerOptions));
+    headerOptions[0].optionID = 2990;
+    headerOptions[0].optionLength = 9;
+    memcpy(headerOptions[0].optionData, "long data", 9);
+    headerOptions[1].optionID = COAP_OPTION_OBSERVE;
+    headerOptions[1].optionLength = 4;
+    // variable length integer, shrunk to its shortest encoding
+    headerOptions[1].optionData[3] = 1;
+
+    CAInfo_t info;
+    memset(&info, 0, sizeof(CAInfo_t));
+    info.options = headerOptions;
+    info.numOptions = 2;
+    info.payloadFormat = CA_FORMAT_APPLICATION_VND_OCF_CBOR;
+    info.payloadVersion = 2048;
+    info.acceptFormat = CA_FORMAT_UNDEFINED;
+
+    CAOptionList_t optlist;
+    CAInitOptionList(&optlist);
+    EXPECT_EQ(CA_STATUS_OK, CAParseURI(sampleURI, &optlist));
+    EXPECT_EQ(CA_STATUS_OK, CAParseHeadOption(CA_GET, &info, &optlist));
+
+    // port, observe, 16 path segments, content format, 2 queries, 2 custom
+    ASSERT_EQ(23u, optlist.count);
+    EXPECT_NE(optlist.inlineOptions, optlist.options);
+    for (size_t i = 1; i < optlist.count; i++)
+    {
+        EXPECT_LE(optlist.options[i - 1].key, optlist.options[i].key);
+    }
+
+    EXPECT_EQ(COAP_OPTION_OBSERVE, optlist.options[0].key);
+    EXPECT_EQ(1u, optlist.options[0].length);
+    EXPECT_EQ(1, CAGetOptionValue(&optlist.options[0])[0]);
+    EXPECT_EQ(COAP_OPTION_URI_PORT, optlist.options[1].key);
+    for (size_t i = 0; i < 16; i++)
+    {
+        EXPECT_EQ(COAP_OPTION_URI_PATH, optlist.options[2 + i].key);
+        EXPECT_EQ('a' + (int)i, CAGetOptionValue(&optlist.options[2 + i])[0]);
+    }
+    EXPECT_EQ(COAP_OPTION_CONTENT_FORMAT, optlist.options[18].key);
+    EXPECT_EQ(0, memcmp("x=1", CAGetOptionValue(&optlist.options[19]), 3));
+    EXPECT_EQ(0, memcmp("y=2", CAGetOptionValue(&optlist.options[20]), 3));
+    EXPECT_EQ(CA_OPTION_CONTENT_VERSION, optlist.options[21].key);
+    EXPECT_EQ(2990, optlist.options[22].key);
+    EXPECT_EQ((const uint8_t *)headerOptions[0].optionData, optlist.options[22].data);
+
+    CAClearOptionList(&optlist);
+    EXPECT_EQ(0u, optlist.count);
+    EXPECT_EQ(optlist.inlineOptions, optlist.options);
+}
+
+namespace {
+
+int OrderOptions(void *a, void *b)
+{
+    if (COAP_OPTION_KEY(*(coap_option *) a) < COAP_OPTION_KEY(*(coap_option *) b))
+    {
+        return -1;
+    }
+    return COAP_OPTION_KEY(*(coap_option *) a) == COAP_OPTION_KEY(*(coap_option *) b);
+}
+
+coap_pdu_t *NewPDU(const CAInfo_t *info)
+{
+    coap_pdu_t *pdu = coap_pdu_init(CA_MSG_NONCONFIRM, CA_GET, info->messageId,
+                                    COAP_MAX_PDU_SIZE);
+    coap_add_token(pdu, info->tokenLength, (const unsigned char *) info->token);
+    return pdu;
+}
+
+// Parses the options of info and writes them straight into a pdu.
+coap_pdu_t *EncodeWithOptionList(const CAInfo_t *info, const char *uri)
+{
+    CAOptionList_t optlist;
+    CAInitOptionList(&optlist);
+    CAParseURI(uri, &optlist);
+    CAParseHeadOption(CA_GET, info, &optlist);
+
+    coap_pdu_t *pdu = NewPDU(info);
+    CAWriteOptionListToPDU(pdu, &optlist, COAP_UDP);
+    coap_add_data(pdu, (unsigned int) info->payloadSize, (const unsigned char *) info->payload);
+    CAClearOptionList(&optlist);
+    return pdu;
+}
+
+// Same, but with one allocated list node per option sorted by coap_insert(),
+// as CAGeneratePDU used to do.
+coap_pdu_t *EncodeWithListNodes(const CAInfo_t *info, const char *uri)
+{
+    CAOptionList_t parsed;
+    CAInitOptionList(&parsed);
+    CAParseURI(uri, &parsed);
+    CAParseHeadOption(CA_GET, info, &parsed);
+
+    coap_list_t *optlist = NULL;
+    for (size_t i = 0; i < parsed.count; i++)
+    {
+        const CAOption_t *option = &parsed.options[i];
+        coap_option *node = (coap_option *) coap_malloc(sizeof(coap_option) + option->length + 1);
+        COAP_OPTION_KEY(*node) = option->key;
+        COAP_OPTION_LENGTH(*node) = option->length;
+        memcpy(COAP_OPTION_DATA(*node), CAGetOptionValue(option), option->length);
+        coap_insert(&optlist, coap_new_listnode(node, NULL), OrderOptions);
+    }
+
+    coap_pdu_t *pdu = NewPDU(info);
+    for (coap_list_t *opt = optlist; opt; opt = opt->next)
+    {
+        coap_add_option(pdu, COAP_OPTION_KEY(*(coap_option *) opt->data),
+                        COAP_OPTION_LENGTH(*(coap_option *) opt->data),
+                        COAP_OPTION_DATA(*(coap_option *) opt->data));
+    }
+    coap_add_data(pdu, (unsigned int) info->payloadSize, (const unsigned char *) info->payload);
+    coap_delete_list(optlist);
+    CAClearOptionList(&parsed);
+    return pdu;
+}
+
+} // namespace
+
+// Encoding and decoding a small notification, compared with building the
+// options as a list of allocated nodes first.
+TEST(CAProtocolMessage, PDUEncodeDecodeBenchmark)
+{
+    const int messages = 20000;
+    const char uri[] = "coap://[::]/a/light?if=oic.if.baseline";
+
+    CAEndpoint_t tempRep;
+    memset(&tempRep, 0, sizeof(CAEndpoint_t));
+    tempRep.flags = CA_DEFAULT_FLAGS;
+    tempRep.adapter = CA_ADAPTER_IP;
+    tempRep.port = 5683;
+
+    CAHeaderOption_t observe;
+    memset(&observe, 0, sizeof(observe));
+    observe.optionID = COAP_OPTION_OBSERVE;
+    observe.optionLength = 1;
+    observe.optionData[0] = 5;
+
+    uint8_t payload[24] = { 0xbf, 0x61, 0x76, 0x18, 0x2a, 0xff };
+    CAInfo_t inData;
+    memset(&inData, 0, sizeof(CAInfo_t));
+    inData.token = (CAToken_t)"token";
+    inData.tokenLength = 5;
+    inData.type = CA_MSG_NONCONFIRM;
+    inData.messageId = 1;
+    inData.options = &observe;
+    inData.numOptions = 1;
+    inData.payload = payload;
+    inData.payloadSize = sizeof(payload);
+    inData.payloadFormat = CA_FORMAT_APPLICATION_VND_OCF_CBOR;
+    inData.payloadVersion = 2048;
+    inData.acceptFormat = CA_FORMAT_UNDEFINED;
+
+    coap_pdu_t *pdu = EncodeWithOptionList(&inData, uri);
+    coap_pdu_t *listPdu = EncodeWithListNodes(&inData, uri);
+    ASSERT_EQ(listPdu->length, pdu->length);
+    EXPECT_EQ(0, memcmp(listPdu->transport_hdr, pdu->transport_hdr, pdu->length));
+    coap_delete_pdu(listPdu);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < messages; i++)
+    {
+        coap_delete_pdu(EncodeWithListNodes(&inData, uri));
+    }
+    auto listUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < messages; i++)
+    {
+        coap_delete_pdu(EncodeWithOptionList(&inData, uri));
+    }
+    auto encodeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < messages; i++)
+    {
+        uint32_t code = 0;
+        CAInfo_t outData;
+        ASSERT_EQ(CA_STATUS_OK, CAGetInfoFromPDU(pdu, &tempRep, &code, &outData));
+        OICFree(outData.options);
+        OICFree(outData.token);
+        OICFree(outData.payload);
+        OICFree(outData.resourceUri);
+    }
+    auto decodeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
     coap_delete_pdu(pdu);
+
+    std::cout << "[ BENCH    ] " << messages << " notifications: encode via list nodes "
+              << listUs << " us, via option list " << encodeUs << " us, decode "
+              << decodeUs << " us" << std::endl;
 }
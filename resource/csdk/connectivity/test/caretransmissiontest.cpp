@@ -0,0 +1,180 @@
+//******************************************************************
+//
+// Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <iostream>
+
+#include "caretransmission.h"
+#include "oic_malloc.h"
+#include "oic_time.h"
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+// Pending CON messages used by the ACK matching benchmark.
+#define BENCH_PENDING       5000
+#define RT_TIMEOUT_US       (10 * 1000 * 1000)
+
+static std::atomic<uint32_t> g_resent(0);
+static std::atomic<uint32_t> g_timedOut(0);
+
+static CAResult_t rtSend(const CAEndpoint_t * /*endpoint*/, const void * /*pdu*/,
+                         uint32_t /*size*/, CADataType_t /*dataType*/)
+{
+    g_resent++;
+    return CA_STATUS_OK;
+}
+
+static void rtTimeout(const CAEndpoint_t * /*endpoint*/, const void * /*pdu*/,
+                      uint32_t /*size*/)
+{
+    g_timedOut++;
+}
+
+// Minimal 4 byte CoAP header: version 1, no token.
+static void rtMakePdu(uint8_t *pdu, CAMessageType_t type, uint8_t code, uint16_t messageId)
+{
+    pdu[0] = (uint8_t)(0x40 | (type << 4));
+    pdu[1] = code;
+    pdu[2] = (uint8_t)(messageId >> 8);
+    pdu[3] = (uint8_t)(messageId & 0xFF);
+}
+
+class RetransmissionTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &threadPool));
+        endpoint = CAEndpoint_t();
+        endpoint.adapter = CA_ADAPTER_IP;
+        endpoint.flags = CA_IPV4;
+        g_resent = 0;
+        g_timedOut = 0;
+    }
+
+    virtual void TearDown()
+    {
+        ca_thread_pool_free(threadPool);
+    }
+
+    ca_thread_pool_t threadPool = NULL;
+    CAEndpoint_t endpoint;
+};
+
+TEST_F(RetransmissionTest, AckRemovesPendingMessage)
+{
+    CARetransmission_t context;
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionInitialize(&context, threadPool, rtSend,
+                                                       rtTimeout, NULL));
+
+    uint8_t con[4];
+    rtMakePdu(con, CA_MSG_CONFIRM, 1, 0x1234);
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionSentData(&context, &endpoint, CA_REQUEST_DATA,
+                                                     con, sizeof(con)));
+    EXPECT_EQ(CA_STATUS_FAILED, CARetransmissionSentData(&context, &endpoint, CA_REQUEST_DATA,
+                                                         con, sizeof(con)));
+    EXPECT_EQ(1u, u_arraylist_length(context.dataList));
+
+    // an ACK for another message id leaves the entry alone
+    uint8_t ack[4];
+    void *retransmissionPdu = NULL;
+    rtMakePdu(ack, CA_MSG_ACKNOWLEDGE, 0, 0x4321);
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionReceivedData(&context, &endpoint, ack, sizeof(ack),
+                                                         &retransmissionPdu));
+    EXPECT_EQ(1u, u_arraylist_length(context.dataList));
+    EXPECT_EQ(NULL, retransmissionPdu);
+
+    // an empty ACK removes it and hands back the original request
+    rtMakePdu(ack, CA_MSG_ACKNOWLEDGE, 0, 0x1234);
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionReceivedData(&context, &endpoint, ack, sizeof(ack),
+                                                         &retransmissionPdu));
+    EXPECT_EQ(0u, u_arraylist_length(context.dataList));
+    ASSERT_NE((void *)NULL, retransmissionPdu);
+    EXPECT_EQ(0, memcmp(con, retransmissionPdu, sizeof(con)));
+    OICFree(retransmissionPdu);
+
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionDestroy(&context));
+}
+
+TEST_F(RetransmissionTest, RetransmitsThenTimesOut)
+{
+    CARetransmission_t context;
+    CARetransmissionConfig_t config = { CA_ADAPTER_IP, 1 };
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionInitialize(&context, threadPool, rtSend,
+                                                       rtTimeout, &config));
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionStart(&context));
+
+    uint8_t con[4];
+    rtMakePdu(con, CA_MSG_CONFIRM, 1, 1);
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionSentData(&context, &endpoint, CA_REQUEST_DATA,
+                                                     con, sizeof(con)));
+
+    uint64_t deadline = OICGetCurrentTime(TIME_IN_US) + RT_TIMEOUT_US;
+    while (0 == g_timedOut && OICGetCurrentTime(TIME_IN_US) < deadline)
+    {
+        usleep(10 * 1000);
+    }
+
+    EXPECT_EQ(1u, g_resent);
+    EXPECT_EQ(1u, g_timedOut);
+
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionStop(&context));
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionDestroy(&context));
+}
+
+// Measures how long it takes to match ACKs against many pending CON messages.
+TEST_F(RetransmissionTest, AckMatchingBenchmark)
+{
+    CARetransmission_t context;
+    ASSERT_EQ(CA_STATUS_OK, CARetransmissionInitialize(&context, threadPool, rtSend,
+                                                       rtTimeout, NULL));
+
+    uint8_t pdu[4];
+    for (uint16_t i = 0; i < BENCH_PENDING; i++)
+    {
+        rtMakePdu(pdu, CA_MSG_CONFIRM, 1, i);
+        ASSERT_EQ(CA_STATUS_OK, CARetransmissionSentData(&context, &endpoint, CA_REQUEST_DATA,
+                                                         pdu, sizeof(pdu)));
+    }
+
+    // acknowledge newest first, the worst case for a linear scan
+    uint64_t start = OICGetCurrentTime(TIME_IN_US);
+    for (uint16_t i = BENCH_PENDING; i > 0; i--)
+    {
+        void *retransmissionPdu = NULL;
+        rtMakePdu(pdu, CA_MSG_ACKNOWLEDGE, 0, (uint16_t)(i - 1));
+        EXPECT_EQ(CA_STATUS_OK, CARetransmissionReceivedData(&context, &endpoint, pdu,
+                                                             sizeof(pdu), &retransmissionPdu));
+        OICFree(retransmissionPdu);
+    }
+    uint64_t elapsed = OICGetCurrentTime(TIME_IN_US) - start;
+
+    EXPECT_EQ(0u, u_arraylist_length(context.dataList));
+
+    std::cout << "[ BENCH    ] Retransmission ACK matching: " << BENCH_PENDING
+              << " ACKs in " << elapsed << " us" << std::endl;
+
+    EXPECT_EQ(CA_STATUS_OK, CARetransmissionDestroy(&context));
+}
@@ -0,0 +1,188 @@
+//******************************************************************
+//
+// Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "iotivity_config.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "catcpinterface.h"
+#include "cathreadpool.h"
+#include "oic_time.h"
+
+// Number of loopback sessions opened per run. Scaled down when the process
+// may not open that many descriptors (each session needs two) or when the
+// adapter is built without epoll.
+#define LOAD_SESSIONS       10000
+#define LOAD_RESERVED_FDS   64
+#define LOAD_TIMEOUT_US     (30 * 1000 * 1000)
+
+static std::atomic<uint32_t> g_connected(0);
+static std::atomic<uint32_t> g_received(0);
+
+static void loadConnectionChanged(const CAEndpoint_t * /*endpoint*/, bool isConnected,
+                                  bool /*isClient*/)
+{
+    if (isConnected)
+    {
+        g_connected++;
+    }
+}
+
+static void loadPacketReceived(const CASecureEndpoint_t * /*sep*/,
+                               const void * /*data*/, size_t /*dataLength*/)
+{
+    g_received++;
+}
+
+static uint32_t loadSessionCount()
+{
+    struct rlimit rl;
+    if (0 != getrlimit(RLIMIT_NOFILE, &rl))
+    {
+        return 0;
+    }
+    if (rl.rlim_cur < rl.rlim_max)
+    {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+        getrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    rlim_t available = (rl.rlim_cur > LOAD_RESERVED_FDS) ? (rl.rlim_cur - LOAD_RESERVED_FDS) : 0;
+#if !defined(WITH_EPOLL) || !defined(HAVE_SYS_EPOLL_H)
+    // select() cannot watch descriptors beyond FD_SETSIZE.
+    available = std::min<rlim_t>(available, FD_SETSIZE - LOAD_RESERVED_FDS);
+#endif
+    return (uint32_t)std::min<rlim_t>(LOAD_SESSIONS, available / 2);
+}
+
+static bool waitFor(std::atomic<uint32_t> &counter, uint32_t expected, uint64_t deadline)
+{
+    while (counter < expected)
+    {
+        if (OICGetCurrentTime(TIME_IN_US) >= deadline)
+        {
+            return false;
+        }
+        usleep(1000);
+    }
+    return true;
+}
+
+// Opens many sessions to the TCP adapter and sends one message on each,
+// measuring how fast the receive thread accepts and dispatches them.
+// Build with WITH_EPOLL=0 and WITH_EPOLL=1 to compare select()/epoll().
+TEST(TCPServerTest, ManySessionsLoad)
+{
+    uint32_t sessions = loadSessionCount();
+    ASSERT_LT(0u, sessions);
+
+    ca_thread_pool_t threadPool = NULL;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &threadPool));
+
+    caglobals.tcp.ipv4.fd = OC_INVALID_SOCKET;
+    caglobals.tcp.ipv4s.fd = OC_INVALID_SOCKET;
+    caglobals.tcp.ipv6.fd = OC_INVALID_SOCKET;
+    caglobals.tcp.ipv6s.fd = OC_INVALID_SOCKET;
+    caglobals.tcp.ipv4.port = 0;
+    caglobals.tcp.ipv4s.port = 0;
+    caglobals.tcp.ipv6.port = 0;
+    caglobals.tcp.ipv6s.port = 0;
+    caglobals.tcp.ipv4tcpenabled = true;
+    caglobals.tcp.ipv6tcpenabled = false;
+    caglobals.tcp.selectTimeout = 1;
+    caglobals.tcp.listenBacklog = SOMAXCONN;
+    g_connected = 0;
+    g_received = 0;
+    CATCPSetConnectionChangedCallback(loadConnectionChanged);
+    CATCPSetPacketReceiveCallback(loadPacketReceived);
+    ASSERT_EQ(CA_STATUS_OK, CATCPStartServer(threadPool));
+
+    struct sockaddr_in to = sockaddr_in();
+    to.sin_family = AF_INET;
+    to.sin_port = htons(caglobals.tcp.ipv4.port);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    std::vector<int> fds;
+    fds.reserve(sessions);
+
+    uint64_t start = OICGetCurrentTime(TIME_IN_US);
+    uint64_t deadline = start + LOAD_TIMEOUT_US;
+
+    for (uint32_t i = 0; i < sessions; i++)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (-1 == fd)
+        {
+            break;
+        }
+        if (0 != connect(fd, (struct sockaddr *)&to, sizeof(to)))
+        {
+            close(fd);
+            break;
+        }
+        fds.push_back(fd);
+    }
+    EXPECT_EQ(sessions, fds.size());
+
+    bool accepted = waitFor(g_connected, fds.size(), deadline);
+    uint64_t acceptElapsed = OICGetCurrentTime(TIME_IN_US) - start;
+
+    const char payload[] = "load";
+    uint64_t sendStart = OICGetCurrentTime(TIME_IN_US);
+    for (size_t i = 0; i < fds.size(); i++)
+    {
+        EXPECT_EQ((ssize_t)sizeof(payload), send(fds[i], payload, sizeof(payload), 0));
+    }
+    bool dispatched = waitFor(g_received, fds.size(), deadline);
+    uint64_t sendElapsed = OICGetCurrentTime(TIME_IN_US) - sendStart;
+
+    uint32_t connected = g_connected;
+    uint32_t received = g_received;
+
+    for (size_t i = 0; i < fds.size(); i++)
+    {
+        close(fds[i]);
+    }
+    CATCPStopServer();
+    CATCPSetPacketReceiveCallback(NULL);
+    CATCPSetConnectionChangedCallback(NULL);
+    ca_thread_pool_free(threadPool);
+
+    std::cout << "[ BENCH    ] TCP accept: " << connected << " sessions in "
+              << acceptElapsed << " us" << std::endl;
+    std::cout << "[ BENCH    ] TCP dispatch: " << received << " messages in "
+              << sendElapsed << " us ("
+              << (sendElapsed ? (received * 1000000ULL / sendElapsed) : 0)
+              << " messages/sec)" << std::endl;
+
+    EXPECT_TRUE(accepted);
+    EXPECT_TRUE(dispatched);
+    EXPECT_EQ(fds.size(), received);
+}
@@ -39,6 +39,12 @@
 #include "octhread.h"
 #include <cathreadpool.h>
 
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
 #ifdef HAVE_TIME_H
 #include <time.h>
 #endif
@@ -542,3 +548,155 @@ TEST(ConditionTests, TC_07_WAITDURATION)
 
     oc_cond_free(sharedCond);
 }
+
+static void countFunc(void *data)
+{
+    (*(std::atomic<int> *)data)++;
+}
+
+static void *countThreadFunc(void *data)
+{
+    countFunc(data);
+    return NULL;
+}
+
+static bool waitForCount(std::atomic<int> &count, int expected)
+{
+    uint64_t end = getAbsTime() + 5 * USECS_PER_SEC;
+    while ((count < expected) && (getAbsTime() < end))
+    {
+        std::this_thread::yield();
+    }
+    return (count >= expected);
+}
+
+TEST(ThreadPoolTests, RunsQueuedTasks)
+{
+    ca_thread_pool_t pool;
+    std::atomic<int> count(0);
+    const int tasks = 1000;
+
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &pool));
+    for (int i = 0; i < tasks; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, countFunc, &count));
+    }
+    EXPECT_TRUE(waitForCount(count, tasks));
+
+    ca_thread_pool_stats_t stats;
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_get_stats(pool, &stats));
+    EXPECT_EQ((uint64_t)tasks, stats.tasksQueued);
+    EXPECT_GE(2u, stats.threads);
+
+    ca_thread_pool_free(pool);
+}
+
+static std::atomic<int> g_blockingTaskRan(0);
+
+// Long-lived task, such as an adapter's receive loop, which keeps its worker
+// until another task has run.
+static void waitForCountFunc(void *data)
+{
+    waitForCount(*(std::atomic<int> *)data, 1);
+    g_blockingTaskRan++;
+}
+
+TEST(ThreadPoolTests, SecondTaskDoesNotWaitForLongTask)
+{
+    ca_thread_pool_t pool;
+    std::atomic<int> warmUp(0);
+    std::atomic<int> count(0);
+    g_blockingTaskRan = 0;
+
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &pool));
+
+    // Leave one idle worker behind.
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, countFunc, &warmUp));
+    EXPECT_TRUE(waitForCount(warmUp, 1));
+
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, waitForCountFunc, &count));
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, countFunc, &count));
+
+    EXPECT_TRUE(waitForCount(count, 1));
+    EXPECT_TRUE(waitForCount(g_blockingTaskRan, 1));
+    ca_thread_pool_free(pool);
+}
+
+static void sleepFunc(void * /*data*/)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+}
+
+TEST(ThreadPoolTests, FreeDiscardsQueuedTasks)
+{
+    ca_thread_pool_t pool;
+    std::atomic<int> count(0);
+
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, sleepFunc, NULL));
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, countFunc, &count));
+    }
+
+    ca_thread_pool_free(pool);
+    EXPECT_EQ(0, count);
+}
+
+TEST(ThreadPoolTests, InvalidParams)
+{
+    ca_thread_pool_t pool;
+    ca_thread_pool_stats_t stats;
+
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, ca_thread_pool_init(0, &pool));
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, ca_thread_pool_add_task(pool, NULL, NULL));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, ca_thread_pool_get_stats(pool, NULL));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, ca_thread_pool_get_stats(NULL, &stats));
+    ca_thread_pool_free(pool);
+}
+
+// Time to run short tasks on the pool compared with starting a thread for each,
+// which is what the pool used to do.
+TEST(ThreadPoolTests, DispatchLatencyBenchmark)
+{
+    const int tasks = 5000;
+    std::atomic<int> count(0);
+
+    std::vector<oc_thread> threads(tasks);
+    uint64_t beg = getAbsTime();
+    for (int i = 0; i < tasks; i++)
+    {
+        ASSERT_EQ(OC_THREAD_SUCCESS, oc_thread_new(&threads[i], countThreadFunc, &count));
+    }
+    for (int i = 0; i < tasks; i++)
+    {
+        oc_thread_wait(threads[i]);
+        oc_thread_free(threads[i]);
+    }
+    uint64_t threadUs = getAbsTime() - beg;
+
+    ca_thread_pool_t pool;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(4, &pool));
+    count = 0;
+    beg = getAbsTime();
+    for (int i = 0; i < tasks; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, countFunc, &count));
+    }
+    while (count < tasks)
+    {
+        std::this_thread::yield();
+    }
+    uint64_t poolUs = getAbsTime() - beg;
+
+    ca_thread_pool_stats_t stats;
+    EXPECT_EQ(CA_STATUS_OK, ca_thread_pool_get_stats(pool, &stats));
+    ca_thread_pool_free(pool);
+
+    std::cout << "[ BENCH    ] " << tasks << " tasks: thread per task " << threadUs
+              << " us, pool " << poolUs << " us (" << stats.threads << " threads, avg dispatch "
+              << stats.totalDispatchLatencyUs / tasks << " us, max queue "
+              << stats.maxQueueLength << ")" << std::endl;
+    EXPECT_EQ((uint64_t)tasks, stats.tasksCompleted);
+}
@@ -27,6 +27,10 @@
 #include "iotivity_config.h"
 #include <gtest/gtest.h>
 #include "time.h"
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <vector>
 #include "octypes.h"
 #ifdef HAVE_WINSOCK2_H
 #include <winsock2.h>
@@ -1899,7 +1903,7 @@ static void * test0CAinitiateSslHandshake(void * arg)
     g_sslContextMutex = oc_mutex_new_recursive();
     oc_mutex_lock(g_sslContextMutex);
     g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
-    g_caSslContext->peerList = u_arraylist_create();
+    mbedtls_ssl_cache_init(&g_caSslContext->sessionCache);
     mbedtls_entropy_init(&g_caSslContext->entropy);
     mbedtls_ctr_drbg_init(&g_caSslContext->rnd);
     mbedtls_ctr_drbg_seed(&g_caSslContext->rnd, mbedtls_entropy_func_clutch,
@@ -2965,7 +2969,7 @@ TEST(TLSAdapter, Test_11)
     g_sslContextMutex = oc_mutex_new_recursive();
     oc_mutex_lock(g_sslContextMutex);
     g_caSslContext = (SslContext_t *)OICCalloc(1, sizeof(SslContext_t));
-    g_caSslContext->peerList = u_arraylist_create();
+    mbedtls_ssl_cache_init(&g_caSslContext->sessionCache);
     mbedtls_entropy_init(&g_caSslContext->entropy);
     mbedtls_ctr_drbg_init(&g_caSslContext->rnd);
     mbedtls_ctr_drbg_seed(&g_caSslContext->rnd, mbedtls_entropy_func_clutch,
@@ -3055,3 +3059,306 @@ TEST(TLSAdapter, TestCertsValid)
     EXPECT_EQ(0, ret) << "Failed to parse CA cert";
     mbedtls_x509_crt_free(&cert);
 }
+
+/* **************************
+ *
+ *
+ * Session resumption test
+ *
+ *
+ * *************************/
+
+#define LOOPBACK_CLIENT_PORT 40000
+
+struct LoopbackRecord
+{
+    uint16_t port;
+    std::vector<uint8_t> data;
+};
+
+static std::deque<LoopbackRecord> g_loopback;
+static int g_loopbackHandshakes = 0;
+
+static ssize_t LoopbackSendCB(CAEndpoint_t *endpoint, const void *buf, size_t buflen)
+{
+    const uint8_t *data = (const uint8_t *)buf;
+    g_loopback.push_back(LoopbackRecord { endpoint->port, std::vector<uint8_t>(data, data + buflen) });
+    return (ssize_t)buflen;
+}
+
+static void LoopbackReceivedCB(const CASecureEndpoint_t *, const void *, size_t)
+{
+}
+
+static void LoopbackErrorCB(const CAEndpoint_t *, const void *, size_t, CAResult_t)
+{
+}
+
+static CAResult_t LoopbackHandshakeCB(const CAEndpoint_t *, const CAErrorInfo_t *info)
+{
+    if (CA_STATUS_OK == info->result)
+    {
+        g_loopbackHandshakes++;
+    }
+    return CA_STATUS_OK;
+}
+
+// The test certificates have expired, which is not what these tests are about.
+static int IgnoreExpiry(void *, mbedtls_x509_crt *, int, uint32_t *flags)
+{
+    *flags &= ~(MBEDTLS_X509_BADCERT_EXPIRED);
+    return 0;
+}
+
+static void MakeLoopbackEndpoint(CASecureEndpoint_t *sep, uint16_t port)
+{
+    memset(sep, 0, sizeof(*sep));
+    sep->endpoint.adapter = CA_ADAPTER_TCP;
+    sep->endpoint.flags = CA_SECURE;
+    sep->endpoint.port = port;
+    strcpy(sep->endpoint.addr, "127.0.0.1");
+}
+
+static void LoopbackInit()
+{
+    ASSERT_EQ(CA_STATUS_OK, CAinitSslAdapter());
+    CAsetSslAdapterCallbacks(LoopbackReceivedCB, LoopbackSendCB, LoopbackErrorCB, CA_ADAPTER_TCP);
+    CAsetSslHandshakeCallback(LoopbackHandshakeCB);
+    CAsetPkixInfoCallback(infoCallback_that_loads_x509);
+    CAsetCredentialTypesCallback(clutch);
+    mbedtls_ssl_conf_verify(&g_caSslContext->clientTlsConf, IgnoreExpiry, NULL);
+    mbedtls_ssl_conf_verify(&g_caSslContext->serverTlsConf, IgnoreExpiry, NULL);
+}
+
+static void LoopbackDeinit()
+{
+    CAsetSslHandshakeCallback(NULL);
+    CAdeinitSslAdapter();
+    g_loopback.clear();
+}
+
+// Runs a handshake between the client and the server side of the adapter, passing
+// records between them in memory. Returns whether both sides completed it.
+static bool LoopbackHandshake(const CASecureEndpoint_t *server, const CASecureEndpoint_t *client)
+{
+    int handshakes = g_loopbackHandshakes;
+    if (CA_STATUS_OK != CAinitiateSslHandshake(&server->endpoint))
+    {
+        return false;
+    }
+    while (!g_loopback.empty())
+    {
+        LoopbackRecord record = g_loopback.front();
+        g_loopback.pop_front();
+        // Records sent to the server came from the client and the other way round.
+        const CASecureEndpoint_t *from = (server->endpoint.port == record.port) ? client : server;
+        CAdecryptSsl(from, record.data.data(), record.data.size());
+    }
+    return (handshakes + 2 == g_loopbackHandshakes);
+}
+
+static void LoopbackClose(const CASecureEndpoint_t *server, const CASecureEndpoint_t *client)
+{
+    CAcloseSslConnection(&server->endpoint);
+    CAcloseSslConnection(&client->endpoint);
+    g_loopback.clear();
+}
+
+static bool IsResumed(const CAEndpoint_t *peer)
+{
+    oc_mutex_lock(g_sslContextMutex);
+    SslEndPoint_t *tep = GetSslPeer(peer);
+    bool resumed = (NULL != tep && tep->resumed);
+    oc_mutex_unlock(g_sslContextMutex);
+    return resumed;
+}
+
+TEST(TLSAdapter, SessionResumption)
+{
+    CASecureEndpoint_t server;
+    CASecureEndpoint_t client;
+    MakeLoopbackEndpoint(&server, SERVER_PORT);
+    MakeLoopbackEndpoint(&client, LOOPBACK_CLIENT_PORT);
+    LoopbackInit();
+
+    EXPECT_TRUE(LoopbackHandshake(&server, &client));
+    EXPECT_FALSE(IsResumed(&server.endpoint));
+    EXPECT_FALSE(IsResumed(&client.endpoint));
+    LoopbackClose(&server, &client);
+
+    // Both the client and the server side pick up the session of the first handshake.
+    EXPECT_TRUE(LoopbackHandshake(&server, &client));
+    EXPECT_TRUE(IsResumed(&server.endpoint));
+    EXPECT_TRUE(IsResumed(&client.endpoint));
+
+    // The handshake random the owner PSK is derived from is not exchanged again.
+    uint8_t label[] = {0x01, 0x02, 0x03, 0x04};
+    uint8_t ownerPsk[16];
+    EXPECT_NE(CA_STATUS_OK, CAsslGenerateOwnerPsk(&server.endpoint, label, sizeof(label),
+                                                  label, sizeof(label), label, sizeof(label),
+                                                  ownerPsk, sizeof(ownerPsk)));
+    LoopbackClose(&server, &client);
+
+    // A preferred ciphersuite, as selected for ownership transfer, takes a full handshake.
+    EXPECT_EQ(CA_STATUS_OK, CAsetTlsCipherSuite(MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_CBC_SHA256));
+    EXPECT_TRUE(LoopbackHandshake(&server, &client));
+    EXPECT_FALSE(IsResumed(&server.endpoint));
+    LoopbackClose(&server, &client);
+
+    LoopbackDeinit();
+}
+
+TEST(TLSAdapter, NoResumptionAfterCredentialChange)
+{
+    CASecureEndpoint_t server;
+    CASecureEndpoint_t client;
+    MakeLoopbackEndpoint(&server, SERVER_PORT);
+    MakeLoopbackEndpoint(&client, LOOPBACK_CLIENT_PORT);
+    LoopbackInit();
+
+    EXPECT_TRUE(LoopbackHandshake(&server, &client));
+    LoopbackClose(&server, &client);
+
+    // Removing a cred or updating the CRL invalidates the PKIX info.
+    CAinvalidatePkixInfo();
+
+    // Neither side may skip the chain and CRL checks of the new credentials.
+    EXPECT_TRUE(LoopbackHandshake(&server, &client));
+    EXPECT_FALSE(IsResumed(&server.endpoint));
+    EXPECT_FALSE(IsResumed(&client.endpoint));
+    LoopbackClose(&server, &client);
+
+    // Sessions established after the change are resumable again.
+    EXPECT_TRUE(LoopbackHandshake(&server, &client));
+    EXPECT_TRUE(IsResumed(&server.endpoint));
+    LoopbackClose(&server, &client);
+
+    LoopbackDeinit();
+}
+
+// Full handshakes compared with resumed ones between both sides of the adapter.
+TEST(TLSAdapter, SessionResumptionBenchmark)
+{
+    const int rounds = 50;
+    CASecureEndpoint_t server;
+    CASecureEndpoint_t client;
+    MakeLoopbackEndpoint(&server, SERVER_PORT);
+    MakeLoopbackEndpoint(&client, LOOPBACK_CLIENT_PORT);
+    LoopbackInit();
+
+    int completed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++)
+    {
+        oc_mutex_lock(g_sslContextMutex);
+        DeleteSavedSessions();
+        oc_mutex_unlock(g_sslContextMutex);
+        completed += LoopbackHandshake(&server, &client) ? 1 : 0;
+        LoopbackClose(&server, &client);
+    }
+    auto fullUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++)
+    {
+        completed += LoopbackHandshake(&server, &client) ? 1 : 0;
+        LoopbackClose(&server, &client);
+    }
+    auto resumedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+    LoopbackDeinit();
+
+    std::cout << "[ BENCH    ] " << rounds << " handshakes: full " << fullUs
+              << " us, resumed " << resumedUs << " us" << std::endl;
+    EXPECT_EQ(2 * rounds, completed);
+}
+
+static int g_pkixInfoCalls = 0;
+
+static void CountingPkixInfoCallback(PkiInfo_t *inf)
+{
+    g_pkixInfoCalls++;
+    infoCallback_that_loads_x509(inf);
+}
+
+TEST(TLSAdapter, PkixInfoCache)
+{
+    CASecureEndpoint_t server;
+    CASecureEndpoint_t client;
+    MakeLoopbackEndpoint(&server, SERVER_PORT);
+    MakeLoopbackEndpoint(&client, LOOPBACK_CLIENT_PORT);
+    LoopbackInit();
+    CAsetPkixInfoCallback(CountingPkixInfoCallback);
+    g_pkixInfoCalls = 0;
+
+    // The client and the server side share what was parsed for the first handshake.
+    EXPECT_TRUE(LoopbackHandshake(&server, &client));
+    EXPECT_EQ(1, g_pkixInfoCalls);
+    LoopbackClose(&server, &client);
+
+    oc_mutex_lock(g_sslContextMutex);
+    DeleteSavedSessions();
+    oc_mutex_unlock(g_sslContextMutex);
+    EXPECT_TRUE(LoopbackHandshake(&server, &client));
+    EXPECT_EQ(1, g_pkixInfoCalls);
+    LoopbackClose(&server, &client);
+
+    // Once the info changed it is loaded again, and still good for a full handshake.
+    CAinvalidatePkixInfo();
+    oc_mutex_lock(g_sslContextMutex);
+    DeleteSavedSessions();
+    oc_mutex_unlock(g_sslContextMutex);
+    EXPECT_TRUE(LoopbackHandshake(&server, &client));
+    EXPECT_FALSE(IsResumed(&server.endpoint));
+    EXPECT_EQ(2, g_pkixInfoCalls);
+    LoopbackClose(&server, &client);
+
+    // So is a callback registered in place of the previous one.
+    CAsetPkixInfoCallback(infoCallback_that_loads_x509);
+    EXPECT_TRUE(LoopbackHandshake(&server, &client));
+    EXPECT_EQ(2, g_pkixInfoCalls);
+    LoopbackClose(&server, &client);
+
+    LoopbackDeinit();
+}
+
+// Full handshakes loading the PKIX info each time, as if it changed before every one of
+// them, compared with full handshakes using what was parsed before.
+TEST(TLSAdapter, PkixInfoCacheBenchmark)
+{
+    const int rounds = 50;
+    CASecureEndpoint_t server;
+    CASecureEndpoint_t client;
+    MakeLoopbackEndpoint(&server, SERVER_PORT);
+    MakeLoopbackEndpoint(&client, LOOPBACK_CLIENT_PORT);
+    LoopbackInit();
+
+    int completed = 0;
+    std::chrono::microseconds::rep us[2] = { 0, 0 };
+    for (int cached = 0; cached < 2; cached++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++)
+        {
+            if (!cached)
+            {
+                CAinvalidatePkixInfo();
+            }
+            oc_mutex_lock(g_sslContextMutex);
+            DeleteSavedSessions();
+            oc_mutex_unlock(g_sslContextMutex);
+            completed += LoopbackHandshake(&server, &client) ? 1 : 0;
+            LoopbackClose(&server, &client);
+        }
+        us[cached] = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+
+    LoopbackDeinit();
+
+    std::cout << "[ BENCH    ] " << rounds << " full handshakes: PKIX info loaded each time "
+              << us[0] << " us, cached " << us[1] << " us" << std::endl;
+    EXPECT_EQ(2 * rounds, completed);
+}
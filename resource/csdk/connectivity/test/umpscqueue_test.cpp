@@ -0,0 +1,300 @@
+//******************************************************************
+//
+// Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+
+#include "umpscqueue.h"
+#include "caqueueingthread.h"
+#include "cathreadpool.h"
+#include "oic_malloc.h"
+#include "oic_time.h"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static const int PRODUCERS = 4;
+static const int MESSAGES_PER_PRODUCER = 50000;
+
+TEST(UMpscQueue, Base)
+{
+    u_mpsc_queue_t *queue = u_mpsc_queue_create();
+    ASSERT_TRUE(queue != NULL);
+
+    EXPECT_EQ(0u, u_mpsc_queue_get_size(queue));
+    EXPECT_TRUE(NULL == u_mpsc_queue_get_element(queue));
+
+    EXPECT_EQ(CA_STATUS_OK, u_mpsc_queue_delete(queue));
+}
+
+TEST(UMpscQueue, FirstInFirstOut)
+{
+    u_mpsc_queue_t *queue = u_mpsc_queue_create();
+    ASSERT_TRUE(queue != NULL);
+
+    int data[10];
+    for (int round = 0; round < 3; round++)
+    {
+        for (int i = 0; i < 10; i++)
+        {
+            EXPECT_EQ(CA_STATUS_OK, u_mpsc_queue_add_element(queue, &data[i], i + 1));
+        }
+        EXPECT_EQ(10u, u_mpsc_queue_get_size(queue));
+
+        for (int i = 0; i < 10; i++)
+        {
+            u_queue_message_t *message = u_mpsc_queue_get_element(queue);
+            ASSERT_TRUE(message != NULL);
+            EXPECT_EQ(&data[i], message->msg);
+            EXPECT_EQ((uint32_t)i + 1, message->size);
+            OICFree(message);
+        }
+        EXPECT_EQ(0u, u_mpsc_queue_get_size(queue));
+        EXPECT_TRUE(NULL == u_mpsc_queue_get_element(queue));
+    }
+
+    // Elements left behind are released by delete.
+    EXPECT_EQ(CA_STATUS_OK, u_mpsc_queue_add_element(queue, &data[0], 1));
+    EXPECT_EQ(CA_STATUS_OK, u_mpsc_queue_delete(queue));
+}
+
+TEST(UMpscQueue, ConcurrentProducersKeepTheirOrder)
+{
+    u_mpsc_queue_t *queue = u_mpsc_queue_create();
+    ASSERT_TRUE(queue != NULL);
+
+    std::vector<std::thread> producers;
+    for (intptr_t p = 0; p < PRODUCERS; p++)
+    {
+        producers.push_back(std::thread([queue, p]
+        {
+            for (uint32_t i = 1; i <= MESSAGES_PER_PRODUCER; i++)
+            {
+                u_mpsc_queue_add_element(queue, (void *)p, i);
+            }
+        }));
+    }
+
+    uint32_t last[PRODUCERS] = { 0 };
+    int received = 0;
+    while (received < PRODUCERS * MESSAGES_PER_PRODUCER)
+    {
+        u_queue_message_t *message = u_mpsc_queue_get_element(queue);
+        if (NULL == message)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        intptr_t p = (intptr_t)message->msg;
+        EXPECT_EQ(last[p] + 1, message->size);
+        last[p] = message->size;
+        OICFree(message);
+        received++;
+    }
+
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+    EXPECT_EQ(0u, u_mpsc_queue_get_size(queue));
+    EXPECT_EQ(CA_STATUS_OK, u_mpsc_queue_delete(queue));
+}
+
+static std::atomic<int> g_processed(0);
+
+static void CountTask(void *)
+{
+    g_processed++;
+}
+
+static void NoDestroy(void *, uint32_t)
+{
+}
+
+static std::atomic<int> g_destroyed(0);
+static std::atomic<int> g_batches(0);
+static std::atomic<bool> g_batchDoneAfterDestroy(false);
+
+static void CountDestroy(void *, uint32_t)
+{
+    g_destroyed++;
+}
+
+static void CheckBatchDone()
+{
+    // Data of the batch just processed must still be alive.
+    if (g_destroyed >= g_processed)
+    {
+        g_batchDoneAfterDestroy = true;
+    }
+    g_batches++;
+}
+
+TEST(UMpscQueue, QueueingThreadBatchDoneRunsBeforeDestroy)
+{
+    static int data;
+    ca_thread_pool_t pool;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &pool));
+
+    g_processed = 0;
+    g_destroyed = 0;
+    g_batches = 0;
+    g_batchDoneAfterDestroy = false;
+
+    CAQueueingThread_t thread;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadInitialize(&thread, pool, CountTask, CountDestroy));
+    EXPECT_EQ(CA_STATUS_INVALID_PARAM, CAQueueingThreadSetBatchDone(NULL, CheckBatchDone));
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadSetBatchDone(&thread, CheckBatchDone));
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadStart(&thread));
+
+    const int total = 1000;
+    for (int i = 0; i < total; i++)
+    {
+        CAQueueingThreadAddData(&thread, &data, sizeof(data));
+    }
+    while (g_destroyed < total)
+    {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadStop(&thread));
+    ca_thread_pool_free(pool);
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadDestroy(&thread));
+
+    EXPECT_EQ(total, g_processed);
+    EXPECT_LT(0, g_batches);
+    EXPECT_GE(total, g_batches);
+    EXPECT_FALSE(g_batchDoneAfterDestroy);
+}
+
+// The mutex, condition and u_queue_t handoff CAQueueingThread used before.
+struct LockedQueue
+{
+    oc_mutex mutex;
+    oc_cond cond;
+    u_queue_t *queue;
+    bool stop;
+};
+
+static void LockedQueueConsumer(void *data)
+{
+    LockedQueue *q = (LockedQueue *)data;
+    oc_mutex_lock(q->mutex);
+    while (!q->stop)
+    {
+        if (0 == u_queue_get_size(q->queue))
+        {
+            oc_cond_wait(q->cond, q->mutex);
+            continue;
+        }
+        u_queue_message_t *message = u_queue_get_element(q->queue);
+        oc_mutex_unlock(q->mutex);
+        CountTask(message->msg);
+        OICFree(message);
+        oc_mutex_lock(q->mutex);
+    }
+    oc_mutex_unlock(q->mutex);
+}
+
+static void LockedQueueAdd(LockedQueue *q, void *data)
+{
+    u_queue_message_t *message = (u_queue_message_t *)OICMalloc(sizeof(u_queue_message_t));
+    message->msg = data;
+    message->size = 1;
+    oc_mutex_lock(q->mutex);
+    u_queue_add_element(q->queue, message);
+    oc_cond_signal(q->cond);
+    oc_mutex_unlock(q->mutex);
+}
+
+template <typename Add>
+static uint64_t RunProducers(Add add)
+{
+    const int total = PRODUCERS * MESSAGES_PER_PRODUCER;
+    g_processed = 0;
+
+    uint64_t start = OICGetCurrentTime(TIME_IN_US);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        producers.push_back(std::thread([&add]
+        {
+            for (int i = 0; i < MESSAGES_PER_PRODUCER; i++)
+            {
+                add();
+            }
+        }));
+    }
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+    while (g_processed < total)
+    {
+        std::this_thread::yield();
+    }
+    return OICGetCurrentTime(TIME_IN_US) - start;
+}
+
+// Messages through a queueing thread from several producers, compared with the
+// locked u_queue_t handoff it replaced.
+TEST(UMpscQueue, QueueingThreadThroughputBenchmark)
+{
+    static int data;
+    ca_thread_pool_t pool;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(2, &pool));
+
+    LockedQueue locked;
+    locked.mutex = oc_mutex_new();
+    locked.cond = oc_cond_new();
+    locked.queue = u_queue_create();
+    locked.stop = false;
+    ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_add_task(pool, LockedQueueConsumer, &locked));
+
+    uint64_t lockedUs = RunProducers([&locked] { LockedQueueAdd(&locked, &data); });
+
+    oc_mutex_lock(locked.mutex);
+    locked.stop = true;
+    oc_cond_signal(locked.cond);
+    oc_mutex_unlock(locked.mutex);
+
+    CAQueueingThread_t thread;
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadInitialize(&thread, pool, CountTask, NoDestroy));
+    ASSERT_EQ(CA_STATUS_OK, CAQueueingThreadStart(&thread));
+
+    uint64_t mpscUs = RunProducers([&thread] {
+        CAQueueingThreadAddData(&thread, &data, sizeof(data));
+    });
+
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadStop(&thread));
+    ca_thread_pool_free(pool);
+    EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadDestroy(&thread));
+
+    u_queue_delete(locked.queue);
+    oc_cond_free(locked.cond);
+    oc_mutex_free(locked.mutex);
+
+    int total = PRODUCERS * MESSAGES_PER_PRODUCER;
+    std::cout << "[ BENCH    ] " << total << " messages from " << PRODUCERS
+              << " producers: locked u_queue " << lockedUs << " us, queueing thread "
+              << mpscUs << " us" << std::endl;
+    EXPECT_EQ(total, g_processed);
+}
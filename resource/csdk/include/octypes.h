@@ -1209,6 +1209,14 @@ typedef struct {
 
     /** Persistent storage unlink handler.*/
     int (* unlink)(const char *path);
+
+    /**
+     * Set to true when open and unlink keep the files named "<database>.log" and
+     * "<database>.tmp" next to the database they are derived from. SVR updates are
+     * then journaled instead of rewriting the whole database; credential updates
+     * still rewrite it, so that replaced keys are not left behind in the journal.
+     */
+    bool journal;
 } OCPersistentStorage;
 
 /**
@@ -1519,6 +1527,9 @@ typedef struct OCRepPayloadValue
 
 } OCRepPayloadValue;
 
+/** Private lookup index of OCRepPayload::values, see ocpayload.c. */
+struct OCRepPayloadValueIndex;
+
 // used for get/set/put/observe/etc representations
 typedef struct OCRepPayload
 {
@@ -1528,6 +1539,8 @@ typedef struct OCRepPayload
     OCStringLL* interfaces;
     OCRepPayloadValue* values;
     struct OCRepPayload* next;
+    /** Built by the OCRepPayloadSet* functions once values is long, NULL otherwise. */
+    struct OCRepPayloadValueIndex* valueIndex;
 } OCRepPayload;
 
 // used inside a resource payload
@@ -88,6 +88,120 @@ static sqlite3 *gRDDB = NULL;
     "FOREIGN KEY("XSTR(LINK_ID)") REFERENCES RD_DEVICE_LINK_LIST("XSTR(OC_RSRVD_INS)") " \
     "ON DELETE CASCADE);"
 
+/*
+ * di already has the index of its UNIQUE constraint. The child tables are looked up and
+ * cascade deleted by LINK_ID; rt and if are part of their index so that the lookups by link
+ * never touch the table itself.
+ */
+#define RD_INDEXES \
+    "create index if not exists RD_DEVICE_LINK_LIST_HREF on RD_DEVICE_LINK_LIST(" \
+    "DEVICE_ID, " XSTR(OC_RSRVD_HREF) ");" \
+    "create index if not exists RD_LINK_RT_LINK_ID on RD_LINK_RT(" \
+    "LINK_ID, " XSTR(OC_RSRVD_RESOURCE_TYPE) ");" \
+    "create index if not exists RD_LINK_IF_LINK_ID on RD_LINK_IF(" \
+    "LINK_ID, " XSTR(OC_RSRVD_INTERFACE) ");" \
+    "create index if not exists RD_LINK_EP_LINK_ID on RD_LINK_EP(LINK_ID);"
+
+/**
+ * Statements run on every publish and delete. Each one is prepared the first time it is
+ * needed, reset after every use and finalized when the database is closed.
+ */
+typedef enum
+{
+    RD_STMT_BEGIN = 0,
+    RD_STMT_COMMIT,
+    RD_STMT_ROLLBACK,
+    RD_STMT_INSERT_DEVICE,
+    RD_STMT_UPDATE_DEVICE,
+    RD_STMT_SELECT_DEVICE,
+    RD_STMT_DELETE_DEVICE,
+    RD_STMT_INSERT_LINK,
+    RD_STMT_UPDATE_LINK,
+    RD_STMT_SELECT_LINK,
+    RD_STMT_DELETE_LINK,
+    RD_STMT_DELETE_RT,
+    RD_STMT_INSERT_RT,
+    RD_STMT_DELETE_IF,
+    RD_STMT_INSERT_IF,
+    RD_STMT_DELETE_EP,
+    RD_STMT_INSERT_EP,
+    RD_STMT_COUNT
+} RDStatement;
+
+static const char *gRDStatementSql[RD_STMT_COUNT] =
+{
+    [RD_STMT_BEGIN] = "BEGIN TRANSACTION",
+    [RD_STMT_COMMIT] = "COMMIT",
+    [RD_STMT_ROLLBACK] = "ROLLBACK",
+    /* INSERT OR IGNORE then UPDATE to update or insert the row without triggering the cascading deletes */
+    [RD_STMT_INSERT_DEVICE] = "INSERT OR IGNORE INTO RD_DEVICE_LIST (ID, di, ttl, external_host) "
+        "VALUES ((SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId), @deviceId, @ttl, @external_host)",
+    [RD_STMT_UPDATE_DEVICE] = "UPDATE RD_DEVICE_LIST SET ttl=@ttl WHERE di=@deviceId",
+    [RD_STMT_SELECT_DEVICE] = "SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId",
+    [RD_STMT_DELETE_DEVICE] = "DELETE FROM RD_DEVICE_LIST WHERE di=@deviceId",
+    [RD_STMT_INSERT_LINK] = "INSERT OR IGNORE INTO RD_DEVICE_LINK_LIST (ins, href, DEVICE_ID) "
+        "VALUES((SELECT ins FROM RD_DEVICE_LINK_LIST WHERE DEVICE_ID=@id AND href=@uri),@uri,@id)",
+    [RD_STMT_UPDATE_LINK] = "UPDATE RD_DEVICE_LINK_LIST SET anchor=@anchor,bm=@bm "
+        "WHERE DEVICE_ID=@id AND href=@uri",
+    [RD_STMT_SELECT_LINK] = "SELECT ins FROM RD_DEVICE_LINK_LIST WHERE DEVICE_ID=@id AND href=@uri",
+    [RD_STMT_DELETE_LINK] = "DELETE FROM RD_DEVICE_LINK_LIST WHERE ins=@ins",
+    [RD_STMT_DELETE_RT] = "DELETE FROM RD_LINK_RT WHERE LINK_ID=@id",
+    [RD_STMT_INSERT_RT] = "INSERT INTO RD_LINK_RT VALUES(@resourceType, @id)",
+    [RD_STMT_DELETE_IF] = "DELETE FROM RD_LINK_IF WHERE LINK_ID=@id",
+    [RD_STMT_INSERT_IF] = "INSERT INTO RD_LINK_IF VALUES(@interfaceType, @id)",
+    [RD_STMT_DELETE_EP] = "DELETE FROM RD_LINK_EP WHERE LINK_ID=@id",
+    [RD_STMT_INSERT_EP] = "INSERT INTO RD_LINK_EP VALUES(@ep, @pri, @id)",
+};
+
+static sqlite3_stmt *gRDStatements[RD_STMT_COUNT] = { NULL };
+
+static int getStatement(RDStatement id, sqlite3_stmt **stmt)
+{
+    if (!gRDStatements[id])
+    {
+        int res = sqlite3_prepare_v2(gRDDB, gRDStatementSql[id], -1, &gRDStatements[id], NULL);
+        if (SQLITE_OK != res)
+        {
+            return res;
+        }
+    }
+    *stmt = gRDStatements[id];
+    return SQLITE_OK;
+}
+
+/* Makes a cached statement ready for its next use. */
+static void releaseStatement(sqlite3_stmt *stmt)
+{
+    if (stmt)
+    {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+}
+
+static void finalizeStatements(void)
+{
+    for (size_t i = 0; i < RD_STMT_COUNT; i++)
+    {
+        sqlite3_finalize(gRDStatements[i]);
+        gRDStatements[i] = NULL;
+    }
+}
+
+/* Runs a cached statement that takes no parameters and returns no rows. */
+static int execStatement(RDStatement id)
+{
+    sqlite3_stmt *stmt = NULL;
+    int res = getStatement(id, &stmt);
+    if (SQLITE_OK == res)
+    {
+        res = sqlite3_step(stmt);
+        res = (SQLITE_DONE == res) ? SQLITE_OK : res;
+        releaseStatement(stmt);
+    }
+    return res;
+}
+
 static void errorCallback(void *arg, int errCode, const char *errMsg)
 {
     OC_UNUSED(arg);
@@ -119,6 +233,10 @@ static bool stringArgumentsWithinBounds(const char** arguments, size_t count)
     return true;
 }
 
+/*
+ * The store functions below only run inside the transaction storeResources() opens for the
+ * whole publish, so a failure anywhere rolls back the complete publish.
+ */
 static int storeResourceTypes(const char **resourceTypes, size_t size, sqlite3_int64 rowid)
 {
     int res = SQLITE_ERROR;
@@ -128,26 +246,18 @@ static int storeResourceTypes(const char **resourceTypes, size_t size, sqlite3_i
         return res;
     }
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "SAVEPOINT storeResourceTypes", NULL, NULL, NULL));
-
-    static const char deleteRT[] = "DELETE FROM RD_LINK_RT WHERE LINK_ID=@id";
-    static const char insertRT[] = "INSERT INTO RD_LINK_RT VALUES(@resourceType, @id)";
-    int deleteRTSize = (int)sizeof(deleteRT);
-    int insertRTSize = (int)sizeof(insertRT);
-
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, deleteRT, deleteRTSize, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_STMT_DELETE_RT, &stmt));
     VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
     res = sqlite3_step(stmt);
     if (SQLITE_DONE != res)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
+    releaseStatement(stmt);
 
+    VERIFY_SQLITE(getStatement(RD_STMT_INSERT_RT, &stmt));
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertRT, insertRTSize, &stmt, NULL));
         if (resourceTypes[i])
         {
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
@@ -159,19 +269,13 @@ static int storeResourceTypes(const char **resourceTypes, size_t size, sqlite3_i
         {
             goto exit;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
-        stmt = NULL;
+        releaseStatement(stmt);
     }
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "RELEASE storeResourceTypes", NULL, NULL, NULL));
     res = SQLITE_OK;
 
 exit:
-    sqlite3_finalize(stmt);
-    if (SQLITE_OK != res)
-    {
-        sqlite3_exec(gRDDB, "ROLLBACK TO storeResourceTypes", NULL, NULL, NULL);
-    }
+    releaseStatement(stmt);
     return res;
 }
 
@@ -184,26 +288,18 @@ static int storeInterfaces(const char **interfaces, size_t size, sqlite3_int64 r
         return res;
     }
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "SAVEPOINT storeInterfaces", NULL, NULL, NULL));
-
-    static const char deleteIF[] = "DELETE FROM RD_LINK_IF WHERE LINK_ID=@id";
-    static const char insertIF[] = "INSERT INTO RD_LINK_IF VALUES(@interfaceType, @id)";
-    int deleteIFLength = (int)sizeof(deleteIF);
-    int insertIFLength = (int)sizeof(insertIF);
-
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, deleteIF, deleteIFLength, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_STMT_DELETE_IF, &stmt));
     VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
     res = sqlite3_step(stmt);
     if (SQLITE_DONE != res)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
+    releaseStatement(stmt);
 
+    VERIFY_SQLITE(getStatement(RD_STMT_INSERT_IF, &stmt));
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertIF, insertIFLength, &stmt, NULL));
         if (interfaces[i])
         {
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
@@ -215,19 +311,13 @@ static int storeInterfaces(const char **interfaces, size_t size, sqlite3_int64 r
         {
             goto exit;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
-        stmt = NULL;
+        releaseStatement(stmt);
     }
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "RELEASE storeInterfaces", NULL, NULL, NULL));
     res = SQLITE_OK;
 
 exit:
-    sqlite3_finalize(stmt);
-    if (SQLITE_OK != res)
-    {
-        sqlite3_exec(gRDDB, "ROLLBACK TO storeInterfaces", NULL, NULL, NULL);
-    }
+    releaseStatement(stmt);
     return res;
 }
 
@@ -237,29 +327,23 @@ static int storeEndpoints(OCRepPayload **eps, size_t size, sqlite3_int64 rowid)
     char *ep = NULL;
     sqlite3_stmt *stmt = NULL;
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "SAVEPOINT storeEndpoints", NULL, NULL, NULL));
-    static const char deleteEp[] = "DELETE FROM RD_LINK_EP WHERE LINK_ID=@id";
-    static const char insertEp[] = "INSERT INTO RD_LINK_EP VALUES(@ep, @pri, @id)";
-    int deleteEpLength = (int)sizeof(deleteEp);
-    int insertEpLength = (int)sizeof(insertEp);
-
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, deleteEp, deleteEpLength, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_STMT_DELETE_EP, &stmt));
     VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
     res = sqlite3_step(stmt);
     if (SQLITE_DONE != res)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
+    releaseStatement(stmt);
 
+    VERIFY_SQLITE(getStatement(RD_STMT_INSERT_EP, &stmt));
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertEp, insertEpLength, &stmt, NULL));
         if (OCRepPayloadGetPropString(eps[i], OC_RSRVD_ENDPOINT, &ep))
         {
             if (!stringArgumentWithinBounds(ep))
             {
+                res = SQLITE_ERROR;
                 goto exit;
             }
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@ep"),
@@ -274,22 +358,16 @@ static int storeEndpoints(OCRepPayload **eps, size_t size, sqlite3_int64 rowid)
         {
             goto exit;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
-        stmt = NULL;
+        releaseStatement(stmt);
         OICFree(ep);
         ep = NULL;
     }
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "RELEASE storeEndpoints", NULL, NULL, NULL));
     res = SQLITE_OK;
 
 exit:
+    releaseStatement(stmt);
     OICFree(ep);
-    sqlite3_finalize(stmt);
-    if (SQLITE_OK != res)
-    {
-        sqlite3_exec(gRDDB, "ROLLBACK TO storeInterfaces", NULL, NULL, NULL);
-    }
     return res;
 }
 
@@ -332,20 +410,10 @@ static int storeLinkPayload(OCRepPayloadValue *links, sqlite3_int64 rowid)
     OCRepPayload** eps = NULL;
     size_t epsDim[MAX_REP_ARRAY_DEPTH] = {0};
 
-    static const char insertDeviceLLList[] = "INSERT OR IGNORE INTO RD_DEVICE_LINK_LIST (ins, href, DEVICE_ID) "
-        "VALUES((SELECT ins FROM RD_DEVICE_LINK_LIST WHERE DEVICE_ID=@id AND href=@uri),@uri,@id)";
-    static const char updateDeviceLLList[] = "UPDATE RD_DEVICE_LINK_LIST SET anchor=@anchor,bm=@bm "
-        "WHERE DEVICE_ID=@id AND href=@uri";
-    int insertDeviceLLListSize = (int)sizeof(insertDeviceLLList);
-    int updateDeviceLLListSize = (int)sizeof(updateDeviceLLList);
-
     assert(links);
     for (size_t i = 0; (SQLITE_OK == res) && (i < links->arr.dimensions[0]); i++)
     {
-        VERIFY_SQLITE(sqlite3_exec(gRDDB, "SAVEPOINT storeLinkPayload", NULL, NULL, NULL));
-
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertDeviceLLList,
-                        insertDeviceLLListSize, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_STMT_INSERT_LINK, &stmt));
 
         OCRepPayload *link = links->arr.objArray[i];
         VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
@@ -353,7 +421,8 @@ static int storeLinkPayload(OCRepPayloadValue *links, sqlite3_int64 rowid)
         {
             if (!stringArgumentWithinBounds(uri))
             {
-                return SQLITE_ERROR;
+                res = SQLITE_ERROR;
+                goto exit;
             }
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@uri"),
                             uri, (int)strlen(uri), SQLITE_STATIC));
@@ -363,11 +432,9 @@ static int storeLinkPayload(OCRepPayloadValue *links, sqlite3_int64 rowid)
         {
             goto exit;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
-        stmt = NULL;
+        releaseStatement(stmt);
 
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, updateDeviceLLList,
-                        updateDeviceLLListSize, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_STMT_UPDATE_LINK, &stmt));
         VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
         if (uri)
         {
@@ -378,6 +445,7 @@ static int storeLinkPayload(OCRepPayloadValue *links, sqlite3_int64 rowid)
         {
             if (!stringArgumentWithinBounds(anchor))
             {
+                res = SQLITE_ERROR;
                 goto exit;
             }
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@anchor"),
@@ -396,13 +464,9 @@ static int storeLinkPayload(OCRepPayloadValue *links, sqlite3_int64 rowid)
         {
             goto exit;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
-        stmt = NULL;
-
-        static const char input[] = "SELECT ins FROM RD_DEVICE_LINK_LIST WHERE DEVICE_ID=@id AND href=@uri";
-        int inputSize = (int)sizeof(input);
+        releaseStatement(stmt);
 
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_STMT_SELECT_LINK, &stmt));
         VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@id"), rowid));
         if (uri)
         {
@@ -413,12 +477,12 @@ static int storeLinkPayload(OCRepPayloadValue *links, sqlite3_int64 rowid)
         if (res == SQLITE_ROW || res == SQLITE_DONE)
         {
             sqlite3_int64 ins = sqlite3_column_int64(stmt, 0);
-            VERIFY_SQLITE(sqlite3_finalize(stmt));
-            stmt = NULL;
+            releaseStatement(stmt);
             if (!OCRepPayloadSetPropInt(link, OC_RSRVD_INS, ins))
             {
                 OIC_LOG_V(ERROR, TAG, "Error setting 'ins' value");
-                return SQLITE_ERROR;
+                res = SQLITE_ERROR;
+                goto exit;
             }
             OCRepPayloadGetStringArray(link, OC_RSRVD_RESOURCE_TYPE, &rt, rtDim);
             OCRepPayloadGetStringArray(link, OC_RSRVD_INTERFACE, &itf, itfDim);
@@ -429,11 +493,9 @@ static int storeLinkPayload(OCRepPayloadValue *links, sqlite3_int64 rowid)
         }
         else
         {
-            VERIFY_SQLITE(sqlite3_finalize(stmt));
-            stmt = NULL;
+            releaseStatement(stmt);
         }
 
-        VERIFY_SQLITE(sqlite3_exec(gRDDB, "RELEASE storeLinkPayload", NULL, NULL, NULL));
         res = SQLITE_OK;
 
     exit:
@@ -470,12 +532,8 @@ static int storeLinkPayload(OCRepPayloadValue *links, sqlite3_int64 rowid)
         anchor = NULL;
         OICFree(uri);
         uri = NULL;
-        sqlite3_finalize(stmt);
+        releaseStatement(stmt);
         stmt = NULL;
-        if (SQLITE_OK != res)
-        {
-            sqlite3_exec(gRDDB, "ROLLBACK TO storeLinkPayload", NULL, NULL, NULL);
-        }
     }
 
     return res;
@@ -510,14 +568,9 @@ static int storeResources(const OCRepPayload *payload, bool externalHost)
     }
 
     int res;
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
+    VERIFY_SQLITE(execStatement(RD_STMT_BEGIN));
 
-    /* INSERT OR IGNORE then UPDATE to update or insert the row without triggering the cascading deletes */
-    static const char insertDeviceList[] = "INSERT OR IGNORE INTO RD_DEVICE_LIST (ID, di, ttl, external_host) "
-        "VALUES ((SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId), @deviceId, @ttl, @external_host)";
-    int insertDeviceListSize = (int)sizeof(insertDeviceList);
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertDeviceList, insertDeviceListSize,
-                    &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_STMT_INSERT_DEVICE, &stmt));
     if (deviceId)
     {
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
@@ -534,13 +587,9 @@ static int storeResources(const OCRepPayload *payload, bool externalHost)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
+    releaseStatement(stmt);
 
-    static const char updateDeviceList[] = "UPDATE RD_DEVICE_LIST SET ttl=@ttl WHERE di=@deviceId";
-    int updateDeviceListSize = (int)sizeof(updateDeviceList);
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, updateDeviceList, updateDeviceListSize,
-                    &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_STMT_UPDATE_DEVICE, &stmt));
     if (deviceId)
     {
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
@@ -555,14 +604,10 @@ static int storeResources(const OCRepPayload *payload, bool externalHost)
     {
         goto exit;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
+    releaseStatement(stmt);
 
     /* Store the rest of the payload */
-    static const char input[] = "SELECT ID FROM RD_DEVICE_LIST WHERE di=@deviceId";
-    int inputSize = (int)sizeof(input);
-
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_STMT_SELECT_DEVICE, &stmt));
     if (deviceId)
     {
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
@@ -572,32 +617,29 @@ static int storeResources(const OCRepPayload *payload, bool externalHost)
     if (res == SQLITE_ROW || res == SQLITE_DONE)
     {
         sqlite3_int64 rowid = sqlite3_column_int64(stmt, 0);
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
-        stmt = NULL;
+        releaseStatement(stmt);
         VERIFY_SQLITE(storeLinkPayload(links, rowid));
     }
     else
     {
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
-        stmt = NULL;
+        releaseStatement(stmt);
     }
 
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
+    VERIFY_SQLITE(execStatement(RD_STMT_COMMIT));
     res = SQLITE_OK;
 
 exit:
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     OICFree(deviceId);
     if (SQLITE_OK != res)
     {
-        sqlite3_exec(gRDDB, "ROLLBACK", NULL, NULL, NULL);
+        execStatement(RD_STMT_ROLLBACK);
     }
     return res;
 }
 
 static int deleteResources(const char *deviceId, const int64_t *instanceIds, uint16_t nInstanceIds)
 {
-    char *delResource = NULL;
     sqlite3_stmt *stmt = NULL;
     if (!stringArgumentWithinBounds(deviceId))
     {
@@ -606,65 +648,44 @@ static int deleteResources(const char *deviceId, const int64_t *instanceIds, uin
     }
 
     int res;
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
+    VERIFY_SQLITE(execStatement(RD_STMT_BEGIN));
 
     if (!instanceIds || !nInstanceIds)
     {
-        static const char delDevice[] = "DELETE FROM RD_DEVICE_LIST WHERE di=@deviceId";
-        int delDeviceSize = (int)sizeof(delDevice);
-
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, delDevice, delDeviceSize, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_STMT_DELETE_DEVICE, &stmt));
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
                                         deviceId, (int)strlen(deviceId), SQLITE_STATIC));
-    }
-    else
-    {
-        static const char pre[] = "DELETE FROM RD_DEVICE_LINK_LIST "
-            "WHERE ins IN ("
-            "SELECT RD_DEVICE_LINK_LIST.ins FROM RD_DEVICE_LINK_LIST "
-            "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-            "WHERE RD_DEVICE_LINK_LIST.ins IN (";
-        size_t inLen = nInstanceIds + (nInstanceIds - 1);
-        static const char post[] = "))";
-        size_t delResourceSize = sizeof(pre) + inLen + (sizeof(post) - 1);
-        delResource = OICCalloc(delResourceSize, 1);
-        if (!delResource)
+        res = sqlite3_step(stmt);
+        if (SQLITE_DONE != res)
         {
-            res = SQLITE_NOMEM;
             goto exit;
         }
-        OICStrcat(delResource, delResourceSize, pre);
-        OICStrcat(delResource, delResourceSize, "?");
-        for (uint16_t i = 1; i < nInstanceIds; ++i)
-        {
-            OICStrcat(delResource, delResourceSize, ",?");
-        }
-        OICStrcat(delResource, delResourceSize, post);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, delResource, (int)delResourceSize,
-                        &stmt, NULL));
+        releaseStatement(stmt);
+    }
+    else
+    {
+        VERIFY_SQLITE(getStatement(RD_STMT_DELETE_LINK, &stmt));
         for (uint16_t i = 0; i < nInstanceIds; ++i)
         {
-            VERIFY_SQLITE(sqlite3_bind_int64(stmt, 1 + i, instanceIds[i]));
+            VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@ins"),
+                                             instanceIds[i]));
+            res = sqlite3_step(stmt);
+            if (SQLITE_DONE != res)
+            {
+                goto exit;
+            }
+            releaseStatement(stmt);
         }
     }
 
-    res = sqlite3_step(stmt);
-    if (SQLITE_DONE != res)
-    {
-        goto exit;
-    }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
-
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
+    VERIFY_SQLITE(execStatement(RD_STMT_COMMIT));
     res = SQLITE_OK;
 
 exit:
-    OICFree(delResource);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     if (SQLITE_OK != res)
     {
-        sqlite3_exec(gRDDB, "ROLLBACK", NULL, NULL, NULL);
+        execStatement(RD_STMT_ROLLBACK);
     }
     return res;
 }
@@ -714,6 +735,19 @@ OCStackResult OC_CALL OCRDDatabaseInit()
         }
         VERIFY_SQLITE(sqlite3_finalize(stmt));
         stmt = NULL;
+
+        /* Also run on databases created before the indexes existed */
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_INDEXES, NULL, NULL, NULL));
+
+        /*
+         * Republishing devices write often while discovery reads through its own connection;
+         * with a write-ahead log neither blocks the other and a commit appends to one file.
+         */
+        if (SQLITE_OK != sqlite3_exec(gRDDB, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL))
+        {
+            OIC_LOG_V(WARNING, TAG, "RD database stays in its journal mode: %s",
+                      sqlite3_errmsg(gRDDB));
+        }
     }
 
 exit:
@@ -734,6 +768,7 @@ OCStackResult OC_CALL OCRDDatabaseClose()
 {
     CHECK_DATABASE_INIT;
     int res;
+    finalizeStatements();
     VERIFY_SQLITE(sqlite3_close(gRDDB));
     gRDDB = NULL;
 
@@ -47,6 +47,7 @@ extern "C"
 #include <string.h>
 
 #include <iostream>
+#include <vector>
 #include <stdint.h>
 
 #include "gtest_helper.h"
@@ -489,3 +490,74 @@ TEST_F(RDDatabaseTests, TTLLapsedDeleteDevice)
     OCDiscoveryPayloadDestroy(discPayload);
     discPayload = NULL;
 }
+
+// Measures publishing, republishing on TTL and looking up the links of many devices.
+TEST_F(RDDatabaseTests, PublishAndLookupBenchmark)
+{
+    itst::DeadmanTimer killSwitch(std::chrono::minutes(3));
+
+    const size_t deviceCount = 1000;
+    const size_t linkCount = 10;
+    const int lookups = 10;
+
+    char uris[linkCount][MAX_URI_LENGTH];
+    Resource resources[linkCount];
+    for (size_t i = 0; i < linkCount; ++i)
+    {
+        snprintf(uris[i], sizeof(uris[i]), "/a/light%zu", i);
+        resources[i].uri = uris[i];
+        resources[i].rt = (i % 2) ? "core.light" : "core.switch";
+        resources[i].itf = OC_RSRVD_INTERFACE_DEFAULT;
+        resources[i].bm = OC_DISCOVERABLE;
+    }
+
+    std::vector<OCRepPayload *> payloads;
+    for (size_t d = 0; d < deviceCount; ++d)
+    {
+        char deviceId[sizeof("7a960f46-a52e-4837-bd83-460b1a6dd56b")];
+        snprintf(deviceId, sizeof(deviceId), "%08zx-a52e-4837-bd83-460b1a6dd56b", d);
+        OCRepPayload *repPayload = CreateRDPublishPayload(deviceId, 0, resources, linkCount);
+        ASSERT_TRUE(NULL != repPayload) << "CreateRDPublishPayload failed!";
+        payloads.push_back(repPayload);
+    }
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (OCRepPayload *repPayload : payloads)
+        {
+            EXPECT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(repPayload));
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start).count();
+        std::cout << "[ BENCH    ] RD " << (pass ? "republish" : "publish") << ", "
+                  << deviceCount << " devices x " << linkCount << " links in "
+                  << elapsed << " us" << std::endl;
+    }
+
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; ++i)
+    {
+        OCDiscoveryPayload *discPayload = NULL;
+        EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDiscoveryPayloadCreate(NULL, "core.light", &discPayload));
+        for (OCDiscoveryPayload *payload = discPayload; payload; payload = payload->next)
+        {
+            for (OCResourcePayload *resource = payload->resources; resource; resource = resource->next)
+            {
+                ++found;
+            }
+        }
+        OCDiscoveryPayloadDestroy(discPayload);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start).count();
+    std::cout << "[ BENCH    ] RD lookup rt=core.light, " << deviceCount << " devices: "
+              << lookups << " lookups in " << elapsed << " us" << std::endl;
+    EXPECT_EQ(lookups * deviceCount * (linkCount / 2), found);
+
+    for (OCRepPayload *repPayload : payloads)
+    {
+        OCPayloadDestroy((OCPayload *)repPayload);
+    }
+}
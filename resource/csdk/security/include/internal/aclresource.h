@@ -78,6 +78,14 @@ const OicSecAce_t* GetACLResourceDataByRoles(const OicSecRole_t *roles, size_t r
  */
 const OicSecAce_t* GetACLResourceDataByConntype(const OicSecConntype_t conntype, OicSecAce_t **savePtr);
 
+/**
+ * Get the generation number of the ACL. It changes every time the ACL is
+ * modified, so callers can tell when anything derived from it is stale.
+ *
+ * @return the current ACL generation.
+ */
+uint32_t GetACLGeneration(void);
+
 /**
  * This function converts ACL data into CBOR format.
  *
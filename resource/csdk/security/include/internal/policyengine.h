@@ -49,6 +49,11 @@ void CheckPermission( SRMRequestContext_t *context );
  */
 uint16_t GetPermissionFromCAMethod_t(const CAMethod_t method);
 
+/**
+ * Release the access decisions cached by the policy engine.
+ */
+void DeInitPolicyEngine(void);
+
 typedef OCStackResult (*GetSvrRownerId_t)(OicUuid_t *rowner);
 
 #endif //IOTVT_SRM_PE_H
@@ -212,6 +212,12 @@ OCStackResult OC_CALL SetPreconfigPin(const char *pinBuffer, size_t pinLength);
  */
 OCStackResult OC_CALL SetRandomPinPolicy(size_t pinSize, OicSecPinType_t pinType);
 
+/**
+ * Zeroizes the PSK kept from the last DerivePSKUsingPIN() call. Done whenever
+ * the PIN is set and when an ownership transfer ends, successfully or not.
+ */
+void ClearPinDerivedPsk(void);
+
 #ifdef __WITH_DTLS__
 
 /**
@@ -22,6 +22,8 @@
 #include <string.h>
 
 #include "ocstack.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
 #include "experimental/logger.h"
 #include "octhread.h"
 #include "cathreadpool.h"
@@ -627,16 +629,42 @@ static void *userRequests(void *data)
     return NULL;
 }
 
-FILE* server_fopen(const char *path, const char *mode)
+/**
+ * Map the security database, and the journal and commit files named after it,
+ * onto |fname|. The caller frees the returned path.
+ */
+static char *serverPath(const char *path)
 {
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    if (0 != strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
     {
-        return fopen(fname, mode);
+        return OICStrdup(path);
     }
-    else
+
+    size_t size = strlen(fname) + strlen(path + dbNameLen) + 1;
+    char *filePath = (char *)OICMalloc(size);
+    if (filePath)
     {
-        return fopen(path, mode);
+        OICStrcpy(filePath, size, fname);
+        OICStrcat(filePath, size, path + dbNameLen);
     }
+    return filePath;
+}
+
+FILE* server_fopen(const char *path, const char *mode)
+{
+    char *filePath = serverPath(path);
+    FILE *file = filePath ? fopen(filePath, mode) : NULL;
+    OICFree(filePath);
+    return file;
+}
+
+int server_unlink(const char *path)
+{
+    char *filePath = serverPath(path);
+    int ret = filePath ? unlink(filePath) : -1;
+    OICFree(filePath);
+    return ret;
 }
 
 /**
@@ -688,7 +716,7 @@ bool parseCommandLineArguments(int argc, char *argv[])
 OCStackResult initPersistentStorage()
 {
     //Initialize Persistent Storage for SVR database
-    static OCPersistentStorage ps = {server_fopen, fread, fwrite, fclose, unlink};
+    static OCPersistentStorage ps = {server_fopen, fread, fwrite, fclose, server_unlink, true};
 
     return OCRegisterPersistentStorageHandler(&ps);
 }
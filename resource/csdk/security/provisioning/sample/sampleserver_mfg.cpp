@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <string>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
@@ -404,16 +405,28 @@ void handleSigInt(int signum)
     }
 }
 
-FILE* server_fopen(const char *path, const char *mode)
+/**
+ * Map the security database, and the journal and commit files named after it,
+ * onto CRED_FILE.
+ */
+static std::string server_path(const char *path)
 {
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
-    {
-        return fopen(CRED_FILE, mode);
-    }
-    else
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    if (0 == strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
     {
-        return fopen(path, mode);
+        return std::string(CRED_FILE) + (path + dbNameLen);
     }
+    return path;
+}
+
+FILE* server_fopen(const char *path, const char *mode)
+{
+    return fopen(server_path(path).c_str(), mode);
+}
+
+int server_remove(const char *path)
+{
+    return remove(server_path(path).c_str());
 }
 
 static CAResult_t peerCNVerifyCallback(const unsigned char *cn, size_t cnLen)
@@ -437,7 +450,7 @@ int main()
     OIC_LOG(DEBUG, TAG, "OCServer is starting...");
 
     // Initialize Persistent Storage for SVR database
-    OCPersistentStorage ps = {server_fopen, fread, fwrite, fclose, remove};
+    OCPersistentStorage ps = {server_fopen, fread, fwrite, fclose, server_remove, true};
 
     OCRegisterPersistentStorageHandler(&ps);
 
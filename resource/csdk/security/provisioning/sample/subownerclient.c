@@ -101,6 +101,7 @@ static int printDevList(const OCProvisionDev_t*);
 static size_t printResultList(const OCProvisionResult_t*, const size_t);
 static void printUuid(const OicUuid_t*);
 static FILE* fopen_prvnMng(const char*, const char*);
+static int unlink_prvnMng(const char*);
 static int waitCallbackRet(void);
 
 // callback function(s) for provisioning client using C-level provisioning API
@@ -204,7 +205,7 @@ static void OC_CALL inputPinCB(char* pin, size_t len)
 static int initProvisionClient(void)
 {
     // initialize persistent storage for SVR DB
-    static OCPersistentStorage ps = {fopen_prvnMng, fread, fwrite, fclose, unlink};
+    static OCPersistentStorage ps = {fopen_prvnMng, fread, fwrite, fclose, unlink_prvnMng, true};
     if(OC_STACK_OK != OCRegisterPersistentStorageHandler(&ps))
     {
         OIC_LOG(ERROR, TAG, "OCRegisterPersistentStorageHandler error");
@@ -803,19 +804,42 @@ static void printUuid(const OicUuid_t* uid)
     }
 }
 
-static FILE* fopen_prvnMng(const char* path, const char* mode)
+/**
+ * Map the security database, and the journal and commit files named after it,
+ * onto |SVR_DB_FILE_NAME|. The caller frees the returned path.
+ */
+static char* prvnMngPath(const char* path)
 {
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    if (0 != strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
     {
-        // input |g_svr_db_fname| internally by force, not using |path| parameter
-        // because |OCPersistentStorage::open| is called |OCPersistentStorage| internally
-        // with its own |SVR_DB_FILE_NAME|
-        return fopen(SVR_DB_FILE_NAME, mode);
+        return OICStrdup(path);
     }
-    else
+
+    size_t size = strlen(SVR_DB_FILE_NAME) + strlen(path + dbNameLen) + 1;
+    char* filePath = (char*)OICMalloc(size);
+    if (filePath)
     {
-        return fopen(path, mode);
+        OICStrcpy(filePath, size, SVR_DB_FILE_NAME);
+        OICStrcat(filePath, size, path + dbNameLen);
     }
+    return filePath;
+}
+
+static FILE* fopen_prvnMng(const char* path, const char* mode)
+{
+    char* filePath = prvnMngPath(path);
+    FILE* file = filePath ? fopen(filePath, mode) : NULL;
+    OICFree(filePath);
+    return file;
+}
+
+static int unlink_prvnMng(const char* path)
+{
+    char* filePath = prvnMngPath(path);
+    int ret = filePath ? unlink(filePath) : -1;
+    OICFree(filePath);
+    return ret;
 }
 
 static int waitCallbackRet(void)
@@ -26,6 +26,7 @@
 #endif
 #include <stdlib.h>
 
+#include <coap/uthash.h>
 #include "utlist.h"
 #include "ocstack.h"
 #include "octypes.h"
@@ -97,6 +98,267 @@ struct AceIdList
     AceIdList_t *next;
 };
 
+/**
+ * Key of the ACE subject index. The union is zeroed before use so that the
+ * whole structure can be hashed as raw bytes.
+ */
+typedef struct AclIndexKey
+{
+    OicSecAceSubjectType subjectType;
+    union
+    {
+        OicUuid_t uuid;
+        OicSecRole_t role;
+        OicSecConntype_t conntype;
+    } subject;
+} AclIndexKey_t;
+
+/**
+ * All ACEs of gAcl with the same subject, kept in ACL order.
+ */
+typedef struct AclIndexEntry
+{
+    AclIndexKey_t key;
+    OicSecAce_t **aces;
+    size_t *order;              /**< position of aces[i] in gAcl->aces */
+    size_t count;
+    size_t capacity;
+    UT_hash_handle hh;
+} AclIndexEntry_t;
+
+/**
+ * Position of an ACE in gAcl->aces, used to resume a search from savePtr.
+ */
+typedef struct AclIndexPos
+{
+    const OicSecAce_t *ace;
+    size_t order;
+    UT_hash_handle hh;
+} AclIndexPos_t;
+
+static AclIndexEntry_t *g_aclIndex = NULL;
+static AclIndexPos_t *g_aclIndexPos = NULL;
+static bool g_aclIndexValid = false;
+static const OicSecAcl_t *g_aclIndexAcl = NULL;
+static const OicSecAce_t *g_aclIndexHead = NULL;
+
+// Bumped whenever gAcl changes so that cached policy decisions can be dropped.
+static uint32_t g_aclGeneration = 0;
+
+static void FreeACLIndex(void)
+{
+    AclIndexEntry_t *entry = NULL;
+    AclIndexEntry_t *tmpEntry = NULL;
+    HASH_ITER(hh, g_aclIndex, entry, tmpEntry)
+    {
+        HASH_DEL(g_aclIndex, entry);
+        OICFree(entry->aces);
+        OICFree(entry->order);
+        OICFree(entry);
+    }
+
+    AclIndexPos_t *pos = NULL;
+    AclIndexPos_t *tmpPos = NULL;
+    HASH_ITER(hh, g_aclIndexPos, pos, tmpPos)
+    {
+        HASH_DEL(g_aclIndexPos, pos);
+        OICFree(pos);
+    }
+
+    g_aclIndexValid = false;
+    g_aclIndexAcl = NULL;
+    g_aclIndexHead = NULL;
+}
+
+/**
+ * Must be called after every change of gAcl or of the ACEs it holds.
+ */
+static void ACLChanged(void)
+{
+    FreeACLIndex();
+    g_aclGeneration++;
+}
+
+uint32_t GetACLGeneration(void)
+{
+    return g_aclGeneration;
+}
+
+static void MakeACLIndexKey(AclIndexKey_t *key, const OicSecAce_t *ace)
+{
+    memset(key, 0, sizeof(*key));
+    key->subjectType = ace->subjectType;
+    switch (ace->subjectType)
+    {
+        case OicSecAceUuidSubject:
+            memcpy(&key->subject.uuid, &ace->subjectuuid, sizeof(key->subject.uuid));
+            break;
+        case OicSecAceRoleSubject:
+            OICStrcpy(key->subject.role.id, sizeof(key->subject.role.id),
+                      ace->subjectRole.id);
+            OICStrcpy(key->subject.role.authority, sizeof(key->subject.role.authority),
+                      ace->subjectRole.authority);
+            break;
+        case OicSecAceConntypeSubject:
+            key->subject.conntype = ace->subjectConn;
+            break;
+        default:
+            break;
+    }
+}
+
+static bool AddACEToIndex(OicSecAce_t *ace, size_t order)
+{
+    AclIndexPos_t *pos = (AclIndexPos_t *)OICCalloc(1, sizeof(AclIndexPos_t));
+    if (NULL == pos)
+    {
+        return false;
+    }
+    pos->ace = ace;
+    pos->order = order;
+    HASH_ADD(hh, g_aclIndexPos, ace, sizeof(pos->ace), pos);
+
+    AclIndexKey_t key;
+    MakeACLIndexKey(&key, ace);
+
+    AclIndexEntry_t *entry = NULL;
+    HASH_FIND(hh, g_aclIndex, &key, sizeof(key), entry);
+    if (NULL == entry)
+    {
+        entry = (AclIndexEntry_t *)OICCalloc(1, sizeof(AclIndexEntry_t));
+        if (NULL == entry)
+        {
+            return false;
+        }
+        entry->key = key;
+        HASH_ADD(hh, g_aclIndex, key, sizeof(entry->key), entry);
+    }
+
+    if (entry->count == entry->capacity)
+    {
+        size_t capacity = entry->capacity ? (entry->capacity * 2) : 4;
+        OicSecAce_t **aces = (OicSecAce_t **)OICRealloc(entry->aces,
+                                                        capacity * sizeof(*aces));
+        if (NULL == aces)
+        {
+            return false;
+        }
+        entry->aces = aces;
+        size_t *orders = (size_t *)OICRealloc(entry->order, capacity * sizeof(*orders));
+        if (NULL == orders)
+        {
+            return false;
+        }
+        entry->order = orders;
+        entry->capacity = capacity;
+    }
+
+    entry->aces[entry->count] = ace;
+    entry->order[entry->count] = order;
+    entry->count++;
+    return true;
+}
+
+/**
+ * Build the subject index of gAcl if it is missing or out of date.
+ *
+ * @return true if the index can be used, false on allocation failure.
+ */
+static bool EnsureACLIndex(void)
+{
+    if (g_aclIndexValid && (g_aclIndexAcl == gAcl) && (g_aclIndexHead == gAcl->aces))
+    {
+        return true;
+    }
+
+    FreeACLIndex();
+
+    size_t order = 0;
+    OicSecAce_t *ace = NULL;
+    LL_FOREACH(gAcl->aces, ace)
+    {
+        if (!AddACEToIndex(ace, order++))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to build ACL index");
+            FreeACLIndex();
+            return false;
+        }
+    }
+
+    g_aclIndexValid = true;
+    g_aclIndexAcl = gAcl;
+    g_aclIndexHead = gAcl->aces;
+    return true;
+}
+
+/**
+ * Find the position in gAcl->aces after which a successive search continues.
+ *
+ * @return false if savePtr is no longer part of gAcl.
+ */
+static bool GetACLSearchStart(const OicSecAce_t *savePtr, size_t *start)
+{
+    if (NULL == savePtr)
+    {
+        *start = 0;
+        return true;
+    }
+
+    AclIndexPos_t *pos = NULL;
+    HASH_FIND(hh, g_aclIndexPos, &savePtr, sizeof(savePtr), pos);
+    if (NULL == pos)
+    {
+        return false;
+    }
+    *start = pos->order + 1;
+    return true;
+}
+
+/**
+ * Return the index of the first ACE of entry at or after ACL position start,
+ * or entry->count if there is none.
+ */
+static size_t FindACLIndexSlot(const AclIndexEntry_t *entry, size_t start)
+{
+    size_t low = 0;
+    size_t high = entry->count;
+    while (low < high)
+    {
+        size_t mid = low + ((high - low) / 2);
+        if (entry->order[mid] < start)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * Return the next ACE of the given subject after savePtr, in ACL order.
+ */
+static OicSecAce_t *GetNextIndexedACE(const AclIndexKey_t *key, const OicSecAce_t *savePtr)
+{
+    size_t start = 0;
+    if (!EnsureACLIndex() || !GetACLSearchStart(savePtr, &start))
+    {
+        return NULL;
+    }
+
+    AclIndexEntry_t *entry = NULL;
+    HASH_FIND(hh, g_aclIndex, key, sizeof(*key), entry);
+    if (NULL == entry)
+    {
+        return NULL;
+    }
+
+    size_t slot = FindACLIndexSlot(entry, start);
+    return (slot < entry->count) ? entry->aces[slot] : NULL;
+}
+
 void FreeRsrc(OicSecRsrc_t *rsrc)
 {
     //Clean each member of resource
@@ -2225,6 +2487,8 @@ OCStackResult RemoveACE(const OicUuid_t *subject, const char *resource)
 
     if (deleteFlag)
     {
+        ACLChanged();
+
         // In case of unit test do not update persistant storage.
         if (memcmp(subject->id, &WILDCARD_SUBJECT_B64_ID, sizeof(subject->id)) == 0)
         {
@@ -2287,6 +2551,8 @@ static OCStackResult RemoveAceByAceIds(AceIdList_t *aceIdList)
 
     if (deleteFlag)
     {
+        ACLChanged();
+
         uint8_t *payload = NULL;
         size_t size = 0;
         if (OC_STACK_OK == AclToCBORPayload(gAcl, OIC_SEC_ACL_V2, &payload, &size))
@@ -2718,6 +2984,7 @@ static OCStackResult RemoveAllAce(const char *resource)
                 FreeACE(aceItem);
             }
         }
+        ACLChanged();
 
         //Generate empty ACL payload
         ret = AclToCBORPayload(gAcl, OIC_SEC_ACL_V2, &payload, &size);
@@ -2744,6 +3011,7 @@ static OCStackResult RemoveAllAce(const char *resource)
                 {
                     DeleteACLList(gAcl);
                     gAcl = originAcl;
+                    ACLChanged();
                 }
                 else
                 {
@@ -2952,6 +3220,8 @@ static OCEntityHandlerResult HandleACLPostRequest(const OCEntityHandlerRequest *
                 }
             }
 
+            ACLChanged();
+
             // set acl rowner id and save
             OCStackResult ownerRes = SetAclRownerId(&newAcl->rownerID);
             if (OC_STACK_OK != ownerRes && OC_STACK_NO_RESOURCE != ownerRes)
@@ -3072,6 +3342,8 @@ static OCEntityHandlerResult HandleACL2PostRequest(const OCEntityHandlerRequest
                 }
             }
 
+            ACLChanged();
+
             // set acl rowner id and save
             OCStackResult ownerRes = SetAclRownerId(&newAcl->rownerID);
             if (OC_STACK_OK != ownerRes && OC_STACK_NO_RESOURCE != ownerRes)
@@ -3257,6 +3529,7 @@ static OCStackResult CreateACLResource()
 OCStackResult SetDefaultACL(OicSecAcl_t *acl)
 {
     gAcl = acl;
+    ACLChanged();
     return OC_STACK_OK;
 }
 
@@ -3477,6 +3750,7 @@ OCStackResult InitACLResource()
         // TODO Needs to update persistent storage
     }
     VERIFY_NOT_NULL(TAG, gAcl, FATAL);
+    ACLChanged();
 
     // Instantiate 'oic.sec.acl'
     ret = CreateACLResource();
@@ -3501,6 +3775,7 @@ OCStackResult DeInitACLResource()
         DeleteACLList(gAcl);
         gAcl = NULL;
     }
+    ACLChanged();
 
     oc_mutex_free(g_AceIdCounterMutex);
     g_AceIdCounterMutex = NULL;
@@ -3510,9 +3785,6 @@ OCStackResult DeInitACLResource()
 
 const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **savePtr)
 {
-    OicSecAce_t *ace = NULL;
-    OicSecAce_t *begin = NULL;
-
     if (NULL == subjectId || NULL == savePtr || NULL == gAcl)
     {
         return NULL;
@@ -3523,51 +3795,26 @@ const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **
 
     /*
      * savePtr MUST point to NULL if this is the 'first' call to retrieve ACL for
-     * subjectID.
+     * subjectID. On a 'successive' call the search resumes after savePtr.
      */
-    if (NULL == *savePtr)
-    {
-        begin = gAcl->aces;
-    }
-    else
-    {
-        /*
-         * If this is a 'successive' call, search for location pointed by
-         * savePtr and assign 'begin' to the next ACL after it in the linked
-         * list and start searching from there.
-         */
-        LL_FOREACH(gAcl->aces, ace)
-        {
-            if (ace == *savePtr)
-            {
-                begin = ace->next;
-            }
-        }
-    }
+    AclIndexKey_t key;
+    memset(&key, 0, sizeof(key));
+    key.subjectType = OicSecAceUuidSubject;
+    memcpy(&key.subject.uuid, subjectId, sizeof(key.subject.uuid));
 
-    // Find the next ACL corresponding to the 'subjectID' and return it.
-    LL_FOREACH(begin, ace)
+    OicSecAce_t *ace = GetNextIndexedACE(&key, *savePtr);
+    if (NULL != ace)
     {
-        if ((OicSecAceUuidSubject == ace->subjectType) &&
-            (0 == memcmp(&(ace->subjectuuid), subjectId, sizeof(OicUuid_t))))
-        {
-            OIC_LOG(DEBUG, TAG, "GetACLResourceData: found matching ACE:");
-            OIC_LOG_ACE(DEBUG, ace);
-            *savePtr = ace;
-            return ace;
-        }
+        OIC_LOG(DEBUG, TAG, "GetACLResourceData: found matching ACE:");
+        OIC_LOG_ACE(DEBUG, ace);
     }
 
-    // Cleanup in case no ACL is found
-    *savePtr = NULL;
-    return NULL;
+    *savePtr = ace;
+    return ace;
 }
 
 const OicSecAce_t* GetACLResourceDataByRoles(const OicSecRole_t *roles, size_t roleCount, OicSecAce_t **savePtr)
 {
-    OicSecAce_t *ace = NULL;
-    OicSecAce_t *begin = NULL;
-
     if ((NULL == savePtr) || (NULL == gAcl))
     {
         OIC_LOG(ERROR, TAG, "Invalid parameters to GetACLResourceDataByRoles");
@@ -3580,57 +3827,46 @@ const OicSecAce_t* GetACLResourceDataByRoles(const OicSecRole_t *roles, size_t r
         return NULL;
     }
 
-    /*
-     * savePtr MUST point to NULL if this is the 'first' call to retrieve ACL for
-     * subjectID.
-     */
-    if (NULL == *savePtr)
+    size_t start = 0;
+    if (!EnsureACLIndex() || !GetACLSearchStart(*savePtr, &start))
     {
-        begin = gAcl->aces;
+        *savePtr = NULL;
+        return NULL;
     }
-    else
+
+    // Each role has its own bucket; return the earliest match across them.
+    OicSecAce_t *found = NULL;
+    size_t foundOrder = 0;
+    for (size_t i = 0; i < roleCount; i++)
     {
-        /*
-         * If this is a 'successive' call, search for location pointed by
-         * savePtr and assign 'begin' to the next ACL after it in the linked
-         * list and start searching from there.
-         */
-        LL_FOREACH(gAcl->aces, ace)
+        AclIndexKey_t key;
+        memset(&key, 0, sizeof(key));
+        key.subjectType = OicSecAceRoleSubject;
+        OICStrcpy(key.subject.role.id, sizeof(key.subject.role.id), roles[i].id);
+        OICStrcpy(key.subject.role.authority, sizeof(key.subject.role.authority),
+                  roles[i].authority);
+
+        AclIndexEntry_t *entry = NULL;
+        HASH_FIND(hh, g_aclIndex, &key, sizeof(key), entry);
+        if (NULL == entry)
         {
-            if (ace == *savePtr)
-            {
-                begin = ace->next;
-            }
+            continue;
         }
-    }
 
-    // Find the next ACL corresponding to the 'roleID' and return it.
-    LL_FOREACH(begin, ace)
-    {
-        if (OicSecAceRoleSubject == ace->subjectType)
+        size_t slot = FindACLIndexSlot(entry, start);
+        if ((slot < entry->count) && ((NULL == found) || (entry->order[slot] < foundOrder)))
         {
-            for (size_t i = 0; i < roleCount; i++)
-            {
-                if ((0 == strcmp(ace->subjectRole.id, roles[i].id) &&
-                    (0 == strcmp(ace->subjectRole.authority, roles[i].authority))))
-                {
-                    *savePtr = ace;
-                    return ace;
-                }
-            }
+            found = entry->aces[slot];
+            foundOrder = entry->order[slot];
         }
     }
 
-    // Cleanup in case no ACL is found
-    *savePtr = NULL;
-    return NULL;
+    *savePtr = found;
+    return found;
 }
 
 const OicSecAce_t* GetACLResourceDataByConntype(const OicSecConntype_t conntype, OicSecAce_t **savePtr)
 {
-    OicSecAce_t *ace = NULL;
-    OicSecAce_t *begin = NULL;
-
     OIC_LOG_V(DEBUG, TAG, "IN: %s(%d)", __func__, conntype);
 
     if ((NULL == savePtr) || (NULL == gAcl))
@@ -3640,43 +3876,17 @@ const OicSecAce_t* GetACLResourceDataByConntype(const OicSecConntype_t conntype,
     }
 
     // savePtr MUST point to NULL if this is the 'first' call to retrieve ACL.
-    if (NULL == *savePtr)
-    {
-        begin = gAcl->aces;
-    }
-    else
-    {
-        // If this is a 'successive' call, search for location pointed by
-        // savePtr and assign 'begin' to the next ACE after it in the linked
-        // list and start searching from there.
-        LL_FOREACH(gAcl->aces, ace)
-        {
-            if (ace == *savePtr)
-            {
-                begin = ace->next;
-            }
-        }
-    }
+    AclIndexKey_t key;
+    memset(&key, 0, sizeof(key));
+    key.subjectType = OicSecAceConntypeSubject;
+    key.subject.conntype = conntype;
 
-    // Find the next ACE corresponding to the conntype, and return it.
-    LL_FOREACH(begin, ace)
-    {
-        if (OicSecAceConntypeSubject == ace->subjectType)
-        {
-            if (conntype == ace->subjectConn)
-            {
-                *savePtr = ace;
-                return ace;
-            }
-        }
-    }
-
-    // Cleanup in case no ACE is found
-    *savePtr = NULL;
+    OicSecAce_t *ace = GetNextIndexedACE(&key, *savePtr);
+    *savePtr = ace;
 
     OIC_LOG_V(DEBUG, TAG, "OUT: %s(%d)", __func__, conntype);
 
-    return NULL;
+    return ace;
 }
 
 OCStackResult AppendACLObject(const OicSecAcl_t* acl)
@@ -3703,6 +3913,7 @@ OCStackResult AppendACLObject(const OicSecAcl_t* acl)
     {
         gAcl->aces = acl->aces;
     }
+    ACLChanged();
 
     OIC_LOG_ACL(INFO, gAcl);
 
@@ -3964,7 +4175,11 @@ OCStackResult UpdateDefaultSecProvACE()
             if (secDefaultAce)
             {
                 LL_APPEND(gAcl->aces, secDefaultAce);
+            }
+            ACLChanged();
 
+            if (secDefaultAce)
+            {
                 size_t size = 0;
                 uint8_t *payload = NULL;
                 if (OC_STACK_OK == AclToCBORPayload(gAcl, OIC_SEC_ACL_V2, &payload, &size))
@@ -39,9 +39,11 @@
 #include "ocserverrequest.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
+#include "octhread.h"
 #include "ocpayload.h"
 #include "ocpayloadcbor.h"
 #include "utlist.h"
+#include <coap/uthash.h>
 #include "credresource.h"
 #include "experimental/doxmresource.h"
 #include "pstatresource.h"
@@ -95,6 +97,26 @@ static OicSecCred_t        *gCred = NULL;
 static OCResourceHandle    gCredHandle = NULL;
 static OicUuid_t           gRownerId = { .id = { 0 } };
 
+/**
+ * Credentials of gCred with the same subject. The decoded key of pskCred is
+ * kept once a PSK handshake asked for it and is zeroized with the index.
+ * The index is used by the handshakes on the CA thread and cleared when gCred
+ * changes, so it is only accessed with gCredCacheMutex held.
+ */
+typedef struct CredSubjectIndex
+{
+    OicUuid_t subject;
+    OicSecCred_t *cred;         /**< first cred of the subject in gCred */
+    OicSecCred_t *pskCred;      /**< first SYMMETRIC_PAIR_WISE_KEY of the subject */
+    uint8_t *psk;
+    size_t pskLen;
+    UT_hash_handle hh;
+} CredSubjectIndex_t;
+
+static CredSubjectIndex_t *gCredSubjectIndex = NULL;
+static bool gCredSubjectIndexValid = false;
+static oc_mutex gCredCacheMutex = NULL;
+
 typedef enum CredCompareResult{
     CRED_CMP_EQUAL = 0,
     CRED_CMP_NOT_EQUAL = 1,
@@ -1455,11 +1477,117 @@ static OCStackResult CopyPayload(uint8_t **payload, size_t *payloadSize, const D
 }
 #endif
 
+/**
+ * Tells the SSL adapter the certificates and keys it parsed from gCred are stale.
+ * Has to be called after gCred changed, not before.
+ */
+static void InvalidatePkixInfo()
+{
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    CAinvalidatePkixInfo();
+#endif // __WITH_DTLS__ or __WITH_TLS__
+}
+
+static void LockCredCaches()
+{
+    if (gCredCacheMutex)
+    {
+        oc_mutex_lock(gCredCacheMutex);
+    }
+}
+
+static void UnlockCredCaches()
+{
+    if (gCredCacheMutex)
+    {
+        oc_mutex_unlock(gCredCacheMutex);
+    }
+}
+
+static void ClearCredSubjectIndex()
+{
+    CredSubjectIndex_t *entry = NULL;
+    CredSubjectIndex_t *tmpEntry = NULL;
+    LockCredCaches();
+    HASH_ITER(hh, gCredSubjectIndex, entry, tmpEntry)
+    {
+        HASH_DEL(gCredSubjectIndex, entry);
+        if (entry->psk)
+        {
+            OICClearMemory(entry->psk, entry->pskLen);
+            OICFree(entry->psk);
+        }
+        OICFree(entry);
+    }
+    gCredSubjectIndexValid = false;
+    UnlockCredCaches();
+}
+
+/**
+ * Builds the subject index of gCred unless it is up to date. The caller holds
+ * gCredCacheMutex for as long as it uses the index.
+ *
+ * @return true if gCredSubjectIndex can be used, false if gCred has to be scanned.
+ */
+static bool BuildCredSubjectIndex()
+{
+    if (gCredSubjectIndexValid)
+    {
+        return true;
+    }
+
+    OicSecCred_t *cred = NULL;
+    LL_FOREACH(gCred, cred)
+    {
+        CredSubjectIndex_t *entry = NULL;
+        HASH_FIND(hh, gCredSubjectIndex, cred->subject.id, sizeof(cred->subject.id), entry);
+        if (NULL == entry)
+        {
+            entry = (CredSubjectIndex_t *)OICCalloc(1, sizeof(CredSubjectIndex_t));
+            if (NULL == entry)
+            {
+                OIC_LOG(ERROR, TAG, "Failed to allocate cred subject index");
+                ClearCredSubjectIndex();
+                return false;
+            }
+            memcpy(entry->subject.id, cred->subject.id, sizeof(entry->subject.id));
+            entry->cred = cred;
+            HASH_ADD(hh, gCredSubjectIndex, subject.id, sizeof(entry->subject.id), entry);
+        }
+        if ((NULL == entry->pskCred) && (SYMMETRIC_PAIR_WISE_KEY == cred->credType))
+        {
+            entry->pskCred = cred;
+        }
+    }
+
+    gCredSubjectIndexValid = true;
+    return true;
+}
+
+static CredSubjectIndex_t *FindCredSubjectIndex(const uint8_t *subject)
+{
+    CredSubjectIndex_t *entry = NULL;
+    HASH_FIND(hh, gCredSubjectIndex, subject, UUID_LENGTH, entry);
+    return entry;
+}
+
+/**
+ * Drops everything derived from gCred. Has to be called after gCred changed.
+ */
+static void InvalidateCredCaches()
+{
+    ClearCredSubjectIndex();
+    InvalidatePkixInfo();
+}
+
 static bool UpdatePersistentStorage(const OicSecCred_t *cred)
 {
     bool ret = false;
     OIC_LOG(DEBUG, TAG, "IN Cred UpdatePersistentStorage");
 
+    // Every change to the cred list is followed by storing it
+    InvalidateCredCaches();
+
     // Convert Cred data into JSON for update to persistent storage
     if (cred)
     {
@@ -1589,6 +1717,8 @@ static uint16_t GetCredId()
 #else
     LL_SORT(gCred, CmpCredId);
 #endif
+    // The index keeps the first cred of each subject in list order
+    ClearCredSubjectIndex();
 
     OicSecCred_t *currentCred = NULL, *credTmp = NULL;
     uint16_t nextCredId = 1;
@@ -2553,6 +2683,12 @@ OCStackResult InitCredResource()
     OicSecCred_t* cred = NULL;
     OicUuid_t   *rownerId = NULL;
 
+    if (NULL == gCredCacheMutex)
+    {
+        // Recursive because a failed index build clears the index it holds.
+        gCredCacheMutex = oc_mutex_new_recursive();
+    }
+
     //Read Cred resource from PS
     uint8_t *data = NULL;
     size_t size = 0;
@@ -2625,6 +2761,7 @@ OCStackResult InitCredResource()
     {
         gCred = GetCredDefault();
     }
+    InvalidateCredCaches();
 
     if (gCred)
     {
@@ -2684,6 +2821,9 @@ OCStackResult DeInitCredResource()
     OCStackResult result = OCDeleteResource(gCredHandle);
     DeleteCredList(gCred);
     gCred = NULL;
+    InvalidateCredCaches();
+    oc_mutex_free(gCredCacheMutex);
+    gCredCacheMutex = NULL;
     return result;
 }
 
@@ -2696,6 +2836,16 @@ OicSecCred_t* GetCredResourceData(const OicUuid_t* subject)
        return NULL;
     }
 
+    LockCredCaches();
+    if (BuildCredSubjectIndex())
+    {
+        CredSubjectIndex_t *entry = FindCredSubjectIndex(subject->id);
+        cred = entry ? entry->cred : NULL;
+        UnlockCredCaches();
+        return cred;
+    }
+    UnlockCredCaches();
+
     LL_FOREACH(gCred, cred)
     {
         if(memcmp(cred->subject.id, subject->id, sizeof(subject->id)) == 0)
@@ -2795,6 +2945,83 @@ static bool ValueWithinBounds(uint64_t value, uint64_t maxValue)
     return true;
 }
 
+/**
+ * Copies the key of a SYMMETRIC_PAIR_WISE_KEY cred to result, decoding it if needed.
+ *
+ * @return length of the key, or -1 on failure.
+ */
+static int32_t DecodePsk(const OicSecCred_t *cred, uint8_t *result, size_t result_length)
+{
+    int32_t ret = -1;
+
+    OIC_LOG_V(DEBUG, TAG, "%s: cred->privateData.encoding = %u", __func__, cred->privateData.encoding);
+
+    // Copy PSK.
+    // TODO: Added as workaround. Will be replaced soon.
+    if(OIC_ENCODING_RAW == cred->privateData.encoding)
+    {
+        OIC_LOG_V(DEBUG, TAG, "%s: OIC_ENCODING_RAW detected; copying PSK.", __func__);
+        if (ValueWithinBounds(cred->privateData.len, INT32_MAX))
+        {
+            size_t len = cred->privateData.len;
+            if (result_length < len)
+            {
+                OIC_LOG (ERROR, TAG, "Wrong value for result_length");
+                return -1;
+            }
+            memcpy(result, cred->privateData.data, len);
+            ret = (int32_t)len;
+        }
+    }
+    else if(OIC_ENCODING_BASE64 == cred->privateData.encoding)
+    {
+        OIC_LOG_V(DEBUG, TAG, "%s: OIC_ENCODING_BASE64 detected; copying PSK.", __func__);
+        size_t outKeySize;
+        int decodeResult = mbedtls_base64_decode(NULL, 0, &outKeySize, cred->privateData.data, cred->privateData.len);
+        if(MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL != decodeResult)
+        {
+            OIC_LOG(ERROR, TAG, "Failed base64 decoding");
+            return -1;
+        }
+        size_t outBufSize = outKeySize;
+        uint8_t* outKey = OICCalloc(1, outBufSize);
+        if(NULL == outKey)
+        {
+            OIC_LOG (ERROR, TAG, "Failed to allocate memory.");
+            return -1;
+        }
+
+        if(0 == mbedtls_base64_decode(outKey, outBufSize, &outKeySize, cred->privateData.data, cred->privateData.len))
+        {
+            if (ValueWithinBounds(outKeySize, INT32_MAX))
+            {
+                if (result_length < outKeySize)
+                {
+                    OIC_LOG (ERROR, TAG, "Wrong value for result_length");
+                }
+                else
+                {
+                    memcpy(result, outKey, outKeySize);
+                    ret = (int32_t)outKeySize;
+                }
+            }
+        }
+        else
+        {
+            OIC_LOG (ERROR, TAG, "Failed base64 decoding.");
+        }
+
+        OICClearMemory(outKey, outBufSize);
+        OICFree(outKey);
+    }
+    else
+    {
+        OIC_LOG_V(WARNING, TAG, "%s: unsupported encoding type.", __func__);
+    }
+
+    return ret;
+}
+
 int32_t GetDtlsPskCredentials(CADtlsPskCredType_t type,
               const uint8_t *desc, size_t desc_len,
               uint8_t *result, size_t result_length)
@@ -2850,113 +3077,89 @@ int32_t GetDtlsPskCredentials(CADtlsPskCredType_t type,
         case CA_DTLS_PSK_KEY:
             {
                 OicSecCred_t *cred = NULL;
-                LL_FOREACH(gCred, cred)
+                CredSubjectIndex_t *entry = NULL;
+                LockCredCaches();
+                if (desc_len == sizeof(cred->subject.id) && BuildCredSubjectIndex())
                 {
-                    if (cred->credType != SYMMETRIC_PAIR_WISE_KEY)
+                    entry = FindCredSubjectIndex(desc);
+                    cred = entry ? entry->pskCred : NULL;
+                }
+                else
+                {
+                    LL_FOREACH(gCred, cred)
                     {
-                        OIC_LOG_V(DEBUG, TAG, "%s: credid %u not a SYMMETRIC_PAIR_WISE_KEY type... skipping",
-                            __func__, cred->credId);
-                        continue;
+                        if ((cred->credType == SYMMETRIC_PAIR_WISE_KEY) &&
+                            (desc_len == sizeof(cred->subject.id)) &&
+                            (memcmp(desc, cred->subject.id, sizeof(cred->subject.id)) == 0))
+                        {
+                            break;
+                        }
                     }
+                }
 
-                    if ((desc_len == sizeof(cred->subject.id)) &&
-                        (memcmp(desc, cred->subject.id, sizeof(cred->subject.id)) == 0))
-                    {
+                if (cred)
+                {
 #ifndef NDEBUG
-                        if (OCConvertUuidToString(cred->subject.id, strUuidTmp))
-                        {
-                            OIC_LOG_V(DEBUG, TAG, "%s: credid %u (subject = %s) matches desc; checking validity.",
-                                __func__, cred->credId, strUuidTmp);
-                        }
-                        else
-                        {
-                            OIC_LOG(ERROR, TAG, "failed to convert credid to str.");
-                        }
+                    if (OCConvertUuidToString(cred->subject.id, strUuidTmp))
+                    {
+                        OIC_LOG_V(DEBUG, TAG, "%s: credid %u (subject = %s) matches desc; checking validity.",
+                            __func__, cred->credId, strUuidTmp);
+                    }
+                    else
+                    {
+                        OIC_LOG(ERROR, TAG, "failed to convert credid to str.");
+                    }
 #endif
-                        /*
-                         * If the credentials are valid for limited time,
-                         * check their expiry.
-                         */
-                        if (cred->period)
+                    /*
+                     * If the credentials are valid for limited time,
+                     * check their expiry.
+                     */
+                    if (cred->period)
+                    {
+                        if(IOTVTICAL_VALID_ACCESS != IsRequestWithinValidTime(cred->period, NULL))
                         {
-                            if(IOTVTICAL_VALID_ACCESS != IsRequestWithinValidTime(cred->period, NULL))
-                            {
-                                OIC_LOG (INFO, TAG, "Credentials are expired.");
-                                goto exit;
-                            }
+                            OIC_LOG (INFO, TAG, "Credentials are expired.");
+                            UnlockCredCaches();
+                            goto exit;
                         }
+                    }
 
-                        OIC_LOG_V(DEBUG, TAG, "%s: cred->privateData.encoding = %u", __func__, cred->privateData.encoding);
-
-                        // Copy PSK.
-                        // TODO: Added as workaround. Will be replaced soon.
-                        if(OIC_ENCODING_RAW == cred->privateData.encoding)
+                    if (entry && entry->psk)
+                    {
+                        OIC_LOG_V(DEBUG, TAG, "%s: using the cached PSK of credid %u.", __func__, cred->credId);
+                        if (result_length < entry->pskLen)
                         {
-                            OIC_LOG_V(DEBUG, TAG, "%s: OIC_ENCODING_RAW detected; copying PSK.", __func__);
-                            if (ValueWithinBounds(cred->privateData.len, INT32_MAX))
-                            {
-                                size_t len = cred->privateData.len;
-                                if (result_length < len)
-                                {
-                                    OIC_LOG (ERROR, TAG, "Wrong value for result_length");
-                                    goto exit;
-                                }
-                                memcpy(result, cred->privateData.data, len);
-                                ret = (int32_t)len;
-                            }
+                            OIC_LOG (ERROR, TAG, "Wrong value for result_length");
+                            UnlockCredCaches();
+                            goto exit;
                         }
-                        else if(OIC_ENCODING_BASE64 == cred->privateData.encoding)
+                        memcpy(result, entry->psk, entry->pskLen);
+                        ret = (int32_t)entry->pskLen;
+                    }
+                    else
+                    {
+                        ret = DecodePsk(cred, result, result_length);
+                        if ((0 < ret) && entry)
                         {
-                            OIC_LOG_V(DEBUG, TAG, "%s: OIC_ENCODING_BASE64 detected; copying PSK.", __func__);
-                            size_t outKeySize;
-                            int decodeResult = mbedtls_base64_decode(NULL, 0, &outKeySize, cred->privateData.data, cred->privateData.len);
-                            if(MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL != decodeResult)
-                            {
-                                OIC_LOG(ERROR, TAG, "Failed base64 decoding");
-                                goto exit;
-                            }
-                            size_t outBufSize = outKeySize;
-                            uint8_t* outKey = OICCalloc(1, outBufSize);
-                            if(NULL == outKey)
+                            entry->psk = (uint8_t *)OICMalloc((size_t)ret);
+                            if (entry->psk)
                             {
-                                OIC_LOG (ERROR, TAG, "Failed to allocate memory.");
-                                goto exit;
+                                memcpy(entry->psk, result, (size_t)ret);
+                                entry->pskLen = (size_t)ret;
                             }
-
-                            if(0 == mbedtls_base64_decode(outKey, outBufSize, &outKeySize, cred->privateData.data, cred->privateData.len))
-                            {
-                                if (ValueWithinBounds(outKeySize, INT32_MAX))
-                                {
-                                    if (result_length < outKeySize)
-                                    {
-                                        OIC_LOG (ERROR, TAG, "Wrong value for result_length");
-                                        OICFree(outKey);
-                                        goto exit;
-                                    }
-                                    memcpy(result, outKey, outKeySize);
-                                    ret = (int32_t)outKeySize;
-                                }
-                            }
-                            else
-                            {
-                                OIC_LOG (ERROR, TAG, "Failed base64 decoding.");
-                            }
-
-                            OICFree(outKey);
-                        }
-                        else
-                        {
-                            OIC_LOG_V(WARNING, TAG, "%s: unsupported encoding type.", __func__);
-                        }
-
-                        if (OC_STACK_OK != RegisterSymmetricCredentialRole(cred))
-                        {
-                            OIC_LOG(WARNING, TAG, "Couldn't RegisterRoleForSubject");
                         }
+                    }
+                    UnlockCredCaches();
 
-                        goto exit;
+                    if (OC_STACK_OK != RegisterSymmetricCredentialRole(cred))
+                    {
+                        OIC_LOG(WARNING, TAG, "Couldn't RegisterRoleForSubject");
                     }
+
+                    goto exit;
                 }
+
+                UnlockCredCaches();
                 OIC_LOG(DEBUG, TAG, "Can not find subject matched credential.");
 
 #ifdef MULTIPLE_OWNER
@@ -31,6 +31,7 @@
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "crlresource.h"
+#include "casecurityinterface.h"
 #include "ocpayloadcbor.h"
 #include "mbedtls/base64.h"
 #include <time.h>
@@ -76,6 +77,16 @@ void DeleteCrl(OicSecCrl_t *crl)
     }
 }
 
+/**
+ * Tells the SSL adapter the CRL it parsed is stale.
+ */
+static void InvalidatePkixInfo()
+{
+#if defined(__WITH_DTLS__) || defined(__WITH_TLS__)
+    CAinvalidatePkixInfo();
+#endif // __WITH_DTLS__ or __WITH_TLS__
+}
+
 static bool copyByteArray(const uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len)
 {
     OICFree(*out);
@@ -455,7 +466,10 @@ OCStackResult UpdateCRLResource(OicSecCrl_t *crl)
         return res;
     }
 
-    return UpdateSecureResourceInPS(OIC_CBOR_CRL_NAME, payload, size);
+    res = UpdateSecureResourceInPS(OIC_CBOR_CRL_NAME, payload, size);
+    // GetDerCrl() reads the CRL back from PS, so the SSL adapter has to reload it now
+    InvalidatePkixInfo();
+    return res;
 }
 
 static bool ValidateQuery(const char * query)
@@ -696,6 +710,7 @@ OCStackResult InitCRLResource()
     {
         gCrl = GetCrlDefault();
     }
+    InvalidatePkixInfo();
 
     ret = CreateCRLResource();
     OICFree(data);
@@ -711,6 +726,7 @@ OCStackResult DeInitCRLResource()
     gCrlHandle = NULL;
     DeleteCrl(gCrl);
     gCrl = NULL;
+    InvalidatePkixInfo();
     return result;
 }
 
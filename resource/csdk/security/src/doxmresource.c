@@ -1228,6 +1228,11 @@ static CAResult_t DoxmDTLSHandshakeCB(const CAEndpoint_t *endpoint, const CAErro
         OC_VERIFY(CASetSecureEndpointAttribute(endpoint,
             CA_SECURE_ENDPOINT_ATTRIBUTE_ADMINISTRATOR));
     }
+    else
+    {
+        // The ownership transfer failed; the next attempt derives its own PSK.
+        ClearPinDerivedPsk();
+    }
 
     OIC_LOG_V(DEBUG, TAG, "Out %s(%p, %p)", __func__, endpoint, info);
     return CA_STATUS_OK;
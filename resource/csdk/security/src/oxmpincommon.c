@@ -77,6 +77,25 @@ static PinOxmData_t g_PinOxmData = {
         .pinType = (OicSecPinType_t)(OXM_RANDOM_PIN_DEFAULT_PIN_TYPE),
     };
 
+/**
+ * PSK last derived from a PIN, so that repeated handshakes with the same PIN
+ * and device do not run PBKDF2 again.
+ */
+typedef struct PinDerivedPsk {
+    bool valid;
+    uint8_t pinData[OXM_RANDOM_PIN_MAX_SIZE + 1];
+    size_t pinSize;
+    OicUuid_t newDevice;
+    uint8_t psk[OWNER_PSK_LENGTH_128];
+}PinDerivedPsk_t;
+
+static PinDerivedPsk_t g_PinDerivedPsk = { .valid = false };
+
+void ClearPinDerivedPsk(void)
+{
+    OICClearMemory(&g_PinDerivedPsk, sizeof(g_PinDerivedPsk));
+}
+
 /**
  * Internal function to check pinType
  */
@@ -311,6 +330,7 @@ OCStackResult OC_CALL GeneratePin(char* pinBuffer, size_t bufferSize)
 
     pinBuffer[g_PinOxmData.pinSize] = '\0';
     g_PinOxmData.pinData[g_PinOxmData.pinSize] = '\0';
+    ClearPinDerivedPsk();
 
     if(g_displayPinCallbacks.callback)
     {
@@ -383,6 +403,7 @@ OCStackResult InputPin(OicUuid_t deviceId, char* pinBuffer, size_t bufferSize)
         OIC_LOG(ERROR, TAG, "Callback for input PIN should be registered to use Random PIN based OxM.");
         return OC_STACK_ERROR;
     }
+    ClearPinDerivedPsk();
 
     return OC_STACK_OK;
 }
@@ -397,6 +418,7 @@ OCStackResult OC_CALL SetPreconfigPin(const char *pinBuffer, size_t pinLength)
 
     memcpy(g_PinOxmData.pinData, pinBuffer, pinLength);
     g_PinOxmData.pinData[pinLength] = '\0';
+    ClearPinDerivedPsk();
 
     return OC_STACK_OK;
 }
@@ -409,11 +431,26 @@ void SetUuidForPinBasedOxm(const OicUuid_t* uuid)
     if(NULL != uuid)
     {
         memcpy(g_PinOxmData.newDevice.id, uuid->id, UUID_LENGTH);
+        // Called when an ownership transfer starts and when it ends.
+        ClearPinDerivedPsk();
     }
 }
 
 int DerivePSKUsingPIN(uint8_t* result)
 {
+    if (g_PinDerivedPsk.valid &&
+        (g_PinDerivedPsk.pinSize == g_PinOxmData.pinSize) &&
+        (0 == memcmp(g_PinDerivedPsk.pinData, g_PinOxmData.pinData, g_PinOxmData.pinSize)) &&
+        (0 == memcmp(g_PinDerivedPsk.newDevice.id, g_PinOxmData.newDevice.id, UUID_LENGTH)))
+    {
+        OIC_LOG(DEBUG, TAG, "Using the PSK already derived from this PIN");
+        memcpy(result, g_PinDerivedPsk.psk, OWNER_PSK_LENGTH_128);
+        return 0;
+    }
+
+    // PIN or device changed: the old key must not stay in memory
+    ClearPinDerivedPsk();
+
     int dtlsRes = DeriveCryptoKeyFromPassword(
                                               (const unsigned char *)g_PinOxmData.pinData,
                                               g_PinOxmData.pinSize,
@@ -421,6 +458,15 @@ int DerivePSKUsingPIN(uint8_t* result)
                                               UUID_LENGTH, PBKDF_ITERATIONS,
                                               OWNER_PSK_LENGTH_128, result);
 
+    if ((0 == dtlsRes) && (g_PinOxmData.pinSize < sizeof(g_PinDerivedPsk.pinData)))
+    {
+        memcpy(g_PinDerivedPsk.pinData, g_PinOxmData.pinData, g_PinOxmData.pinSize);
+        g_PinDerivedPsk.pinSize = g_PinOxmData.pinSize;
+        memcpy(g_PinDerivedPsk.newDevice.id, g_PinOxmData.newDevice.id, UUID_LENGTH);
+        memcpy(g_PinDerivedPsk.psk, result, OWNER_PSK_LENGTH_128);
+        g_PinDerivedPsk.valid = true;
+    }
+
     OIC_LOG_V(DEBUG, TAG, "DeriveCryptoKeyFromPassword Completed (%d)", dtlsRes);
     OIC_LOG_V(DEBUG, TAG, "PIN : %s", g_PinOxmData.pinData);
     OIC_LOG(DEBUG, TAG, "UUID : ");
@@ -20,8 +20,10 @@
 #include <string.h>
 #include <assert.h>
 
+#include <coap/uthash.h>
 #include "utlist.h"
 #include "oic_malloc.h"
+#include "oic_string.h"
 #include "experimental/ocrandom.h"
 #include "policyengine.h"
 #include "resourcemanager.h"
@@ -39,6 +41,38 @@
 
 #define TAG "OIC_SRM_PE"
 
+/**
+ * Maximum number of ACL decisions remembered by the policy engine.
+ */
+#define PE_DECISION_CACHE_SIZE 64
+
+/**
+ * Everything in the request context that ProcessAccessRequest() depends on.
+ * Zeroed before use so that it can be hashed as raw bytes.
+ */
+typedef struct PEDecisionKey
+{
+    OicUuid_t               subjectUuid;
+    uint16_t                requestedPermission;
+    bool                    secureChannel;
+    OicSecDiscoverable_t    discoverable;
+    char                    resourceUri[MAX_URI_LENGTH + 1];
+} PEDecisionKey_t;
+
+typedef struct PEDecision
+{
+    PEDecisionKey_t         key;
+    SRMAccessResponse_t     responseVal;
+    struct PEDecision       *prev;
+    struct PEDecision       *next;
+    UT_hash_handle          hh;
+} PEDecision_t;
+
+static PEDecision_t *g_decisionCache = NULL;    // hashed by key
+static PEDecision_t *g_decisionList = NULL;     // oldest first, for eviction
+static size_t g_decisionCount = 0;
+static uint32_t g_decisionGeneration = 0;
+
 uint16_t GetPermissionFromCAMethod_t(const CAMethod_t method)
 {
     uint16_t perm = 0;
@@ -69,6 +103,91 @@ uint16_t GetPermissionFromCAMethod_t(const CAMethod_t method)
     return perm;
 }
 
+static void ClearDecisionCache(void)
+{
+    PEDecision_t *decision = NULL;
+    PEDecision_t *tmp = NULL;
+    HASH_ITER(hh, g_decisionCache, decision, tmp)
+    {
+        HASH_DEL(g_decisionCache, decision);
+        DL_DELETE(g_decisionList, decision);
+        OICFree(decision);
+    }
+    g_decisionCount = 0;
+}
+
+void DeInitPolicyEngine(void)
+{
+    ClearDecisionCache();
+}
+
+static void MakeDecisionKey(const SRMRequestContext_t *context, PEDecisionKey_t *key)
+{
+    memset(key, 0, sizeof(*key));
+    memcpy(&key->subjectUuid, &context->subjectUuid, sizeof(key->subjectUuid));
+    key->requestedPermission = context->requestedPermission;
+    key->secureChannel = context->secureChannel;
+    key->discoverable = context->discoverable;
+    OICStrcpy(key->resourceUri, sizeof(key->resourceUri), context->resourceUri);
+}
+
+/**
+ * Look up a previous ACL decision for this request. The cache is dropped
+ * whenever the ACL has changed since it was filled.
+ *
+ * @return true and set context->responseVal if a decision was found.
+ */
+static bool GetCachedDecision(SRMRequestContext_t *context)
+{
+    uint32_t generation = GetACLGeneration();
+    if (generation != g_decisionGeneration)
+    {
+        ClearDecisionCache();
+        g_decisionGeneration = generation;
+        return false;
+    }
+
+    PEDecisionKey_t key;
+    MakeDecisionKey(context, &key);
+
+    PEDecision_t *decision = NULL;
+    HASH_FIND(hh, g_decisionCache, &key, sizeof(key), decision);
+    if (NULL == decision)
+    {
+        return false;
+    }
+
+    context->responseVal = decision->responseVal;
+    return true;
+}
+
+static void CacheDecision(const SRMRequestContext_t *context)
+{
+    PEDecision_t *decision = NULL;
+    if (PE_DECISION_CACHE_SIZE <= g_decisionCount)
+    {
+        // Reuse the oldest entry.
+        decision = g_decisionList;
+        HASH_DEL(g_decisionCache, decision);
+        DL_DELETE(g_decisionList, decision);
+        g_decisionCount--;
+    }
+    else
+    {
+        decision = (PEDecision_t *)OICMalloc(sizeof(PEDecision_t));
+        if (NULL == decision)
+        {
+            return;
+        }
+    }
+
+    MakeDecisionKey(context, &decision->key);
+    decision->responseVal = context->responseVal;
+    HASH_ADD(hh, g_decisionCache, key, sizeof(decision->key), decision);
+    DL_APPEND(g_decisionList, decision);
+    g_decisionCount++;
+}
+
 /**
  * Compare the request's subject to DevOwner.
  *
@@ -672,9 +791,20 @@ static void ProcessAccessRequest(SRMRequestContext_t *context)
 
     OIC_LOG_V(DEBUG, TAG, "Entering %s(%s)", __func__, context->resourceUri);
 
+    if (GetCachedDecision(context))
+    {
+        OIC_LOG_V(INFO, TAG, "%s: returning cached responseVal = %s", __func__,
+            IsAccessGranted(context->responseVal) ? "ACCESS_GRANTED" : "ACCESS_DENIED");
+        return;
+    }
+
     const OicSecAce_t *currentAce = NULL;
     OicSecAce_t *aceSavePtr = NULL;
 
+    // Decisions that depend on the time of day or on the endpoint's asserted
+    // roles are not cached.
+    bool cacheable = true;
+
     // Start out assuming subject not found.
     context->responseVal = ACCESS_DENIED_SUBJECT_NOT_FOUND;
 
@@ -696,6 +826,7 @@ static void ProcessAccessRequest(SRMRequestContext_t *context)
         {
             OIC_LOG_V(DEBUG, TAG, "%s: found conntype %s match; processing for access.",
                 __func__, (AUTH_CRYPT == conntype?"auth-crypt":"anon-clear"));
+            cacheable = cacheable && (NULL == currentAce->validities);
             ProcessMatchingACE(context, currentAce);
         }
         else
@@ -716,6 +847,7 @@ static void ProcessAccessRequest(SRMRequestContext_t *context)
 
             if (NULL != currentAce)
             {
+                cacheable = cacheable && (NULL == currentAce->validities);
                 ProcessMatchingACE(context, currentAce);
             }
             else
@@ -730,6 +862,7 @@ static void ProcessAccessRequest(SRMRequestContext_t *context)
     // If no subject ACE granted access, try role ACEs.
     if (!IsAccessGranted(context->responseVal))
     {
+        cacheable = false;
         currentAce = NULL;
         aceSavePtr = NULL;
         OicSecRole_t *roles = NULL;
@@ -761,6 +894,11 @@ static void ProcessAccessRequest(SRMRequestContext_t *context)
     }
 #endif /* defined(__WITH_DTLS__) || defined(__WITH_TLS__) */
 
+    if (cacheable)
+    {
+        CacheDecision(context);
+    }
+
     OIC_LOG_V(INFO, TAG, "%s: returning with responseVal = %s", __func__,
         IsAccessGranted(context->responseVal) ? "ACCESS_GRANTED" : "ACCESS_DENIED");
     return;
@@ -32,6 +32,7 @@
 #include "ocpayloadcbor.h"
 #include "ocstack.h"
 #include "oic_malloc.h"
+#include "oic_string.h"
 #include "experimental/payload_logging.h"
 #include "resourcemanager.h"
 #include "secureresourcemanager.h"
@@ -64,6 +65,191 @@ typedef enum _PSDatabase
     PS_DATABASE_DEVICEPROPERTIES
 } PSDatabase;
 
+/*
+ * Updates of a single resource are appended to a journal file stored next to
+ * the database ("<database>.log") instead of rewriting the whole database.
+ * The database file itself keeps the original CBOR map format, so existing
+ * databases are used as they are and become the base the journal applies to.
+ *
+ * Journal layout, all integers little endian:
+ *   header : "OCPJ" | version (1 byte) | 3 reserved bytes | base size (4) | base CRC-32 (4)
+ *   record : name length (2) | payload length (4) | name | payload | CRC-32 of the previous fields (4)
+ *
+ * A record with an empty payload removes the resource. The header ties the
+ * journal to one version of the database, so a journal is ignored once the
+ * database has been rewritten. A torn record at the end of the journal fails
+ * its CRC check and is dropped with everything after it; the next update then
+ * rewrites the database rather than the journal.
+ *
+ * When the journal grows bigger than the database (or PS_JOURNAL_MIN_COMPACT_SIZE)
+ * it is merged back. The merged database is first written to "<database>.tmp",
+ * then to the database, and only then are the journal and the temporary file
+ * removed. A complete temporary file found later means that sequence was
+ * interrupted, and it is copied over the database again.
+ *
+ * The handler opens the journal and the temporary file by the names above, so
+ * it has to keep them with the database: journaling is only used when the
+ * handler sets OCPersistentStorage::journal. Otherwise every update rewrites
+ * the database as before.
+ */
+#define PS_JOURNAL_SUFFIX ".log"
+#define PS_COMMIT_SUFFIX ".tmp"
+#define PS_JOURNAL_VERSION 1
+#define PS_JOURNAL_HEADER_SIZE 16
+#define PS_JOURNAL_RECORD_OVERHEAD 10
+#define PS_COMMIT_HEADER_SIZE 16
+#define PS_JOURNAL_MIN_COMPACT_SIZE 4096
+
+static const uint8_t PS_JOURNAL_MAGIC[4] = { 'O', 'C', 'P', 'J' };
+static const uint8_t PS_COMMIT_MAGIC[4] = { 'O', 'C', 'P', 'T' };
+
+/**
+ * Resources kept when a database is rewritten, in addition to the one being
+ * updated and those found in the journal.
+ */
+static const char * const * GetDatabaseResourceNames(PSDatabase database, size_t *count)
+{
+    static const char *securityNames[7];
+    static const char *devicePropsNames[1];
+
+    if (PS_DATABASE_DEVICEPROPERTIES == database)
+    {
+        devicePropsNames[0] = OC_JSON_DEVICE_PROPS_NAME;
+        *count = sizeof(devicePropsNames) / sizeof(devicePropsNames[0]);
+        return devicePropsNames;
+    }
+
+    securityNames[0] = OIC_JSON_ACL_NAME;
+    securityNames[1] = OIC_JSON_PSTAT_NAME;
+    securityNames[2] = OIC_JSON_DOXM_NAME;
+    securityNames[3] = OIC_JSON_AMACL_NAME;
+    securityNames[4] = OIC_JSON_CRED_NAME;
+    securityNames[5] = OIC_JSON_RESET_PF_NAME;
+    securityNames[6] = OIC_JSON_CRL_NAME;
+    *count = sizeof(securityNames) / sizeof(securityNames[0]);
+    return securityNames;
+}
+
+static PSDatabase GetDatabaseType(const char *databaseName)
+{
+    // Determine which database we are working with so we can scope our operations
+    if (0 == strcmp(OC_DEVICE_PROPS_FILE_NAME, databaseName))
+    {
+        return PS_DATABASE_DEVICEPROPERTIES;
+    }
+    return PS_DATABASE_SECURITY;
+}
+
+static uint32_t PSCrc32(const uint8_t *data, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void PutUint16(uint8_t *buf, uint16_t value)
+{
+    buf[0] = (uint8_t)(value & 0xFF);
+    buf[1] = (uint8_t)(value >> 8);
+}
+
+static void PutUint32(uint8_t *buf, uint32_t value)
+{
+    for (size_t i = 0; i < 4; i++)
+    {
+        buf[i] = (uint8_t)((value >> (8 * i)) & 0xFF);
+    }
+}
+
+static uint16_t GetUint16(const uint8_t *buf)
+{
+    return (uint16_t)(buf[0] | (buf[1] << 8));
+}
+
+static uint32_t GetUint32(const uint8_t *buf)
+{
+    return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+           ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+/**
+ * Whether the handler keeps the journal and temporary files with the database.
+ */
+static bool IsJournalEnabled(const OCPersistentStorage *ps)
+{
+    return ps->journal && ps->unlink;
+}
+
+/**
+ * Whether a resource holds key material. Updates to it are written by a full
+ * rewrite, so that replaced or deleted keys do not linger in the journal.
+ */
+static bool IsSecretResource(const char *resourceName)
+{
+    return (0 == strcmp(resourceName, OIC_JSON_CRED_NAME));
+}
+
+/**
+ * Builds "<databaseName><suffix>". The caller must OICFree() the result.
+ */
+static char *GetDatabaseFileName(const char *databaseName, const char *suffix)
+{
+    size_t len = strlen(databaseName) + strlen(suffix) + 1;
+    char *name = (char *)OICMalloc(len);
+    if (name)
+    {
+        OICStrcpy(name, len, databaseName);
+        OICStrcat(name, len, suffix);
+    }
+    return name;
+}
+
+/**
+ * Writes size bytes to a file in persistent storage.
+ *
+ * @param ps    is a pointer to OCPersistentStorage for the Virtual Resource(s).
+ * @param name  is the name of the file.
+ * @param mode  is the open mode, "wb" to replace the file or "ab" to append to it.
+ * @param data  is the data to write. Both data and size may be 0 to create an empty file.
+ * @param size  is the size of data.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult WriteFileToPS(const OCPersistentStorage *ps, const char *name,
+                                   const char *mode, const uint8_t *data, size_t size)
+{
+    OCStackResult result = OC_STACK_ERROR;
+
+    FILE *fp = ps->open(name, mode);
+    if (fp)
+    {
+        size_t numberItems = size ? ps->write(data, 1, size, fp) : 0;
+        if (size == numberItems)
+        {
+            OIC_LOG_V(DEBUG, TAG, "Written %" PRIuPTR " bytes into %s", size, name);
+            result = OC_STACK_OK;
+        }
+        else
+        {
+            OIC_LOG_V(ERROR, TAG, "Failed writing %" PRIuPTR " in %s", numberItems, name);
+        }
+        ps->close(fp);
+    }
+    else
+    {
+        OIC_LOG_V(ERROR, TAG, "File open failed for %s.", name);
+    }
+
+    return result;
+}
+
 /**
  * Writes CBOR payload to the specified database in persistent storage.
  *
@@ -80,35 +266,15 @@ static OCStackResult WritePayloadToPS(const char *databaseName, uint8_t *payload
         return OC_STACK_INVALID_PARAM;
     }
 
-    OCStackResult result = OC_STACK_ERROR;
-
     OIC_LOG_V(DEBUG, TAG, "Writing in the file: %" PRIuPTR, size);
 
     OCPersistentStorage* ps = OCGetPersistentStorageHandler();
-    if (ps)
+    if (!ps)
     {
-        FILE *fp = ps->open(databaseName, "wb");
-        if (fp)
-        {
-            size_t numberItems = ps->write(payload, 1, size, fp);
-            if (size == numberItems)
-            {
-                OIC_LOG_V(DEBUG, TAG, "Written %" PRIuPTR " bytes into %s", size, databaseName);
-                result = OC_STACK_OK;
-            }
-            else
-            {
-                OIC_LOG_V(ERROR, TAG, "Failed writing %" PRIuPTR " in %s", numberItems, databaseName);
-            }
-            ps->close(fp);
-        }
-        else
-        {
-            OIC_LOG(ERROR, TAG, "File open failed.");
-        }
+        return OC_STACK_ERROR;
     }
 
-    return result;
+    return WriteFileToPS(ps, databaseName, "wb", payload, size);
 }
 
 /**
@@ -142,6 +308,580 @@ static size_t GetDatabaseSize(const OCPersistentStorage *ps, const char *databas
     return size;
 }
 
+/**
+ * Reads a whole file from persistent storage.
+ *
+ * @note A missing or empty file is not an error; data is then left NULL.
+ *       Caller of this method MUST use OICFree() to release data.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult ReadFileFromPS(const OCPersistentStorage *ps, const char *name,
+                                    uint8_t **data, size_t *size)
+{
+    *data = NULL;
+    *size = 0;
+
+    size_t fileSize = GetDatabaseSize(ps, name);
+    if (0 == fileSize)
+    {
+        return OC_STACK_OK;
+    }
+
+    uint8_t *fileData = (uint8_t *)OICCalloc(1, fileSize);
+    if (!fileData)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    OCStackResult ret = OC_STACK_ERROR;
+    FILE *fp = ps->open(name, "rb");
+    if (fp)
+    {
+        if (ps->read(fileData, 1, fileSize, fp) == fileSize)
+        {
+            ret = OC_STACK_OK;
+        }
+        ps->close(fp);
+    }
+
+    if (OC_STACK_OK != ret)
+    {
+        OICFree(fileData);
+        return ret;
+    }
+
+    *data = fileData;
+    *size = fileSize;
+    return OC_STACK_OK;
+}
+
+/**
+ * One resource update read back from a journal. name and payload point into
+ * the journal buffer; name is not NUL terminated.
+ */
+typedef struct PSJournalRecord
+{
+    const char *name;
+    size_t nameLen;
+    const uint8_t *payload;
+    size_t payloadLen;
+} PSJournalRecord_t;
+
+static bool IsJournalForDatabase(const uint8_t *journal, size_t journalSize,
+                                 const uint8_t *dbData, size_t dbSize)
+{
+    return (journal && (PS_JOURNAL_HEADER_SIZE <= journalSize) &&
+            (0 == memcmp(journal, PS_JOURNAL_MAGIC, sizeof(PS_JOURNAL_MAGIC))) &&
+            (PS_JOURNAL_VERSION == journal[4]) &&
+            (GetUint32(journal + 8) == (uint32_t)dbSize) &&
+            (GetUint32(journal + 12) == PSCrc32(dbData, dbSize)));
+}
+
+/**
+ * Reads the journal record at *offset and advances *offset past it.
+ *
+ * @return false at the end of the journal or at the first damaged record.
+ */
+static bool GetNextJournalRecord(const uint8_t *journal, size_t journalSize,
+                                 size_t *offset, PSJournalRecord_t *record)
+{
+    size_t pos = *offset;
+    if ((journalSize < pos) || ((journalSize - pos) < PS_JOURNAL_RECORD_OVERHEAD))
+    {
+        return false;
+    }
+
+    size_t nameLen = GetUint16(journal + pos);
+    size_t payloadLen = GetUint32(journal + pos + 2);
+    size_t available = journalSize - pos - PS_JOURNAL_RECORD_OVERHEAD;
+    if ((0 == nameLen) || (nameLen > available) || (payloadLen > (available - nameLen)))
+    {
+        return false;
+    }
+
+    size_t crcOffset = pos + 6 + nameLen + payloadLen;
+    if (GetUint32(journal + crcOffset) != PSCrc32(journal + pos, crcOffset - pos))
+    {
+        OIC_LOG_V(WARNING, TAG, "Dropping damaged journal record at %" PRIuPTR, pos);
+        return false;
+    }
+
+    record->name = (const char *)(journal + pos + 6);
+    record->nameLen = nameLen;
+    record->payload = journal + pos + 6 + nameLen;
+    record->payloadLen = payloadLen;
+    *offset = crcOffset + 4;
+    return true;
+}
+
+/**
+ * @return the length of the undamaged part of a journal.
+ */
+static size_t GetJournalValidSize(const uint8_t *journal, size_t journalSize)
+{
+    size_t offset = PS_JOURNAL_HEADER_SIZE;
+    PSJournalRecord_t record;
+    while (GetNextJournalRecord(journal, journalSize, &offset, &record))
+    {
+    }
+    return offset;
+}
+
+/**
+ * Finds the latest journal record for resourceName.
+ *
+ * @return true if the journal holds resourceName, in which case record
+ *         describes the latest value (an empty payload means removed).
+ */
+static bool FindJournalRecord(const uint8_t *journal, size_t journalSize,
+                              const char *resourceName, PSJournalRecord_t *found)
+{
+    bool isFound = false;
+    size_t nameLen = strlen(resourceName);
+    size_t offset = PS_JOURNAL_HEADER_SIZE;
+    PSJournalRecord_t record;
+    while (GetNextJournalRecord(journal, journalSize, &offset, &record))
+    {
+        if ((record.nameLen == nameLen) && (0 == memcmp(record.name, resourceName, nameLen)))
+        {
+            *found = record;
+            isFound = true;
+        }
+    }
+    return isFound;
+}
+
+/**
+ * One resource of a database being rebuilt. data is either borrowed or,
+ * when it was copied out of the old database, owned through ownedData.
+ */
+typedef struct PSSection
+{
+    const char *name;
+    size_t nameLen;
+    const uint8_t *data;
+    size_t size;
+    uint8_t *ownedData;
+} PSSection_t;
+
+typedef struct PSSectionList
+{
+    PSSection_t *sections;
+    size_t count;
+    size_t capacity;
+} PSSectionList_t;
+
+static void FreeSectionList(PSSectionList_t *list)
+{
+    for (size_t i = 0; i < list->count; i++)
+    {
+        OICFree(list->sections[i].ownedData);
+    }
+    OICFree(list->sections);
+    memset(list, 0, sizeof(*list));
+}
+
+static OCStackResult SetSection(PSSectionList_t *list, const char *name, size_t nameLen,
+                                const uint8_t *data, size_t size, uint8_t *ownedData)
+{
+    PSSection_t *section = NULL;
+    for (size_t i = 0; i < list->count; i++)
+    {
+        if ((list->sections[i].nameLen == nameLen) &&
+            (0 == memcmp(list->sections[i].name, name, nameLen)))
+        {
+            section = &list->sections[i];
+            OICFree(section->ownedData);
+            break;
+        }
+    }
+
+    if (!section)
+    {
+        if (list->count == list->capacity)
+        {
+            size_t capacity = list->capacity ? (list->capacity * 2) : 8;
+            PSSection_t *sections = (PSSection_t *)OICRealloc(list->sections,
+                                                              capacity * sizeof(PSSection_t));
+            if (!sections)
+            {
+                OICFree(ownedData);
+                return OC_STACK_NO_MEMORY;
+            }
+            list->sections = sections;
+            list->capacity = capacity;
+        }
+        section = &list->sections[list->count++];
+        section->name = name;
+        section->nameLen = nameLen;
+    }
+
+    section->data = data;
+    section->size = size;
+    section->ownedData = ownedData;
+    return OC_STACK_OK;
+}
+
+/**
+ * Rebuilds a database from its current content, the undamaged records of its
+ * journal and one more update.
+ *
+ * @param databaseName  is the name of the database.
+ * @param dbData        is the current database, may be NULL.
+ * @param dbSize        is the size of dbData.
+ * @param journal       is the journal to apply, may be NULL.
+ * @param journalSize   is the size of journal.
+ * @param resourceName  is the name of the resource to update, may be NULL.
+ * @param payload       is the new value of resourceName; NULL removes it.
+ * @param size          is the size of payload.
+ * @param outPayload    receives the new database. Caller must OICFree() it.
+ * @param outSize       receives the size of outPayload.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult BuildDatabase(const char *databaseName,
+                                   const uint8_t *dbData, size_t dbSize,
+                                   const uint8_t *journal, size_t journalSize,
+                                   const char *resourceName, const uint8_t *payload, size_t size,
+                                   uint8_t **outPayload, size_t *outSize)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    int64_t cborEncoderResult = CborNoError;
+    PSSectionList_t list;
+    memset(&list, 0, sizeof(list));
+    uint8_t *out = NULL;
+
+    // Only copy resources owned by the target database
+    if (dbData && dbSize)
+    {
+        size_t nameCount = 0;
+        const char * const *names = GetDatabaseResourceNames(GetDatabaseType(databaseName),
+                                                             &nameCount);
+
+        CborParser parser;  // will be initialized in |cbor_parser_init|
+        CborValue cbor;     // will be initialized in |cbor_parser_init|
+        cbor_parser_init(dbData, dbSize, 0, &parser, &cbor);
+        for (size_t i = 0; i < nameCount; i++)
+        {
+            CborValue curVal = {0};
+            CborError cborFindResult = cbor_value_map_find_value(&cbor, names[i], &curVal);
+            if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
+            {
+                uint8_t *value = NULL;
+                size_t valueLen = 0;
+                cborFindResult = cbor_value_dup_byte_string(&curVal, &value, &valueLen, NULL);
+                if (CborNoError != cborFindResult)
+                {
+                    OIC_LOG_V(ERROR, TAG, "Failed Finding %s Value.", names[i]);
+                    ret = OC_STACK_ERROR;
+                    goto exit;
+                }
+                ret = SetSection(&list, names[i], strlen(names[i]), value, valueLen, value);
+                VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
+            }
+        }
+    }
+
+    if (journal)
+    {
+        size_t offset = PS_JOURNAL_HEADER_SIZE;
+        PSJournalRecord_t record;
+        while (GetNextJournalRecord(journal, journalSize, &offset, &record))
+        {
+            ret = SetSection(&list, record.name, record.nameLen,
+                             record.payload, record.payloadLen, NULL);
+            VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
+        }
+    }
+
+    if (resourceName)
+    {
+        ret = SetSection(&list, resourceName, strlen(resourceName),
+                         payload, payload ? size : 0, NULL);
+        VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
+    }
+
+    ret = OC_STACK_ERROR;
+    {
+        size_t allocSize = CBOR_ENCODING_SIZE_ADDITION;
+        for (size_t i = 0; i < list.count; i++)
+        {
+            // Name, value and their CBOR headers
+            allocSize += list.sections[i].nameLen + list.sections[i].size + 18;
+        }
+
+        out = (uint8_t *)OICCalloc(1, allocSize);
+        VERIFY_NOT_NULL(TAG, out, ERROR);
+        CborEncoder encoder;  // will be initialized in |cbor_parser_init|
+        cbor_encoder_init(&encoder, out, allocSize, 0);
+        CborEncoder resource;  // will be initialized in |cbor_encoder_create_map|
+        cborEncoderResult |= cbor_encoder_create_map(&encoder, &resource, CborIndefiniteLength);
+        VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding PS Map.");
+
+        for (size_t i = 0; i < list.count; i++)
+        {
+            const PSSection_t *section = &list.sections[i];
+            if (0 == section->size)
+            {
+                continue;
+            }
+            cborEncoderResult |= cbor_encode_text_string(&resource, section->name, section->nameLen);
+            VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Value Tag");
+            cborEncoderResult |= cbor_encode_byte_string(&resource, section->data, section->size);
+            VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Value.");
+        }
+
+        cborEncoderResult |= cbor_encoder_close_container(&encoder, &resource);
+        VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Closing Array.");
+        VERIFY_SUCCESS(TAG, (CborNoError == cborEncoderResult), ERROR);
+
+        *outSize = cbor_encoder_get_buffer_size(&encoder, out);
+        *outPayload = out;
+        out = NULL;
+        ret = OC_STACK_OK;
+    }
+
+exit:
+    OICFree(out);
+    FreeSectionList(&list);
+    return ret;
+}
+
+/**
+ * Replaces a database and drops its journal, so that an interruption at any
+ * point leaves either the old or the new content.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+static OCStackResult CommitDatabaseToPS(const char *databaseName, uint8_t *payload, size_t size)
+{
+    if (!databaseName || !payload || (0 == size))
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCPersistentStorage *ps = OCGetPersistentStorageHandler();
+    if (!ps)
+    {
+        return OC_STACK_ERROR;
+    }
+    if (!IsJournalEnabled(ps))
+    {
+        return WritePayloadToPS(databaseName, payload, size);
+    }
+
+    OCStackResult ret = OC_STACK_ERROR;
+    uint8_t *commit = NULL;
+    char *journalName = GetDatabaseFileName(databaseName, PS_JOURNAL_SUFFIX);
+    char *commitName = GetDatabaseFileName(databaseName, PS_COMMIT_SUFFIX);
+    VERIFY_NOT_NULL(TAG, journalName, ERROR);
+    VERIFY_NOT_NULL(TAG, commitName, ERROR);
+
+    commit = (uint8_t *)OICCalloc(1, PS_COMMIT_HEADER_SIZE + size);
+    VERIFY_NOT_NULL(TAG, commit, ERROR);
+    memcpy(commit, PS_COMMIT_MAGIC, sizeof(PS_COMMIT_MAGIC));
+    PutUint32(commit + 8, (uint32_t)size);
+    PutUint32(commit + 12, PSCrc32(payload, size));
+    memcpy(commit + PS_COMMIT_HEADER_SIZE, payload, size);
+
+    ret = WriteFileToPS(ps, commitName, "wb", commit, PS_COMMIT_HEADER_SIZE + size);
+    if (OC_STACK_OK != ret)
+    {
+        ps->unlink(commitName);
+        goto exit;
+    }
+
+    ret = WritePayloadToPS(databaseName, payload, size);
+    VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
+
+    ps->unlink(journalName);
+    ps->unlink(commitName);
+
+exit:
+    OICFree(commit);
+    OICFree(journalName);
+    OICFree(commitName);
+    return ret;
+}
+
+/**
+ * Finishes a database commit that was interrupted, if any.
+ */
+static void RecoverDatabaseInPS(const OCPersistentStorage *ps, const char *databaseName)
+{
+    if (!IsJournalEnabled(ps))
+    {
+        return;
+    }
+
+    char *commitName = GetDatabaseFileName(databaseName, PS_COMMIT_SUFFIX);
+    char *journalName = GetDatabaseFileName(databaseName, PS_JOURNAL_SUFFIX);
+    uint8_t *commit = NULL;
+    size_t commitSize = 0;
+    VERIFY_NOT_NULL(TAG, commitName, ERROR);
+    VERIFY_NOT_NULL(TAG, journalName, ERROR);
+
+    if ((OC_STACK_OK != ReadFileFromPS(ps, commitName, &commit, &commitSize)) || !commit)
+    {
+        goto exit;
+    }
+
+    if ((PS_COMMIT_HEADER_SIZE < commitSize) &&
+        (0 == memcmp(commit, PS_COMMIT_MAGIC, sizeof(PS_COMMIT_MAGIC))) &&
+        (GetUint32(commit + 8) == (commitSize - PS_COMMIT_HEADER_SIZE)) &&
+        (GetUint32(commit + 12) == PSCrc32(commit + PS_COMMIT_HEADER_SIZE,
+                                           commitSize - PS_COMMIT_HEADER_SIZE)))
+    {
+        OIC_LOG_V(INFO, TAG, "Completing interrupted update of %s", databaseName);
+        if (OC_STACK_OK != WriteFileToPS(ps, databaseName, "wb",
+                                         commit + PS_COMMIT_HEADER_SIZE,
+                                         commitSize - PS_COMMIT_HEADER_SIZE))
+        {
+            // Keep the copy for the next attempt.
+            goto exit;
+        }
+        ps->unlink(journalName);
+    }
+    // An incomplete copy means the database itself was never touched.
+    ps->unlink(commitName);
+
+exit:
+    OICFree(commit);
+    OICFree(commitName);
+    OICFree(journalName);
+}
+
+/**
+ * Reads the database and, if it matches the database, its journal.
+ *
+ * @note Caller of this method MUST use OICFree() to release dbData and journal.
+ *       journal is NULL when there is no usable journal; journalSize is the
+ *       size of its undamaged part and journalIntact tells whether that is
+ *       the whole file.
+ */
+static OCStackResult ReadDatabaseAndJournal(const OCPersistentStorage *ps, const char *databaseName,
+                                            uint8_t **dbData, size_t *dbSize,
+                                            uint8_t **journal, size_t *journalSize,
+                                            bool *journalIntact)
+{
+    *journal = NULL;
+    *journalSize = 0;
+    *journalIntact = false;
+
+    RecoverDatabaseInPS(ps, databaseName);
+
+    OCStackResult ret = ReadFileFromPS(ps, databaseName, dbData, dbSize);
+    if ((OC_STACK_OK != ret) || !*dbData || !IsJournalEnabled(ps))
+    {
+        return ret;
+    }
+
+    char *journalName = GetDatabaseFileName(databaseName, PS_JOURNAL_SUFFIX);
+    if (!journalName)
+    {
+        return OC_STACK_NO_MEMORY;
+    }
+
+    uint8_t *data = NULL;
+    size_t size = 0;
+    if ((OC_STACK_OK == ReadFileFromPS(ps, journalName, &data, &size)) &&
+        IsJournalForDatabase(data, size, *dbData, *dbSize))
+    {
+        *journal = data;
+        *journalSize = GetJournalValidSize(data, size);
+        *journalIntact = (*journalSize == size);
+        data = NULL;
+    }
+
+    OICFree(data);
+    OICFree(journalName);
+    return OC_STACK_OK;
+}
+
+/**
+ * Records an update of one resource in the journal of a database.
+ *
+ * @return ::OC_STACK_OK for Success, ::OC_STACK_ERROR if the database has to
+ *         be rewritten instead.
+ */
+static OCStackResult AppendToJournal(const OCPersistentStorage *ps, const char *databaseName,
+                                     const uint8_t *dbData, size_t dbSize,
+                                     const uint8_t *journal, size_t journalSize, bool journalIntact,
+                                     const char *resourceName, const uint8_t *payload, size_t size)
+{
+    if (journal && !journalIntact)
+    {
+        // Rewriting the journal in place could lose the records before the damaged tail.
+        OIC_LOG_V(DEBUG, TAG, "Journal of %s is damaged", databaseName);
+        return OC_STACK_ERROR;
+    }
+
+    size_t nameLen = strlen(resourceName);
+    if (!payload)
+    {
+        size = 0;
+    }
+    if ((0 == nameLen) || (UINT16_MAX < nameLen) || (UINT32_MAX < size))
+    {
+        return OC_STACK_ERROR;
+    }
+
+    size_t recordSize = PS_JOURNAL_RECORD_OVERHEAD + nameLen + size;
+    size_t baseSize = journal ? journalSize : PS_JOURNAL_HEADER_SIZE;
+    size_t limit = (dbSize > PS_JOURNAL_MIN_COMPACT_SIZE) ? dbSize : PS_JOURNAL_MIN_COMPACT_SIZE;
+    if ((baseSize + recordSize) > limit)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Journal of %s is full", databaseName);
+        return OC_STACK_ERROR;
+    }
+
+    OCStackResult ret = OC_STACK_ERROR;
+    char *journalName = GetDatabaseFileName(databaseName, PS_JOURNAL_SUFFIX);
+    uint8_t *buffer = (uint8_t *)OICMalloc(baseSize + recordSize);
+    VERIFY_NOT_NULL(TAG, journalName, ERROR);
+    VERIFY_NOT_NULL(TAG, buffer, ERROR);
+
+    if (journal)
+    {
+        memcpy(buffer, journal, journalSize);
+    }
+    else
+    {
+        memset(buffer, 0, PS_JOURNAL_HEADER_SIZE);
+        memcpy(buffer, PS_JOURNAL_MAGIC, sizeof(PS_JOURNAL_MAGIC));
+        buffer[4] = PS_JOURNAL_VERSION;
+        PutUint32(buffer + 8, (uint32_t)dbSize);
+        PutUint32(buffer + 12, PSCrc32(dbData, dbSize));
+    }
+
+    uint8_t *record = buffer + baseSize;
+    PutUint16(record, (uint16_t)nameLen);
+    PutUint32(record + 2, (uint32_t)size);
+    memcpy(record + 6, resourceName, nameLen);
+    if (size)
+    {
+        memcpy(record + 6 + nameLen, payload, size);
+    }
+    PutUint32(record + 6 + nameLen + size, PSCrc32(record, recordSize - 4));
+
+    if (journal)
+    {
+        // Common case: only the new record is written.
+        ret = WriteFileToPS(ps, journalName, "ab", record, recordSize);
+    }
+    else
+    {
+        // New journal; one left over from an older database is not used anymore.
+        ret = WriteFileToPS(ps, journalName, "wb", buffer, baseSize + recordSize);
+    }
+
+exit:
+    OICFree(buffer);
+    OICFree(journalName);
+    return ret;
+}
+
 /**
  * Reads the database from PS
  * 
@@ -165,59 +905,71 @@ OCStackResult ReadDatabaseFromPS(const char *databaseName, const char *resourceN
         return OC_STACK_INVALID_PARAM;
     }
 
-    FILE *fp = NULL;
     uint8_t *fsData = NULL;
     size_t fileSize = 0;
+    uint8_t *journal = NULL;
+    size_t journalSize = 0;
+    bool journalIntact = false;
     OCStackResult ret = OC_STACK_ERROR;
 
     OCPersistentStorage *ps = OCGetPersistentStorageHandler();
     VERIFY_NOT_NULL(TAG, ps, ERROR);
 
-    fileSize = GetDatabaseSize(ps, databaseName);
+    VERIFY_SUCCESS(TAG, (OC_STACK_OK == ReadDatabaseAndJournal(ps, databaseName,
+                                                               &fsData, &fileSize, &journal,
+                                                               &journalSize, &journalIntact)), ERROR);
     OIC_LOG_V(DEBUG, TAG, "File Read Size: %" PRIuPTR, fileSize);
     if (fileSize)
     {
-        fsData = (uint8_t *) OICCalloc(1, fileSize);
-        VERIFY_NOT_NULL(TAG, fsData, ERROR);
-
-        fp = ps->open(databaseName, "rb");
-        VERIFY_NOT_NULL(TAG, fp, ERROR);
-        if (ps->read(fsData, 1, fileSize, fp) == fileSize)
+        PSJournalRecord_t record;
+        if (resourceName && journal &&
+            FindJournalRecord(journal, journalSize, resourceName, &record))
         {
-            if (resourceName)
+            // The journal holds a newer value than the database
+            if (record.payloadLen)
             {
-                CborParser parser;  // will be initialized in |cbor_parser_init|
-                CborValue cbor;     // will be initialized in |cbor_parser_init|
-                cbor_parser_init(fsData, fileSize, 0, &parser, &cbor);
-                CborValue cborValue = {0};
-                CborError cborFindResult = cbor_value_map_find_value(&cbor, resourceName, &cborValue);
-                if (CborNoError == cborFindResult && cbor_value_is_byte_string(&cborValue))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&cborValue, data, size, NULL);
-                    VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
-                    ret = OC_STACK_OK;
-                }
-                // in case of |else (...)|, svr_data not found
+                *data = (uint8_t *)OICMalloc(record.payloadLen);
+                VERIFY_NOT_NULL(TAG, *data, ERROR);
+                memcpy(*data, record.payload, record.payloadLen);
+                *size = record.payloadLen;
+                ret = OC_STACK_OK;
             }
-            // return everything in case resourceName is NULL
-            else
+            // in case of |else (...)|, svr_data was removed
+        }
+        else if (resourceName)
+        {
+            CborParser parser;  // will be initialized in |cbor_parser_init|
+            CborValue cbor;     // will be initialized in |cbor_parser_init|
+            cbor_parser_init(fsData, fileSize, 0, &parser, &cbor);
+            CborValue cborValue = {0};
+            CborError cborFindResult = cbor_value_map_find_value(&cbor, resourceName, &cborValue);
+            if (CborNoError == cborFindResult && cbor_value_is_byte_string(&cborValue))
             {
-                *size = fileSize;
-                *data = (uint8_t *) OICCalloc(1, fileSize);
-                VERIFY_NOT_NULL(TAG, *data, ERROR);
-                memcpy(*data, fsData, fileSize);
+                cborFindResult = cbor_value_dup_byte_string(&cborValue, data, size, NULL);
+                VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
                 ret = OC_STACK_OK;
             }
+            // in case of |else (...)|, svr_data not found
+        }
+        // return everything in case resourceName is NULL
+        else if (journal)
+        {
+            ret = BuildDatabase(databaseName, fsData, fileSize, journal, journalSize,
+                                NULL, NULL, 0, data, size);
+        }
+        else
+        {
+            *size = fileSize;
+            *data = fsData;
+            fsData = NULL;
+            ret = OC_STACK_OK;
         }
     }
     OIC_LOG(DEBUG, TAG, "ReadDatabaseFromPS OUT");
 
 exit:
-    if (fp)
-    {
-        ps->close(fp);
-    }
     OICFree(fsData);
+    OICFree(journal);
     return ret;
 }
 
@@ -241,258 +993,46 @@ OCStackResult UpdateResourceInPS(const char *databaseName, const char *resourceN
 
     size_t dbSize = 0;
     size_t outSize = 0;
+    size_t journalSize = 0;
     uint8_t *dbData = NULL;
+    uint8_t *journal = NULL;
     uint8_t *outPayload = NULL;
+    bool journalIntact = false;
+    OCStackResult ret = OC_STACK_ERROR;
 
-    uint8_t *aclCbor = NULL;
-    uint8_t *pstatCbor = NULL;
-    uint8_t *doxmCbor = NULL;
-    uint8_t *amaclCbor = NULL;
-    uint8_t *credCbor = NULL;
-    uint8_t *resetPfCbor = NULL;
-    uint8_t *crlCbor = NULL;
-    uint8_t *dpCbor = NULL;
+    OCPersistentStorage *ps = OCGetPersistentStorageHandler();
+    VERIFY_NOT_NULL(TAG, ps, ERROR);
 
-    int64_t cborEncoderResult = CborNoError;
-    OCStackResult ret = ReadDatabaseFromPS(databaseName, NULL, &dbData, &dbSize);
-    if (dbData && dbSize)
+    ret = ReadDatabaseAndJournal(ps, databaseName, &dbData, &dbSize,
+                                 &journal, &journalSize, &journalIntact);
+    if ((OC_STACK_OK == ret) && dbData && IsJournalEnabled(ps) && !IsSecretResource(resourceName))
     {
-        PSDatabase database = PS_DATABASE_SECURITY;
-        size_t allocSize = 0;
-        size_t aclCborLen = 0;
-        size_t pstatCborLen = 0;
-        size_t doxmCborLen = 0;
-        size_t amaclCborLen = 0;
-        size_t credCborLen = 0;
-        size_t resetPfCborLen = 0;
-        size_t crlCborLen = 0;
-        size_t dpCborLen = 0;
-
-        // Determine which database we are working with so we can scope our operations
-        if (0 == strcmp(OC_DEVICE_PROPS_FILE_NAME, databaseName))
-        {
-            database = PS_DATABASE_DEVICEPROPERTIES;
-        }
-
-        // Gets each secure virtual resource from persistent storage
-        // this local scoping intended, for destroying large cbor instances after use
-        {
-            CborParser parser;  // will be initialized in |cbor_parser_init|
-            CborValue cbor;     // will be initialized in |cbor_parser_init|
-            cbor_parser_init(dbData, dbSize, 0, &parser, &cbor);
-            CborValue curVal = {0};
-            CborError cborFindResult = CborNoError;
-
-            // Only search for and copy resources owned by the target database
-            if (PS_DATABASE_SECURITY == database)
-            {
-                // Security database
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_ACL_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &aclCbor, &aclCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborFindResult, "Failed Finding ACL Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_PSTAT_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &pstatCbor, &pstatCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborFindResult, "Failed Finding PSTAT Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_DOXM_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &doxmCbor, &doxmCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborFindResult, "Failed Finding DOXM Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_AMACL_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &amaclCbor, &amaclCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborFindResult, "Failed Finding AMACL Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_CRED_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &credCbor, &credCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborFindResult, "Failed Finding CRED Name Value.");
-                }
-                cborFindResult = cbor_value_map_find_value(&cbor, OIC_JSON_RESET_PF_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &resetPfCbor, &resetPfCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborFindResult, "Failed Finding Reset Profile Name Value.");
-                }
-                int64_t cborFindCrlResult = cbor_value_map_find_value(&cbor, OIC_JSON_CRL_NAME, &curVal);
-                if ((CborNoError == cborFindCrlResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindCrlResult = cbor_value_dup_byte_string(&curVal, &crlCbor, &crlCborLen, NULL);
-                    if ((CborNoError != cborFindCrlResult) && (CborErrorOutOfMemory != cborFindCrlResult))
-                    {
-                        OIC_LOG(ERROR, TAG, "Failed Finding optional CRL Name Value.");
-                    }
-                    else
-                    {
-                        OIC_LOG(INFO, TAG, "Successfully Finding optional CRL Name Value.");
-                    }
-                }
-            }
-            else
-            {
-                // Device Properties database
-                cborFindResult = cbor_value_map_find_value(&cbor, OC_JSON_DEVICE_PROPS_NAME, &curVal);
-                if ((CborNoError == cborFindResult) && cbor_value_is_byte_string(&curVal))
-                {
-                    cborFindResult = cbor_value_dup_byte_string(&curVal, &dpCbor, &dpCborLen, NULL);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborFindResult, "Failed Finding Device Properties Name Value.");
-                }
-            }
-        }
-
-        // Updates the added |payload| with the existing secure virtual resource(s)
-        // this local scoping intended, for destroying large cbor instances after use
+        ret = AppendToJournal(ps, databaseName, dbData, dbSize, journal, journalSize,
+                              journalIntact, resourceName, payload, size);
+        if (OC_STACK_OK == ret)
         {
-            if (PS_DATABASE_SECURITY == database)
-            {
-                allocSize = aclCborLen + pstatCborLen + doxmCborLen + amaclCborLen
-                          + credCborLen + /* pconfCborLen + */ resetPfCborLen + crlCborLen
-                          + size + CBOR_ENCODING_SIZE_ADDITION;
-            }
-            else
-            {
-                allocSize = dpCborLen + size + CBOR_ENCODING_SIZE_ADDITION;
-            }
-
-
-            outPayload = (uint8_t *)OICCalloc(1, allocSize);
-            VERIFY_NOT_NULL(TAG, outPayload, ERROR);
-            CborEncoder encoder;  // will be initialized in |cbor_parser_init|
-            cbor_encoder_init(&encoder, outPayload, allocSize, 0);
-            CborEncoder resource;  // will be initialized in |cbor_encoder_create_map|
-            cborEncoderResult |= cbor_encoder_create_map(&encoder, &resource, CborIndefiniteLength);
-            VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding PS Map.");
-
-            // Encode the updated payload and add it to our map so it will be stored in the database.
-            if (payload && size)
-            {
-                cborEncoderResult |= cbor_encode_text_string(&resource, resourceName, strlen(resourceName));
-                VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Value Tag");
-                cborEncoderResult |= cbor_encode_byte_string(&resource, payload, size);
-                VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Value.");
-            }
-
-            // Check all of the resources from a particular database to see if we need to encode them. If the resource
-            // currently exists in the database and has not been updated then we need to encode it and add it to the
-            // map. If the resource has been updated then it was encoded and added to the map above so we skip it to
-            // avoid having duplicate entries for the resource in the database.
-            if (PS_DATABASE_SECURITY == database)
-            {
-                // Security database
-                if (strcmp(OIC_JSON_ACL_NAME, resourceName) && aclCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_ACL_NAME, strlen(OIC_JSON_ACL_NAME));
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding ACL Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, aclCbor, aclCborLen);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding ACL Value.");
-                }
-                if (strcmp(OIC_JSON_PSTAT_NAME, resourceName) && pstatCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_PSTAT_NAME, strlen(OIC_JSON_PSTAT_NAME));
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding PSTAT Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, pstatCbor, pstatCborLen);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding PSTAT Value.");
-                }
-                if (strcmp(OIC_JSON_DOXM_NAME, resourceName) && doxmCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_DOXM_NAME, strlen(OIC_JSON_DOXM_NAME));
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Doxm Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, doxmCbor, doxmCborLen);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Doxm Value.");
-                }
-                if (strcmp(OIC_JSON_AMACL_NAME, resourceName) && amaclCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_AMACL_NAME, strlen(OIC_JSON_AMACL_NAME));
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Amacl Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, amaclCbor, amaclCborLen);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Amacl Value.");
-                }
-                if (strcmp(OIC_JSON_CRED_NAME, resourceName) && credCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_CRED_NAME, strlen(OIC_JSON_CRED_NAME));
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Cred Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, credCbor, credCborLen);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Cred Value.");
-                }
-                if (strcmp(OIC_JSON_RESET_PF_NAME, resourceName) && resetPfCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_RESET_PF_NAME, strlen(OIC_JSON_RESET_PF_NAME));
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Reset Profile Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, resetPfCbor, resetPfCborLen);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Reset Profile Value.");
-                }
-                if (strcmp(OIC_JSON_CRL_NAME, resourceName) && crlCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OIC_JSON_CRL_NAME, strlen(OIC_JSON_CRL_NAME));
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Crl Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, crlCbor, crlCborLen);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Crl Value.");
-                }
-            }
-            else
-            {
-                // Device Properties database
-                if (strcmp(OC_JSON_DEVICE_PROPS_NAME, resourceName) && dpCborLen)
-                {
-                    cborEncoderResult |= cbor_encode_text_string(&resource, OC_JSON_DEVICE_PROPS_NAME, strlen(OC_JSON_DEVICE_PROPS_NAME));
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Device Properties Name.");
-                    cborEncoderResult |= cbor_encode_byte_string(&resource, dpCbor, dpCborLen);
-                    VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Device Properties Value.");
-                }
-            }
-
-            cborEncoderResult |= cbor_encoder_close_container(&encoder, &resource);
-            VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Closing Array.");
-            outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
+            OIC_LOG_V(DEBUG, TAG, "Journaled %s update of %" PRIuPTR " bytes", resourceName, size);
+            goto exit;
         }
     }
-    else if (payload && size)
-    {
-        size_t allocSize = size + CBOR_ENCODING_SIZE_ADDITION;
-
-        outPayload = (uint8_t *)OICCalloc(1, allocSize);
-        VERIFY_NOT_NULL(TAG, outPayload, ERROR);
-        CborEncoder encoder;  // will be initialized in |cbor_parser_init|
-        cbor_encoder_init(&encoder, outPayload, allocSize, 0);
-        CborEncoder resource;  // will be initialized in |cbor_encoder_create_map|
-        cborEncoderResult |= cbor_encoder_create_map(&encoder, &resource, CborIndefiniteLength);
-        VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding PS Map.");
 
-        cborEncoderResult |= cbor_encode_text_string(&resource, resourceName, strlen(resourceName));
-        VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Value Tag");
-        cborEncoderResult |= cbor_encode_byte_string(&resource, payload, size);
-        VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Adding Value.");
-
-        cborEncoderResult |= cbor_encoder_close_container(&encoder, &resource);
-        VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, cborEncoderResult, "Failed Closing Array.");
-        outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
+    // Merge the database, its journal and the update into a new database.
+    if ((dbData && dbSize) || (payload && size))
+    {
+        ret = BuildDatabase(databaseName, dbData, dbSize, journal, journalSize,
+                            resourceName, payload, size, &outPayload, &outSize);
+        VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
     }
 
-    ret = WritePayloadToPS(databaseName, outPayload, outSize);
+    ret = CommitDatabaseToPS(databaseName, outPayload, outSize);
     VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
 
     OIC_LOG(DEBUG, TAG, "UpdateResourceInPS OUT");
 
 exit:
     OICFree(dbData);
+    OICFree(journal);
     OICFree(outPayload);
-    OICFree(aclCbor);
-    OICFree(pstatCbor);
-    OICFree(doxmCbor);
-    OICFree(amaclCbor);
-    OICFree(credCbor);
-    OICFree(resetPfCbor);
-    OICFree(crlCbor);
-    OICFree(dpCbor);
     return ret;
 }
 
@@ -652,7 +1192,7 @@ OCStackResult ResetSecureResourceInPS(void)
             outSize = cbor_encoder_get_buffer_size(&encoder, outPayload);
         }
 
-        ret = WritePayloadToPS(SVR_DB_DAT_FILE_NAME, outPayload, outSize);
+        ret = CommitDatabaseToPS(SVR_DB_DAT_FILE_NAME, outPayload, outSize);
         VERIFY_SUCCESS(TAG, (OC_STACK_OK == ret), ERROR);
     }
 
@@ -459,6 +459,7 @@ OCStackResult SRMInitSecureResources()
 void SRMDeInitSecureResources()
 {
     DestroySecureResources();
+    DeInitPolicyEngine();
 }
 
 bool SRMIsSecurityResourceURI(const char* uri)
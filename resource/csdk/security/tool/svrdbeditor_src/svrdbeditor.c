@@ -52,6 +52,7 @@ static void PrintEditMenu(const char *resourceName, bool print, bool add, bool r
                           bool modify);
 static void PrintHelp(void);
 static FILE *SVRDBFopen(const char *path, const char *mode);
+static int SVRDBUnlink(const char *path);
 
 int main(int argc, char *argv[])
 {
@@ -81,7 +82,8 @@ static int MainOperation(const char *svrpath)
         .read = fread,
         .write = fwrite,
         .close = fclose,
-        .unlink = unlink
+        .unlink = SVRDBUnlink,
+        .journal = true
     };
 
     if (!svrpath)
@@ -251,10 +253,40 @@ static int MainOperation(const char *svrpath)
     return 0;
 }
 
+/**
+ * Every file the stack asks for is |g_svrDbPath|, except that the journal and commit
+ * files keep the suffix they carry after the database name.
+ */
+static bool GetSVRDBFilePath(const char *path, char *filePath, size_t size)
+{
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    const char *suffix = "";
+    if (0 == strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
+    {
+        suffix = path + dbNameLen;
+    }
+    int len = snprintf(filePath, size, "%s%s", g_svrDbPath, suffix);
+    return (0 <= len) && ((size_t)len < size);
+}
+
 static FILE *SVRDBFopen(const char *path, const char *mode)
 {
-    (void)path;  // unused |path| parameter
-    return fopen(g_svrDbPath, mode);
+    char filePath[SVR_DB_PATH_LENGTH + 8];
+    if (!GetSVRDBFilePath(path, filePath, sizeof(filePath)))
+    {
+        return NULL;
+    }
+    return fopen(filePath, mode);
+}
+
+static int SVRDBUnlink(const char *path)
+{
+    char filePath[SVR_DB_PATH_LENGTH + 8];
+    if (!GetSVRDBFilePath(path, filePath, sizeof(filePath)))
+    {
+        return -1;
+    }
+    return unlink(filePath);
 }
 
 static void PrintHelp(void)
@@ -21,6 +21,8 @@
 #include <gtest/gtest.h>
 #include <coap/utlist.h>
 #include <sys/stat.h>
+#include <chrono>
+#include <iostream>
 #include "ocstack.h"
 #include "psinterface.h"
 #include "ocpayload.h"
@@ -41,6 +43,10 @@
 #include "security_internals.h"
 #include "acl_logging.h"
 
+extern "C" {
+#include "policyengine.h"
+}
+
 using namespace std;
 
 #define TAG  "SRM-ACL-UT"
@@ -620,3 +626,256 @@ TEST(ACLResourceTest, ACLGetWithQueryTest)
     OICFree(ehReq.query);
     OICFree(payload);
 }
+
+// Builds an ACL with aceCount ACEs. Subjects alternate between uuid-based and
+// conntype-based ACEs, and uuid subjects repeat every subjectCount entries.
+static OicSecAcl_t *BuildLargeAcl(size_t aceCount, size_t subjectCount)
+{
+    OicSecAcl_t *acl = (OicSecAcl_t *)OICCalloc(1, sizeof(OicSecAcl_t));
+    if (NULL == acl)
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < aceCount; i++)
+    {
+        OicSecAce_t *ace = (OicSecAce_t *)OICCalloc(1, sizeof(OicSecAce_t));
+        if (NULL == ace)
+        {
+            DeleteACLList(acl);
+            return NULL;
+        }
+        if (0 == (i % 2))
+        {
+            ace->subjectType = OicSecAceUuidSubject;
+            size_t subject = (i / 2) % subjectCount;
+            memcpy(ace->subjectuuid.id, &subject, sizeof(subject));
+        }
+        else
+        {
+            ace->subjectType = OicSecAceConntypeSubject;
+            ace->subjectConn = AUTH_CRYPT;
+        }
+        ace->permission = PERMISSION_READ;
+        LL_APPEND(acl->aces, ace);
+    }
+    return acl;
+}
+
+TEST(ACLResourceTest, GetACLResourceDataKeepsAclOrder)
+{
+    const size_t aceCount = 40;
+    const size_t subjectCount = 4;
+    OicSecAcl_t *acl = BuildLargeAcl(aceCount, subjectCount);
+    ASSERT_TRUE(NULL != acl);
+    EXPECT_EQ(OC_STACK_OK, SetDefaultACL(acl));
+
+    OicUuid_t subject = OicUuid_t();
+    size_t subjectIndex = 1;
+    memcpy(subject.id, &subjectIndex, sizeof(subjectIndex));
+
+    // Every ACE for the subject must be returned once, in list order.
+    const OicSecAce_t *expected = acl->aces;
+    OicSecAce_t *savePtr = NULL;
+    const OicSecAce_t *ace = NULL;
+    size_t found = 0;
+    while (NULL != (ace = GetACLResourceData(&subject, &savePtr)))
+    {
+        while ((NULL != expected) &&
+               ((OicSecAceUuidSubject != expected->subjectType) ||
+                (0 != memcmp(&expected->subjectuuid, &subject, sizeof(subject)))))
+        {
+            expected = expected->next;
+        }
+        ASSERT_EQ(expected, ace);
+        expected = expected->next;
+        found++;
+    }
+    EXPECT_EQ(aceCount / 2 / subjectCount, found);
+    EXPECT_TRUE(NULL == savePtr);
+
+    // Removing the subject must be visible to the next lookup.
+    uint32_t generation = GetACLGeneration();
+    RemoveACE(&subject, NULL);
+    EXPECT_NE(generation, GetACLGeneration());
+    savePtr = NULL;
+    EXPECT_TRUE(NULL == GetACLResourceData(&subject, &savePtr));
+
+    found = 0;
+    savePtr = NULL;
+    while (NULL != GetACLResourceDataByConntype(AUTH_CRYPT, &savePtr))
+    {
+        found++;
+    }
+    EXPECT_EQ(aceCount / 2, found);
+
+    DeInitACLResource();
+}
+
+// Measures the cost of finding the ACEs of one subject as the ACL grows.
+TEST(ACLResourceTest, GetACLResourceDataBenchmark)
+{
+    const size_t aceCounts[] = { 10, 100, 1000 };
+    const int lookups = 10000;
+
+    for (size_t aceCount : aceCounts)
+    {
+        OicSecAcl_t *acl = BuildLargeAcl(aceCount, aceCount);
+        ASSERT_TRUE(NULL != acl);
+        EXPECT_EQ(OC_STACK_OK, SetDefaultACL(acl));
+
+        // The last uuid subject in the list is the worst case for a linear scan.
+        OicUuid_t subject = OicUuid_t();
+        size_t subjectIndex = (aceCount - 1) / 2;
+        memcpy(subject.id, &subjectIndex, sizeof(subjectIndex));
+
+        size_t matches = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; i++)
+        {
+            OicSecAce_t *savePtr = NULL;
+            while (NULL != GetACLResourceData(&subject, &savePtr))
+            {
+                matches++;
+            }
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "[ BENCH    ] ACL lookup, " << aceCount << " ACEs: " << lookups
+                  << " lookups in " << elapsed << " us" << std::endl;
+        EXPECT_EQ((size_t)lookups, matches);
+
+        DeInitACLResource();
+    }
+}
+
+// Gives every uuid-subject ACE of acl access to rsrcName.
+static bool AddResourceToUuidAces(OicSecAcl_t *acl, const char *rsrcName)
+{
+    OicSecAce_t *ace = NULL;
+    LL_FOREACH(acl->aces, ace)
+    {
+        if ((OicSecAceUuidSubject == ace->subjectType) &&
+            !AddResourceToACE(ace, rsrcName, "oic.r.light", "oic.if.baseline"))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void InitCheckPermissionContext(SRMRequestContext_t *context,
+                                       const OicUuid_t *subject, const char *rsrcName)
+{
+    *context = SRMRequestContext_t();
+    context->resourceType = NOT_A_SVR_RESOURCE;
+    OICStrcpy(context->resourceUri, sizeof(context->resourceUri), rsrcName);
+    context->requestedPermission = PERMISSION_READ;
+    context->secureChannel = true;
+    context->discoverable = DISCOVERABLE_TRUE;
+    context->subjectIdType = SUBJECT_ID_TYPE_UUID;
+    memcpy(&context->subjectUuid, subject, sizeof(context->subjectUuid));
+}
+
+TEST(ACLResourceTest, CheckPermissionUsesDecisionCache)
+{
+    // CheckPermission() needs the /pstat DOS.
+    ASSERT_EQ(OC_STACK_OK, InitPstatResourceToDefault());
+
+    const char *rsrcName = "/a/led";
+    OicSecAcl_t *acl = BuildLargeAcl(8, 4);
+    ASSERT_TRUE(NULL != acl);
+    ASSERT_TRUE(AddResourceToUuidAces(acl, rsrcName));
+    EXPECT_EQ(OC_STACK_OK, SetDefaultACL(acl));
+
+    OicUuid_t subject = OicUuid_t();
+    size_t subjectIndex = 1;
+    memcpy(subject.id, &subjectIndex, sizeof(subjectIndex));
+
+    SRMRequestContext_t context;
+    InitCheckPermissionContext(&context, &subject, rsrcName);
+    CheckPermission(&context);
+    EXPECT_EQ(ACCESS_GRANTED, context.responseVal);
+
+    // The repeated request is answered from the cache and leaves the ACL alone.
+    uint32_t generation = GetACLGeneration();
+    InitCheckPermissionContext(&context, &subject, rsrcName);
+    CheckPermission(&context);
+    EXPECT_EQ(ACCESS_GRANTED, context.responseVal);
+    EXPECT_EQ(generation, GetACLGeneration());
+
+    // Once the subject's ACE is removed, the cached grant must not be reused.
+    RemoveACE(&subject, NULL);
+    EXPECT_NE(generation, GetACLGeneration());
+    InitCheckPermissionContext(&context, &subject, rsrcName);
+    CheckPermission(&context);
+    EXPECT_NE(ACCESS_GRANTED, context.responseVal);
+
+    // Restoring an ACE for the subject grants access again.
+    OicSecAce_t *ace = (OicSecAce_t *)OICCalloc(1, sizeof(OicSecAce_t));
+    ASSERT_TRUE(NULL != ace);
+    ace->subjectType = OicSecAceUuidSubject;
+    memcpy(&ace->subjectuuid, &subject, sizeof(subject));
+    ace->permission = PERMISSION_READ;
+    ASSERT_TRUE(AddResourceToACE(ace, rsrcName, "oic.r.light", "oic.if.baseline"));
+    OicSecAcl_t *newAcl = (OicSecAcl_t *)OICCalloc(1, sizeof(OicSecAcl_t));
+    ASSERT_TRUE(NULL != newAcl);
+    newAcl->aces = ace;
+    // The in-memory ACL is updated even if persisting it fails.
+    AppendACLObject(newAcl);
+    OICFree(newAcl);
+
+    InitCheckPermissionContext(&context, &subject, rsrcName);
+    CheckPermission(&context);
+    EXPECT_EQ(ACCESS_GRANTED, context.responseVal);
+
+    DeInitACLResource();
+    DeInitPolicyEngine();
+}
+
+// Measures the cost of an access check as the ACL grows. Repeated requests
+// are answered from the decision cache.
+TEST(ACLResourceTest, CheckPermissionBenchmark)
+{
+    ASSERT_EQ(OC_STACK_OK, InitPstatResourceToDefault());
+
+    const size_t aceCounts[] = { 10, 100, 1000 };
+    const int checks = 10000;
+    const char *rsrcName = "/a/led";
+
+    for (size_t aceCount : aceCounts)
+    {
+        OicSecAcl_t *acl = BuildLargeAcl(aceCount, aceCount);
+        ASSERT_TRUE(NULL != acl);
+        ASSERT_TRUE(AddResourceToUuidAces(acl, rsrcName));
+        EXPECT_EQ(OC_STACK_OK, SetDefaultACL(acl));
+
+        // The last uuid subject in the list is the worst case for a linear scan.
+        OicUuid_t subject = OicUuid_t();
+        size_t subjectIndex = (aceCount - 1) / 2;
+        memcpy(subject.id, &subjectIndex, sizeof(subjectIndex));
+
+        size_t granted = 0;
+        SRMRequestContext_t context;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < checks; i++)
+        {
+            InitCheckPermissionContext(&context, &subject, rsrcName);
+            CheckPermission(&context);
+            if (ACCESS_GRANTED == context.responseVal)
+            {
+                granted++;
+            }
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "[ BENCH    ] CheckPermission, " << aceCount << " ACEs: " << checks
+                  << " checks in " << elapsed << " us" << std::endl;
+        EXPECT_EQ((size_t)checks, granted);
+
+        DeInitACLResource();
+    }
+    DeInitPolicyEngine();
+}
@@ -19,6 +19,8 @@
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 
 #include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
 #include "ocpayload.h"
 #include "ocstack.h"
 #include "oic_malloc.h"
@@ -372,7 +374,13 @@ TEST(CredResourceTest, GenerateAndAddCredentialValidInput)
 
     printCred(credList);
 
-    DeleteCredList(headCred);
+    // The creds belong to gCred now, so they are freed by removing them.
+    OICStrcpy((char *)subject.id, sizeof(subject.id), "subject11");
+    EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveCredential(&subject));
+    OICStrcpy((char *)subject.id, sizeof(subject.id), "subject22");
+    EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveCredential(&subject));
+    OICStrcpy((char *)subject.id, sizeof(subject.id), "subject33");
+    EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveCredential(&subject));
 }
 
 #if 0
@@ -389,6 +397,129 @@ TEST(CredGetDtlsPskCredentialsTest, NullResult)
     EXPECT_EQ(-1, GetDtlsPskCredentials(CA_DTLS_PSK_KEY, NULL, 0, NULL, 0));
 }
 
+static void MakePskSubject(size_t index, OicUuid_t *subject)
+{
+    memset(subject->id, 0, sizeof(subject->id));
+    OICStrcpy((char *)subject->id, sizeof(subject->id), "psksubject");
+    uint32_t value = (uint32_t)index;
+    memcpy(subject->id + sizeof(subject->id) - sizeof(value), &value, sizeof(value));
+}
+
+static void AddPskCredentials(size_t count)
+{
+    static OCPersistentStorage ps = OCPersistentStorage();
+    SetPersistentHandler(&ps, true);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        OicUuid_t subject;
+        MakePskSubject(i, &subject);
+
+        uint8_t privateKey[OWNER_PSK_LENGTH_128];
+        memset(privateKey, (int)(i & 0xFF), sizeof(privateKey));
+        OicSecKey_t key = {privateKey, sizeof(privateKey), OIC_ENCODING_RAW};
+
+        OicSecCred_t *cred = GenerateCredential(&subject, SYMMETRIC_PAIR_WISE_KEY, NULL,
+                                                &key, NULL);
+        ASSERT_TRUE(NULL != cred);
+        ASSERT_EQ(OC_STACK_OK, AddCredential(cred));
+    }
+}
+
+static void RemovePskCredentials(size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        OicUuid_t subject;
+        MakePskSubject(i, &subject);
+        EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveCredential(&subject));
+    }
+}
+
+TEST(CredGetDtlsPskCredentialsTest, IndexedLookup)
+{
+    const size_t credCount = 50;
+    AddPskCredentials(credCount);
+
+    for (size_t i = 0; i < credCount; i++)
+    {
+        OicUuid_t subject;
+        MakePskSubject(i, &subject);
+        EXPECT_TRUE(NULL != GetCredResourceData(&subject));
+
+        // The second lookup is answered from the cached key.
+        for (int pass = 0; pass < 2; pass++)
+        {
+            uint8_t psk[OWNER_PSK_LENGTH_128 * 2] = {0};
+            ASSERT_EQ(OWNER_PSK_LENGTH_128,
+                      GetDtlsPskCredentials(CA_DTLS_PSK_KEY, subject.id, sizeof(subject.id),
+                                            psk, sizeof(psk)));
+            EXPECT_EQ((uint8_t)(i & 0xFF), psk[0]);
+            EXPECT_EQ((uint8_t)(i & 0xFF), psk[OWNER_PSK_LENGTH_128 - 1]);
+        }
+    }
+
+    // A removed cred must not be served from the cache.
+    OicUuid_t subject;
+    MakePskSubject(0, &subject);
+    EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveCredential(&subject));
+    uint8_t psk[OWNER_PSK_LENGTH_128] = {0};
+    EXPECT_EQ(-1, GetDtlsPskCredentials(CA_DTLS_PSK_KEY, subject.id, sizeof(subject.id),
+                                        psk, sizeof(psk)));
+    EXPECT_TRUE(NULL == GetCredResourceData(&subject));
+
+    // A replaced cred is served with its new key.
+    uint8_t newKey[OWNER_PSK_LENGTH_128];
+    memset(newKey, 0xA5, sizeof(newKey));
+    OicSecKey_t key = {newKey, sizeof(newKey), OIC_ENCODING_RAW};
+    MakePskSubject(1, &subject);
+    EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveCredential(&subject));
+    OicSecCred_t *cred = GenerateCredential(&subject, SYMMETRIC_PAIR_WISE_KEY, NULL, &key, NULL);
+    ASSERT_TRUE(NULL != cred);
+    ASSERT_EQ(OC_STACK_OK, AddCredential(cred));
+    EXPECT_EQ(OWNER_PSK_LENGTH_128,
+              GetDtlsPskCredentials(CA_DTLS_PSK_KEY, subject.id, sizeof(subject.id),
+                                    psk, sizeof(psk)));
+    EXPECT_EQ(0xA5, psk[0]);
+
+    for (size_t i = 1; i < credCount; i++)
+    {
+        MakePskSubject(i, &subject);
+        EXPECT_EQ(OC_STACK_RESOURCE_DELETED, RemoveCredential(&subject));
+    }
+}
+
+// Measures the cred part of a PSK handshake setup with 1000 provisioned creds.
+TEST(CredGetDtlsPskCredentialsTest, PskLookupBenchmark)
+{
+    const size_t credCount = 1000;
+    const int handshakes = 10000;
+    AddPskCredentials(credCount);
+
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < handshakes; i++)
+    {
+        OicUuid_t subject;
+        MakePskSubject(credCount - 1 - ((size_t)i % credCount), &subject);
+
+        uint8_t psk[OWNER_PSK_LENGTH_128] = {0};
+        if (OWNER_PSK_LENGTH_128 == GetDtlsPskCredentials(CA_DTLS_PSK_KEY, subject.id,
+                                                          sizeof(subject.id), psk, sizeof(psk)))
+        {
+            found++;
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[ BENCH    ] PSK lookup, " << credCount << " creds: " << handshakes
+              << " handshakes in " << elapsed << " us" << std::endl;
+    EXPECT_EQ((size_t)handshakes, found);
+
+    RemovePskCredentials(credCount);
+}
+
 TEST(CredAddTmpPskWithPINTest, NullSubject)
 {
     EXPECT_EQ(OC_STACK_INVALID_PARAM, AddTmpPskWithPIN(NULL, SYMMETRIC_PAIR_WISE_KEY,
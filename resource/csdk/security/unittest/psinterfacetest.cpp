@@ -0,0 +1,256 @@
+//******************************************************************
+//
+// Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+#include "ocstack.h"
+#include "oic_malloc.h"
+#include "srmresourcestrings.h"
+#include "srmtestcommon.h"
+
+extern "C" {
+#include "psinterface.h"
+}
+
+#define PS_UT_DB_NAME       "psinterface_ut.dat"
+#define PS_UT_JOURNAL_NAME  PS_UT_DB_NAME ".log"
+#define PS_UT_COMMIT_NAME   PS_UT_DB_NAME ".tmp"
+
+static OCPersistentStorage g_ps;
+static size_t g_bytesWritten = 0;
+
+static size_t CountingWrite(const void *ptr, size_t size, size_t nmemb, FILE *stream)
+{
+    g_bytesWritten += size * nmemb;
+    return fwrite(ptr, size, nmemb, stream);
+}
+
+static long GetFileSize(const char *name)
+{
+    FILE *fp = fopen(name, "rb");
+    if (NULL == fp)
+    {
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+static bool HasValue(const char *resourceName, const char *value)
+{
+    uint8_t *data = NULL;
+    size_t size = 0;
+    OCStackResult res = ReadDatabaseFromPS(PS_UT_DB_NAME, resourceName, &data, &size);
+    bool matches = (OC_STACK_OK == res) && (strlen(value) == size) &&
+                   (0 == memcmp(data, value, size));
+    OICFree(data);
+    return matches;
+}
+
+static bool FileContains(const char *name, const char *bytes)
+{
+    FILE *fp = fopen(name, "rb");
+    if (NULL == fp)
+    {
+        return false;
+    }
+    std::string content;
+    char buf[512];
+    size_t len = 0;
+    while (0 < (len = fread(buf, 1, sizeof(buf), fp)))
+    {
+        content.append(buf, len);
+    }
+    fclose(fp);
+    return std::string::npos != content.find(bytes);
+}
+
+static OCStackResult Update(const char *resourceName, const char *value)
+{
+    return UpdateResourceInPS(PS_UT_DB_NAME, resourceName, (const uint8_t *)value,
+                              value ? strlen(value) : 0);
+}
+
+class PSInterfaceTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        SetPersistentHandler(&g_ps, true);
+        g_ps.write = CountingWrite;
+        g_ps.journal = true;
+        remove(PS_UT_DB_NAME);
+        remove(PS_UT_JOURNAL_NAME);
+        remove(PS_UT_COMMIT_NAME);
+    }
+
+    virtual void TearDown()
+    {
+        remove(PS_UT_DB_NAME);
+        remove(PS_UT_JOURNAL_NAME);
+        remove(PS_UT_COMMIT_NAME);
+    }
+};
+
+TEST_F(PSInterfaceTest, UpdateOnlyAppendsToJournal)
+{
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-1"));
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_CRED_NAME, "cred-1"));
+    long dbSize = GetFileSize(PS_UT_DB_NAME);
+
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-2"));
+
+    EXPECT_EQ(dbSize, GetFileSize(PS_UT_DB_NAME));
+    EXPECT_LT(0, GetFileSize(PS_UT_JOURNAL_NAME));
+    EXPECT_TRUE(HasValue(OIC_JSON_ACL_NAME, "acl-2"));
+    EXPECT_TRUE(HasValue(OIC_JSON_CRED_NAME, "cred-1"));
+}
+
+TEST_F(PSInterfaceTest, RemovedResourceIsNotRead)
+{
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-1"));
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_DOXM_NAME, "doxm-1"));
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_DOXM_NAME, NULL));
+
+    uint8_t *data = NULL;
+    size_t size = 0;
+    EXPECT_NE(OC_STACK_OK, ReadDatabaseFromPS(PS_UT_DB_NAME, OIC_JSON_DOXM_NAME, &data, &size));
+    EXPECT_TRUE(NULL == data);
+    EXPECT_TRUE(HasValue(OIC_JSON_ACL_NAME, "acl-1"));
+}
+
+TEST_F(PSInterfaceTest, DamagedJournalTailIsIgnored)
+{
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-1"));
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-2"));
+
+    // Simulate a record cut short by a power failure.
+    FILE *fp = fopen(PS_UT_JOURNAL_NAME, "ab");
+    ASSERT_TRUE(NULL != fp);
+    const uint8_t torn[] = { 0x03, 0x00, 0x10, 0x00, 0x00, 0x00, 'a', 'c' };
+    fwrite(torn, 1, sizeof(torn), fp);
+    fclose(fp);
+
+    EXPECT_TRUE(HasValue(OIC_JSON_ACL_NAME, "acl-2"));
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_PSTAT_NAME, "pstat-1"));
+
+    // The damaged journal is merged into a new database rather than rewritten.
+    EXPECT_EQ(-1, GetFileSize(PS_UT_JOURNAL_NAME));
+    EXPECT_TRUE(HasValue(OIC_JSON_PSTAT_NAME, "pstat-1"));
+    EXPECT_TRUE(HasValue(OIC_JSON_ACL_NAME, "acl-2"));
+}
+
+TEST_F(PSInterfaceTest, NoSideFilesWithoutJournalSupport)
+{
+    g_ps.journal = false;
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-1"));
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-2"));
+
+    EXPECT_EQ(-1, GetFileSize(PS_UT_JOURNAL_NAME));
+    EXPECT_EQ(-1, GetFileSize(PS_UT_COMMIT_NAME));
+    EXPECT_TRUE(HasValue(OIC_JSON_ACL_NAME, "acl-2"));
+}
+
+TEST_F(PSInterfaceTest, WholeDatabaseReadIncludesJournal)
+{
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-1"));
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_DOXM_NAME, "doxm-1"));
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-2"));
+
+    uint8_t *data = NULL;
+    size_t size = 0;
+    ASSERT_EQ(OC_STACK_OK, ReadDatabaseFromPS(PS_UT_DB_NAME, NULL, &data, &size));
+
+    // Replacing the database with the merged copy must give the same view.
+    FILE *fp = fopen(PS_UT_DB_NAME, "wb");
+    ASSERT_TRUE(NULL != fp);
+    fwrite(data, 1, size, fp);
+    fclose(fp);
+    OICFree(data);
+
+    EXPECT_TRUE(HasValue(OIC_JSON_ACL_NAME, "acl-2"));
+    EXPECT_TRUE(HasValue(OIC_JSON_DOXM_NAME, "doxm-1"));
+}
+
+TEST_F(PSInterfaceTest, JournalIsCompacted)
+{
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-1"));
+
+    std::string doxm(3000, 'd');
+    for (char i = '0'; i < '5'; i++)
+    {
+        doxm[0] = i;
+        EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_DOXM_NAME, doxm.c_str()));
+    }
+
+    EXPECT_GE(GetFileSize(PS_UT_DB_NAME) + 4096, GetFileSize(PS_UT_JOURNAL_NAME));
+    EXPECT_TRUE(HasValue(OIC_JSON_DOXM_NAME, doxm.c_str()));
+    EXPECT_TRUE(HasValue(OIC_JSON_ACL_NAME, "acl-1"));
+}
+
+TEST_F(PSInterfaceTest, ReplacedCredKeyIsNotLeftInFiles)
+{
+    const char *oldKey = "psk-0f1e2d3c4b5a6978";
+    const char *newKey = "psk-8796a5b4c3d2e1f0";
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-1"));
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_CRED_NAME, oldKey));
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-2"));
+    ASSERT_LT(0, GetFileSize(PS_UT_JOURNAL_NAME));
+
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_CRED_NAME, newKey));
+    EXPECT_TRUE(HasValue(OIC_JSON_CRED_NAME, newKey));
+    EXPECT_FALSE(FileContains(PS_UT_DB_NAME, oldKey));
+    EXPECT_FALSE(FileContains(PS_UT_JOURNAL_NAME, oldKey));
+    EXPECT_FALSE(FileContains(PS_UT_COMMIT_NAME, oldKey));
+
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl-3"));
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_CRED_NAME, NULL));
+    EXPECT_FALSE(FileContains(PS_UT_DB_NAME, newKey));
+    EXPECT_FALSE(FileContains(PS_UT_JOURNAL_NAME, newKey));
+    EXPECT_FALSE(FileContains(PS_UT_COMMIT_NAME, newKey));
+    EXPECT_TRUE(HasValue(OIC_JSON_ACL_NAME, "acl-3"));
+}
+
+// Bytes written to storage for small ACL updates next to a large credential section.
+TEST_F(PSInterfaceTest, UpdateWriteVolumeBenchmark)
+{
+    std::string cred(8000, 'c');
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_CRED_NAME, cred.c_str()));
+    EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, "acl"));
+
+    const int updates = 100;
+    g_bytesWritten = 0;
+    char acl[32];
+    for (int i = 0; i < updates; i++)
+    {
+        snprintf(acl, sizeof(acl), "acl-%d", i);
+        EXPECT_EQ(OC_STACK_OK, Update(OIC_JSON_ACL_NAME, acl));
+    }
+
+    std::cout << "[ BENCH    ] " << updates << " ACL updates wrote " << g_bytesWritten
+              << " bytes (database is " << GetFileSize(PS_UT_DB_NAME) << " bytes)" << std::endl;
+    EXPECT_TRUE(HasValue(OIC_JSON_ACL_NAME, acl));
+    EXPECT_TRUE(HasValue(OIC_JSON_CRED_NAME, cred.c_str()));
+}
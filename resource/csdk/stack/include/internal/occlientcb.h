@@ -111,6 +111,9 @@ typedef struct ClientCB {
     /** Remote address complete.*/
     OCDevAddr * devAddr;
 
+    /** Deliver representation responses undecoded, see OCSetRawResponsePayload().*/
+    bool rawPayload;
+
 #ifdef WITH_PRESENCE
     /** Struct to hold TTL info for presence.*/
     OCPresence * presence;
@@ -130,12 +133,19 @@ typedef struct ClientCB {
 
     /** next node in this list.*/
     struct ClientCB    *next;
+
+    /** previous node in this list.*/
+    struct ClientCB    *prev;
+
+    /** Token, handle and TTL bookkeeping, private to occlientcb.c.*/
+    struct ClientCBIndex *index;
 } ClientCB;
 
 //TODO: Now ocstack is directly accessing the clientCB list to process presence.
 //      It should be avoided after we make a presence feature separately.
 /**
- * Linked list of ClientCB node.
+ * Doubly linked list of ClientCB node. Only iterate it; nodes are added and
+ * removed with AddClientCB and DeleteClientCB, which also keep the indexes.
  */
 extern struct ClientCB *g_cbList;
 
@@ -194,6 +204,20 @@ void DeleteClientCB(ClientCB *cbNode);
  */
 void DeleteClientCBList();
 
+/**
+ * This method is used to delete the callbacks whose TTL has passed.
+ * Callbacks are kept in TTL order, so only expired ones are visited.
+ */
+void DeleteTimedOutClientCBs();
+
+/**
+ * This method is used to change the TTL of a callback.
+ *
+ * @param[in]  cbNode               Address to client callback node.
+ * @param[in]  ttl                  New time to live in coap_ticks, 0 for none.
+ */
+void SetClientCBTTL(ClientCB *cbNode, uint32_t ttl);
+
 /**
  * This method is used to search and retrieve a cb node in cbList using token.
  *
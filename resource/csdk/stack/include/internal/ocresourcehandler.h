@@ -266,6 +266,30 @@ OCStackResult DevicePropertiesToCBORPayload(const OCDeviceProperties *deviceProp
  */
 OCStackResult CBORPayloadToDeviceProperties(const uint8_t *payload, size_t size, OCDeviceProperties **deviceProperties);
 
+/**
+ * Counters of the discovery response cache.
+ */
+typedef struct
+{
+    /** Discovery requests answered with a cached response.*/
+    uint32_t hits;
+
+    /** Discovery requests whose response was built and cached.*/
+    uint32_t misses;
+} OCDiscoveryCacheStats;
+
+/**
+ * Internal API used to drop the cached discovery (/oic/res) responses. Called whenever the
+ * resources, their types, interfaces or properties, or the device name change.
+ */
+void InvalidateDiscoveryCache();
+
+/**
+ * Internal API used to get the counters of the discovery response cache.
+ * @param stats   Receives the counters.
+ */
+void GetDiscoveryCacheStats(OCDiscoveryCacheStats *stats);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -46,6 +46,25 @@ extern "C"
  */
 typedef OCStackResult (* OCEHResponseHandler)(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * Additional recipient of a response, used when one entity handler response is
+ * sent to several observers that asked for the same representation.
+ */
+typedef struct OCServerRecipient
+{
+    /** Remote endpoint address.*/
+    OCDevAddr devAddr;
+
+    /** qos of the message sent to this recipient.*/
+    OCQualityOfService qos;
+
+    /** token length of the observe request.*/
+    uint8_t tokenLength;
+
+    /** Token of the observe request.*/
+    char token[CA_MAX_TOKEN_LEN];
+} OCServerRecipient;
+
 /**
  * following structure will be created in occoap and passed up the stack on the server side.
  */
@@ -118,6 +137,13 @@ typedef struct OCServerRequest
     /** Flag indicating notification.*/
     uint8_t notificationFlag;
 
+    /** Recipients that get a copy of the response in addition to the requester.
+     *  Owned by the request and freed with it.*/
+    OCServerRecipient *recipients;
+
+    /** Number of additional recipients.*/
+    uint32_t numRecipients;
+
     /** Payload format retrieved from the received request PDU. */
     OCPayloadFormat payloadFormat;
 
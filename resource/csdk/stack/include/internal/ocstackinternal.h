@@ -234,6 +234,30 @@ OCStackResult BindResourceTypeToResource(OCResource *resource,
 OCStackResult BindTpsTypeToResource(OCResource *resource,
                                     OCTpsSchemeFlags resourceTpsTypes);
 
+/**
+ * Find the resources with a resource type.
+ *
+ * @param resourceTypeName Name of resource type.
+ * @param resources Receives the resources in resource list order, NULL if there are none.
+ *                  The caller frees the array with OICFree().
+ * @param count Receives the number of resources.
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult FindResourcesWithType(const char *resourceTypeName,
+                                    OCResource ***resources, size_t *count);
+
+/**
+ * Find the resources with an interface.
+ *
+ * @param interfaceName Name of interface.
+ * @param resources Receives the resources in resource list order, NULL if there are none.
+ *                  The caller frees the array with OICFree().
+ * @param count Receives the number of resources.
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult FindResourcesWithInterface(const char *interfaceName,
+                                         OCResource ***resources, size_t *count);
+
 /**
  * Convert OCStackResult to CAResponseResult_t.
  *
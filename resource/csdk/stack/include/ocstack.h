@@ -31,6 +31,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include "octypes.h"
+#include "ocevent.h"
 
 #include "platform_features.h"
 
@@ -130,6 +131,44 @@ OCStackResult OC_CALL OCStopMulticastServer();
  */
 OCStackResult OC_CALL OCProcess();
 
+/**
+ * This function does the same processing as ::OCProcess and also reports how
+ * long the caller may sleep before the stack has timer work to do. Together
+ * with ::OCRegisterProcessEvent it lets a main loop block instead of polling:
+ *
+ *     OCRegisterProcessEvent(event);
+ *     while (running)
+ *     {
+ *         OCProcessEvent(&nextEventTime);
+ *         oc_event_wait_for(event, nextEventTime);
+ *     }
+ *
+ * @param nextEventTime   On return, milliseconds until ::OCProcessEvent needs
+ *                        to be called again if the event is not signaled first.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCProcessEvent(uint32_t *nextEventTime);
+
+/**
+ * Register an event which the stack signals whenever a message arrives that
+ * ::OCProcessEvent has to handle.  Several callers may each register their own
+ * event; all of them are signaled.  The registrations are dropped by ::OCStop.
+ *
+ * @param event   Event to signal.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCRegisterProcessEvent(oc_event event);
+
+/**
+ * Stop signaling an event registered with ::OCRegisterProcessEvent.  Events
+ * registered by other callers keep being signaled.
+ *
+ * @param event   Event to stop signaling.
+ */
+void OC_CALL OCUnregisterProcessEvent(oc_event event);
+
 /**
  * This function discovers or Perform requests on a specified resource
  * (specified by that Resource's respective URI).
@@ -238,6 +277,20 @@ OCStackResult OC_CALL OCCancel(OCDoHandle handle,
                        OCHeaderOption * options,
                        uint8_t numOptions);
 
+/**
+ * This function asks for the representation responses of a specific @ref OCDoResource
+ * invocation to be handed to its callback undecoded. The response payload is then a
+ * ::PAYLOAD_TYPE_SECURITY payload holding the CBOR bytes as received, for callers
+ * that decode representations themselves. Responses to batch interface requests
+ * are always decoded.
+ *
+ * @param handle       Used to identify a specific OCDoResource invocation.
+ * @param raw          true to skip decoding, false to restore the default.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OC_CALL OCSetRawResponsePayload(OCDoHandle handle, bool raw);
+
 /**
  * Register Persistent storage callback.
  * @param   persistentStorageHandler  Pointers to open, read, write, close & unlink handlers.
@@ -1183,7 +1183,7 @@ void OC_CALL ClosePinDisplayCB(void)
 int main(int argc, char* argv[])
 {
     int opt;
-    OCPersistentStorage ps{ server_fopen, fread, fwrite, fclose, unlink };
+    OCPersistentStorage ps{ server_fopen, fread, fwrite, fclose, unlink, true };
 
     while ((opt = getopt(argc, argv, "u:t:c:i:s:")) != -1)
     {
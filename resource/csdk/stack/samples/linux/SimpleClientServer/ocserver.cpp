@@ -1177,7 +1177,8 @@ int main(int argc, char* argv[])
         fread,
         fwrite,
         fclose,
-        unlink
+        unlink,
+        true
     };
     if (OC_STACK_OK != OCRegisterPersistentStorageHandler(&pstStr))
     {
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <string>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
@@ -34,16 +35,28 @@ void handleSigInt(int signum)
     }
 }
 
-FILE* service_fopen(const char *path, const char *mode)
+/**
+ * Map the security database, and the journal and commit files named after it,
+ * onto AMSS_DB_FILE.
+ */
+static std::string service_path(const char *path)
 {
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
-    {
-        return fopen(AMSS_DB_FILE, mode);
-    }
-    else
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    if (0 == strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
     {
-        return fopen(path, mode);
+        return std::string(AMSS_DB_FILE) + (path + dbNameLen);
     }
+    return path;
+}
+
+FILE* service_fopen(const char *path, const char *mode)
+{
+    return fopen(service_path(path).c_str(), mode);
+}
+
+int service_unlink(const char *path)
+{
+    return unlink(service_path(path).c_str());
 }
 
 int main(int /*argc*/, char* /*argv*/[])
@@ -53,7 +66,7 @@ int main(int /*argc*/, char* /*argv*/[])
     OIC_LOG(DEBUG, TAG, "OCAMS service is starting...");
 
     // Initialize Persistent Storage for SVR database
-    OCPersistentStorage ps = { service_fopen, fread, fwrite, fclose, unlink };
+    OCPersistentStorage ps = { service_fopen, fread, fwrite, fclose, service_unlink, true };
     OCRegisterPersistentStorageHandler(&ps);
 
     if (OCInit(NULL, 0, OC_SERVER) != OC_STACK_OK)
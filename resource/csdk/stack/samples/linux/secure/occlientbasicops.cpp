@@ -345,29 +345,40 @@ int InitDiscovery()
     return ret;
 }
 
-FILE *client_fopen_devowner(const char *path, const char *mode)
+/**
+ * Map the security database, and the journal and commit files named after it,
+ * onto dbFile.
+ */
+static std::string client_path(const char *path, const char *dbFile)
 {
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    if (0 == strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
     {
-        return fopen(CRED_FILE_DEVOWNER, mode);
-    }
-    else
-    {
-        return fopen(path, mode);
+        return std::string(dbFile) + (path + dbNameLen);
     }
+    return path;
+}
+
+FILE *client_fopen_devowner(const char *path, const char *mode)
+{
+    return fopen(client_path(path, CRED_FILE_DEVOWNER).c_str(), mode);
+}
+
+int client_unlink_devowner(const char *path)
+{
+    return unlink(client_path(path, CRED_FILE_DEVOWNER).c_str());
 }
 
 FILE *client_fopen_nondevowner(const char *path, const char *mode)
 {
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
-    {
-        return fopen(CRED_FILE_NONDEVOWNER, mode);
-    }
-    else
-    {
-        return fopen(path, mode);
-    }
+    return fopen(client_path(path, CRED_FILE_NONDEVOWNER).c_str(), mode);
 }
+
+int client_unlink_nondevowner(const char *path)
+{
+    return unlink(client_path(path, CRED_FILE_NONDEVOWNER).c_str());
+}
+
 int main(int argc, char *argv[])
 {
     int opt;
@@ -428,9 +439,9 @@ int main(int argc, char *argv[])
 
     // Initialize Persistent Storage for SVR database
     if (DevOwner)
-        ps = { client_fopen_devowner, fread, fwrite, fclose, unlink };
+        ps = { client_fopen_devowner, fread, fwrite, fclose, client_unlink_devowner, true };
     else
-        ps = { client_fopen_nondevowner, fread, fwrite, fclose, unlink };
+        ps = { client_fopen_nondevowner, fread, fwrite, fclose, client_unlink_nondevowner, true };
     OCRegisterPersistentStorageHandler(&ps);
 
     /* Initialize OCStack*/
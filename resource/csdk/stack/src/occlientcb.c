@@ -21,6 +21,7 @@
 #include "iotivity_config.h"
 #include "occlientcb.h"
 #include <coap/coap.h>
+#include <coap/uthash.h>
 #include "experimental/logger.h"
 #include "trace.h"
 #include "oic_malloc.h"
@@ -39,6 +40,26 @@
 /// Module Name
 #define TAG "OIC_RI_CLIENTCB"
 
+/**
+ * Index entry of a client callback, so that it can be found by token or by
+ * handle, and expired in TTL order, without walking g_cbList.
+ */
+typedef struct ClientCBIndex
+{
+    /** Indexed callback.*/
+    ClientCB *cbNode;
+
+    /** Hash handle for the token index, keyed by cbNode->token.*/
+    UT_hash_handle hh;
+
+    /** Hash handle for the handle index, keyed by cbNode->handle.*/
+    UT_hash_handle hhHandle;
+
+    /** Neighbours in the list of callbacks with a TTL, ordered by TTL.*/
+    struct ClientCBIndex *timeoutPrev;
+    struct ClientCBIndex *timeoutNext;
+} ClientCBIndex;
+
 //-------------------------------------------------------------------------------------------------
 // Private variables
 //-------------------------------------------------------------------------------------------------
@@ -46,9 +67,78 @@
 //      This should be static variable after we make a presence feature separately.
 struct ClientCB *g_cbList = NULL;
 
+static ClientCBIndex *g_cbTokenIndex = NULL;
+static ClientCBIndex *g_cbHandleIndex = NULL;
+static ClientCBIndex *g_cbTimeoutHead = NULL;
+static ClientCBIndex *g_cbTimeoutTail = NULL;
+
 //-------------------------------------------------------------------------------------------------
 // Local functions
 //-------------------------------------------------------------------------------------------------
+static void RemoveTimeout(ClientCBIndex *index)
+{
+    if (index->timeoutPrev)
+    {
+        index->timeoutPrev->timeoutNext = index->timeoutNext;
+    }
+    else if (g_cbTimeoutHead == index)
+    {
+        g_cbTimeoutHead = index->timeoutNext;
+    }
+    else
+    {
+        return; // not in the list
+    }
+
+    if (index->timeoutNext)
+    {
+        index->timeoutNext->timeoutPrev = index->timeoutPrev;
+    }
+    else
+    {
+        g_cbTimeoutTail = index->timeoutPrev;
+    }
+    index->timeoutPrev = NULL;
+    index->timeoutNext = NULL;
+}
+
+/*
+ * Callbacks mostly get the same timeout relative to now, so the insertion
+ * point is searched from the tail and is usually found at once.
+ */
+static void InsertTimeout(ClientCBIndex *index)
+{
+    if (0 == index->cbNode->TTL)
+    {
+        return;
+    }
+
+    ClientCBIndex *after = g_cbTimeoutTail;
+    while (after && after->cbNode->TTL > index->cbNode->TTL)
+    {
+        after = after->timeoutPrev;
+    }
+
+    index->timeoutPrev = after;
+    index->timeoutNext = after ? after->timeoutNext : g_cbTimeoutHead;
+    if (index->timeoutNext)
+    {
+        index->timeoutNext->timeoutPrev = index;
+    }
+    else
+    {
+        g_cbTimeoutTail = index;
+    }
+    if (after)
+    {
+        after->timeoutNext = index;
+    }
+    else
+    {
+        g_cbTimeoutHead = index;
+    }
+}
+
 static void DeleteClientCBInternal(ClientCB * cbNode)
 {
     assert(cbNode);
@@ -59,7 +149,11 @@ static void DeleteClientCBInternal(ClientCB * cbNode)
     OIC_TRACE_BUFFER("OIC_RI_CLIENTCB:DeleteClientCB:token:",
                      (const uint8_t *)cbNode->token, cbNode->tokenLength);
 
-    LL_DELETE(g_cbList, cbNode);
+    DL_DELETE(g_cbList, cbNode);
+    HASH_DELETE(hh, g_cbTokenIndex, cbNode->index);
+    HASH_DELETE(hhHandle, g_cbHandleIndex, cbNode->index);
+    RemoveTimeout(cbNode->index);
+    OICFree(cbNode->index);
     CADestroyToken(cbNode->token);
     OICFree(cbNode->devAddr);
     OICFree(cbNode->handle);
@@ -108,31 +202,6 @@ static void DeleteClientCBInternal(ClientCB * cbNode)
     OIC_TRACE_END();
 }
 
-/*
- * This function checks if the node is past its time to live and
- * deletes it if timed-out. Calling this function with a  presence or observe
- * callback with ttl set to 0 will not delete anything as presence nodes have
- * their own mechanisms for timeouts. A null argument will cause the function to
- * silently return.
- */
-static void CheckAndDeleteTimedOutCB(ClientCB * cbNode)
-{
-    assert(cbNode);
-
-    if (cbNode->TTL == 0)
-    {
-        return;
-    }
-    coap_tick_t now;
-    coap_ticks(&now);
-
-    if (cbNode->TTL < now)
-    {
-        OIC_LOG(INFO, TAG, "Deleting timed-out callback");
-        DeleteClientCBInternal(cbNode);
-    }
-}
-
 #ifdef WITH_PRESENCE
 /**
  * Inserts a new resource type filter into this cb node.
@@ -197,6 +266,15 @@ OCStackResult AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
             goto exit;
         }
 
+        cbNode->index = (ClientCBIndex *) OICCalloc(1, sizeof(ClientCBIndex));
+        if (!cbNode->index)
+        {
+            OICFree(cbNode);
+            *clientCB = NULL;
+            goto exit;
+        }
+        cbNode->index->cbNode = cbNode;
+
         OIC_LOG(INFO, TAG, "Adding client callback with token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
         OIC_TRACE_BUFFER("OIC_RI_CLIENTCB:AddClientCB:token:",
@@ -217,6 +295,7 @@ OCStackResult AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
             if (!cbNode->options)
             {
                 OIC_LOG(ERROR, TAG, "Out of memory");
+                OICFree(cbNode->index);
                 OICFree(cbNode);
                 return OC_STACK_NO_MEMORY;
             }
@@ -240,6 +319,7 @@ OCStackResult AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
                 {
                     OICFree(cbNode->options);
                 }
+                OICFree(cbNode->index);
                 OICFree(cbNode);
                 return OC_STACK_NO_MEMORY;
             }
@@ -256,6 +336,7 @@ OCStackResult AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
         cbNode->handle = *handle;
         cbNode->method = method;
         cbNode->sequenceNumber = 0;
+        cbNode->rawPayload = false;
 #ifdef WITH_PRESENCE
         cbNode->presence = NULL;
         cbNode->interestingPresenceResourceType = NULL;
@@ -275,7 +356,12 @@ OCStackResult AddClientCB(ClientCB** clientCB, OCCallbackData* cbData,
         cbNode->devAddr = devAddr;          // I own it now
         OIC_LOG_V(INFO, TAG, "Added Callback for uri : %s", requestUri);
         OIC_TRACE_MARK(%s:AddClientCB:uri:%s, TAG, requestUri);
-        LL_APPEND(g_cbList, cbNode);
+        DL_APPEND(g_cbList, cbNode);
+        HASH_ADD_KEYPTR(hh, g_cbTokenIndex, cbNode->token, cbNode->tokenLength,
+                        cbNode->index);
+        HASH_ADD_KEYPTR(hhHandle, g_cbHandleIndex, &cbNode->handle, sizeof(cbNode->handle),
+                        cbNode->index);
+        InsertTimeout(cbNode->index);
         *clientCB = cbNode;
     }
 #ifdef WITH_PRESENCE
@@ -322,18 +408,9 @@ exit:
 
 void DeleteClientCB(ClientCB * cbNode)
 {
-    if (cbNode)
+    if (cbNode && (cbNode == GetClientCBUsingHandle(cbNode->handle)))
     {
-        ClientCB* out = NULL;
-        ClientCB* tmp = NULL;
-        LL_FOREACH_SAFE(g_cbList, out, tmp)
-        {
-            if (cbNode == out)
-            {
-                DeleteClientCBInternal(out);
-                break;
-            }
-        }
+        DeleteClientCBInternal(cbNode);
     }
 }
 
@@ -341,13 +418,37 @@ void DeleteClientCBList()
 {
     ClientCB* out = NULL;
     ClientCB* tmp = NULL;
-    LL_FOREACH_SAFE(g_cbList, out, tmp)
+    DL_FOREACH_SAFE(g_cbList, out, tmp)
     {
         DeleteClientCBInternal(out);
     }
     g_cbList = NULL;
 }
 
+void DeleteTimedOutClientCBs()
+{
+    coap_tick_t now;
+    coap_ticks(&now);
+
+    while (g_cbTimeoutHead && (g_cbTimeoutHead->cbNode->TTL < now))
+    {
+        OIC_LOG(INFO, TAG, "Deleting timed-out callback");
+        DeleteClientCBInternal(g_cbTimeoutHead->cbNode);
+    }
+}
+
+void SetClientCBTTL(ClientCB *cbNode, uint32_t ttl)
+{
+    if (!cbNode)
+    {
+        return;
+    }
+
+    RemoveTimeout(cbNode->index);
+    cbNode->TTL = ttl;
+    InsertTimeout(cbNode->index);
+}
+
 ClientCB* GetClientCBUsingToken(const CAToken_t token,
                                 const uint8_t tokenLength)
 {
@@ -360,18 +461,12 @@ ClientCB* GetClientCBUsingToken(const CAToken_t token,
     OIC_LOG (INFO, TAG, "Looking for token");
     OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
 
-    ClientCB* out = NULL;
-    ClientCB* tmp = NULL;
-    LL_FOREACH_SAFE(g_cbList, out, tmp)
+    ClientCBIndex *index = NULL;
+    HASH_FIND(hh, g_cbTokenIndex, token, tokenLength, index);
+    if (index)
     {
-        /* de-annotate below line if want to see all token in g_cbList */
-        //OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-        if (memcmp(out->token, token, tokenLength) == 0)
-        {
-            OIC_LOG(INFO, TAG, "Found in callback list");
-            return out;
-        }
-        CheckAndDeleteTimedOutCB(out);
+        OIC_LOG(INFO, TAG, "Found in callback list");
+        return index->cbNode;
     }
 
     OIC_LOG(INFO, TAG, "Callback Not found!");
@@ -388,16 +483,12 @@ ClientCB* GetClientCBUsingHandle(const OCDoHandle handle)
 
     OIC_LOG(INFO, TAG,  "Looking for handle");
 
-    ClientCB* out = NULL;
-    ClientCB* tmp = NULL;
-    LL_FOREACH_SAFE(g_cbList, out, tmp)
+    ClientCBIndex *index = NULL;
+    HASH_FIND(hhHandle, g_cbHandleIndex, &handle, sizeof(handle), index);
+    if (index)
     {
-        if (out->handle == handle)
-        {
-            OIC_LOG(INFO, TAG, "Found in callback list");
-            return out;
-        }
-        CheckAndDeleteTimedOutCB(out);
+        OIC_LOG(INFO, TAG, "Found in callback list");
+        return index->cbNode;
     }
 
     OIC_LOG(INFO, TAG, "Callback Not found!");
@@ -416,8 +507,7 @@ ClientCB* GetClientCBUsingUri(const char *requestUri)
     OIC_LOG_V(INFO, TAG, "Looking for uri %s", requestUri);
 
     ClientCB* out = NULL;
-    ClientCB* tmp = NULL;
-    LL_FOREACH_SAFE(g_cbList, out, tmp)
+    DL_FOREACH(g_cbList, out)
     {
         /* de-annotate below line if want to see all uri in g_cbList */
         //OIC_LOG_V(INFO, TAG, "%s", out->requestUri);
@@ -426,7 +516,6 @@ ClientCB* GetClientCBUsingUri(const char *requestUri)
             OIC_LOG(INFO, TAG, "Found in callback list");
             return out;
         }
-        CheckAndDeleteTimedOutCB(out);
     }
 
     OIC_LOG(INFO, TAG, "Callback Not found!");
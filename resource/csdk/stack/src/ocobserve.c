@@ -96,22 +96,162 @@ static OCQualityOfService DetermineObserverQoS(OCMethod method,
 }
 
 /**
- * Create a get request and pass to entityhandler to notify specific observer.
+ * Observers of a resource that asked for the same representation. The entity handler is
+ * invoked once for the group and the encoded response is sent to every member.
+ */
+typedef struct ObserverGroup
+{
+    /** Observer whose request is passed to the entity handler.*/
+    ResourceObserver *observer;
+
+    /** Quality of service decided for that observer.*/
+    OCQualityOfService qos;
+
+    /** Other observers in the group.*/
+    ResourceObserver **members;
+
+    /** Endpoint, token and qos of the other observers, in the same order as members.*/
+    OCServerRecipient *recipients;
+
+    /** Number of other observers.*/
+    uint32_t numMembers;
+
+    /** Allocated length of members and recipients.*/
+    uint32_t capacity;
+
+    /** next node in this list.*/
+    struct ObserverGroup *next;
+} ObserverGroup;
+
+static bool IsSameQuery(const char *query1, const char *query2)
+{
+    return 0 == strcmp(query1 ? query1 : "", query2 ? query2 : "");
+}
+
+/**
+ * Check whether two observers get the same notification, that is whether they observe the
+ * same resource with the same query and accept format/version, over the same transport and
+ * interface. Virtual resources such as /oic/res build their endpoints and ports from the
+ * requester's address.
+ */
+static bool IsSameRepresentation(const ResourceObserver *observer1,
+                                 const ResourceObserver *observer2)
+{
+    return (observer1->devAddr.adapter == observer2->devAddr.adapter) &&
+           (observer1->devAddr.flags == observer2->devAddr.flags) &&
+           (observer1->devAddr.ifindex == observer2->devAddr.ifindex) &&
+           (observer1->acceptFormat == observer2->acceptFormat) &&
+           (observer1->acceptVersion == observer2->acceptVersion) &&
+           IsSameQuery(observer1->query, observer2->query) &&
+           IsSameQuery(observer1->resUri, observer2->resUri);
+}
+
+static void FreeObserverGroup(ObserverGroup *group)
+{
+    if (group)
+    {
+        OICFree(group->members);
+        OICFree(group->recipients);
+        OICFree(group);
+    }
+}
+
+/**
+ * Add an observer to the group that gets the same notification, creating the group if
+ * there is none yet.
+ *
+ * @param groups List of groups.
+ * @param observer Observer to add.
+ * @param qos Quality of service of the notification for this observer.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult AddToObserverGroup(ObserverGroup **groups, ResourceObserver *observer,
+                                        OCQualityOfService qos)
+{
+    ObserverGroup *group = NULL;
+
+    // A resource is rarely observed with more than a few distinct queries or formats,
+    // so the list of groups stays short.
+    LL_FOREACH(*groups, group)
+    {
+        if (IsSameRepresentation(group->observer, observer))
+        {
+            break;
+        }
+    }
+
+    if (!group)
+    {
+        group = (ObserverGroup *) OICCalloc(1, sizeof(ObserverGroup));
+        if (!group)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to allocate observer group");
+            return OC_STACK_NO_MEMORY;
+        }
+        group->observer = observer;
+        group->qos = qos;
+        LL_APPEND(*groups, group);
+        return OC_STACK_OK;
+    }
+
+    if (observer->tokenLength > CA_MAX_TOKEN_LEN)
+    {
+        OIC_LOG(ERROR, TAG, "Invalid observer token length");
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    if (group->numMembers == group->capacity)
+    {
+        uint32_t capacity = group->capacity ? (group->capacity * 2) : 4;
+        ResourceObserver **members = (ResourceObserver **)
+                OICRealloc(group->members, capacity * sizeof(ResourceObserver *));
+        if (!members)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to grow observer group");
+            return OC_STACK_NO_MEMORY;
+        }
+        group->members = members;
+
+        OCServerRecipient *recipients = (OCServerRecipient *)
+                OICRealloc(group->recipients, capacity * sizeof(OCServerRecipient));
+        if (!recipients)
+        {
+            OIC_LOG(ERROR, TAG, "Failed to grow observer group");
+            return OC_STACK_NO_MEMORY;
+        }
+        group->recipients = recipients;
+        group->capacity = capacity;
+    }
+
+    OCServerRecipient *recipient = &group->recipients[group->numMembers];
+    recipient->devAddr = observer->devAddr;
+    recipient->qos = qos;
+    recipient->tokenLength = observer->tokenLength;
+    memcpy(recipient->token, observer->token, observer->tokenLength);
+
+    group->members[group->numMembers] = observer;
+    group->numMembers++;
+    return OC_STACK_OK;
+}
+
+/**
+ * Create a get request and pass to entityhandler to notify a group of observers.
+ * The response is encoded once and sent to every observer in the group.
  *
- * @param observer Observer that need to be notified.
- * @param qos Quality of service of resource.
+ * @param group Observers that need to be notified.
+ * @param sequenceNum Sequence number of the notification.
  *
  * @return ::OC_STACK_OK on success, some other value upon failure.
  */
-static OCStackResult SendObserveNotification(ResourceObserver *observer,
-                                             uint32_t sequenceNum,
-                                             OCQualityOfService qos)
+static OCStackResult SendObserveNotification(ObserverGroup *group, uint32_t sequenceNum)
 {
     OCStackResult result = OC_STACK_ERROR;
     OCServerRequest * request = NULL;
+    ResourceObserver *observer = group->observer;
 
     result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                              0, sequenceNum, qos,
+                              0, sequenceNum, group->qos,
                               observer->query, NULL, OC_FORMAT_UNDEFINED, NULL,
                               observer->token, observer->tokenLength,
                               observer->resUri, 0, observer->acceptFormat,
@@ -120,6 +260,13 @@ static OCStackResult SendObserveNotification(ResourceObserver *observer,
     if (request)
     {
         request->observeResult = OC_STACK_OK;
+
+        // The request owns the recipients from here on, since a slow entity handler
+        // may respond after this function has returned.
+        request->recipients = group->recipients;
+        request->numRecipients = group->numMembers;
+        group->recipients = NULL;
+
         if (result == OC_STACK_OK)
         {
             ResourceHandling resHandling = OC_RESOURCE_VIRTUAL;
@@ -129,7 +276,12 @@ static OCStackResult SendObserveNotification(ResourceObserver *observer,
             {
                 result = ProcessRequest(resHandling, resource, request);
                 // Reset Observer TTL.
-                observer->TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+                uint32_t TTL = GetTicks(MAX_OBSERVER_TTL_SECONDS * MILLISECONDS_PER_SECOND);
+                observer->TTL = TTL;
+                for (uint32_t i = 0; i < group->numMembers; i++)
+                {
+                    group->members[i]->TTL = TTL;
+                }
             }
         }
     }
@@ -158,7 +310,12 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
 
     OCStackResult result = OC_STACK_ERROR;
     ResourceObserver * resourceObserver = resPtr->observersHead;
+#ifdef WITH_PRESENCE
     OCServerRequest * request = NULL;
+#endif
+    ObserverGroup *groups = NULL;
+    ObserverGroup *group = NULL;
+    ObserverGroup *tmp = NULL;
     bool observeErrorFlag = false;
 
     // Find clients that are observing this resource
@@ -169,7 +326,7 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
         {
 #endif
             qos = DetermineObserverQoS(method, resourceObserver, qos);
-            result = SendObserveNotification(resourceObserver, resPtr->sequenceNum, qos);
+            result = AddToObserverGroup(&groups, resourceObserver, qos);
 #ifdef WITH_PRESENCE
         }
         else
@@ -221,6 +378,18 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
         resourceObserver = resourceObserver->next;
     }
 
+    // Invoke the entity handler once per group of observers that get the same notification.
+    LL_FOREACH_SAFE(groups, group, tmp)
+    {
+        result = SendObserveNotification(group, resPtr->sequenceNum);
+        if (result != OC_STACK_OK)
+        {
+            observeErrorFlag = true;
+        }
+        LL_DELETE(groups, group);
+        FreeObserverGroup(group);
+    }
+
     if (observeErrorFlag)
     {
         OIC_LOG(ERROR, TAG, "Observer notification error");
@@ -449,7 +618,8 @@ static void CheckTimedOutObserver(ResourceObserver* observer, OCResource *resour
     {
         // Send confirmable notification message to observer.
         OIC_LOG(INFO, TAG, "Sending High-QoS notification to observer");
-        SendObserveNotification(observer, resource->sequenceNum, OC_HIGH_QOS);
+        ObserverGroup group = { .observer = observer, .qos = OC_HIGH_QOS };
+        SendObserveNotification(&group, resource->sequenceNum);
     }
 }
 
@@ -40,6 +40,27 @@
 #define CSV_SEPARATOR ','
 #define MASK_SECURE_FAMS (OC_FLAG_SECURE | OC_MASK_FAMS)
 
+// Number of values from which a representation gets a hash index for lookups.
+#define REP_PAYLOAD_INDEX_THRESHOLD 16
+#define REP_PAYLOAD_INDEX_MIN_CAPACITY 32
+
+/*
+ * Open addressing (linear probing) table of the values of an OCRepPayload,
+ * which stay in their list so they are still encoded in insertion order.
+ * Values are never removed from a payload, so there are no tombstones.
+ */
+typedef struct OCRepPayloadValueIndex
+{
+    /** payload->values when the index was built; differs if someone replaced the list. */
+    OCRepPayloadValue* head;
+    /** Last value in the index; its next is set if someone appended to the list. */
+    OCRepPayloadValue* tail;
+    size_t count;
+    /** Power of two, kept at least twice count. */
+    size_t capacity;
+    OCRepPayloadValue** slots;
+} OCRepPayloadValueIndex;
+
 static void OCFreeRepPayloadValueContents(OCRepPayloadValue* val);
 
 void OC_CALL OCPayloadDestroy(OCPayload* payload)
@@ -106,6 +127,147 @@ void OC_CALL OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
     child->next = NULL;
 }
 
+static uint32_t OCRepPayloadHashName(const char* name)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* c = (const unsigned char*)name; *c; c++)
+    {
+        hash = (hash ^ *c) * 16777619u;
+    }
+    return hash;
+}
+
+static OCRepPayloadValue** OCRepPayloadIndexSlot(const OCRepPayloadValueIndex* index,
+                                                 const char* name)
+{
+    size_t mask = index->capacity - 1;
+    size_t i = OCRepPayloadHashName(name) & mask;
+    while (index->slots[i] && 0 != strcmp(index->slots[i]->name, name))
+    {
+        i = (i + 1) & mask;
+    }
+    return &index->slots[i];
+}
+
+static bool OCRepPayloadIndexGrow(OCRepPayloadValueIndex* index, size_t capacity)
+{
+    OCRepPayloadValue** slots = (OCRepPayloadValue**)OICCalloc(capacity, sizeof(*slots));
+    if (!slots)
+    {
+        return false;
+    }
+
+    OCRepPayloadValue** oldSlots = index->slots;
+    size_t oldCapacity = index->capacity;
+    index->slots = slots;
+    index->capacity = capacity;
+    for (size_t i = 0; i < oldCapacity; i++)
+    {
+        if (oldSlots[i])
+        {
+            *OCRepPayloadIndexSlot(index, oldSlots[i]->name) = oldSlots[i];
+        }
+    }
+    OICFree(oldSlots);
+    return true;
+}
+
+static bool OCRepPayloadIndexAdd(OCRepPayloadValueIndex* index, OCRepPayloadValue* val)
+{
+    if (2 * (index->count + 1) > index->capacity &&
+        !OCRepPayloadIndexGrow(index, 2 * index->capacity))
+    {
+        return false;
+    }
+
+    // Like the list walk, a lookup finds the first of several values of the same name.
+    OCRepPayloadValue** slot = OCRepPayloadIndexSlot(index, val->name);
+    if (!*slot)
+    {
+        *slot = val;
+        index->count++;
+    }
+    index->tail = val;
+    return true;
+}
+
+static void OCRepPayloadIndexFree(OCRepPayload* payload)
+{
+    if (payload->valueIndex)
+    {
+        OICFree(payload->valueIndex->slots);
+        OICFree(payload->valueIndex);
+        payload->valueIndex = NULL;
+    }
+}
+
+/*
+ * Catches the index up with values appended to the list directly, or drops it
+ * if the list was replaced. Returns the index if it can be used for lookups.
+ */
+static OCRepPayloadValueIndex* OCRepPayloadIndexSync(OCRepPayload* payload)
+{
+    OCRepPayloadValueIndex* index = payload->valueIndex;
+    if (!index)
+    {
+        return NULL;
+    }
+
+    if (index->head != payload->values)
+    {
+        OCRepPayloadIndexFree(payload);
+        return NULL;
+    }
+
+    while (index->tail->next)
+    {
+        if (!OCRepPayloadIndexAdd(index, index->tail->next))
+        {
+            OCRepPayloadIndexFree(payload);
+            return NULL;
+        }
+    }
+    return index;
+}
+
+/*
+ * Indexes all values of payload. Failing only leaves lookups slower.
+ */
+static void OCRepPayloadIndexBuild(OCRepPayload* payload)
+{
+    OCRepPayloadIndexFree(payload);
+    if (!payload->values)
+    {
+        return;
+    }
+
+    OCRepPayloadValueIndex* index =
+        (OCRepPayloadValueIndex*)OICCalloc(1, sizeof(OCRepPayloadValueIndex));
+    if (!index)
+    {
+        return;
+    }
+    index->capacity = REP_PAYLOAD_INDEX_MIN_CAPACITY;
+    index->slots = (OCRepPayloadValue**)OICCalloc(index->capacity, sizeof(*index->slots));
+    if (!index->slots)
+    {
+        OICFree(index);
+        return;
+    }
+    index->head = payload->values;
+    payload->valueIndex = index;
+
+    for (OCRepPayloadValue* val = payload->values; val; val = val->next)
+    {
+        if (!OCRepPayloadIndexAdd(index, val))
+        {
+            OCRepPayloadIndexFree(payload);
+            return;
+        }
+    }
+}
+
 static OCRepPayloadValue* OC_CALL OCRepPayloadFindValue(const OCRepPayload* payload, const char* name)
 {
     if (!payload || !name)
@@ -113,6 +275,13 @@ static OCRepPayloadValue* OC_CALL OCRepPayloadFindValue(const OCRepPayload* payl
         return NULL;
     }
 
+    // Getters take a const payload, so the index is only used while it is current.
+    const OCRepPayloadValueIndex* index = payload->valueIndex;
+    if (index && index->head == payload->values && !index->tail->next)
+    {
+        return *OCRepPayloadIndexSlot(index, name);
+    }
+
     OCRepPayloadValue* val = payload->values;
     while(val)
     {
@@ -351,56 +520,69 @@ static OCRepPayloadValue* OC_CALL OCRepPayloadFindAndSetValue(OCRepPayload* payl
         return NULL;
     }
 
-    OCRepPayloadValue* val = payload->values;
-    if (val == NULL)
+    OCRepPayloadValue* val = NULL;
+    OCRepPayloadValue* last = NULL;
+    size_t count = 0;
+    OCRepPayloadValueIndex* index = OCRepPayloadIndexSync(payload);
+    if (index)
     {
-        payload->values = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
-        if (!payload->values)
-        {
-            return NULL;
-        }
-        payload->values->name = OICStrdup(name);
-        if (!payload->values->name)
-        {
-            OICFree(payload->values);
-            payload->values = NULL;
-            return NULL;
-        }
-        payload->values->type =type;
-        return payload->values;
+        val = *OCRepPayloadIndexSlot(index, name);
+        last = index->tail;
     }
-
-    while(val)
+    else
     {
-        if (0 == strcmp(val->name, name))
+        for (val = payload->values; val; val = val->next)
         {
-            OCFreeRepPayloadValueContents(val);
-            val->type = type;
-            return val;
-        }
-        else if (val->next == NULL)
-        {
-            val->next = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
-            if (!val->next)
+            if (0 == strcmp(val->name, name))
             {
-                return NULL;
-            }
-            val->next->name = OICStrdup(name);
-            if (!val->next->name)
-            {
-                OICFree(val->next);
-                val->next = NULL;
-                return NULL;
+                break;
             }
-            val->next->type =type;
-            return val->next;
+            last = val;
+            count++;
         }
+    }
 
-        val = val->next;
+    if (val)
+    {
+        OCFreeRepPayloadValueContents(val);
+        val->type = type;
+        return val;
     }
 
-    OIC_LOG(ERROR, TAG, "FindAndSetValue reached point after while loop, pointer corruption?");
-    return NULL;
+    val = (OCRepPayloadValue*)OICCalloc(1, sizeof(OCRepPayloadValue));
+    if (!val)
+    {
+        return NULL;
+    }
+    val->name = OICStrdup(name);
+    if (!val->name)
+    {
+        OICFree(val);
+        return NULL;
+    }
+    val->type = type;
+
+    if (last)
+    {
+        last->next = val;
+    }
+    else
+    {
+        payload->values = val;
+    }
+
+    if (index)
+    {
+        if (!OCRepPayloadIndexAdd(index, val))
+        {
+            OCRepPayloadIndexFree(payload);
+        }
+    }
+    else if (count + 1 >= REP_PAYLOAD_INDEX_THRESHOLD)
+    {
+        OCRepPayloadIndexBuild(payload);
+    }
+    return val;
 }
 
 bool OC_CALL OCRepPayloadAddResourceType(OCRepPayload* payload, const char* resourceType)
@@ -1601,6 +1783,10 @@ OCRepPayload* OC_CALL OCRepPayloadClone (const OCRepPayload* payload)
     clone->types = CloneOCStringLL (payload->types);
     clone->interfaces = CloneOCStringLL (payload->interfaces);
     clone->values = OCRepPayloadValueClone (payload->values);
+    if (payload->valueIndex)
+    {
+        OCRepPayloadIndexBuild(clone);
+    }
 
     return clone;
 }
@@ -1624,6 +1810,10 @@ OCRepPayload* OC_CALL OCRepPayloadBatchClone(const OCRepPayload* repPayload)
     clone->types  = CloneOCStringLL(repPayload->types);
     clone->interfaces  = CloneOCStringLL(repPayload->interfaces);
     clone->values = OCRepPayloadValueClone(repPayload->values);
+    if (repPayload->valueIndex)
+    {
+        OCRepPayloadIndexBuild(clone);
+    }
     OCRepPayloadSetPropObjectAsOwner(newPayload, OC_RSRVD_REPRESENTATION, clone);
 
     return newPayload;
@@ -1640,6 +1830,7 @@ void OC_CALL OCRepPayloadDestroy(OCRepPayload* payload)
     OCFreeOCStringLL(payload->types);
     OCFreeOCStringLL(payload->interfaces);
     OCFreeRepPayloadValue(payload->values);
+    OCRepPayloadIndexFree(payload);
     OCRepPayloadDestroy(payload->next);
     OICFree(payload);
 }
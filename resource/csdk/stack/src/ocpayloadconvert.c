@@ -36,7 +36,8 @@
 
 #define TAG "OIC_RI_PAYLOADCONVERT"
 
-// Arbitrarily chosen size that seems to contain the majority of packages
+// Arbitrarily chosen size that seems to contain the majority of packages.
+// Payloads are first encoded into a stack buffer of this size.
 #define INIT_SIZE (255)
 
 // Discovery Links Map Length.
@@ -82,7 +83,9 @@ OCStackResult OCConvertPayload(OCPayload* payload, OCPayloadFormat format,
     OCStackResult ret = OC_STACK_INVALID_PARAM;
     int64_t err = CborErrorOutOfMemory;
     uint8_t *out = NULL;
+    uint8_t scratch[INIT_SIZE];
     size_t curSize = INIT_SIZE;
+    bool preEncoded = false;
 
     VERIFY_PARAM_NON_NULL(TAG, payload, "Input param, payload is NULL");
     VERIFY_PARAM_NON_NULL(TAG, outPayload, "OutPayload parameter is NULL");
@@ -91,48 +94,42 @@ OCStackResult OCConvertPayload(OCPayload* payload, OCPayloadFormat format,
     OIC_LOG_V(INFO, TAG, "Converting payload of type %d", payload->type);
     if (PAYLOAD_TYPE_SECURITY == payload->type)
     {
-        size_t securityPayloadSize = ((OCSecurityPayload *)payload)->payloadSize;
-        if (securityPayloadSize > 0)
-        {
-            curSize = securityPayloadSize;
-        }
+        curSize = ((OCSecurityPayload *)payload)->payloadSize;
+        preEncoded = true;
     }
     if (PAYLOAD_TYPE_INTROSPECTION == payload->type)
     {
-        size_t introspectionPayloadSize = ((OCIntrospectionPayload *)payload)->cborPayload.len;
-        if (introspectionPayloadSize > 0)
-        {
-            curSize = introspectionPayloadSize;
-        }
+        curSize = ((OCIntrospectionPayload *)payload)->cborPayload.len;
+        preEncoded = true;
     }
 
     ret = OC_STACK_NO_MEMORY;
 
-    for (;;)
+    if (!preEncoded)
     {
-        out = (uint8_t *)OICCalloc(1, curSize);
-        VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
-        err = OCConvertPayloadHelper(payload, format, out, &curSize);
-
-        if (CborErrorOutOfMemory != err)
+        // Encode into the scratch buffer first. A payload that fits is encoded once and
+        // copied out; for a larger one tinycbor keeps counting once the buffer is full, so
+        // this pass yields the exact size and the payload is encoded once more into a
+        // buffer of that size.
+        err = OCConvertPayloadHelper(payload, format, scratch, &curSize);
+        if (CborNoError == err)
         {
-            break;
+            out = (uint8_t *)OICMalloc(curSize ? curSize : 1);
+            VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
+            memcpy(out, scratch, curSize);
         }
+    }
 
+    while (CborErrorOutOfMemory == err)
+    {
         OICFree(out);
+        out = (uint8_t *)OICMalloc(curSize ? curSize : 1);
+        VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
+        err = OCConvertPayloadHelper(payload, format, out, &curSize);
     }
 
     if (err == CborNoError)
     {
-        if ((curSize < INIT_SIZE) &&
-            (PAYLOAD_TYPE_SECURITY != payload->type) &&
-            (PAYLOAD_TYPE_INTROSPECTION != payload->type))
-        {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-            out = out2;
-        }
-
         *size = curSize;
         *outPayload = out;
         OIC_LOG_V(DEBUG, TAG, "Payload Size: %zd Payload : ", *size);
@@ -438,7 +435,6 @@ static int64_t OCConvertDiscoveryPayloadCbor(OCDiscoveryPayload *payload,
         CborEncoder linkArray;
         err |= cbor_encode_text_string(&rootMap, OC_RSRVD_LINKS, sizeof(OC_RSRVD_LINKS) - 1);
         VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, err, "Failed setting links array tag");
-        size_t resourceCount =  OCDiscoveryPayloadGetResourceCount(payload);
         err |= cbor_encoder_create_array(&rootMap, &linkArray, CborIndefiniteLength);
         VERIFY_CBOR_SUCCESS_OR_OUT_OF_MEMORY(TAG, err, "Failed setting links array");
 
@@ -449,11 +445,9 @@ static int64_t OCConvertDiscoveryPayloadCbor(OCDiscoveryPayload *payload,
             isSelf = !strcmp(payload->sid, deviceId);
         }
 
-        for (size_t i = 0; i < resourceCount; ++i)
+        // Walk the list directly; looking each resource up by index is quadratic.
+        for (OCResourcePayload *resource = payload->resources; resource; resource = resource->next)
         {
-            OCResourcePayload *resource = OCDiscoveryPayloadGetResource(payload, i);
-            VERIFY_PARAM_NON_NULL(TAG, resource, "Failed retrieving resource");
-
             if (isSelf || !resource->eps)
             {
                 err |= OCConvertResourcePayloadCbor(&linkArray, resource, NULL);
@@ -555,10 +549,8 @@ static int64_t OCConvertDiscoveryPayloadVndOcfCbor(OCDiscoveryPayload *payload,
 
     while (payload && payload->resources)
     {
-        size_t resourceCount =  OCDiscoveryPayloadGetResourceCount(payload);
-        for (size_t i = 0; i < resourceCount; ++i)
+        for (OCResourcePayload *resource = payload->resources; resource; resource = resource->next)
         {
-            OCResourcePayload *resource = OCDiscoveryPayloadGetResource(payload, i);
 
             // Open a link map in the root array
             CborEncoder linkMap;
@@ -58,6 +58,7 @@
 #include "oickeepalive.h"
 #include "ocpayloadcbor.h"
 #include "psinterface.h"
+#include <coap/uthash.h>
 
 #ifdef ROUTING_GATEWAY
 #include "routingmanager.h"
@@ -83,6 +84,34 @@ static const uint16_t CBOR_SIZE = 512;
  */
 static const uint16_t CBOR_MAX_SIZE = 4400;
 
+/**
+ * Max number of encoded discovery responses kept. The oldest one is dropped first.
+ */
+#define DISCOVERY_CACHE_MAX_ENTRIES (16)
+
+/**
+ * Encoded discovery response for one combination of request parameters.
+ */
+typedef struct DiscoveryCacheEntry
+{
+    char *key;                  /**< Request parameters the response was built for. */
+    OCStackResult result;       /**< ::OC_STACK_OK or ::OC_STACK_NO_RESOURCE. */
+    uint8_t *payload;           /**< Encoded response, NULL for ::OC_STACK_NO_RESOURCE. */
+    size_t payloadSize;
+    UT_hash_handle hh;
+} DiscoveryCacheEntry;
+
+static DiscoveryCacheEntry *g_discoveryCache = NULL;
+
+/**
+ * Network information and device ID the cached responses were built with.
+ */
+static CAEndpoint_t *g_discoveryCacheNetworkInfo = NULL;
+static size_t g_discoveryCacheInfoSize = 0;
+static char g_discoveryCacheSid[UUID_STRING_SIZE];
+
+static OCDiscoveryCacheStats g_discoveryCacheStats;
+
 extern OCResource *headResource;
 extern bool g_multicastServerStopped;
 
@@ -1303,17 +1332,12 @@ OCResource *OC_CALL FindResourceByUri(const char* resourceUri)
         return NULL;
     }
 
-    OCResource * pointer = headResource;
-    while (pointer)
+    OCResource *pointer = (OCResource *) OCGetResourceHandleAtUri(resourceUri);
+    if (!pointer)
     {
-        if (strcmp(resourceUri, pointer->uri) == 0)
-        {
-            return pointer;
-        }
-        pointer = pointer->next;
+        OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
     }
-    OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
-    return NULL;
+    return pointer;
 }
 
 OCStackResult CheckRequestsEndpoint(const OCDevAddr *reqDevAddr,
@@ -1872,6 +1896,305 @@ exit:
     return result;
 }
 
+void InvalidateDiscoveryCache()
+{
+    DiscoveryCacheEntry *entry = NULL;
+    DiscoveryCacheEntry *tmp = NULL;
+    HASH_ITER(hh, g_discoveryCache, entry, tmp)
+    {
+        HASH_DEL(g_discoveryCache, entry);
+        OICFree(entry->key);
+        OICFree(entry->payload);
+        OICFree(entry);
+    }
+    OICFree(g_discoveryCacheNetworkInfo);
+    g_discoveryCacheNetworkInfo = NULL;
+    g_discoveryCacheInfoSize = 0;
+}
+
+void GetDiscoveryCacheStats(OCDiscoveryCacheStats *stats)
+{
+    if (stats)
+    {
+        *stats = g_discoveryCacheStats;
+    }
+}
+
+/**
+ * Check whether the encoded response to this request may be kept. Only the CBOR formats are
+ * encoded by the stack, and resources published at the resource directory are looked up in
+ * its database, which changes without the local resource list changing.
+ */
+static bool isDiscoveryResponseCacheable(const OCServerRequest *request)
+{
+    if (OC_FORMAT_UNDEFINED != request->acceptFormat &&
+        OC_FORMAT_CBOR != request->acceptFormat &&
+        OC_FORMAT_VND_OCF_CBOR != request->acceptFormat)
+    {
+        return false;
+    }
+#ifdef RD_SERVER
+    if (OCGetResourceHandleAtUri(OC_RSRVD_RD_URI) != NULL)
+    {
+        return false;
+    }
+#endif
+    return true;
+}
+
+/**
+ * Drop the cached responses if the network information or the device ID a response is built
+ * with now differ from the ones the cached responses were built with.
+ */
+static void validateDiscoveryCache(const CAEndpoint_t *networkInfo, size_t infoSize)
+{
+    const char *sid = OCGetServerInstanceIDString();
+    bool valid = (0 == strcmp(sid ? sid : "", g_discoveryCacheSid)) &&
+                 (infoSize == g_discoveryCacheInfoSize);
+    for (size_t i = 0; valid && i < infoSize; i++)
+    {
+        const CAEndpoint_t *a = &networkInfo[i];
+        const CAEndpoint_t *b = &g_discoveryCacheNetworkInfo[i];
+        valid = (a->adapter == b->adapter) && (a->flags == b->flags) && (a->port == b->port) &&
+                (a->ifindex == b->ifindex) && (0 == strcmp(a->addr, b->addr));
+    }
+    if (valid)
+    {
+        return;
+    }
+
+    InvalidateDiscoveryCache();
+    OICStrcpy(g_discoveryCacheSid, sizeof(g_discoveryCacheSid), sid ? sid : "");
+    if (infoSize)
+    {
+        g_discoveryCacheNetworkInfo = (CAEndpoint_t *)OICMalloc(infoSize * sizeof(CAEndpoint_t));
+        if (g_discoveryCacheNetworkInfo)
+        {
+            memcpy(g_discoveryCacheNetworkInfo, networkInfo, infoSize * sizeof(CAEndpoint_t));
+            g_discoveryCacheInfoSize = infoSize;
+        }
+    }
+}
+
+/**
+ * Build the cache key from everything besides the resource list that goes into the response:
+ * the virtual resource, the accepted format, the endpoint the request came from and the
+ * filters. A missing filter is kept apart from an empty one.
+ *
+ * @return the key, NULL if out of memory.
+ */
+static char *createDiscoveryCacheKey(OCVirtualResources virtualUri,
+                                     const OCServerRequest *request,
+                                     const char *interfaceQuery,
+                                     const char *resourceTypeQuery)
+{
+    static const char format[] = "%d/%d/%d/%u/%u/%d:%s/%d:%s";
+    int ifLen = interfaceQuery ? (int)strlen(interfaceQuery) : -1;
+    int rtLen = resourceTypeQuery ? (int)strlen(resourceTypeQuery) : -1;
+    const char *ifQuery = interfaceQuery ? interfaceQuery : "";
+    const char *rtQuery = resourceTypeQuery ? resourceTypeQuery : "";
+
+    int len = snprintf(NULL, 0, format, (int)virtualUri, (int)request->acceptFormat,
+                       (int)request->devAddr.adapter, (unsigned int)request->devAddr.flags,
+                       (unsigned int)request->devAddr.ifindex, ifLen, ifQuery, rtLen, rtQuery);
+    if (len < 0)
+    {
+        return NULL;
+    }
+    char *key = (char *)OICMalloc((size_t)len + 1);
+    if (key)
+    {
+        snprintf(key, (size_t)len + 1, format, (int)virtualUri, (int)request->acceptFormat,
+                 (int)request->devAddr.adapter, (unsigned int)request->devAddr.flags,
+                 (unsigned int)request->devAddr.ifindex, ifLen, ifQuery, rtLen, rtQuery);
+    }
+    return key;
+}
+
+/**
+ * Keep the response built for a request. A discovery payload is replaced by a payload of
+ * its encoding, so the bytes kept are the ones sent.
+ *
+ * @param key      cache key, ownership is taken.
+ * @param format   format the response is encoded in.
+ * @param result   result of building the response.
+ * @param payload  discovery payload built, NULL if there is none.
+ */
+static void cacheDiscoveryResponse(char *key, OCPayloadFormat format,
+                                   OCStackResult result, OCPayload **payload)
+{
+    uint8_t *encoded = NULL;
+    size_t encodedSize = 0;
+
+    if (OC_STACK_OK == result)
+    {
+        if (!*payload || OC_STACK_OK != OCConvertPayload(*payload, format, &encoded, &encodedSize))
+        {
+            OICFree(key);
+            return;
+        }
+        OCPayload *encodedPayload = (OCPayload *)OCSecurityPayloadCreate(encoded, encodedSize);
+        if (encodedPayload)
+        {
+            OCPayloadDestroy(*payload);
+            *payload = encodedPayload;
+        }
+    }
+    else if (OC_STACK_NO_RESOURCE != result)
+    {
+        OICFree(key);
+        return;
+    }
+
+    DiscoveryCacheEntry *entry = (DiscoveryCacheEntry *)OICCalloc(1, sizeof(DiscoveryCacheEntry));
+    if (!entry)
+    {
+        OICFree(key);
+        OICFree(encoded);
+        return;
+    }
+    entry->key = key;
+    entry->result = result;
+    entry->payload = encoded;
+    entry->payloadSize = encodedSize;
+
+    if (HASH_COUNT(g_discoveryCache) >= DISCOVERY_CACHE_MAX_ENTRIES)
+    {
+        // The hash iterates in insertion order, so the head is the oldest entry.
+        DiscoveryCacheEntry *oldest = g_discoveryCache;
+        HASH_DEL(g_discoveryCache, oldest);
+        OICFree(oldest->key);
+        OICFree(oldest->payload);
+        OICFree(oldest);
+    }
+    HASH_ADD_KEYPTR(hh, g_discoveryCache, entry->key, strlen(entry->key), entry);
+}
+
+/**
+ * Add a resource to the /oic/res response if it passes the filters.
+ */
+static OCStackResult addDiscoveredResource(OCServerRequest *request, OCResource *resource,
+                                           OCResourceProperty prop,
+                                           char *interfaceQuery, char *resourceTypeQuery,
+                                           OCDiscoveryPayload *discPayload,
+                                           CAEndpoint_t *networkInfo, size_t infoSize)
+{
+    // This case will handle when no resource type and it is oic.if.ll.
+    // Do not assume check if the query is ll
+    if (!resourceTypeQuery &&
+        (interfaceQuery && 0 == strcmp(interfaceQuery, OC_RSRVD_INTERFACE_LL)))
+    {
+        // Only include discoverable type
+        if (resource->resourceProperties & prop)
+        {
+            return BuildVirtualResourceResponse(resource, discPayload, &request->devAddr,
+                                                networkInfo, infoSize);
+        }
+    }
+    else if (includeThisResourceInResponse(resource, interfaceQuery, resourceTypeQuery))
+    {
+        return BuildVirtualResourceResponse(resource, discPayload, &request->devAddr,
+                                            networkInfo, infoSize);
+    }
+    return OC_STACK_OK;
+}
+
+/**
+ * Build the /oic/res response for the local resources, and those at the resource directory.
+ *
+ * @param request            discovery request.
+ * @param resource           first resource of the resource list.
+ * @param virtualUri         virtual resource the request is for.
+ * @param interfaceQuery     interface filter, NULL if none.
+ * @param resourceTypeQuery  resource type filter, NULL if none.
+ * @param networkInfo        network information the endpoints are built from.
+ * @param infoSize           number of entries in networkInfo.
+ * @param payload            receives the discovery payload, NULL if there is none to send.
+ *
+ * @return ::OC_STACK_OK if resources were found, ::OC_STACK_NO_RESOURCE if none matched,
+ *         some other value upon failure.
+ */
+static OCStackResult buildDiscoveryPayload(OCServerRequest *request, OCResource *resource,
+                                           OCVirtualResources virtualUri,
+                                           char *interfaceQuery, char *resourceTypeQuery,
+                                           CAEndpoint_t *networkInfo, size_t infoSize,
+                                           OCPayload **payload)
+{
+    OCStackResult discoveryResult = discoveryPayloadCreateAndAddDeviceId(payload);
+    VERIFY_PARAM_NON_NULL(TAG, *payload, "Failed creating Discovery Payload.");
+    VERIFY_SUCCESS(discoveryResult);
+
+    OCDiscoveryPayload *discPayload = (OCDiscoveryPayload *)*payload;
+    if (interfaceQuery && 0 == strcmp(interfaceQuery, OC_RSRVD_INTERFACE_DEFAULT))
+    {
+        discoveryResult = addDiscoveryBaselineCommonProperties(discPayload);
+        VERIFY_SUCCESS(discoveryResult);
+    }
+    OCResourceProperty prop = OC_DISCOVERABLE;
+#ifdef MQ_BROKER
+    prop = (OC_MQ_BROKER_URI == virtualUri) ? OC_MQ_BROKER : prop;
+#else
+    OC_UNUSED(virtualUri);
+#endif
+
+    // An rt filter, or an if filter other than oic.if.ll and oic.if.baseline which all
+    // resources have, only needs the resources listed for it.
+    OCResource **matches = NULL;
+    size_t matchCount = 0;
+    bool indexed = false;
+    if (resourceTypeQuery && *resourceTypeQuery)
+    {
+        discoveryResult = FindResourcesWithType(resourceTypeQuery, &matches, &matchCount);
+        VERIFY_SUCCESS(discoveryResult);
+        indexed = true;
+    }
+    else if (interfaceQuery && *interfaceQuery &&
+             0 != strcmp(interfaceQuery, OC_RSRVD_INTERFACE_LL) &&
+             0 != strcmp(interfaceQuery, OC_RSRVD_INTERFACE_DEFAULT))
+    {
+        discoveryResult = FindResourcesWithInterface(interfaceQuery, &matches, &matchCount);
+        VERIFY_SUCCESS(discoveryResult);
+        indexed = true;
+    }
+
+    if (indexed)
+    {
+        for (size_t i = 0; i < matchCount && discoveryResult == OC_STACK_OK; i++)
+        {
+            discoveryResult = addDiscoveredResource(request, matches[i], prop, interfaceQuery,
+                                                    resourceTypeQuery, discPayload,
+                                                    networkInfo, infoSize);
+        }
+        OICFree(matches);
+    }
+    else
+    {
+        for (; resource && discoveryResult == OC_STACK_OK; resource = resource->next)
+        {
+            discoveryResult = addDiscoveredResource(request, resource, prop, interfaceQuery,
+                                                    resourceTypeQuery, discPayload,
+                                                    networkInfo, infoSize);
+        }
+    }
+    if (discPayload->resources == NULL)
+    {
+        discoveryResult = OC_STACK_NO_RESOURCE;
+        OCPayloadDestroy(*payload);
+        *payload = NULL;
+    }
+
+#ifdef RD_SERVER
+    discoveryResult = findResourcesAtRD(interfaceQuery, resourceTypeQuery, &request->devAddr,
+            (OCDiscoveryPayload **)payload);
+#endif
+    return discoveryResult;
+
+exit:
+    OCPayloadDestroy(*payload);
+    *payload = NULL;
+    return (OC_STACK_OK == discoveryResult) ? OC_STACK_NO_MEMORY : discoveryResult;
+}
+
 static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource* resource)
 {
     if (!request || !resource)
@@ -1956,65 +2279,48 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
             interfaceQuery = OICStrdup(OC_RSRVD_INTERFACE_LL);
         }
 
-        discoveryResult = discoveryPayloadCreateAndAddDeviceId(&payload);
-        VERIFY_PARAM_NON_NULL(TAG, payload, "Failed creating Discovery Payload.");
-        VERIFY_SUCCESS(discoveryResult);
+        char *cacheKey = NULL;
+        if (isDiscoveryResponseCacheable(request))
+        {
+            validateDiscoveryCache(networkInfo, infoSize);
+            cacheKey = createDiscoveryCacheKey(virtualUriInRequest, request,
+                                               interfaceQuery, resourceTypeQuery);
+        }
 
-        OCDiscoveryPayload *discPayload = (OCDiscoveryPayload *)payload;
-        if (interfaceQuery && 0 == strcmp(interfaceQuery, OC_RSRVD_INTERFACE_DEFAULT))
+        DiscoveryCacheEntry *cached = NULL;
+        if (cacheKey)
         {
-            discoveryResult = addDiscoveryBaselineCommonProperties(discPayload);
-            VERIFY_SUCCESS(discoveryResult);
+            HASH_FIND_STR(g_discoveryCache, cacheKey, cached);
         }
-        OCResourceProperty prop = OC_DISCOVERABLE;
-#ifdef MQ_BROKER
-        prop = (OC_MQ_BROKER_URI == virtualUriInRequest) ? OC_MQ_BROKER : prop;
-#endif
-        for (; resource && discoveryResult == OC_STACK_OK; resource = resource->next)
+
+        if (cached)
         {
-            // This case will handle when no resource type and it is oic.if.ll.
-            // Do not assume check if the query is ll
-            if (!resourceTypeQuery &&
-                (interfaceQuery && 0 == strcmp(interfaceQuery, OC_RSRVD_INTERFACE_LL)))
+            g_discoveryCacheStats.hits++;
+            OICFree(cacheKey);
+            discoveryResult = cached->result;
+            if (cached->payload)
             {
-                // Only include discoverable type
-                if (resource->resourceProperties & prop)
+                payload = (OCPayload *)OCSecurityPayloadCreate(cached->payload,
+                                                               cached->payloadSize);
+                if (!payload)
                 {
-                    discoveryResult = BuildVirtualResourceResponse(resource,
-                                                                   discPayload,
-                                                                   &request->devAddr,
-                                                                   networkInfo,
-                                                                   infoSize);
+                    discoveryResult = OC_STACK_NO_MEMORY;
                 }
             }
-            else if (includeThisResourceInResponse(resource, interfaceQuery, resourceTypeQuery))
-            {
-                discoveryResult = BuildVirtualResourceResponse(resource,
-                                                               discPayload,
-                                                               &request->devAddr,
-                                                               networkInfo,
-                                                               infoSize);
-            }
-            else
-            {
-                discoveryResult = OC_STACK_OK;
-            }
-        }
-        if (discPayload->resources == NULL)
-        {
-            discoveryResult = OC_STACK_NO_RESOURCE;
-            OCPayloadDestroy(payload);
-            payload = NULL;
         }
-
-        if (networkInfo)
+        else
         {
-            OICFree(networkInfo);
+            discoveryResult = buildDiscoveryPayload(request, resource, virtualUriInRequest,
+                                                    interfaceQuery, resourceTypeQuery,
+                                                    networkInfo, infoSize, &payload);
+            if (cacheKey)
+            {
+                g_discoveryCacheStats.misses++;
+                cacheDiscoveryResponse(cacheKey, request->acceptFormat, discoveryResult,
+                                       &payload);
+            }
         }
-#ifdef RD_SERVER
-        discoveryResult = findResourcesAtRD(interfaceQuery, resourceTypeQuery, &request->devAddr,
-                (OCDiscoveryPayload **)&payload);
-#endif
+        OICFree(networkInfo);
     }
     else if (virtualUriInRequest == OC_DEVICE_URI)
     {
@@ -2652,6 +2958,12 @@ static OCStackResult SetAttributeInternal(OCResource *resource,
     }
     VERIFY_PARAM_NON_NULL(TAG, resAttrib->attrValue, "Failed allocating attribute value");
 
+    // The device name is part of the oic.if.baseline discovery response.
+    if (0 == strcmp(OC_RSRVD_DEVICE_NAME, attribute))
+    {
+        InvalidateDiscoveryCache();
+    }
+
     // The resource has changed from what is stored in the database. Update the database to
     // reflect the new value.
     if (updateDatabase)
@@ -188,6 +188,82 @@ static OCStackResult OCSendResponse (const CAEndpoint_t *object, CAResponseInfo_
     return OC_STACK_OK;
 }
 
+/**
+ * Send a response to a remote endpoint. With presence enabled, a response for the default
+ * adapter is sent out on all adapters.
+ *
+ * @param[in]  endpoint         CA remote endpoint.
+ * @param[in]  responseInfo     CA response info.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult SendResponseToEndpoint (const CAEndpoint_t *endpoint,
+                                             CAResponseInfo_t *responseInfo)
+{
+    OCStackResult result = OC_STACK_OK;
+    CAEndpoint_t responseEndpoint = *endpoint;
+
+#ifdef WITH_PRESENCE
+    CATransportAdapter_t CAConnTypes[] = {
+                            CA_ADAPTER_IP,
+                            CA_ADAPTER_GATT_BTLE,
+                            CA_ADAPTER_RFCOMM_BTEDR,
+                            CA_ADAPTER_NFC
+#ifdef RA_ADAPTER
+                            , CA_ADAPTER_REMOTE_ACCESS
+#endif
+                            , CA_ADAPTER_TCP
+                        };
+
+    size_t size = sizeof(CAConnTypes)/ sizeof(CATransportAdapter_t);
+
+    CATransportAdapter_t adapter = responseEndpoint.adapter;
+    // Default adapter, try to send response out on all adapters.
+    if (adapter == CA_DEFAULT_ADAPTER)
+    {
+        adapter =
+            (CATransportAdapter_t)(
+                CA_ADAPTER_IP           |
+                CA_ADAPTER_GATT_BTLE    |
+                CA_ADAPTER_RFCOMM_BTEDR |
+                CA_ADAPTER_NFC
+#ifdef RA_ADAP
+                | CA_ADAPTER_REMOTE_ACCESS
+#endif
+                | CA_ADAPTER_TCP
+            );
+    }
+
+    OCStackResult tempResult = OC_STACK_OK;
+
+    for(size_t i = 0; i < size; i++ )
+    {
+        responseEndpoint.adapter = (CATransportAdapter_t)(adapter & CAConnTypes[i]);
+        if(responseEndpoint.adapter)
+        {
+            //The result is set to OC_STACK_OK only if OCSendResponse succeeds in sending the
+            //response on all the n/w interfaces else it is set to OC_STACK_ERROR
+            tempResult = OCSendResponse(&responseEndpoint, responseInfo);
+        }
+        if(OC_STACK_OK != tempResult)
+        {
+            result = tempResult;
+        }
+    }
+#else
+
+    OIC_LOG(INFO, TAG, "Calling OCSendResponse with:");
+    OIC_LOG_V(INFO, TAG, "\tEndpoint address: %s", responseEndpoint.addr);
+    OIC_LOG_V(INFO, TAG, "\tEndpoint adapter: %s", responseEndpoint.adapter);
+    OIC_LOG_V(INFO, TAG, "\tResponse result : %s", responseInfo->result);
+    OIC_LOG_V(INFO, TAG, "\tResponse for uri: %s", responseInfo->info.resourceUri);
+
+    result = OCSendResponse(&responseEndpoint, responseInfo);
+#endif
+
+    return result;
+}
+
 static CAPayloadFormat_t OCToCAPayloadFormat (OCPayloadFormat ocFormat)
 {
     switch (ocFormat)
@@ -410,6 +486,7 @@ void DeleteServerRequest(OCServerRequest * serverRequest)
     {
         RBL_REMOVE(ServerRequestTree, &g_serverRequestTree, serverRequest);
         OICFree(serverRequest->requestToken);
+        OICFree(serverRequest->recipients);
         OICFree(serverRequest);
         serverRequest = NULL;
         OIC_LOG(INFO, TAG, "Server Request Removed");
@@ -766,64 +843,26 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
         }
     }
 
-#ifdef WITH_PRESENCE
-    CATransportAdapter_t CAConnTypes[] = {
-                            CA_ADAPTER_IP,
-                            CA_ADAPTER_GATT_BTLE,
-                            CA_ADAPTER_RFCOMM_BTEDR,
-                            CA_ADAPTER_NFC
-#ifdef RA_ADAPTER
-                            , CA_ADAPTER_REMOTE_ACCESS
-#endif
-                            , CA_ADAPTER_TCP
-                        };
-
-    size_t size = sizeof(CAConnTypes)/ sizeof(CATransportAdapter_t);
+    result = SendResponseToEndpoint(&responseEndpoint, &responseInfo);
 
-    CATransportAdapter_t adapter = responseEndpoint.adapter;
-    // Default adapter, try to send response out on all adapters.
-    if (adapter == CA_DEFAULT_ADAPTER)
+    // Observers grouped with this request get the same encoded response; only the
+    // endpoint, token and message type differ.
+    for (uint32_t i = 0; i < serverRequest->numRecipients; i++)
     {
-        adapter =
-            (CATransportAdapter_t)(
-                CA_ADAPTER_IP           |
-                CA_ADAPTER_GATT_BTLE    |
-                CA_ADAPTER_RFCOMM_BTEDR |
-                CA_ADAPTER_NFC
-#ifdef RA_ADAP
-                | CA_ADAPTER_REMOTE_ACCESS
-#endif
-                | CA_ADAPTER_TCP
-            );
-    }
+        const OCServerRecipient *recipient = &serverRequest->recipients[i];
 
-    result = OC_STACK_OK;
-    OCStackResult tempResult = OC_STACK_OK;
+        CopyDevAddrToEndpoint(&recipient->devAddr, &responseEndpoint);
+        responseInfo.info.type = (OC_HIGH_QOS == recipient->qos) ?
+                                 CA_MSG_CONFIRM : CA_MSG_NONCONFIRM;
+        memcpy(responseInfo.info.token, recipient->token, recipient->tokenLength);
+        responseInfo.info.tokenLength = recipient->tokenLength;
 
-    for(size_t i = 0; i < size; i++ )
-    {
-        responseEndpoint.adapter = (CATransportAdapter_t)(adapter & CAConnTypes[i]);
-        if(responseEndpoint.adapter)
+        OCStackResult recipientResult = SendResponseToEndpoint(&responseEndpoint, &responseInfo);
+        if (OC_STACK_OK != recipientResult)
         {
-            //The result is set to OC_STACK_OK only if OCSendResponse succeeds in sending the
-            //response on all the n/w interfaces else it is set to OC_STACK_ERROR
-            tempResult = OCSendResponse(&responseEndpoint, &responseInfo);
-        }
-        if(OC_STACK_OK != tempResult)
-        {
-            result = tempResult;
+            result = recipientResult;
         }
     }
-#else
-
-    OIC_LOG(INFO, TAG, "Calling OCSendResponse with:");
-    OIC_LOG_V(INFO, TAG, "\tEndpoint address: %s", responseEndpoint.addr);
-    OIC_LOG_V(INFO, TAG, "\tEndpoint adapter: %s", responseEndpoint.adapter);
-    OIC_LOG_V(INFO, TAG, "\tResponse result : %s", responseInfo.result);
-    OIC_LOG_V(INFO, TAG, "\tResponse for uri: %s", responseInfo.info.resourceUri);
-
-    result = OCSendResponse(&responseEndpoint, &responseInfo);
-#endif
 
     OICFree(responseInfo.info.payload);
     OICFree(responseInfo.info.options);
@@ -861,14 +900,32 @@ OCStackResult HandleAggregateResponse(OCEntityHandlerResponse * ehResponse)
             VERIFY_NON_NULL(serverResponse);
         }
 
-        if(ehResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION)
+        OCRepPayload *newPayload = NULL;
+        if (ehResponse->payload->type == PAYLOAD_TYPE_SECURITY)
+        {
+            // Fragments encoded by the application are decoded again to be merged.
+            OCSecurityPayload *encoded = (OCSecurityPayload *)ehResponse->payload;
+            OCPayload *parsed = NULL;
+            stackRet = OCParsePayload(&parsed, OC_FORMAT_CBOR, PAYLOAD_TYPE_REPRESENTATION,
+                                      encoded->securityData, encoded->payloadSize);
+            if (OC_STACK_OK != stackRet)
+            {
+                OIC_LOG(ERROR, TAG, "Error parsing encoded response fragment");
+                goto exit;
+            }
+            newPayload = OCRepPayloadBatchClone((OCRepPayload *)parsed);
+            OCPayloadDestroy(parsed);
+        }
+        else if(ehResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION)
         {
             stackRet = OC_STACK_ERROR;
             OIC_LOG(ERROR, TAG, "Error adding payload, as it was the incorrect type");
             goto exit;
         }
-
-        OCRepPayload *newPayload = OCRepPayloadBatchClone((OCRepPayload *)ehResponse->payload);
+        else
+        {
+            newPayload = OCRepPayloadBatchClone((OCRepPayload *)ehResponse->payload);
+        }
 
         if(!serverResponse->payload)
         {
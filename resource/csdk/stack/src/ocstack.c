@@ -98,6 +98,7 @@
 #include <sys/time.h>
 #endif
 #include <coap/coap.h>
+#include <coap/uthash.h>
 
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
@@ -129,6 +130,63 @@ typedef enum
 } OCPresenceState;
 #endif
 
+/**
+ * Index entry for a resource in the resource list, so that a resource can be found
+ * by URI or by handle without walking the list.
+ */
+typedef struct OCResourceIndex
+{
+    /** Indexed resource.*/
+    OCResource *resource;
+
+    /** Position of the resource in the resource list; later resources have higher values.*/
+    uint32_t order;
+
+    /** Hash handle for the URI index, keyed by resource->uri.*/
+    UT_hash_handle hh;
+
+    /** Hash handle for the handle index, keyed by the resource pointer.*/
+    UT_hash_handle hhHandle;
+} OCResourceIndex;
+
+/**
+ * Resource bound to a resource type or interface name.
+ */
+typedef struct OCNameBinding
+{
+    /** Index entry of the resource.*/
+    OCResourceIndex *entry;
+
+    /** Hash handle, keyed by the index entry pointer.*/
+    UT_hash_handle hh;
+} OCNameBinding;
+
+/**
+ * Resource type or interface name. Each name is stored once however many resources use it,
+ * along with the resources using it so that filtered discovery only visits those.
+ */
+typedef struct OCInternedName
+{
+    /** The name, shared by all OCResourceType and OCResourceInterface with this name.*/
+    char *name;
+
+    /** Number of OCResourceType and OCResourceInterface using the name.*/
+    uint32_t refCount;
+
+    /** Resources with this resource type.*/
+    OCNameBinding *types;
+
+    /** Resources with this interface.*/
+    OCNameBinding *interfaces;
+
+    /** Whether types and interfaces are in resource list order.*/
+    bool typesSorted;
+    bool interfacesSorted;
+
+    /** Hash handle, keyed by name.*/
+    UT_hash_handle hh;
+} OCInternedName;
+
 //-----------------------------------------------------------------------------
 // Private variables
 //-----------------------------------------------------------------------------
@@ -136,6 +194,10 @@ static OCStackState stackState = OC_STACK_UNINITIALIZED;
 
 OCResource *headResource = NULL;
 static OCResource *tailResource = NULL;
+static OCResourceIndex *resourceUriIndex = NULL;
+static OCResourceIndex *resourceHandleIndex = NULL;
+static uint32_t resourceOrder = 0;
+static OCInternedName *internedNames = NULL;
 static OCResourceHandle platformResource = {0};
 static OCResourceHandle deviceResource = {0};
 static OCResourceHandle introspectionResource = {0};
@@ -191,6 +253,10 @@ bool g_multicastServerStopped = false;
 
 #define MILLISECONDS_PER_SECOND   (1000)
 
+// Longest sleep OCProcessEvent allows between calls. Keep-alive and routing
+// timers only work in whole seconds, so this bounds how late they can run.
+#define MAX_PROCESS_EVENT_WAIT_MS (1000)
+
 // handle case that SCNd64 is not defined in arduino's inttypes.h
 #if defined(WITH_ARDUINO) && !defined(SCNd64)
 #define SCNd64 "lld"
@@ -216,9 +282,10 @@ static OCStackResult initResources();
 /**
  * Add a resource to the end of the linked list of resources.
  *
- * @param resource Resource to be added
+ * @param resource Resource to be added. Its uri must already be set.
+ * @return ::OC_STACK_OK on success, some other value upon failure.
  */
-static void insertResource(OCResource *resource);
+static OCStackResult insertResource(OCResource *resource);
 
 /**
  * Find a resource in the linked list of resources.
@@ -290,6 +357,41 @@ static void deleteResourceType(OCResourceType *resourceType);
  */
 static void deleteResourceInterface(OCResourceInterface *resourceInterface);
 
+/**
+ * Get the stored copy of a resource type or interface name, storing it if no resource uses
+ * the name yet.
+ *
+ * @param name Resource type or interface name.
+ *
+ * @return Stored copy of the name, to be released with releaseName(); NULL if out of memory.
+ */
+static char *internName(const char *name);
+
+/**
+ * Release a name returned by internName(). The name is freed once nothing uses it anymore.
+ *
+ * @param name Stored copy of the name, may be NULL.
+ */
+static void releaseName(char *name);
+
+/**
+ * Record that a resource has a resource type or interface.
+ *
+ * @param name Stored copy of the resource type or interface name.
+ * @param resource Resource with the resource type or interface.
+ * @param isType true for a resource type, false for an interface.
+ */
+static void bindResourceName(const char *name, OCResource *resource, bool isType);
+
+/**
+ * Remove the record made by bindResourceName().
+ *
+ * @param name Stored copy of the resource type or interface name.
+ * @param resource Resource with the resource type or interface.
+ * @param isType true for a resource type, false for an interface.
+ */
+static void unbindResourceName(const char *name, const OCResource *resource, bool isType);
+
 /**
  * Delete all of the dynamically allocated elements that were created for the resource.
  *
@@ -1388,6 +1490,32 @@ exit:
     return result;
 }
 
+/**
+ * Whether the request uri selects the batch interface, whose responses are
+ * rewritten by HandleBatchResponse.
+ */
+static bool IsBatchInterfaceRequest(const char *requestUri)
+{
+    bool isBatch = false;
+    char *interfaceName = NULL;
+    char *rtTypeName = NULL;
+    char *uriQuery = NULL;
+    char *uriWithoutQuery = NULL;
+    if (requestUri && OC_STACK_OK == getQueryFromUri(requestUri, &uriQuery, &uriWithoutQuery))
+    {
+        if (OC_STACK_OK == ExtractFiltersFromQuery(uriQuery, &interfaceName, &rtTypeName))
+        {
+            isBatch = interfaceName && (0 == strcmp(OC_RSRVD_INTERFACE_BATCH, interfaceName));
+        }
+    }
+
+    OICFree(interfaceName);
+    OICFree(rtTypeName);
+    OICFree(uriQuery);
+    OICFree(uriWithoutQuery);
+    return isBatch;
+}
+
 OCStackResult HandleBatchResponse(char *requestUri, OCRepPayload **payload)
 {
     if (requestUri && *payload)
@@ -1827,13 +1955,21 @@ void OC_CALL OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo
                     return;
                 }
 
+                // The application decodes the representation itself, so keep the bytes.
+                OCPayloadType parseType = type;
+                if (cbNode->rawPayload && PAYLOAD_TYPE_REPRESENTATION == type &&
+                        !IsBatchInterfaceRequest(cbNode->requestUri))
+                {
+                    parseType = PAYLOAD_TYPE_SECURITY;
+                }
+
                 // In case of error, still want application to receive the error message.
                 if (OCResultToSuccess(response->result) || PAYLOAD_TYPE_REPRESENTATION == type ||
                         PAYLOAD_TYPE_DIAGNOSTIC == type)
                 {
                     if (OC_STACK_OK != OCParsePayload(&response->payload,
                             CAToOCPayloadFormat(responseInfo->info.payloadFormat),
-                            type,
+                            parseType,
                             responseInfo->info.payload,
                             responseInfo->info.payloadSize))
                     {
@@ -1967,8 +2103,8 @@ void OC_CALL OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo
                 else
                 {
                     // To keep discovery callbacks active.
-                    cbNode->TTL = GetTicks(MAX_CB_TIMEOUT_SECONDS *
-                                            MILLISECONDS_PER_SECOND);
+                    SetClientCBTTL(cbNode, GetTicks(MAX_CB_TIMEOUT_SECONDS *
+                                                    MILLISECONDS_PER_SECOND));
                 }
             }
 
@@ -3819,6 +3955,24 @@ OCStackResult OC_CALL OCCancel(OCDoHandle handle, OCQualityOfService qos, OCHead
     return ret;
 }
 
+OCStackResult OC_CALL OCSetRawResponsePayload(OCDoHandle handle, bool raw)
+{
+    if (!handle)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    ClientCB *clientCB = GetClientCBUsingHandle(handle);
+    if (!clientCB)
+    {
+        OIC_LOG(ERROR, TAG, "Callback not found for raw response payload");
+        return OC_STACK_ERROR;
+    }
+
+    clientCB->rawPayload = raw;
+    return OC_STACK_OK;
+}
+
 /**
  * @brief   Register Persistent storage callback.
  * @param   persistentStorageHandler [IN] Pointers to open, read, write, close & unlink handlers.
@@ -3958,6 +4112,7 @@ OCStackResult OC_CALL OCProcess()
 #ifdef WITH_PRESENCE
     OCProcessPresence();
 #endif
+    DeleteTimedOutClientCBs();
     CAHandleRequestResponse();
 
 #ifdef ROUTING_GATEWAY
@@ -3970,6 +4125,82 @@ OCStackResult OC_CALL OCProcess()
     return OC_STACK_OK;
 }
 
+#ifdef WITH_PRESENCE
+/**
+ * Milliseconds until OCProcessPresence has to run again, at most maxWait.
+ */
+static uint32_t GetPresenceWaitTime(uint32_t maxWait)
+{
+    uint32_t now = GetTicks(0);
+    uint32_t waitTime = maxWait;
+    ClientCB* cbNode = NULL;
+
+    LL_FOREACH(g_cbList, cbNode)
+    {
+        if (OC_REST_PRESENCE != cbNode->method || !cbNode->presence)
+        {
+            continue;
+        }
+
+        if (cbNode->presence->TTLlevel >= PresenceTimeOutSize)
+        {
+            if (cbNode->presence->TTLlevel == PresenceTimeOutSize)
+            {
+                // The presence timeout is reported on the next pass.
+                return 0;
+            }
+            continue;
+        }
+
+        uint32_t timeOut = cbNode->presence->timeOut[cbNode->presence->TTLlevel];
+        if (timeOut <= now)
+        {
+            return 0;
+        }
+
+        uint64_t ms = ((uint64_t)(timeOut - now) * MILLISECONDS_PER_SECOND) /
+                      COAP_TICKS_PER_SECOND;
+        if (ms < waitTime)
+        {
+            waitTime = (uint32_t)ms;
+        }
+    }
+
+    return waitTime;
+}
+#endif // WITH_PRESENCE
+
+OCStackResult OC_CALL OCProcessEvent(uint32_t *nextEventTime)
+{
+    if (!nextEventTime)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    *nextEventTime = MAX_PROCESS_EVENT_WAIT_MS;
+
+    OCStackResult result = OCProcess();
+    if (OC_STACK_OK != result)
+    {
+        return result;
+    }
+
+#ifdef WITH_PRESENCE
+    *nextEventTime = GetPresenceWaitTime(*nextEventTime);
+#endif
+    return OC_STACK_OK;
+}
+
+OCStackResult OC_CALL OCRegisterProcessEvent(oc_event event)
+{
+    return CAResultToOCResult(CARegisterProcessEvent(event));
+}
+
+void OC_CALL OCUnregisterProcessEvent(oc_event event)
+{
+    CAUnregisterProcessEvent(event);
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult OC_CALL OCStartPresence(const uint32_t ttl)
 {
@@ -4170,22 +4401,13 @@ OCStackResult OC_CALL OCCreateResourceWithEp(OCResourceHandle *handle,
         return OC_STACK_INVALID_PARAM;
     }
 
-    // If the headResource is NULL, then no resources have been created...
-    pointer = headResource;
-    if (pointer)
+    // Repeated URLs are not allowed.  If a repeat is found, exit with an error
+    if (OCGetResourceHandleAtUri(uri))
     {
-        // At least one resources is in the resource list, so we need to search for
-        // repeated URLs, which are not allowed.  If a repeat is found, exit with an error
-        while (pointer)
-        {
-            if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-            {
-                OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
-                return OC_STACK_INVALID_PARAM;
-            }
-            pointer = pointer->next;
-        }
+        OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
+        return OC_STACK_INVALID_PARAM;
     }
+
     // Create the pointer and insert it into the resource list
     pointer = (OCResource *) OICCalloc(1, sizeof(OCResource));
     if (!pointer)
@@ -4195,12 +4417,14 @@ OCStackResult OC_CALL OCCreateResourceWithEp(OCResourceHandle *handle,
     }
     pointer->sequenceNum = OC_OFFSET_SEQUENCE_NUMBER;
 
-    insertResource(pointer);
-
     // Set the uri
     pointer->uri = OICStrdup(uri);
-    if (!pointer->uri)
+    if (!pointer->uri || (OC_STACK_OK != insertResource(pointer)))
     {
+        // Not in the resource list yet, so deleteResource() below would not free it.
+        OICFree(pointer->uri);
+        OICFree(pointer);
+        pointer = NULL;
         result = OC_STACK_NO_MEMORY;
         goto exit;
     }
@@ -4503,7 +4727,7 @@ OCStackResult BindResourceTypeToResource(OCResource* resource,
         goto exit;
     }
 
-    str = OICStrdup(resourceTypeName);
+    str = internName(resourceTypeName);
     if (!str)
     {
         result = OC_STACK_NO_MEMORY;
@@ -4519,7 +4743,7 @@ exit:
     if (result != OC_STACK_OK)
     {
         OICFree(pointer);
-        OICFree(str);
+        releaseName(str);
     }
 
     return result;
@@ -4549,7 +4773,7 @@ OCStackResult BindResourceInterfaceToResource(OCResource* resource,
         goto exit;
     }
 
-    str = OICStrdup(resourceInterfaceName);
+    str = internName(resourceInterfaceName);
     if (!str)
     {
         result = OC_STACK_NO_MEMORY;
@@ -4566,7 +4790,7 @@ OCStackResult BindResourceInterfaceToResource(OCResource* resource,
     if (result != OC_STACK_OK)
     {
         OICFree(pointer);
-        OICFree(str);
+        releaseName(str);
     }
 
     return result;
@@ -4600,6 +4824,7 @@ OCStackResult BindTpsTypeToResource(OCResource* resource,
 
     OIC_LOG_V(INFO, TAG, "Binding %d TPS flags to %s", supportedTps, resource->uri);
     resource->endpointType = supportedTps;
+    InvalidateDiscoveryCache();
     return result;
 }
 
@@ -4741,6 +4966,7 @@ OCStackResult OC_CALL OCSetResourceProperties(OCResourceHandle handle, uint8_t r
         return OC_STACK_NO_RESOURCE;
     }
     resource->resourceProperties = (OCResourceProperty) (resource->resourceProperties | resourceProperties);
+    InvalidateDiscoveryCache();
     return OC_STACK_OK;
 }
 
@@ -4755,6 +4981,7 @@ OCStackResult OC_CALL OCClearResourceProperties(OCResourceHandle handle, uint8_t
         return OC_STACK_NO_RESOURCE;
     }
     resource->resourceProperties = (OCResourceProperty) (resource->resourceProperties & ~resourceProperties);
+    InvalidateDiscoveryCache();
     return OC_STACK_OK;
 }
 
@@ -5098,6 +5325,7 @@ OCStackResult OCChangeResourceProperty(OCResourceProperty * inputProperty,
     {
         *inputProperty = (OCResourceProperty) (*inputProperty | resourceProperties);
     }
+    InvalidateDiscoveryCache();
     return OC_STACK_OK;
 }
 #endif
@@ -5108,6 +5336,8 @@ OCStackResult initResources()
 
     headResource = NULL;
     tailResource = NULL;
+    resourceUriIndex = NULL;
+    resourceHandleIndex = NULL;
     // Init Virtual Resources
 #ifdef WITH_PRESENCE
     presenceResource.presenceTTL = OC_DEFAULT_PRESENCE_TTL_SECONDS;
@@ -5249,8 +5479,19 @@ OCStackResult initResources()
     return result;
 }
 
-void insertResource(OCResource *resource)
+OCStackResult insertResource(OCResource *resource)
 {
+    OCResourceIndex *entry = (OCResourceIndex *) OICCalloc(1, sizeof(OCResourceIndex));
+    if (!entry)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to allocate resource index entry");
+        return OC_STACK_NO_MEMORY;
+    }
+    entry->resource = resource;
+    entry->order = resourceOrder++;
+    HASH_ADD_KEYPTR(hh, resourceUriIndex, resource->uri, strlen(resource->uri), entry);
+    HASH_ADD(hhHandle, resourceHandleIndex, resource, sizeof(OCResource *), entry);
+
     if (!headResource)
     {
         headResource = resource;
@@ -5262,21 +5503,16 @@ void insertResource(OCResource *resource)
         tailResource = resource;
     }
     resource->next = NULL;
+    InvalidateDiscoveryCache();
+    return OC_STACK_OK;
 }
 
 OCResource *findResource(OCResource *resource)
 {
-    OCResource *pointer = headResource;
+    OCResourceIndex *entry = NULL;
 
-    while (pointer)
-    {
-        if (pointer == resource)
-        {
-            return resource;
-        }
-        pointer = pointer->next;
-    }
-    return NULL;
+    HASH_FIND(hhHandle, resourceHandleIndex, &resource, sizeof(OCResource *), entry);
+    return entry ? entry->resource : NULL;
 }
 
 void deleteAllResources()
@@ -5312,6 +5548,7 @@ void deleteAllResources()
     deleteResource((OCResource *) presenceResource.handle);
     memset(&presenceResource, 0, sizeof(presenceResource));
 #endif // WITH_PRESENCE
+    InvalidateDiscoveryCache();
 }
 
 OCStackResult deleteResource(OCResource *resource)
@@ -5324,6 +5561,13 @@ OCStackResult deleteResource(OCResource *resource)
         return OC_STACK_INVALID_PARAM;
     }
 
+    OCResourceIndex *entry = NULL;
+    HASH_FIND(hhHandle, resourceHandleIndex, &resource, sizeof(OCResource *), entry);
+    if (!entry)
+    {
+        return OC_STACK_ERROR;
+    }
+
     OIC_LOG_V (INFO, TAG, "Deleting resource %s", resource->uri);
 
     temp = headResource;
@@ -5369,6 +5613,20 @@ OCStackResult deleteResource(OCResource *resource)
                 prev->next = temp->next;
             }
 
+            // The name bindings refer to the index entry, so drop them first.
+            for (OCResourceType *type = temp->rsrcType; type; type = type->next)
+            {
+                unbindResourceName(type->resourcetypename, temp, true);
+            }
+            for (OCResourceInterface *iface = temp->rsrcInterface; iface; iface = iface->next)
+            {
+                unbindResourceName(iface->name, temp, false);
+            }
+            HASH_DELETE(hh, resourceUriIndex, entry);
+            HASH_DELETE(hhHandle, resourceHandleIndex, entry);
+            OICFree(entry);
+            InvalidateDiscoveryCache();
+
             deleteResourceElements(temp);
             OICFree(temp);
             temp = NULL;
@@ -5422,10 +5680,7 @@ void deleteResourceType(OCResourceType *resourceType)
     for (OCResourceType *pointer = resourceType; pointer; pointer = next)
     {
         next = pointer->next;
-        if (pointer->resourcetypename)
-        {
-            OICFree(pointer->resourcetypename);
-        }
+        releaseName(pointer->resourcetypename);
         OICFree(pointer);
     }
 }
@@ -5436,10 +5691,7 @@ void deleteResourceInterface(OCResourceInterface *resourceInterface)
     for (OCResourceInterface *pointer = resourceInterface; pointer; pointer = next)
     {
         next = pointer->next;
-        if (pointer->name)
-        {
-            OICFree(pointer->name);
-        }
+        releaseName(pointer->name);
         OICFree(pointer);
     }
 }
@@ -5488,7 +5740,7 @@ void insertResourceType(OCResource *resource, OCResourceType *resourceType)
             if (!strcmp(resourceType->resourcetypename, pointer->resourcetypename))
             {
                 OIC_LOG_V(INFO, TAG, "Type %s already exists", resourceType->resourcetypename);
-                OICFree(resourceType->resourcetypename);
+                releaseName(resourceType->resourcetypename);
                 OICFree(resourceType);
                 return;
             }
@@ -5502,6 +5754,8 @@ void insertResourceType(OCResource *resource, OCResourceType *resourceType)
         }
     }
     resourceType->next = NULL;
+    bindResourceName(resourceType->resourcetypename, resource, true);
+    InvalidateDiscoveryCache();
 
     OIC_LOG_V(INFO, TAG, "Added type %s to %s", resourceType->resourcetypename, resource->uri);
 }
@@ -5565,6 +5819,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
     OCResourceInterface *previous = NULL;
 
     newInterface->next = NULL;
+    InvalidateDiscoveryCache();
 
     OCResourceInterface **firstInterface = &(resource->rsrcInterface);
 
@@ -5579,16 +5834,13 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
         {
             OCStackResult result = BindResourceInterfaceToResource(resource,
                                                                     OC_RSRVD_INTERFACE_DEFAULT);
-            if (result != OC_STACK_OK)
+            if (result != OC_STACK_OK || !*firstInterface)
             {
-                OICFree(newInterface->name);
+                releaseName(newInterface->name);
                 OICFree(newInterface);
                 return;
             }
-            if (*firstInterface)
-            {
-                (*firstInterface)->next = newInterface;
-            }
+            (*firstInterface)->next = newInterface;
         }
     }
     // If once add oic.if.baseline, later too below code take care of freeing memory.
@@ -5596,7 +5848,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
     {
         if (strcmp((*firstInterface)->name, OC_RSRVD_INTERFACE_DEFAULT) == 0)
         {
-            OICFree(newInterface->name);
+            releaseName(newInterface->name);
             OICFree(newInterface);
             return;
         }
@@ -5614,7 +5866,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
         {
             if (strcmp(newInterface->name, pointer->name) == 0)
             {
-                OICFree(newInterface->name);
+                releaseName(newInterface->name);
                 OICFree(newInterface);
                 return;
             }
@@ -5627,6 +5879,7 @@ void insertResourceInterface(OCResource *resource, OCResourceInterface *newInter
             previous->next = newInterface;
         }
     }
+    bindResourceName(newInterface->name, resource, false);
 }
 
 OCResourceInterface *findResourceInterfaceAtIndex(OCResourceHandle handle,
@@ -5658,6 +5911,170 @@ OCResourceInterface *findResourceInterfaceAtIndex(OCResourceHandle handle,
     return pointer;
 }
 
+char *internName(const char *name)
+{
+    OCInternedName *interned = NULL;
+    HASH_FIND_STR(internedNames, name, interned);
+    if (!interned)
+    {
+        interned = (OCInternedName *) OICCalloc(1, sizeof(OCInternedName));
+        if (!interned)
+        {
+            return NULL;
+        }
+        interned->name = OICStrdup(name);
+        if (!interned->name)
+        {
+            OICFree(interned);
+            return NULL;
+        }
+        interned->typesSorted = true;
+        interned->interfacesSorted = true;
+        HASH_ADD_KEYPTR(hh, internedNames, interned->name, strlen(interned->name), interned);
+    }
+    interned->refCount++;
+    return interned->name;
+}
+
+void releaseName(char *name)
+{
+    if (!name)
+    {
+        return;
+    }
+
+    OCInternedName *interned = NULL;
+    HASH_FIND_STR(internedNames, name, interned);
+    if (!interned || (--interned->refCount > 0))
+    {
+        return;
+    }
+
+    // Each binding is for a resource type or interface using the name, so none are left.
+    HASH_DEL(internedNames, interned);
+    OICFree(interned->name);
+    OICFree(interned);
+}
+
+static int compareBindingOrder(OCNameBinding *a, OCNameBinding *b)
+{
+    return (a->entry->order < b->entry->order) ? -1 : (a->entry->order > b->entry->order);
+}
+
+void bindResourceName(const char *name, OCResource *resource, bool isType)
+{
+    OCInternedName *interned = NULL;
+    OCResourceIndex *entry = NULL;
+    HASH_FIND_STR(internedNames, name, interned);
+    HASH_FIND(hhHandle, resourceHandleIndex, &resource, sizeof(OCResource *), entry);
+    if (!interned || !entry)
+    {
+        return;
+    }
+
+    OCNameBinding **bindings = isType ? &interned->types : &interned->interfaces;
+    bool *sorted = isType ? &interned->typesSorted : &interned->interfacesSorted;
+    OCNameBinding *binding = NULL;
+    HASH_FIND_PTR(*bindings, &entry, binding);
+    if (binding)
+    {
+        return;
+    }
+
+    binding = (OCNameBinding *) OICCalloc(1, sizeof(OCNameBinding));
+    if (!binding)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to allocate name binding");
+        return;
+    }
+    binding->entry = entry;
+
+    // Resources usually get their types and interfaces when created, so bindings are mostly
+    // added in resource list order. Sorting is left to the lookup for the others.
+    if (*bindings)
+    {
+        OCNameBinding *last = (OCNameBinding *) ELMT_FROM_HH((*bindings)->hh.tbl,
+                                                             (*bindings)->hh.tbl->tail);
+        if (last->entry->order > entry->order)
+        {
+            *sorted = false;
+        }
+    }
+    HASH_ADD_PTR(*bindings, entry, binding);
+}
+
+void unbindResourceName(const char *name, const OCResource *resource, bool isType)
+{
+    OCInternedName *interned = NULL;
+    OCResourceIndex *entry = NULL;
+    HASH_FIND_STR(internedNames, name, interned);
+    HASH_FIND(hhHandle, resourceHandleIndex, &resource, sizeof(OCResource *), entry);
+    if (!interned || !entry)
+    {
+        return;
+    }
+
+    OCNameBinding **bindings = isType ? &interned->types : &interned->interfaces;
+    OCNameBinding *binding = NULL;
+    HASH_FIND_PTR(*bindings, &entry, binding);
+    if (binding)
+    {
+        HASH_DEL(*bindings, binding);
+        OICFree(binding);
+    }
+}
+
+static OCStackResult findResourcesWithName(const char *name, bool isType,
+                                           OCResource ***resources, size_t *count)
+{
+    VERIFY_NON_NULL(name, ERROR, OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL(resources, ERROR, OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL(count, ERROR, OC_STACK_INVALID_PARAM);
+
+    *resources = NULL;
+    *count = 0;
+
+    OCInternedName *interned = NULL;
+    HASH_FIND_STR(internedNames, name, interned);
+    if (!interned)
+    {
+        return OC_STACK_OK;
+    }
+
+    OCNameBinding **bindings = isType ? &interned->types : &interned->interfaces;
+    bool *sorted = isType ? &interned->typesSorted : &interned->interfacesSorted;
+    size_t bindingCount = HASH_COUNT(*bindings);
+    if (0 == bindingCount)
+    {
+        return OC_STACK_OK;
+    }
+    if (!*sorted)
+    {
+        HASH_SRT(hh, *bindings, compareBindingOrder);
+        *sorted = true;
+    }
+
+    *resources = (OCResource **) OICMalloc(bindingCount * sizeof(OCResource *));
+    VERIFY_NON_NULL(*resources, ERROR, OC_STACK_NO_MEMORY);
+    for (OCNameBinding *binding = *bindings; binding; binding = (OCNameBinding *) binding->hh.next)
+    {
+        (*resources)[(*count)++] = binding->entry->resource;
+    }
+    return OC_STACK_OK;
+}
+
+OCStackResult FindResourcesWithType(const char *resourceTypeName,
+                                    OCResource ***resources, size_t *count)
+{
+    return findResourcesWithName(resourceTypeName, true, resources, count);
+}
+
+OCStackResult FindResourcesWithInterface(const char *interfaceName,
+                                         OCResource ***resources, size_t *count)
+{
+    return findResourcesWithName(interfaceName, false, resources, count);
+}
+
 /*
  * This function splits the uri using the '?' delimiter.
  * "uriWithoutQuery" is the block of characters between the beginning
@@ -6025,16 +6442,12 @@ OCResourceHandle OC_CALL OCGetResourceHandleAtUri(const char *uri)
         return NULL;
     }
 
-    OCResource *pointer = headResource;
-
-    while (pointer)
+    OCResourceIndex *entry = NULL;
+    HASH_FIND(hh, resourceUriIndex, uri, strlen(uri), entry);
+    if (entry)
     {
-        if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-        {
-            OIC_LOG_V(DEBUG, TAG, "Found Resource %s", uri);
-            return pointer;
-        }
-        pointer = pointer->next;
+        OIC_LOG_V(DEBUG, TAG, "Found Resource %s", uri);
+        return entry->resource;
     }
     return NULL;
 }
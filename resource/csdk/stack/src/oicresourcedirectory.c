@@ -79,6 +79,110 @@ if (SQLITE_OK != (arg)) \
     goto exit; \
 }
 
+/**
+ * Statements of a discovery. Each one is prepared the first time it is needed during the
+ * discovery, reset after every use and finalized before the database is closed again.
+ */
+typedef enum
+{
+    RD_LOOKUP_BEGIN = 0,
+    RD_LOOKUP_COMMIT,
+    RD_LOOKUP_ROLLBACK,
+    RD_LOOKUP_DEVICES,
+    RD_LOOKUP_LAPSED,
+    RD_LOOKUP_DELETE_DEVICE,
+    RD_LOOKUP_DELETE_LINK,
+    RD_LOOKUP_LINKS,
+    RD_LOOKUP_LINKS_RT,
+    RD_LOOKUP_LINKS_IF,
+    RD_LOOKUP_LINKS_RT_IF,
+    RD_LOOKUP_LINK_RT,
+    RD_LOOKUP_LINK_IF,
+    RD_LOOKUP_LINK_EP,
+    RD_LOOKUP_COUNT
+} RDLookupStatement;
+
+static const char *gRDLookupSql[RD_LOOKUP_COUNT] =
+{
+    [RD_LOOKUP_BEGIN] = "BEGIN TRANSACTION",
+    [RD_LOOKUP_COMMIT] = "COMMIT",
+    [RD_LOOKUP_ROLLBACK] = "ROLLBACK",
+    [RD_LOOKUP_DEVICES] = "SELECT di, external_host FROM RD_DEVICE_LIST",
+    [RD_LOOKUP_LAPSED] = "SELECT di FROM RD_DEVICE_LIST WHERE ttl < @ttl",
+    [RD_LOOKUP_DELETE_DEVICE] = "DELETE FROM RD_DEVICE_LIST WHERE di=@deviceId",
+    [RD_LOOKUP_DELETE_LINK] = "DELETE FROM RD_DEVICE_LINK_LIST WHERE ins=@ins",
+    [RD_LOOKUP_LINKS] = "SELECT * FROM RD_DEVICE_LINK_LIST "
+        "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
+        "WHERE RD_DEVICE_LIST.di=@di",
+    [RD_LOOKUP_LINKS_RT] = "SELECT * FROM RD_DEVICE_LINK_LIST "
+        "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
+        "INNER JOIN RD_LINK_RT ON RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID "
+        "WHERE RD_DEVICE_LIST.di=@di AND RD_LINK_RT.rt LIKE @resourceType",
+    [RD_LOOKUP_LINKS_IF] = "SELECT * FROM RD_DEVICE_LINK_LIST "
+        "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
+        "INNER JOIN RD_LINK_IF ON RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID "
+        "WHERE RD_DEVICE_LIST.di=@di AND RD_LINK_IF.if LIKE @interfaceType",
+    [RD_LOOKUP_LINKS_RT_IF] = "SELECT * FROM RD_DEVICE_LINK_LIST "
+        "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
+        "INNER JOIN RD_LINK_RT ON RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID "
+        "INNER JOIN RD_LINK_IF ON RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID "
+        "WHERE RD_DEVICE_LIST.di=@di "
+        "AND RD_LINK_RT.rt LIKE @resourceType "
+        "AND RD_LINK_IF.if LIKE @interfaceType",
+    [RD_LOOKUP_LINK_RT] = "SELECT rt FROM RD_LINK_RT WHERE LINK_ID=@id",
+    [RD_LOOKUP_LINK_IF] = "SELECT if FROM RD_LINK_IF WHERE LINK_ID=@id",
+    [RD_LOOKUP_LINK_EP] = "SELECT ep,pri FROM RD_LINK_EP WHERE LINK_ID=@id",
+};
+
+static sqlite3_stmt *gRDLookupStatements[RD_LOOKUP_COUNT] = { NULL };
+
+static int getStatement(RDLookupStatement id, sqlite3_stmt **stmt)
+{
+    if (!gRDLookupStatements[id])
+    {
+        int res = sqlite3_prepare_v2(gRDDB, gRDLookupSql[id], -1, &gRDLookupStatements[id], NULL);
+        if (SQLITE_OK != res)
+        {
+            return res;
+        }
+    }
+    *stmt = gRDLookupStatements[id];
+    return SQLITE_OK;
+}
+
+/* Makes a cached statement ready for its next use. */
+static void releaseStatement(sqlite3_stmt *stmt)
+{
+    if (stmt)
+    {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+}
+
+static void finalizeStatements(void)
+{
+    for (size_t i = 0; i < RD_LOOKUP_COUNT; i++)
+    {
+        sqlite3_finalize(gRDLookupStatements[i]);
+        gRDLookupStatements[i] = NULL;
+    }
+}
+
+/* Runs a cached statement that takes no parameters and returns no rows. */
+static int execStatement(RDLookupStatement id)
+{
+    sqlite3_stmt *stmt = NULL;
+    int res = getStatement(id, &stmt);
+    if (SQLITE_OK == res)
+    {
+        res = sqlite3_step(stmt);
+        res = (SQLITE_DONE == res) ? SQLITE_OK : res;
+        releaseStatement(stmt);
+    }
+    return res;
+}
+
 OCStackResult OC_CALL OCRDDatabaseSetStorageFilename(const char *filename)
 {
     if (!filename)
@@ -150,7 +254,6 @@ static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDevAddr *devAdd
     sqlite3_stmt *stmtRT = NULL;
     sqlite3_stmt *stmtIF = NULL;
     sqlite3_stmt *stmtEP = NULL;
-    sqlite3_stmt *stmtDI = NULL;
     while (SQLITE_ROW == res)
     {
         resourcePayload = (OCResourcePayload *)OICCalloc(1, sizeof(OCResourcePayload));
@@ -177,9 +280,7 @@ static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDevAddr *devAdd
             VERIFY_NON_NULL(resourcePayload->anchor);
         }
 
-        const char rt[] = "SELECT rt FROM RD_LINK_RT WHERE LINK_ID=@id";
-        int rtSize = (int)sizeof(rt);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, rt, rtSize, &stmtRT, NULL));
+        VERIFY_SQLITE(getStatement(RD_LOOKUP_LINK_RT, &stmtRT));
         VERIFY_SQLITE(sqlite3_bind_int64(stmtRT, sqlite3_bind_parameter_index(stmtRT, "@id"), id));
         while (SQLITE_ROW == sqlite3_step(stmtRT))
         {
@@ -190,12 +291,10 @@ static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDevAddr *devAdd
                 goto exit;
             }
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmtRT));
+        releaseStatement(stmtRT);
         stmtRT = NULL;
 
-        const char itf[] = "SELECT if FROM RD_LINK_IF WHERE LINK_ID=@id";
-        int itfSize = (int)sizeof(itf);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, itf, itfSize, &stmtIF, NULL));
+        VERIFY_SQLITE(getStatement(RD_LOOKUP_LINK_IF, &stmtIF));
         VERIFY_SQLITE(sqlite3_bind_int64(stmtIF, sqlite3_bind_parameter_index(stmtIF, "@id"), id));
         while (SQLITE_ROW == sqlite3_step(stmtIF))
         {
@@ -206,7 +305,7 @@ static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDevAddr *devAdd
                 goto exit;
             }
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmtIF));
+        releaseStatement(stmtIF);
         stmtIF = NULL;
 
         resourcePayload->bitmap = (uint8_t)(bitmap & (OC_OBSERVABLE | OC_DISCOVERABLE));
@@ -221,9 +320,7 @@ static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDevAddr *devAdd
                 OIC_LOG(WARNING, TAG, "CAGetNetworkInformation has error on parsing network infomation");
             }
         }
-        const char ep[] = "SELECT ep,pri FROM RD_LINK_EP WHERE LINK_ID=@id";
-        int epSize = (int)sizeof(ep);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, ep, epSize, &stmtEP, NULL));
+        VERIFY_SQLITE(getStatement(RD_LOOKUP_LINK_EP, &stmtEP));
         VERIFY_SQLITE(sqlite3_bind_int64(stmtEP, sqlite3_bind_parameter_index(stmtEP, "@id"), id));
         while (SQLITE_ROW == sqlite3_step(stmtEP))
         {
@@ -270,31 +367,14 @@ static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDevAddr *devAdd
             }
             epPayload = NULL;
         }
-        VERIFY_SQLITE(sqlite3_finalize(stmtEP));
+        releaseStatement(stmtEP);
         stmtEP = NULL;
         if (networkInfo)
         {
             OICFree(networkInfo);
         }
 
-        const char di[] = "SELECT di FROM RD_DEVICE_LIST "
-            "INNER JOIN RD_DEVICE_LINK_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID = RD_DEVICE_LIST.ID "
-            "WHERE RD_DEVICE_LINK_LIST.DEVICE_ID=@deviceId";
-        int diSize = (int)sizeof(di);
-        const uint8_t di_index = 0;
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, di, diSize, &stmtDI, NULL));
-        VERIFY_SQLITE(sqlite3_bind_int64(stmtDI, sqlite3_bind_parameter_index(stmtDI, "@deviceId"), deviceId));
-        res = sqlite3_step(stmtDI);
-        if (SQLITE_ROW == res || SQLITE_DONE == res)
-        {
-            const unsigned char *tempDi = sqlite3_column_text(stmtDI, di_index);
-            OIC_LOG_V(DEBUG, TAG, " %s", tempDi);
-            discPayload->sid = OICStrdup((char *)tempDi);
-            VERIFY_NON_NULL(discPayload->sid);
-        }
-        VERIFY_SQLITE(sqlite3_finalize(stmtDI));
-        stmtDI = NULL;
-
+        /* discPayload->sid already holds the di the links were selected by */
         OCDiscoveryPayloadAddNewResource(discPayload, resourcePayload);
         resourcePayload = NULL;
         res = sqlite3_step(stmt);
@@ -302,10 +382,9 @@ static OCStackResult ResourcePayloadCreate(sqlite3_stmt *stmt, OCDevAddr *devAdd
     result = OC_STACK_OK;
 
 exit:
-    sqlite3_finalize(stmtDI);
-    sqlite3_finalize(stmtEP);
-    sqlite3_finalize(stmtIF);
-    sqlite3_finalize(stmtRT);
+    releaseStatement(stmtEP);
+    releaseStatement(stmtIF);
+    releaseStatement(stmtRT);
     OICFree(epPayload);
     OCDiscoveryResourceDestroy(resourcePayload);
     return result;
@@ -341,12 +420,7 @@ static OCStackResult CheckResources(const char *interfaceType, const char *resou
         if (!interfaceType || 0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_LL) ||
                 0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_DEFAULT))
         {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "INNER JOIN RD_LINK_RT ON RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di AND RD_LINK_RT.rt LIKE @resourceType";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
+            VERIFY_SQLITE(getStatement(RD_LOOKUP_LINKS_RT, &stmt));
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
                             discPayload->sid, (int)sidLength, SQLITE_STATIC));
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
@@ -354,15 +428,7 @@ static OCStackResult CheckResources(const char *interfaceType, const char *resou
         }
         else
         {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "INNER JOIN RD_LINK_RT ON RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID "
-                                "INNER JOIN RD_LINK_IF ON RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di "
-                                "AND RD_LINK_RT.rt LIKE @resourceType "
-                                "AND RD_LINK_IF.if LIKE @interfaceType";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
+            VERIFY_SQLITE(getStatement(RD_LOOKUP_LINKS_RT_IF, &stmt));
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
                             discPayload->sid, (int)sidLength, SQLITE_STATIC));
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@resourceType"),
@@ -377,22 +443,13 @@ static OCStackResult CheckResources(const char *interfaceType, const char *resou
         if (0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_LL) ||
                 0 == strcmp(interfaceType, OC_RSRVD_INTERFACE_DEFAULT))
         {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
+            VERIFY_SQLITE(getStatement(RD_LOOKUP_LINKS, &stmt));
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
                             discPayload->sid, (int)sidLength, SQLITE_STATIC));
         }
         else
         {
-            const char input[] = "SELECT * FROM RD_DEVICE_LINK_LIST "
-                                "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-                                "INNER JOIN RD_LINK_IF ON RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID "
-                                "WHERE RD_DEVICE_LIST.di LIKE @di AND RD_LINK_IF.if LIKE @interfaceType";
-            int inputSize = (int)sizeof(input);
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
+            VERIFY_SQLITE(getStatement(RD_LOOKUP_LINKS_IF, &stmt));
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@di"),
                             discPayload->sid, (int)sidLength, SQLITE_STATIC));
             VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@interfaceType"),
@@ -402,72 +459,53 @@ static OCStackResult CheckResources(const char *interfaceType, const char *resou
     }
 
 exit:
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return result;
 }
 
 static OCStackResult deleteResources(const char *deviceId, const int64_t *instanceIds, uint16_t nInstanceIds)
 {
-    char *delResource = NULL;
     sqlite3_stmt *stmt = NULL;
 
     OCStackResult result;
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
+    VERIFY_SQLITE(execStatement(RD_LOOKUP_BEGIN));
 
     if (!instanceIds || !nInstanceIds)
     {
-        static const char delDevice[] = "DELETE FROM RD_DEVICE_LIST WHERE di=@deviceId";
-        int delDeviceSize = (int)sizeof(delDevice);
-
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, delDevice, delDeviceSize, &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_LOOKUP_DELETE_DEVICE, &stmt));
         VERIFY_SQLITE(sqlite3_bind_text(stmt, sqlite3_bind_parameter_index(stmt, "@deviceId"),
                                         deviceId, (int)strlen(deviceId), SQLITE_STATIC));
+        if (SQLITE_DONE != sqlite3_step(stmt))
+        {
+            result = OC_STACK_ERROR;
+            goto exit;
+        }
+        releaseStatement(stmt);
     }
     else
     {
-        static const char pre[] = "DELETE FROM RD_DEVICE_LINK_LIST "
-            "WHERE ins IN ("
-            "SELECT RD_DEVICE_LINK_LIST.ins FROM RD_DEVICE_LINK_LIST "
-            "INNER JOIN RD_DEVICE_LIST ON RD_DEVICE_LINK_LIST.DEVICE_ID=RD_DEVICE_LIST.ID "
-            "WHERE RD_DEVICE_LINK_LIST.ins IN (";
-        size_t inLen = nInstanceIds + (nInstanceIds - 1);
-        static const char post[] = "))";
-        size_t delResourceSize = sizeof(pre) + inLen + (sizeof(post) - 1);
-        delResource = OICCalloc(delResourceSize, 1);
-        VERIFY_NON_NULL(delResource);
-        OICStrcat(delResource, delResourceSize, pre);
-        OICStrcat(delResource, delResourceSize, "?");
-        for (uint16_t i = 1; i < nInstanceIds; ++i)
-        {
-            OICStrcat(delResource, delResourceSize, ",?");
-        }
-        OICStrcat(delResource, delResourceSize, post);
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, delResource, (int)delResourceSize,
-                        &stmt, NULL));
+        VERIFY_SQLITE(getStatement(RD_LOOKUP_DELETE_LINK, &stmt));
         for (uint16_t i = 0; i < nInstanceIds; ++i)
         {
-            VERIFY_SQLITE(sqlite3_bind_int64(stmt, 1 + i, instanceIds[i]));
+            VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@ins"),
+                                             instanceIds[i]));
+            if (SQLITE_DONE != sqlite3_step(stmt))
+            {
+                result = OC_STACK_ERROR;
+                goto exit;
+            }
+            releaseStatement(stmt);
         }
     }
 
-    int res = sqlite3_step(stmt);
-    if (SQLITE_DONE != res)
-    {
-        result = OC_STACK_ERROR;
-        goto exit;
-    }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
-
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
+    VERIFY_SQLITE(execStatement(RD_LOOKUP_COMMIT));
     result = OC_STACK_OK;
 
 exit:
-    OICFree(delResource);
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     if (OC_STACK_OK != result)
     {
-        sqlite3_exec(gRDDB, "ROLLBACK", NULL, NULL, NULL);
+        execStatement(RD_LOOKUP_ROLLBACK);
     }
     return result;
 }
@@ -478,9 +516,7 @@ static OCStackResult DeleteExpiredResources()
     OCStackResult result;
 
     uint64_t ttl = OICGetCurrentTime(TIME_IN_US);
-    static const char lapsed[] = "SELECT di FROM RD_DEVICE_LIST WHERE ttl < @ttl";
-    int lapsedSize = (int)sizeof(lapsed);
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, lapsed, lapsedSize, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_LOOKUP_LAPSED, &stmt));
     VERIFY_SQLITE(sqlite3_bind_int64(stmt, sqlite3_bind_parameter_index(stmt, "@ttl"),
                                      (int64_t)ttl));
 
@@ -496,12 +532,10 @@ static OCStackResult DeleteExpiredResources()
             OIC_LOG_V(INFO, TAG, "Deleted resources with di=%s", di);
         }
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-    stmt = NULL;
     result = OC_STACK_OK;
 
  exit:
-    sqlite3_finalize(stmt);
+    releaseStatement(stmt);
     return result;
 }
 
@@ -544,11 +578,9 @@ OCStackResult OC_CALL OCRDDatabaseDiscoveryPayloadCreateWithEp(const char *inter
     DeleteExpiredResources();
 
     const char *serverID = OCGetServerInstanceIDString();
-    const char input[] = "SELECT di, external_host FROM RD_DEVICE_LIST";
-    int inputSize = (int)sizeof(input);
     const uint8_t di_index = 0;
     const uint8_t external_host_index = 1;
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, inputSize, &stmt, NULL));
+    VERIFY_SQLITE(getStatement(RD_LOOKUP_DEVICES, &stmt));
     while (SQLITE_ROW == sqlite3_step(stmt))
     {
         const unsigned char *di = sqlite3_column_text(stmt, di_index);
@@ -583,7 +615,7 @@ exit:
         head = NULL;
     }
     *payload = head;
-    sqlite3_finalize(stmt);
+    finalizeStatements();
     sqlite3_close(gRDDB);
     return result;
 }
@@ -27,6 +27,8 @@ extern "C"
     #include "ocpayloadcbor.h"
     #include "experimental/logger.h"
     #include "oic_malloc.h"
+    #include "oic_string.h"
+    #include "oic_time.h"
 }
 
 #include <gtest/gtest.h>
@@ -432,3 +434,235 @@ TEST(CborEmptyArrayTest, EmptyArrayArraySetGetTest)
     OCRepPayloadDestroy(payload_in);
 }
 
+
+static OCRepPayload *CreateLargeRepPayload(size_t propCount)
+{
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetUri(payload, "/a/large_sensor");
+    char name[32];
+    for (size_t i = 0; i < propCount; i++)
+    {
+        snprintf(name, sizeof(name), "property%zu", i);
+        OCRepPayloadSetPropInt(payload, name, (int64_t)i);
+    }
+    return payload;
+}
+
+static OCDiscoveryPayload *CreateDiscoveryPayload(size_t resourceCount)
+{
+    OCDiscoveryPayload *payload = OCDiscoveryPayloadCreate();
+    payload->sid = OICStrdup("88b7c7f0-4b51-4e0a-9faa-cfb439fd7f49");
+    char uri[32];
+    for (size_t i = 0; i < resourceCount; i++)
+    {
+        OCResourcePayload *resource = (OCResourcePayload *)OICCalloc(1, sizeof(OCResourcePayload));
+        snprintf(uri, sizeof(uri), "/a/light/%zu", i);
+        resource->uri = OICStrdup(uri);
+        resource->types = OCCreateOCStringLL("core.light,core.brightlight");
+        resource->interfaces = OCCreateOCStringLL("oic.if.baseline,oic.if.rw");
+        resource->bitmap = OC_DISCOVERABLE | OC_OBSERVABLE;
+        OCDiscoveryPayloadAddNewResource(payload, resource);
+    }
+    return payload;
+}
+
+TEST(CborLargePayloadTest, ConvertParseTest)
+{
+    // Well beyond the initial encoding buffer, so the size is computed before encoding.
+    OCRepPayload *payload_in = CreateLargeRepPayload(500);
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    ASSERT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload *)payload_in, OC_FORMAT_CBOR,
+                                            &payload_cbor, &payload_cbor_size));
+    EXPECT_LT(255u, payload_cbor_size);
+
+    OCPayload *payload_out = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayload(&payload_out, OC_FORMAT_CBOR,
+                                          PAYLOAD_TYPE_REPRESENTATION,
+                                          payload_cbor, payload_cbor_size));
+    int64_t value = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt((OCRepPayload *)payload_out, "property499", &value));
+    EXPECT_EQ(499, value);
+
+    OICFree(payload_cbor);
+    OCPayloadDestroy(payload_out);
+    OCRepPayloadDestroy(payload_in);
+}
+
+static void BenchmarkConvert(const char *name, OCPayload *payload, int iterations)
+{
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+
+    uint64_t start = OICGetCurrentTime(TIME_IN_US);
+    for (int i = 0; i < iterations; i++)
+    {
+        ASSERT_EQ(OC_STACK_OK, OCConvertPayload(payload, OC_FORMAT_CBOR,
+                                                &payload_cbor, &payload_cbor_size));
+        OICFree(payload_cbor);
+    }
+    uint64_t elapsed = OICGetCurrentTime(TIME_IN_US) - start;
+
+    std::cout << "[ BENCH    ] " << name << ": " << payload_cbor_size << " bytes, "
+              << (elapsed * 1000 / iterations) << " ns per conversion" << std::endl;
+}
+
+TEST(CborConvertBenchmark, RepresentativePayloads)
+{
+    OCRepPayload *smallRep = OCRepPayloadCreate();
+    OCRepPayloadSetUri(smallRep, "/a/light");
+    OCRepPayloadSetPropBool(smallRep, "state", true);
+    OCRepPayloadSetPropInt(smallRep, "power", 10);
+    BenchmarkConvert("small rep", (OCPayload *)smallRep, 10000);
+    OCRepPayloadDestroy(smallRep);
+
+    OCRepPayload *largeRep = CreateLargeRepPayload(200);
+    BenchmarkConvert("large rep", (OCPayload *)largeRep, 1000);
+    OCRepPayloadDestroy(largeRep);
+
+    OCDiscoveryPayload *discovery = CreateDiscoveryPayload(100);
+    BenchmarkConvert("discovery, 100 links", (OCPayload *)discovery, 1000);
+    OCDiscoveryPayloadDestroy(discovery);
+
+    uint8_t introspectionData[4096];
+    memset(introspectionData, 0xA5, sizeof(introspectionData));
+    OCIntrospectionPayload *introspection =
+            OCIntrospectionPayloadCreateFromCbor(introspectionData, sizeof(introspectionData));
+    BenchmarkConvert("introspection", (OCPayload *)introspection, 1000);
+    OCIntrospectionPayloadDestroy(introspection);
+}
+
+TEST(RepPayloadIndexTest, SetGetKeepsInsertionOrder)
+{
+    const size_t propCount = 200;
+    OCRepPayload *payload = CreateLargeRepPayload(propCount);
+    ASSERT_TRUE(payload->valueIndex != NULL);
+
+    // Overwriting keeps the value where it was.
+    EXPECT_TRUE(OCRepPayloadSetPropString(payload, "property7", "seven"));
+    EXPECT_TRUE(OCRepPayloadSetPropDouble(payload, "property150", 1.5));
+
+    char name[32];
+    size_t i = 0;
+    for (OCRepPayloadValue *val = payload->values; val; val = val->next, i++)
+    {
+        snprintf(name, sizeof(name), "property%zu", i);
+        EXPECT_STREQ(name, val->name);
+    }
+    EXPECT_EQ(propCount, i);
+
+    for (i = 0; i < propCount; i++)
+    {
+        snprintf(name, sizeof(name), "property%zu", i);
+        int64_t value = -1;
+        EXPECT_EQ(7 != i && 150 != i, OCRepPayloadGetPropInt(payload, name, &value));
+    }
+    char *str = NULL;
+    EXPECT_TRUE(OCRepPayloadGetPropString(payload, "property7", &str));
+    EXPECT_STREQ("seven", str);
+    OICFree(str);
+    double d = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropDouble(payload, "property150", &d));
+    EXPECT_EQ(1.5, d);
+    EXPECT_TRUE(OCRepPayloadIsNull(payload, "missing"));
+
+    OCRepPayload *clone = OCRepPayloadClone(payload);
+    ASSERT_TRUE(clone != NULL);
+    EXPECT_TRUE(clone->valueIndex != NULL);
+    int64_t value = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt(clone, "property199", &value));
+    EXPECT_EQ(199, value);
+
+    OCRepPayloadDestroy(clone);
+    OCRepPayloadDestroy(payload);
+}
+
+TEST(RepPayloadIndexTest, SeesValuesChangedOutsideTheSetters)
+{
+    OCRepPayload *payload = CreateLargeRepPayload(50);
+    ASSERT_TRUE(payload->valueIndex != NULL);
+
+    // Appended straight to the list, the way some services build payloads.
+    OCRepPayloadValue *last = payload->values;
+    while (last->next)
+    {
+        last = last->next;
+    }
+    last->next = (OCRepPayloadValue *)OICCalloc(1, sizeof(OCRepPayloadValue));
+    last->next->name = OICStrdup("appended");
+    last->next->type = OCREP_PROP_INT;
+    last->next->i = 42;
+
+    int64_t value = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload, "appended", &value));
+    EXPECT_EQ(42, value);
+    EXPECT_TRUE(OCRepPayloadSetPropInt(payload, "appended", 43));
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload, "appended", &value));
+    EXPECT_EQ(43, value);
+    EXPECT_TRUE(last->next->next == NULL);
+
+    // A replaced list is not looked up through the old index.
+    OCRepPayload *other = CreateLargeRepPayload(20);
+    OCRepPayloadValue *values = payload->values;
+    payload->values = other->values;
+    other->values = values;
+    EXPECT_FALSE(OCRepPayloadGetPropInt(payload, "property30", &value));
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload, "property19", &value));
+    EXPECT_EQ(19, value);
+    EXPECT_TRUE(OCRepPayloadSetPropInt(payload, "property20", 20));
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload, "property20", &value));
+
+    OCRepPayloadDestroy(other);
+    OCRepPayloadDestroy(payload);
+}
+
+// Building a wide representation and reading every property back. Lookups
+// through the index are compared with the list walk on the same values.
+TEST(RepPayloadIndexTest, WideRepresentationBenchmark)
+{
+    const size_t counts[] = { 16, 128, 1024 };
+    char name[32];
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        size_t propCount = counts[c];
+
+        uint64_t start = OICGetCurrentTime(TIME_IN_US);
+        OCRepPayload *payload = CreateLargeRepPayload(propCount);
+        uint64_t buildUs = OICGetCurrentTime(TIME_IN_US) - start;
+
+        int64_t sum = 0;
+        start = OICGetCurrentTime(TIME_IN_US);
+        for (size_t i = 0; i < propCount; i++)
+        {
+            int64_t value = 0;
+            snprintf(name, sizeof(name), "property%zu", i);
+            OCRepPayloadGetPropInt(payload, name, &value);
+            sum += value;
+        }
+        uint64_t indexedUs = OICGetCurrentTime(TIME_IN_US) - start;
+
+        // Same values in a payload without an index.
+        OCRepPayload *plain = OCRepPayloadCreate();
+        plain->values = payload->values;
+        payload->values = NULL;
+        start = OICGetCurrentTime(TIME_IN_US);
+        for (size_t i = 0; i < propCount; i++)
+        {
+            int64_t value = 0;
+            snprintf(name, sizeof(name), "property%zu", i);
+            OCRepPayloadGetPropInt(plain, name, &value);
+            sum -= value;
+        }
+        uint64_t listUs = OICGetCurrentTime(TIME_IN_US) - start;
+
+        std::cout << "[ BENCH    ] " << propCount << " properties: set all " << buildUs
+                  << " us, get all " << indexedUs << " us indexed, " << listUs
+                  << " us list walk" << std::endl;
+        EXPECT_EQ(0, sum);
+
+        OCRepPayloadDestroy(plain);
+        OCRepPayloadDestroy(payload);
+    }
+}
@@ -29,6 +29,8 @@ extern "C"
     #include "oic_string.h"
     #include "oic_time.h"
     #include "ocresourcehandler.h"
+    #include "ocobserve.h"
+    #include "ocpayloadcbor.h"
     #include "occollection.h"
     #include "mbedtls/ssl_ciphersuites.h"
     #include "octypes.h"
@@ -46,6 +48,15 @@ extern "C"
 #include <unistd.h>
 #endif
 #include <stdlib.h>
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifdef HAVE_NETINET_IN_H
+#include <netinet/in.h>
+#endif
+#ifdef HAVE_ARPA_INET_H
+#include <arpa/inet.h>
+#endif
 
 //-----------------------------------------------------------------------------
 // Includes
@@ -799,6 +810,19 @@ TEST(StackResource, DISABLED_UpdateResourceNullURI)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackResource, SetRawResponsePayloadBadParams)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting SetRawResponsePayloadBadParams test");
+    InitStack(OC_CLIENT);
+
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCSetRawResponsePayload(NULL, true));
+    // Not a handle returned by OCDoResource.
+    EXPECT_EQ(OC_STACK_ERROR, OCSetRawResponsePayload((OCDoHandle)&killSwitch, true));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 TEST(StackResource, CreateResourceBadParams)
 {
     itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
@@ -2392,6 +2416,719 @@ TEST(StackResource, MultipleResourcesDiscovery)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackResource, FindResourceByUriAfterDelete)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting FindResourceByUriAfterDelete test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle1;
+    OCResourceHandle handle2;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1, "core.led", "core.rw", "/a/led1",
+                                            0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle2, "core.led", "core.rw", "/a/led2",
+                                            0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    EXPECT_EQ(handle1, OCGetResourceHandleAtUri("/a/led1"));
+    EXPECT_EQ((OCResource *)handle2, FindResourceByUri("/a/led2"));
+    EXPECT_TRUE(NULL == FindResourceByUri("/a/led"));
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handle1));
+    EXPECT_TRUE(NULL == OCGetResourceHandleAtUri("/a/led1"));
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCDeleteResource(handle1));
+    EXPECT_EQ((OCResource *)handle2, FindResourceByUri("/a/led2"));
+
+    // The URI can be used again once the resource is deleted.
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle1, "core.led", "core.rw", "/a/led1",
+                                            0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ(handle1, OCGetResourceHandleAtUri("/a/led1"));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+// Request dispatch cost with as many resources as a large bridge exposes.
+TEST(StackResource, DetermineResourceHandlingBenchmark)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DetermineResourceHandlingBenchmark test");
+    InitStack(OC_SERVER);
+
+    const int resourceCount = 10000;
+    const int lookups = 100000;
+    char uri[MAX_URI_LENGTH];
+
+    uint64_t start = OICGetCurrentTime(TIME_IN_US);
+    for (int i = 0; i < resourceCount; i++)
+    {
+        OCResourceHandle handle;
+        snprintf(uri, sizeof(uri), "/bridge/device/%d", i);
+        ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.light", "oic.if.baseline", uri,
+                                                0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+    }
+    uint64_t createTime = OICGetCurrentTime(TIME_IN_US) - start;
+
+    OCServerRequest request;
+    memset(&request, 0, sizeof(request));
+    request.devAddr.adapter = OC_ADAPTER_IP;
+
+    start = OICGetCurrentTime(TIME_IN_US);
+    for (int i = 0; i < lookups; i++)
+    {
+        snprintf(request.resourceUrl, sizeof(request.resourceUrl), "/bridge/device/%d",
+                 (i * 7919) % resourceCount);
+        ResourceHandling handling = OC_RESOURCE_VIRTUAL;
+        OCResource *resource = NULL;
+        ASSERT_EQ(OC_STACK_OK, DetermineResourceHandling(&request, &handling, &resource));
+        ASSERT_TRUE(NULL != resource);
+    }
+    uint64_t lookupTime = OICGetCurrentTime(TIME_IN_US) - start;
+
+    std::cout << "[ BENCH    ] " << resourceCount << " resources: created in " << createTime
+              << " us, " << lookups << " dispatch lookups in " << lookupTime << " us"
+              << std::endl;
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+static OCStackApplicationResult noopClientHandler(void * /*ctx*/, OCDoHandle /*handle*/,
+                                                  OCClientResponse * /*clientResponse*/)
+{
+    return OC_STACK_KEEP_TRANSACTION;
+}
+
+static ClientCB *AddTestClientCB(uint32_t id, OCMethod method, uint32_t ttl)
+{
+    OCCallbackData cbData = { NULL, noopClientHandler, NULL };
+    CAToken_t token = (CAToken_t)OICCalloc(1, CA_MAX_TOKEN_LEN);
+    memcpy(token, &id, sizeof(id));
+    OCDoHandle handle = (OCDoHandle)OICMalloc(1);
+    ClientCB *cbNode = NULL;
+
+    EXPECT_EQ(OC_STACK_OK, AddClientCB(&cbNode, &cbData, CA_MSG_CONFIRM, token,
+                                       CA_MAX_TOKEN_LEN, NULL, 0, NULL, 0, CA_FORMAT_UNDEFINED,
+                                       &handle, method, NULL, OICStrdup("/a/light"), NULL, ttl));
+    return cbNode;
+}
+
+TEST(StackClientCB, LookupAndExpiry)
+{
+    uint32_t expired = GetTicks(0) - 1;
+    ClientCB *getCB = AddTestClientCB(1, OC_REST_GET, expired);
+    ClientCB *observeCB = AddTestClientCB(2, OC_REST_OBSERVE, expired);
+    ClientCB *laterCB = AddTestClientCB(3, OC_REST_GET, GetTicks(60000));
+    ASSERT_TRUE(NULL != getCB && NULL != observeCB && NULL != laterCB);
+
+    EXPECT_EQ(getCB, GetClientCBUsingToken(getCB->token, getCB->tokenLength));
+    EXPECT_EQ(observeCB, GetClientCBUsingHandle(observeCB->handle));
+
+    // The GET has timed out; observes have no TTL.
+    DeleteTimedOutClientCBs();
+    EXPECT_EQ(observeCB, GetClientCBUsingToken(observeCB->token, observeCB->tokenLength));
+    EXPECT_EQ(laterCB, GetClientCBUsingToken(laterCB->token, laterCB->tokenLength));
+
+    uint32_t id = 1;
+    uint8_t token[CA_MAX_TOKEN_LEN] = { 0 };
+    memcpy(token, &id, sizeof(id));
+    EXPECT_TRUE(NULL == GetClientCBUsingToken((CAToken_t)token, CA_MAX_TOKEN_LEN));
+
+    SetClientCBTTL(laterCB, expired);
+    DeleteTimedOutClientCBs();
+    id = 3;
+    memcpy(token, &id, sizeof(id));
+    EXPECT_TRUE(NULL == GetClientCBUsingToken((CAToken_t)token, CA_MAX_TOKEN_LEN));
+
+    DeleteClientCB(observeCB);
+    EXPECT_TRUE(NULL == g_cbList);
+    DeleteClientCBList();
+}
+
+// Response dispatch with as many outstanding observations as a large controller keeps.
+TEST(StackClientCB, GetClientCBUsingTokenBenchmark)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+    const uint32_t callbackCount = 10000;
+    const int lookups = 100000;
+
+    uint64_t start = OICGetCurrentTime(TIME_IN_US);
+    for (uint32_t i = 0; i < callbackCount; i++)
+    {
+        ASSERT_TRUE(NULL != AddTestClientCB(i, (i % 2) ? OC_REST_OBSERVE : OC_REST_GET,
+                                            GetTicks(60000)));
+    }
+    uint64_t addTime = OICGetCurrentTime(TIME_IN_US) - start;
+
+    uint8_t token[CA_MAX_TOKEN_LEN] = { 0 };
+    start = OICGetCurrentTime(TIME_IN_US);
+    for (int i = 0; i < lookups; i++)
+    {
+        uint32_t id = (i * 7919) % callbackCount;
+        memcpy(token, &id, sizeof(id));
+        ASSERT_TRUE(NULL != GetClientCBUsingToken((CAToken_t)token, CA_MAX_TOKEN_LEN));
+    }
+    uint64_t lookupTime = OICGetCurrentTime(TIME_IN_US) - start;
+
+    // The list walk lookups used to do, for comparison.
+    start = OICGetCurrentTime(TIME_IN_US);
+    for (int i = 0; i < lookups / 100; i++)
+    {
+        uint32_t id = (i * 7919) % callbackCount;
+        memcpy(token, &id, sizeof(id));
+        ClientCB *out = g_cbList;
+        while (out && (0 != memcmp(out->token, token, CA_MAX_TOKEN_LEN)))
+        {
+            out = out->next;
+        }
+        ASSERT_TRUE(NULL != out);
+    }
+    uint64_t walkTime = (OICGetCurrentTime(TIME_IN_US) - start) * 100;
+
+    start = OICGetCurrentTime(TIME_IN_US);
+    DeleteClientCBList();
+    uint64_t deleteTime = OICGetCurrentTime(TIME_IN_US) - start;
+
+    std::cout << "[ BENCH    ] " << callbackCount << " callbacks: added in " << addTime
+              << " us, " << lookups << " token lookups in " << lookupTime
+              << " us (list walk ~" << walkTime << " us), deleted in " << deleteTime << " us"
+              << std::endl;
+}
+
+static uint32_t g_notifyHandlerCalls = 0;
+
+extern "C" OCEntityHandlerResult notifyEntityHandler(OCEntityHandlerFlag /*flag*/,
+        OCEntityHandlerRequest *entityHandlerRequest, void* /*callbackParam*/)
+{
+    g_notifyHandlerCalls++;
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetPropInt(payload, "value", g_notifyHandlerCalls);
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *)payload;
+    OCStackResult result = OCDoResponse(&response);
+    OCRepPayloadDestroy(payload);
+
+    return (OC_STACK_OK == result) ? OC_EH_OK : OC_EH_ERROR;
+}
+
+static void AddTestObservers(OCResourceHandle handle, uint32_t count, const char *query,
+                             uint8_t tokenTag)
+{
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.flags = OC_IP_USE_V4;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+
+    OCResource *resource = (OCResource *)handle;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        char token[CA_MAX_TOKEN_LEN] = { 0 };
+        token[0] = (char)tokenTag;
+        memcpy(token + 4, &i, sizeof(i));
+        devAddr.port = (uint16_t)(40000 + (i % 1000));
+
+        OCObservationId obsId = 0;
+        ASSERT_EQ(OC_STACK_OK, GenerateObserverId(&obsId));
+        ASSERT_EQ(OC_STACK_OK, AddObserver(resource->uri, query, obsId, token, sizeof(token),
+                                           resource, OC_LOW_QOS, OC_FORMAT_CBOR, 0, &devAddr));
+    }
+}
+
+TEST(StackObserve, NotifyAllObserversGroupsByQuery)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting NotifyAllObserversGroupsByQuery test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.sensor",
+                                            "oic.if.baseline",
+                                            "/a/sensor",
+                                            notifyEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    AddTestObservers(handle, 10, NULL, 1);
+    AddTestObservers(handle, 5, "if=oic.if.baseline", 2);
+
+    g_notifyHandlerCalls = 0;
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+    EXPECT_EQ(2u, g_notifyHandlerCalls);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackObserve, NotifyAllObserversBenchmark)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting NotifyAllObserversBenchmark test");
+
+    const uint32_t observerCounts[] = { 10, 100, 500 };
+    for (size_t i = 0; i < sizeof(observerCounts) / sizeof(observerCounts[0]); i++)
+    {
+        InitStack(OC_SERVER);
+
+        OCResourceHandle handle;
+        EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                                "core.sensor",
+                                                "oic.if.baseline",
+                                                "/a/sensor",
+                                                notifyEntityHandler,
+                                                NULL,
+                                                OC_DISCOVERABLE|OC_OBSERVABLE));
+        AddTestObservers(handle, observerCounts[i], NULL, 1);
+
+        g_notifyHandlerCalls = 0;
+        uint64_t start = OICGetCurrentTime(TIME_IN_US);
+        EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+        uint64_t elapsed = OICGetCurrentTime(TIME_IN_US) - start;
+
+        std::cout << "[ BENCH    ] notify " << observerCounts[i] << " observers: "
+                  << elapsed << " us, " << g_notifyHandlerCalls << " entity handler call(s)"
+                  << std::endl;
+        EXPECT_EQ(1u, g_notifyHandlerCalls);
+
+        EXPECT_EQ(OC_STACK_OK, OCStop());
+    }
+}
+
+static void SendTestDiscoveryRequest(uint16_t id, const char *query,
+                                     OCPayloadFormat acceptFormat)
+{
+    OCDevAddr devAddr;
+    memset(&devAddr, 0, sizeof(devAddr));
+    devAddr.adapter = OC_ADAPTER_IP;
+    devAddr.flags = OC_IP_USE_V4;
+    devAddr.port = 40000;
+    OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+
+    char token[CA_MAX_TOKEN_LEN] = { 0 };
+    memcpy(token, &id, sizeof(id));
+    char queryBuf[MAX_QUERY_LENGTH] = { 0 };
+    if (query)
+    {
+        OICStrcpy(queryBuf, sizeof(queryBuf), query);
+    }
+    char uri[] = OC_RSRVD_WELL_KNOWN_URI;
+
+    OCServerRequest *request = NULL;
+    ASSERT_EQ(OC_STACK_OK, AddServerRequest(&request, id, 0, 0, OC_REST_GET, 0,
+                                            OC_OBSERVE_NO_OPTION, OC_LOW_QOS, queryBuf, NULL,
+                                            OC_FORMAT_UNDEFINED, NULL, (CAToken_t)token,
+                                            sizeof(token), uri, 0, acceptFormat,
+                                            OC_SPEC_VERSION_VALUE, &devAddr));
+
+    ResourceHandling handling = OC_RESOURCE_NOT_SPECIFIED;
+    OCResource *resource = NULL;
+    ASSERT_EQ(OC_STACK_OK, DetermineResourceHandling(request, &handling, &resource));
+    ASSERT_EQ(OC_RESOURCE_VIRTUAL, handling);
+    ProcessRequest(handling, resource, request);
+}
+
+TEST(StackDiscovery, DiscoveryResponseCache)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DiscoveryResponseCache test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.light", "oic.if.baseline", "/a/light",
+                                            0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    OCDiscoveryCacheStats before;
+    OCDiscoveryCacheStats after;
+    GetDiscoveryCacheStats(&before);
+    SendTestDiscoveryRequest(1, NULL, OC_FORMAT_CBOR);
+    SendTestDiscoveryRequest(2, NULL, OC_FORMAT_CBOR);
+    GetDiscoveryCacheStats(&after);
+    EXPECT_EQ(before.misses + 1, after.misses);
+    EXPECT_EQ(before.hits + 1, after.hits);
+
+    // Each filter and format has a response of its own.
+    SendTestDiscoveryRequest(3, "rt=core.light", OC_FORMAT_CBOR);
+    SendTestDiscoveryRequest(4, "rt=core.light", OC_FORMAT_VND_OCF_CBOR);
+    SendTestDiscoveryRequest(5, "rt=core.light", OC_FORMAT_CBOR);
+    GetDiscoveryCacheStats(&after);
+    EXPECT_EQ(before.misses + 3, after.misses);
+    EXPECT_EQ(before.hits + 2, after.hits);
+
+    // Changing a resource drops the cached responses.
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(handle, "core.brightlight"));
+    SendTestDiscoveryRequest(6, "rt=core.light", OC_FORMAT_CBOR);
+    GetDiscoveryCacheStats(&after);
+    EXPECT_EQ(before.misses + 4, after.misses);
+    EXPECT_EQ(before.hits + 2, after.hits);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackDiscovery, DiscoveryResponseCacheBenchmark)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DiscoveryResponseCacheBenchmark test");
+    InitStack(OC_SERVER);
+
+    const int resourceCount = 1000;
+    const uint16_t requests = 200;
+    char uri[MAX_URI_LENGTH];
+    for (int i = 0; i < resourceCount; i++)
+    {
+        OCResourceHandle handle;
+        snprintf(uri, sizeof(uri), "/bridge/device/%d", i);
+        ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.light", "oic.if.baseline", uri,
+                                                0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+    }
+
+    uint64_t start = OICGetCurrentTime(TIME_IN_US);
+    for (uint16_t i = 0; i < requests; i++)
+    {
+        InvalidateDiscoveryCache();
+        SendTestDiscoveryRequest(i, NULL, OC_FORMAT_CBOR);
+    }
+    uint64_t uncachedTime = OICGetCurrentTime(TIME_IN_US) - start;
+
+    OCDiscoveryCacheStats before;
+    OCDiscoveryCacheStats after;
+    GetDiscoveryCacheStats(&before);
+    start = OICGetCurrentTime(TIME_IN_US);
+    for (uint16_t i = 0; i < requests; i++)
+    {
+        SendTestDiscoveryRequest(i, NULL, OC_FORMAT_CBOR);
+    }
+    uint64_t cachedTime = OICGetCurrentTime(TIME_IN_US) - start;
+    GetDiscoveryCacheStats(&after);
+
+    std::cout << "[ BENCH    ] /oic/res with " << resourceCount << " resources: " << requests
+              << " built responses in " << uncachedTime << " us, " << requests
+              << " cached responses in " << cachedTime << " us (" << (after.hits - before.hits)
+              << " hits)" << std::endl;
+    EXPECT_EQ(before.hits + requests, after.hits);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackResource, ResourceTypeIndex)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting ResourceTypeIndex test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle light1;
+    OCResourceHandle fan;
+    OCResourceHandle light2;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&light1, "core.light", "oic.if.a", "/a/light1",
+                                            0, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&fan, "core.fan", "oic.if.baseline", "/a/fan",
+                                            0, NULL, OC_DISCOVERABLE));
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&light2, "core.light", "oic.if.baseline",
+                                            "/a/light2", 0, NULL, OC_DISCOVERABLE));
+    // Bound after /a/light2 was created, still listed in resource list order.
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(fan, "core.light"));
+
+    // Names are stored once.
+    EXPECT_EQ(OCGetResourceTypeName(light1, 0), OCGetResourceTypeName(light2, 0));
+    EXPECT_EQ(OCGetResourceTypeName(light1, 0), OCGetResourceTypeName(fan, 1));
+
+    OCResource **resources = NULL;
+    size_t count = 0;
+    EXPECT_EQ(OC_STACK_OK, FindResourcesWithType("core.light", &resources, &count));
+    ASSERT_EQ(3u, count);
+    EXPECT_EQ(light1, resources[0]);
+    EXPECT_EQ(fan, resources[1]);
+    EXPECT_EQ(light2, resources[2]);
+    OICFree(resources);
+
+    EXPECT_EQ(OC_STACK_OK, FindResourcesWithInterface("oic.if.a", &resources, &count));
+    ASSERT_EQ(1u, count);
+    EXPECT_EQ(light1, resources[0]);
+    OICFree(resources);
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(light1));
+    EXPECT_EQ(OC_STACK_OK, FindResourcesWithType("core.light", &resources, &count));
+    ASSERT_EQ(2u, count);
+    EXPECT_EQ(fan, resources[0]);
+    EXPECT_EQ(light2, resources[1]);
+    OICFree(resources);
+
+    EXPECT_EQ(OC_STACK_OK, FindResourcesWithInterface("oic.if.a", &resources, &count));
+    EXPECT_EQ(0u, count);
+    EXPECT_TRUE(NULL == resources);
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackDiscovery, FilteredDiscoveryBenchmark)
+{
+    itst::DeadmanTimer killSwitch(LONG_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting FilteredDiscoveryBenchmark test");
+    InitStack(OC_SERVER);
+
+    const int resourceCount = 10000;
+    const int typeCount = 1000;
+    const uint16_t requests = 1000;
+    char uri[MAX_URI_LENGTH];
+    char type[32];
+    for (int i = 0; i < resourceCount; i++)
+    {
+        OCResourceHandle handle;
+        snprintf(uri, sizeof(uri), "/bridge/device/%d", i);
+        snprintf(type, sizeof(type), "x.bridge.type%d", i % typeCount);
+        ASSERT_EQ(OC_STACK_OK, OCCreateResource(&handle, type, "oic.if.baseline", uri,
+                                                0, NULL, OC_DISCOVERABLE|OC_OBSERVABLE));
+    }
+
+    char query[MAX_QUERY_LENGTH];
+    uint64_t start = OICGetCurrentTime(TIME_IN_US);
+    for (uint16_t i = 0; i < requests; i++)
+    {
+        // Build each response rather than answer from the discovery cache.
+        InvalidateDiscoveryCache();
+        snprintf(query, sizeof(query), "rt=x.bridge.type%d", (i * 7919) % typeCount);
+        SendTestDiscoveryRequest(i, query, OC_FORMAT_CBOR);
+    }
+    uint64_t elapsed = OICGetCurrentTime(TIME_IN_US) - start;
+
+    std::cout << "[ BENCH    ] " << resourceCount << " resources, " << typeCount
+              << " types: " << requests << " rt= discovery requests in " << elapsed << " us"
+              << std::endl;
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+#if defined(IP_ADAPTER) && defined(HAVE_SYS_SOCKET_H) && defined(HAVE_NETINET_IN_H)
+// Opens a UDP socket on 127.0.0.1 that stands in for an observer.
+static int OpenObserverSocket(uint16_t *port)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    struct timeval timeout = { 5, 0 };
+    if ((0 != bind(fd, (struct sockaddr *)&addr, sizeof(addr))) ||
+        (0 != getsockname(fd, (struct sockaddr *)&addr, &len)) ||
+        (0 != setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout))))
+    {
+        close(fd);
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+// Receives one CoAP message and returns its payload, or NULL if there is none.
+static const uint8_t *ReceiveCoapPayload(int fd, uint8_t *buf, size_t bufSize, size_t *payloadSize)
+{
+    ssize_t len = recv(fd, buf, bufSize, 0);
+    if (len < 4)
+    {
+        return NULL;
+    }
+
+    // Skip the header, the token and the options up to the payload marker.
+    size_t i = 4 + (buf[0] & 0x0F);
+    while ((i < (size_t)len) && (0xFF != buf[i]))
+    {
+        size_t delta = buf[i] >> 4;
+        size_t optLen = buf[i] & 0x0F;
+        i++;
+        i += (13 == delta) ? 1 : ((14 == delta) ? 2 : 0);
+        if (13 == optLen)
+        {
+            optLen = 13 + buf[i];
+            i++;
+        }
+        else if (14 == optLen)
+        {
+            optLen = 269 + ((buf[i] << 8) | buf[i + 1]);
+            i += 2;
+        }
+        i += optLen;
+    }
+    if (i + 1 >= (size_t)len)
+    {
+        return NULL;
+    }
+    *payloadSize = (size_t)len - i - 1;
+    return buf + i + 1;
+}
+
+// Checks that the /a/light link of a discovery notification lists the endpoints for devAddr.
+static void ExpectEndpointsFor(const uint8_t *data, size_t size, OCResource *resource,
+                               const OCDevAddr *devAddr, CAEndpoint_t *info, size_t infoSize)
+{
+    OCPayload *payload = NULL;
+    ASSERT_EQ(OC_STACK_OK, OCParsePayload(&payload, OC_FORMAT_CBOR, PAYLOAD_TYPE_DISCOVERY,
+                                          data, size));
+    ASSERT_TRUE(NULL != payload);
+
+    OCResourcePayload *link = ((OCDiscoveryPayload *)payload)->resources;
+    while (link && strcmp("/a/light", link->uri))
+    {
+        link = link->next;
+    }
+    ASSERT_TRUE(NULL != link);
+
+    OCEndpointPayload *expected = NULL;
+    size_t expectedCount = 0;
+    if (infoSize)
+    {
+        CreateEndpointPayloadList(resource, devAddr, info, infoSize, &expected, &expectedCount,
+                                  NULL);
+    }
+
+    size_t count = 0;
+    for (OCEndpointPayload *ep = link->eps; ep; ep = ep->next)
+    {
+        bool found = false;
+        for (OCEndpointPayload *exp = expected; exp && !found; exp = exp->next)
+        {
+            found = (0 == strcmp(exp->addr, ep->addr)) && (exp->port == ep->port);
+        }
+        EXPECT_TRUE(found) << ep->addr << ":" << ep->port;
+        count++;
+    }
+    EXPECT_EQ(expectedCount, count);
+
+    OCEndpointPayloadDestroy(expected);
+    OCPayloadDestroy(payload);
+}
+
+TEST(StackObserve, DiscoveryObserversOnOtherInterfacesGetTheirOwnEndpoints)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting DiscoveryObserversOnOtherInterfacesGetTheirOwnEndpoints test");
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle, "core.light", "oic.if.baseline",
+                                            "/a/light", entityHandler, NULL, OC_DISCOVERABLE));
+    OCResource *light = (OCResource *)handle;
+    OCResource *wellKnown = (OCResource *)OCGetResourceHandleAtUri(OC_RSRVD_WELL_KNOWN_URI);
+    ASSERT_TRUE(NULL != wellKnown);
+
+    CAEndpoint_t *info = NULL;
+    size_t infoSize = 0;
+    CAGetNetworkInformation(&info, &infoSize);
+    uint32_t ifindex = 1;
+    for (size_t i = 0; i < infoSize; i++)
+    {
+        if (CA_ADAPTER_IP == info[i].adapter)
+        {
+            ifindex = info[i].ifindex;
+            break;
+        }
+    }
+
+    // Both observers are reached over 127.0.0.1, but claim different interfaces, so
+    // /oic/res lists different endpoints for each.
+    OCDevAddr devAddrs[2];
+    int fds[2];
+    memset(devAddrs, 0, sizeof(devAddrs));
+    for (int i = 0; i < 2; i++)
+    {
+        fds[i] = OpenObserverSocket(&devAddrs[i].port);
+        ASSERT_LE(0, fds[i]);
+        devAddrs[i].adapter = OC_ADAPTER_IP;
+        OICStrcpy(devAddrs[i].addr, sizeof(devAddrs[i].addr), "127.0.0.1");
+    }
+    devAddrs[0].flags = OC_IP_USE_V4;
+    devAddrs[0].ifindex = ifindex;
+    devAddrs[1].flags = OC_IP_USE_V4;
+    devAddrs[1].ifindex = ifindex + 1000;
+
+    for (int i = 0; i < 2; i++)
+    {
+        char token[CA_MAX_TOKEN_LEN] = { 0 };
+        token[0] = (char)(i + 1);
+        OCObservationId obsId = 0;
+        ASSERT_EQ(OC_STACK_OK, GenerateObserverId(&obsId));
+        ASSERT_EQ(OC_STACK_OK, AddObserver(wellKnown->uri, "rt=core.light", obsId, token,
+                                           sizeof(token), wellKnown, OC_LOW_QOS,
+                                           OC_FORMAT_CBOR, 0, &devAddrs[i]));
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers((OCResourceHandle)wellKnown, OC_LOW_QOS));
+
+    uint8_t buf[2048];
+    for (int i = 0; i < 2; i++)
+    {
+        size_t size = 0;
+        const uint8_t *data = ReceiveCoapPayload(fds[i], buf, sizeof(buf), &size);
+        EXPECT_TRUE(NULL != data);
+        if (data)
+        {
+            ExpectEndpointsFor(data, size, light, &devAddrs[i], info, infoSize);
+        }
+        close(fds[i]);
+    }
+
+    OICFree(info);
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackProcessEvent, UnregisteringAnEventKeepsTheOthersSignaled)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    InitStack(OC_CLIENT_SERVER);
+
+    // Two callers, such as the C++ client and server wrappers, wait on their own events.
+    oc_event first = oc_event_new();
+    oc_event second = oc_event_new();
+    ASSERT_TRUE(NULL != first);
+    ASSERT_TRUE(NULL != second);
+    EXPECT_EQ(OC_STACK_OK, OCRegisterProcessEvent(first));
+    EXPECT_EQ(OC_STACK_OK, OCRegisterProcessEvent(second));
+    OCUnregisterProcessEvent(first);
+
+    struct sockaddr_in server;
+    memset(&server, 0, sizeof(server));
+    server.sin_family = AF_INET;
+    server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CAEndpoint_t *info = NULL;
+    size_t infoSize = 0;
+    CAGetNetworkInformation(&info, &infoSize);
+    for (size_t i = 0; i < infoSize; i++)
+    {
+        if ((CA_ADAPTER_IP == info[i].adapter) && (info[i].flags & CA_IPV4) &&
+            !(info[i].flags & CA_SECURE))
+        {
+            server.sin_port = htons(info[i].port);
+            break;
+        }
+    }
+    OICFree(info);
+    ASSERT_NE(0, server.sin_port);
+
+    // A non-confirmable GET /oic/res from a local client.
+    const uint8_t request[] = { 0x50, 0x01, 0x12, 0x34,
+                                0xB3, 'o', 'i', 'c', 0x03, 'r', 'e', 's' };
+    uint16_t clientPort = 0;
+    int fd = OpenObserverSocket(&clientPort);
+    ASSERT_LE(0, fd);
+    EXPECT_EQ((ssize_t)sizeof(request),
+              sendto(fd, request, sizeof(request), 0, (struct sockaddr *)&server, sizeof(server)));
+
+    EXPECT_EQ(OC_WAIT_SUCCESS, oc_event_wait_for(second, 2000));
+    EXPECT_EQ(OC_WAIT_TIMEDOUT, oc_event_wait_for(first, 0));
+
+    OCUnregisterProcessEvent(second);
+    close(fd);
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+    oc_event_free(first);
+    oc_event_free(second);
+}
+#endif
+
 TEST(StackPayload, CloneByteString)
 {
     uint8_t bytes[] = { 0, 1, 2, 3 };
@@ -403,7 +403,7 @@ FILE* server_fopen(const char* path, const char* mode)
 int main(int /*argc*/, char** /*argv[]*/)
 {
     // Create persistent storage handlers
-    OCPersistentStorage ps{server_fopen, fread, fwrite, fclose, unlink};
+    OCPersistentStorage ps{server_fopen, fread, fwrite, fclose, unlink, true};
     // Create PlatformConfig object
     PlatformConfig cfg {
         OC::ServiceType::InProc,
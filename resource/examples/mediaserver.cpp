@@ -525,16 +525,28 @@ void PrintUsage()
     cout << "    4 - Non-secure resource, GET slow response, notify all observers\n";
 }
 
-static FILE* client_open(const char* path, const char* mode)
+/**
+ * Map the security database, and the journal and commit files named after it,
+ * onto "./oic_svr_db_server.dat".
+ */
+static std::string client_path(const char *path)
 {
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
-    {
-        return fopen("./oic_svr_db_server.dat", mode);
-    }
-    else
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    if (0 == strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
     {
-        return fopen(path, mode);
+        return std::string("./oic_svr_db_server.dat") + (path + dbNameLen);
     }
+    return path;
+}
+
+static FILE* client_open(const char* path, const char* mode)
+{
+    return fopen(client_path(path).c_str(), mode);
+}
+
+static int client_unlink(const char *path)
+{
+    return unlink(client_path(path).c_str());
 }
 
 void playPause()
@@ -618,7 +630,7 @@ void setVolume(int vol)
 
 int main(int argc, char* argv[])
 {
-    OCPersistentStorage ps {client_open, fread, fwrite, fclose, unlink };
+    OCPersistentStorage ps {client_open, fread, fwrite, fclose, client_unlink, true };
 
     if (argc == 1)
     {
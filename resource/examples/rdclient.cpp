@@ -218,16 +218,28 @@ static void printUsage()
     std::cout<<"Usage: rdserver <coap+tcp://10.11.12.13:5683>\n";
 }
 
-static FILE* client_open(const char* path, const char* mode)
+/**
+ * Map the security database, and the journal and commit files named after it,
+ * onto SVR_DB_FILE_NAME.
+ */
+static std::string client_path(const char *path)
 {
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
-    {
-        return fopen(SVR_DB_FILE_NAME, mode);
-    }
-    else
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    if (0 == strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
     {
-        return fopen(path, mode);
+        return std::string(SVR_DB_FILE_NAME) + (path + dbNameLen);
     }
+    return path;
+}
+
+static FILE* client_open(const char* path, const char* mode)
+{
+    return fopen(client_path(path).c_str(), mode);
+}
+
+static int client_unlink(const char *path)
+{
+    return unlink(client_path(path).c_str());
 }
 
 int main(int argc, char* argv[])
@@ -244,7 +256,7 @@ int main(int argc, char* argv[])
         return -1;
     }
 
-    OCPersistentStorage ps {client_open, fread, fwrite, fclose, unlink };
+    OCPersistentStorage ps {client_open, fread, fwrite, fclose, client_unlink, true };
     PlatformConfig config
     { OC::ServiceType::InProc, ModeType::Both, &ps};
 
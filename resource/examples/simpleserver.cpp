@@ -617,24 +617,38 @@ void PrintUsage()
     std::cout << "    4 - Non-secure resource, GET slow response, notify all observers\n";
 }
 
-static FILE* client_open(const char* path, const char* mode)
+/**
+ * Map the security database, and the journal and commit files named after it,
+ * onto SVR_DB_FILE_NAME, and the introspection file onto its sample data.
+ */
+static std::string client_path(const char *path)
 {
-    char const * filename = path;
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    if (0 == strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
     {
-        filename = SVR_DB_FILE_NAME;
+        return std::string(SVR_DB_FILE_NAME) + (path + dbNameLen);
     }
     else if (0 == strcmp(path, OC_INTROSPECTION_FILE_NAME))
     {
-        filename = "light_introspection.json";
+        return "light_introspection.json";
     }
-    return fopen(filename, mode);
+    return path;
+}
+
+static FILE* client_open(const char* path, const char* mode)
+{
+    return fopen(client_path(path).c_str(), mode);
+}
+
+static int client_unlink(const char *path)
+{
+    return unlink(client_path(path).c_str());
 }
 
 int main(int argc, char* argv[])
 {
     PrintUsage();
-    OCPersistentStorage ps {client_open, fread, fwrite, fclose, unlink };
+    OCPersistentStorage ps {client_open, fread, fwrite, fclose, client_unlink, true };
 
     if (argc == 1)
     {
@@ -47,16 +47,28 @@ HWND WINAPI CreateTrackbar(HWND parent, int x, int y, int w, int h,UINT iMin, UI
 HWND WINAPI CreateLabel(HWND parent, LPCTSTR lpText, int x, int y, int w, int h);
 HWND WINAPI CreateButton(HWND parent, UINT_PTR id, LPCTSTR caption, int x, int y, int w, int h);
 
-FILE* client_open(const char* path, const char* mode)
+/**
+ * Map the security database, and the journal and commit files named after it,
+ * onto "./oic_svr_db_client.dat".
+ */
+static std::string client_path(const char *path)
 {
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
-    {
-        return fopen("./oic_svr_db_client.dat", mode);
-    }
-    else
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    if (0 == strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
     {
-        return fopen(path, mode);
+        return std::string("./oic_svr_db_client.dat") + (path + dbNameLen);
     }
+    return path;
+}
+
+FILE* client_open(const char* path, const char* mode)
+{
+    return fopen(client_path(path).c_str(), mode);
+}
+
+int client_unlink(const char *path)
+{
+    return unlink(client_path(path).c_str());
 }
 
 int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE /* hPrevInstance */,
@@ -183,7 +195,7 @@ WndProc( HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam )
               GetClientRect(hwnd, &rect);
               g_BkgndBrush = GetSysColorBrush(COLOR_MENU);
 
-              OCPersistentStorage ps = {client_open, fread, fwrite, fclose, unlink };
+              OCPersistentStorage ps = {client_open, fread, fwrite, fclose, client_unlink, true };
               app = new WinUIClient::WinUIClientApp(ps);
               if (app->Initialize())
               {
@@ -0,0 +1,112 @@
+//******************************************************************
+//
+// Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifndef OC_CALLBACK_EXECUTOR_H_
+#define OC_CALLBACK_EXECUTOR_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <OCApi.h>
+
+namespace OC
+{
+    /**
+     * Bounded thread pool which runs application callbacks away from the thread
+     * calling OCProcess. Threads are started on demand, up to the configured limit.
+     */
+    class CallbackExecutor
+    {
+    public:
+        typedef std::function<void()> Task;
+
+        CallbackExecutor(const CallbackExecutorConfig& config);
+        ~CallbackExecutor();
+
+        CallbackExecutor(const CallbackExecutor&) = delete;
+        CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+        /**
+         * Queue a callback.
+         *
+         * @param task          Callback to run.
+         * @param orderingKey   Callbacks posted with the same non-null key run one at a
+         *                      time, in the order they were posted.
+         * @param droppable     Whether the overflow policy may discard this callback.
+         *                      Responses which must be delivered are never droppable.
+         *
+         * @return false if the callback was discarded or the executor is stopped.
+         */
+        bool post(Task task, const void* orderingKey = nullptr, bool droppable = false);
+
+        /**
+         * Run every callback still queued, then stop the threads. Later calls to
+         * post() are rejected. Must not be called from one of the callbacks.
+         */
+        void stop();
+
+        CallbackExecutorStats getStats() const;
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct Item
+        {
+            Task task;
+            Clock::time_point queued;
+            bool droppable;
+        };
+
+        /** Entry of the run queue: either a task or the key of a lane with work. */
+        struct Ready
+        {
+            const void* key;
+            Item item;
+        };
+
+        void workerFunc();
+
+        const CallbackExecutorConfig m_config;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::deque<Ready> m_ready;
+        // A lane exists while its key is in m_ready or one of its callbacks is running.
+        std::unordered_map<const void*, std::deque<Item>> m_lanes;
+        std::vector<std::thread> m_threads;
+        size_t m_idleThreads;
+        bool m_stopped;
+
+        size_t m_pending;
+        size_t m_maxPending;
+        uint64_t m_executed;
+        uint64_t m_dropped;
+        uint64_t m_totalLatencyUs;
+        uint64_t m_maxLatencyUs;
+    };
+}
+
+#endif // OC_CALLBACK_EXECUTOR_H_
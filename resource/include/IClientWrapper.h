@@ -134,6 +134,8 @@ namespace OC
 
         virtual OCStackResult GetDefaultQos(QualityOfService& qos) = 0;
 
+        virtual OCStackResult GetCallbackExecutorStats(CallbackExecutorStats& stats) = 0;
+
 #ifdef WITH_MQ
         virtual OCStackResult ListenForMQTopic(
             const OCDevAddr& devAddr,
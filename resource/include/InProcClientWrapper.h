@@ -30,6 +30,8 @@
 #include <IClientWrapper.h>
 #include <InitializeException.h>
 #include <ResourceInitException.h>
+#include <CallbackExecutor.h>
+#include <ocevent.h>
 
 namespace OC
 {
@@ -38,22 +40,32 @@ namespace OC
         struct GetContext
         {
             GetCallback callback;
-            GetContext(GetCallback cb) : callback(cb){}
+            std::shared_ptr<CallbackExecutor> executor;
+            /** responses arrive as undecoded CBOR, see OCSetRawResponsePayload(). */
+            bool rawPayload;
+            GetContext(GetCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex), rawPayload(false){}
         };
 
         struct SetContext
         {
             PutCallback callback;
-            SetContext(PutCallback cb) : callback(cb){}
+            std::shared_ptr<CallbackExecutor> executor;
+            /** responses arrive as undecoded CBOR, see OCSetRawResponsePayload(). */
+            bool rawPayload;
+            SetContext(PutCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex), rawPayload(false){}
         };
 
         struct ListenContext
         {
             FindCallback callback;
             std::weak_ptr<IClientWrapper> clientWrapper;
+            std::shared_ptr<CallbackExecutor> executor;
 
-            ListenContext(FindCallback cb, std::weak_ptr<IClientWrapper> cw)
-                : callback(cb), clientWrapper(cw){}
+            ListenContext(FindCallback cb, std::weak_ptr<IClientWrapper> cw,
+                          std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), clientWrapper(cw), executor(ex){}
         };
 
         struct ListenErrorContext
@@ -61,19 +73,23 @@ namespace OC
             FindCallback callback;
             FindErrorCallback errorCallback;
             std::weak_ptr<IClientWrapper> clientWrapper;
+            std::shared_ptr<CallbackExecutor> executor;
 
             ListenErrorContext(FindCallback cb1, FindErrorCallback cb2,
-                               std::weak_ptr<IClientWrapper> cw)
-                : callback(cb1), errorCallback(cb2), clientWrapper(cw){}
+                               std::weak_ptr<IClientWrapper> cw,
+                               std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb1), errorCallback(cb2), clientWrapper(cw), executor(ex){}
         };
 
         struct ListenResListContext
         {
             FindResListCallback callback;
             std::weak_ptr<IClientWrapper> clientWrapper;
+            std::shared_ptr<CallbackExecutor> executor;
 
-            ListenResListContext(FindResListCallback cb, std::weak_ptr<IClientWrapper> cw)
-                : callback(cb), clientWrapper(cw){}
+            ListenResListContext(FindResListCallback cb, std::weak_ptr<IClientWrapper> cw,
+                                 std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), clientWrapper(cw), executor(ex){}
         };
 
         struct ListenResListWithErrorContext
@@ -81,36 +97,48 @@ namespace OC
             FindResListCallback callback;
             FindErrorCallback errorCallback;
             std::weak_ptr<IClientWrapper> clientWrapper;
+            std::shared_ptr<CallbackExecutor> executor;
 
             ListenResListWithErrorContext(FindResListCallback cb1, FindErrorCallback cb2,
-                               std::weak_ptr<IClientWrapper> cw)
-                : callback(cb1), errorCallback(cb2), clientWrapper(cw){}
+                               std::weak_ptr<IClientWrapper> cw,
+                               std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb1), errorCallback(cb2), clientWrapper(cw), executor(ex){}
         };
 
         struct DeviceListenContext
         {
             FindDeviceCallback callback;
             IClientWrapper::Ptr clientWrapper;
-            DeviceListenContext(FindDeviceCallback cb, IClientWrapper::Ptr cw)
-                    : callback(cb), clientWrapper(cw){}
+            std::shared_ptr<CallbackExecutor> executor;
+            DeviceListenContext(FindDeviceCallback cb, IClientWrapper::Ptr cw,
+                                std::shared_ptr<CallbackExecutor> ex)
+                    : callback(cb), clientWrapper(cw), executor(ex){}
         };
 
         struct SubscribePresenceContext
         {
             SubscribeCallback callback;
-            SubscribePresenceContext(SubscribeCallback cb) : callback(cb){}
+            std::shared_ptr<CallbackExecutor> executor;
+            SubscribePresenceContext(SubscribeCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
 
         struct DeleteContext
         {
             DeleteCallback callback;
-            DeleteContext(DeleteCallback cb) : callback(cb){}
+            std::shared_ptr<CallbackExecutor> executor;
+            DeleteContext(DeleteCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex){}
         };
 
         struct ObserveContext
         {
             ObserveCallback callback;
-            ObserveContext(ObserveCallback cb) : callback(cb){}
+            std::shared_ptr<CallbackExecutor> executor;
+            /** responses arrive as undecoded CBOR, see OCSetRawResponsePayload(). */
+            bool rawPayload;
+            ObserveContext(ObserveCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), executor(ex), rawPayload(false){}
         };
 
 #ifdef WITH_MQ
@@ -118,8 +146,10 @@ namespace OC
         {
             MQTopicCallback callback;
             std::weak_ptr<IClientWrapper> clientWrapper;
-            MQTopicContext(MQTopicCallback cb, std::weak_ptr<IClientWrapper> cw)
-                : callback(cb), clientWrapper(cw){}
+            std::shared_ptr<CallbackExecutor> executor;
+            MQTopicContext(MQTopicCallback cb, std::weak_ptr<IClientWrapper> cw,
+                           std::shared_ptr<CallbackExecutor> ex)
+                : callback(cb), clientWrapper(cw), executor(ex){}
         };
 #endif
     }
@@ -213,6 +243,8 @@ namespace OC
 
         OCStackResult GetDefaultQos(QualityOfService& QoS);
 
+        virtual OCStackResult GetCallbackExecutorStats(CallbackExecutorStats& stats);
+
 #ifdef WITH_MQ
         virtual OCStackResult ListenForMQTopic(
             const OCDevAddr& devAddr,
@@ -236,14 +268,17 @@ namespace OC
         std::string assembleSetResourceUri(std::string uri, const QueryParamsMap& queryParams);
         std::string assembleSetResourceUri(std::string uri, const QueryParamsList& queryParams);
         OCPayload* assembleSetResourcePayload(const OCRepresentation& attributes);
+        bool useDirectCbor(OCDoHandle handle);
         OCHeaderOption* assembleHeaderOptions(OCHeaderOption options[],
            const HeaderOptions& headerOptions);
         std::thread m_listeningThread;
         bool m_threadRun;
+        oc_event m_processEvent;
         std::weak_ptr<std::recursive_mutex> m_csdkLock;
 
     private:
         PlatformConfig  m_cfg;
+        std::shared_ptr<CallbackExecutor> m_executor;
     };
 }
 
@@ -25,6 +25,7 @@
 #include <mutex>
 
 #include <IServerWrapper.h>
+#include <ocevent.h>
 
 namespace OC
 {
@@ -94,6 +95,7 @@ namespace OC
         void processFunc();
         std::thread m_processThread;
         bool m_threadRun;
+        oc_event m_processEvent;
         std::weak_ptr<std::recursive_mutex> m_csdkLock;
         PlatformConfig  m_cfg;
     };
@@ -131,6 +131,67 @@ namespace OC
         NaQos       = OC_NA_QOS
     };
 
+    /**
+     * What the client callback executor does with an observe notification that
+     * arrives while its queue is full. Other callbacks are never dropped.
+     */
+    enum class CallbackOverflowPolicy
+    {
+        /** Discard the notification that just arrived. */
+        DropNewest,
+
+        /**
+         * Discard the oldest notification still queued for the same observation, or the
+         * new one if only errors and final responses are queued for it.
+         */
+        DropOldest
+    };
+
+    /**
+     * Configuration of the thread pool which runs client callbacks.
+     */
+    struct CallbackExecutorConfig
+    {
+        /** maximum number of threads running application callbacks. */
+        unsigned int               threadCount;
+
+        /** queued callbacks beyond which notifications are dropped, 0 for no limit. */
+        size_t                     maxQueueSize;
+
+        /** which notification to drop once maxQueueSize is reached. */
+        CallbackOverflowPolicy     overflowPolicy;
+
+        CallbackExecutorConfig()
+            : threadCount(4),
+            maxQueueSize(1024),
+            overflowPolicy(CallbackOverflowPolicy::DropOldest)
+        {}
+    };
+
+    /**
+     * Counters of the client callback executor.
+     */
+    struct CallbackExecutorStats
+    {
+        /** callbacks waiting for a thread. */
+        size_t                     queueDepth;
+
+        /** highest queueDepth seen so far. */
+        size_t                     maxQueueDepth;
+
+        /** callbacks run so far. */
+        uint64_t                   executed;
+
+        /** notifications discarded by the overflow policy. */
+        uint64_t                   dropped;
+
+        /** mean time in microseconds between a callback being queued and starting to run. */
+        uint64_t                   averageLatencyUs;
+
+        /** longest such time in microseconds. */
+        uint64_t                   maxLatencyUs;
+    };
+
     /**
      *  Data structure to provide the configuration.
      */
@@ -175,6 +236,15 @@ namespace OC
          */
         bool                       useLegacyCleanup;
 
+        /** threads, queue limit and drop policy used to deliver client callbacks. */
+        CallbackExecutorConfig     callbackExecutor;
+
+        /**
+         * Decode and encode representations straight from and to CBOR instead of
+         * going through OCRepPayload. Off by default.
+         */
+        bool                       directCborCodec;
+
         public:
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -188,7 +258,8 @@ namespace OC
                 port(0),
                 QoS(QualityOfService::NaQos),
                 ps(ps_),
-                useLegacyCleanup(false)
+                useLegacyCleanup(false),
+                directCborCodec(false)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig()
@@ -201,7 +272,8 @@ namespace OC
                 port(0),
                 QoS(QualityOfService::NaQos),
                 ps(nullptr),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                directCborCodec(false)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig(const ServiceType serviceType_,
@@ -219,7 +291,8 @@ namespace OC
                 port(0),
                 QoS(QoS_),
                 ps(ps_),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                directCborCodec(false)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig(const ServiceType serviceType_,
@@ -237,7 +310,8 @@ namespace OC
                 port(port_),
                 QoS(QoS_),
                 ps(ps_),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                directCborCodec(false)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig(const ServiceType serviceType_,
@@ -255,7 +329,8 @@ namespace OC
                 ipAddress(ipAddress_),
                 port(port_),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                directCborCodec(false)
         {}
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -271,7 +346,8 @@ namespace OC
                 port(0),
                 QoS(QoS_),
                 ps(ps_),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                directCborCodec(false)
         {}
             /* @deprecated: Use a non deprecated constructor. */
             PlatformConfig(const ServiceType serviceType_,
@@ -290,7 +366,8 @@ namespace OC
                 port(0),
                 QoS(QoS_),
                 ps(ps_),
-                useLegacyCleanup(true)
+                useLegacyCleanup(true),
+                directCborCodec(false)
         {}
 
     };
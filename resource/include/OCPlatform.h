@@ -288,6 +288,17 @@ namespace OC
          */
         OCStackResult getSupportedTransportsInfo(OCTpsSchemeFlags& supportedTps);
 
+        /**
+         * This function returns the counters of the thread pool delivering client
+         * callbacks, configured through PlatformConfig::callbackExecutor.
+         * @note This API applies to client side only.
+         *
+         * @param[out] stats Queue depth, drop count and callback latency.
+         *
+         * @return Returns ::OC_STACK_OK if success.
+         */
+        OCStackResult getCallbackExecutorStats(CallbackExecutorStats& stats);
+
         /**
         * This API registers a resource with the server
         * @note This API applies to server side only.
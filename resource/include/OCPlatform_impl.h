@@ -163,6 +163,8 @@ namespace OC
          */
         OCStackResult getSupportedTransportsInfo(OCTpsSchemeFlags& supportedTps);
 
+        OCStackResult getCallbackExecutorStats(CallbackExecutorStats& stats);
+
         /**
         * This API registers a resource with the server
         * @note This API applies to server side only.
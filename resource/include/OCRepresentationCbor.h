@@ -0,0 +1,72 @@
+//******************************************************************
+//
+// Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of the functions which convert between
+ * CBOR representation payloads and OCRepresentation without building an
+ * OCRepPayload in between.
+ */
+
+#ifndef OC_REPRESENTATION_CBOR_H_
+#define OC_REPRESENTATION_CBOR_H_
+
+#include <vector>
+
+#include <OCRepresentation.h>
+
+namespace OC
+{
+    namespace RepresentationCbor
+    {
+        /**
+         * Decodes a representation payload. The result is the one OCParsePayload
+         * followed by MessageContainer::setPayload gives: the first representation
+         * is the root, any others are its children.
+         *
+         * Some payloads are left to OCParsePayload: arrays of byte strings, arrays
+         * whose elements are not all nested to the same depth, and values of a type
+         * OCRepPayload has no room for.
+         *
+         * @param payload   CBOR encoded representation.
+         * @param size      Size of the payload.
+         * @param reps      Receives the decoded representations.
+         *
+         * @return true if decoded, false if the caller has to use OCParsePayload,
+         *         which is also the case for a malformed payload.
+         */
+        bool decode(const uint8_t* payload, size_t size, std::vector<OCRepresentation>& reps);
+
+        /**
+         * Encodes representations byte for byte as OCConvertPayload encodes the
+         * OCRepPayload MessageContainer::getPayload builds from them.
+         *
+         * @param reps      Root representation followed by its children.
+         * @param payload   Receives the CBOR encoded payload.
+         *
+         * @return ::OC_STACK_OK on success, some other value upon failure.
+         */
+        OCStackResult encode(const std::vector<OCRepresentation>& reps,
+                             std::vector<uint8_t>& payload);
+    }
+}
+
+#endif // OC_REPRESENTATION_CBOR_H_
@@ -189,9 +189,9 @@ namespace OC
     private:
         friend class InProcServerWrapper;
 
-        OCRepPayload* getPayload() const
+        std::vector<OCRepresentation> getRepresentations() const
         {
-            MessageContainer inf;
+            std::vector<OCRepresentation> reps;
             OCRepresentation first(m_representation);
 
             if(m_interface==LINK_INTERFACE)
@@ -207,7 +207,7 @@ namespace OC
                 first.setInterfaceType(InterfaceType::DefaultParent);
             }
 
-            inf.addRepresentation(first);
+            reps.push_back(first);
 
             for(const OCRepresentation& rep : m_representation.getChildren())
             {
@@ -226,8 +226,19 @@ namespace OC
                     cur.setInterfaceType(InterfaceType::DefaultChild);
                 }
 
-                inf.addRepresentation(cur);
+                reps.push_back(cur);
+
+            }
+
+            return reps;
+        }
 
+        OCRepPayload* getPayload() const
+        {
+            MessageContainer inf;
+            for(const OCRepresentation& rep : getRepresentations())
+            {
+                inf.addRepresentation(rep);
             }
 
             return inf.getPayload();
@@ -161,6 +161,9 @@ namespace OC
         virtual OCStackResult GetDefaultQos(QualityOfService& /*QoS*/)
             {return OC_STACK_NOTIMPL;}
 
+        virtual OCStackResult GetCallbackExecutorStats(CallbackExecutorStats& /*stats*/)
+            {return OC_STACK_NOTIMPL;}
+
 #ifdef WITH_MQ
         virtual OCStackResult ListenForMQTopic(const OCDevAddr& /*devAddr*/,
                                                const std::string& /*resourceUri*/,
@@ -69,16 +69,28 @@ DeviceList_t pUnownedDevList, pOwnedDevList, pMOTEnabledDeviceList;
 static int transferDevIdx, ask = 1;
 static uint16_t g_credId = 0;
 
-static FILE* client_open(const char *path, const char *mode)
+/**
+ * Map the security database, and the journal and commit files named after it,
+ * onto DAT_DB_PATH.
+ */
+static std::string client_path(const char *path)
 {
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    if (0 == strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
     {
-        return fopen(DAT_DB_PATH, mode);
-    }
-    else
-    {
-        return fopen(path, mode);
+        return std::string(DAT_DB_PATH) + (path + dbNameLen);
     }
+    return path;
+}
+
+static FILE* client_open(const char *path, const char *mode)
+{
+    return fopen(client_path(path).c_str(), mode);
+}
+
+static int client_unlink(const char *path)
+{
+    return unlink(client_path(path).c_str());
 }
 
 void printMenu()
@@ -738,7 +750,7 @@ void MOTMethodCB(PMResultList_t *result, int hasError)
 int main(void)
 {
     OCStackResult result;
-    OCPersistentStorage ps {client_open, fread, fwrite, fclose, unlink };
+    OCPersistentStorage ps {client_open, fread, fwrite, fclose, client_unlink, true };
 
     // Create PlatformConfig object
     PlatformConfig cfg {
@@ -63,16 +63,28 @@ using namespace OC;
 DeviceList_t pMOwnedDeviceList, pMOTEnabledDeviceList;
 static int transferDevIdx, ask = 1;
 
-static FILE* client_open(const char *path, const char *mode)
+/**
+ * Map the security database, and the journal and commit files named after it,
+ * onto DAT_DB_PATH.
+ */
+static std::string client_path(const char *path)
 {
-    if (0 == strcmp(path, OC_SECURITY_DB_DAT_FILE_NAME))
-    {
-        return fopen(DAT_DB_PATH, mode);
-    }
-    else
+    size_t dbNameLen = strlen(OC_SECURITY_DB_DAT_FILE_NAME);
+    if (0 == strncmp(path, OC_SECURITY_DB_DAT_FILE_NAME, dbNameLen))
     {
-        return fopen(path, mode);
+        return std::string(DAT_DB_PATH) + (path + dbNameLen);
     }
+    return path;
+}
+
+static FILE* client_open(const char *path, const char *mode)
+{
+    return fopen(client_path(path).c_str(), mode);
+}
+
+static int client_unlink(const char *path)
+{
+    return unlink(client_path(path).c_str());
 }
 
 void printMenu()
@@ -196,7 +208,7 @@ int main(void)
 {
     InputPinCallbackHandle callbackHandle = nullptr;
 
-    OCPersistentStorage ps {client_open, fread, fwrite, fclose, unlink };
+    OCPersistentStorage ps {client_open, fread, fwrite, fclose, client_unlink, true };
 
     // Create PlatformConfig object
     PlatformConfig cfg {
@@ -0,0 +1,211 @@
+//******************************************************************
+//
+// Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "CallbackExecutor.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "experimental/logger.h"
+
+#define TAG "OIC_CALLBACK_EXECUTOR"
+
+namespace OC
+{
+    CallbackExecutor::CallbackExecutor(const CallbackExecutorConfig& config)
+        : m_config(config), m_idleThreads(0), m_stopped(false), m_pending(0),
+          m_maxPending(0), m_executed(0), m_dropped(0), m_totalLatencyUs(0),
+          m_maxLatencyUs(0)
+    {
+    }
+
+    CallbackExecutor::~CallbackExecutor()
+    {
+        stop();
+    }
+
+    bool CallbackExecutor::post(Task task, const void* orderingKey, bool droppable)
+    {
+        if (!task)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopped)
+        {
+            OIC_LOG(ERROR, TAG, "callback posted after stop, dropping it");
+            return false;
+        }
+
+        auto lane = orderingKey ? m_lanes.find(orderingKey) : m_lanes.end();
+
+        if (droppable && m_config.maxQueueSize && m_pending >= m_config.maxQueueSize)
+        {
+            if (CallbackOverflowPolicy::DropOldest != m_config.overflowPolicy ||
+                m_lanes.end() == lane)
+            {
+                m_dropped++;
+                return false;
+            }
+
+            // Replace the oldest notification still waiting in this observation's lane.
+            // Errors and final responses queued in the same lane are kept.
+            auto oldest = std::find_if(lane->second.begin(), lane->second.end(),
+                                       [](const Item& queued) { return queued.droppable; });
+            m_dropped++;
+            if (lane->second.end() == oldest)
+            {
+                return false;
+            }
+            lane->second.erase(oldest);
+            m_pending--;
+        }
+
+        Item item { std::move(task), Clock::now(), droppable };
+        if (m_lanes.end() != lane)
+        {
+            lane->second.push_back(std::move(item));
+        }
+        else if (orderingKey)
+        {
+            m_lanes[orderingKey].push_back(std::move(item));
+            m_ready.push_back(Ready { orderingKey, Item() });
+        }
+        else
+        {
+            m_ready.push_back(Ready { nullptr, std::move(item) });
+        }
+
+        m_pending++;
+        if (m_pending > m_maxPending)
+        {
+            m_maxPending = m_pending;
+        }
+
+        if (0 == m_idleThreads &&
+            (m_threads.empty() || m_threads.size() < m_config.threadCount))
+        {
+            m_threads.push_back(std::thread(&CallbackExecutor::workerFunc, this));
+        }
+        else
+        {
+            m_cond.notify_one();
+        }
+        return true;
+    }
+
+    void CallbackExecutor::stop()
+    {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopped = true;
+            threads.swap(m_threads);
+        }
+        m_cond.notify_all();
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    CallbackExecutorStats CallbackExecutor::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        CallbackExecutorStats stats;
+        stats.queueDepth = m_pending;
+        stats.maxQueueDepth = m_maxPending;
+        stats.executed = m_executed;
+        stats.dropped = m_dropped;
+        stats.averageLatencyUs = m_executed ? (m_totalLatencyUs / m_executed) : 0;
+        stats.maxLatencyUs = m_maxLatencyUs;
+        return stats;
+    }
+
+    void CallbackExecutor::workerFunc()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            m_idleThreads++;
+            m_cond.wait(lock, [this] { return m_stopped || !m_ready.empty(); });
+            m_idleThreads--;
+
+            // Queued callbacks are still delivered when stopping.
+            if (m_ready.empty())
+            {
+                break;
+            }
+
+            Ready ready = std::move(m_ready.front());
+            m_ready.pop_front();
+
+            Item item;
+            if (ready.key)
+            {
+                std::deque<Item>& lane = m_lanes[ready.key];
+                item = std::move(lane.front());
+                lane.pop_front();
+            }
+            else
+            {
+                item = std::move(ready.item);
+            }
+
+            m_pending--;
+            uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                    Clock::now() - item.queued).count();
+            m_totalLatencyUs += latency;
+            if (latency > m_maxLatencyUs)
+            {
+                m_maxLatencyUs = latency;
+            }
+
+            lock.unlock();
+            try
+            {
+                item.task();
+            }
+            catch (std::exception& e)
+            {
+                OIC_LOG_V(ERROR, TAG, "callback threw: %s", e.what());
+            }
+            lock.lock();
+
+            m_executed++;
+            if (ready.key)
+            {
+                auto lane = m_lanes.find(ready.key);
+                if (lane->second.empty())
+                {
+                    m_lanes.erase(lane);
+                }
+                else
+                {
+                    m_ready.push_back(Ready { ready.key, Item() });
+                    m_cond.notify_one();
+                }
+            }
+        }
+    }
+}
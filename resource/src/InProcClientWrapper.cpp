@@ -26,6 +26,8 @@
 #include "OCPlatform.h"
 #include "OCResource.h"
 #include "ocpayload.h"
+#include "ocpayloadcbor.h"
+#include "OCRepresentationCbor.h"
 #include <OCSerialization.h>
 #include "experimental/logger.h"
 
@@ -37,8 +39,9 @@ namespace OC
 {
     InProcClientWrapper::InProcClientWrapper(
         std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
-            : m_threadRun(false), m_csdkLock(csdkLock),
-              m_cfg { cfg }
+            : m_threadRun(false), m_processEvent(nullptr), m_csdkLock(csdkLock),
+              m_cfg { cfg },
+              m_executor(std::make_shared<CallbackExecutor>(cfg.callbackExecutor))
     {
         // if the config type is server, we ought to never get called.  If the config type
         // is both, we count on the server to run the thread and do the initialize
@@ -55,6 +58,10 @@ namespace OC
         {
             oclog() << "Exception in stop"<< e.what() << std::flush;
         }
+
+        // Deliver what is already queued; contexts still held by the stack only
+        // keep the executor object alive, not its threads.
+        m_executor->stop();
     }
 
     OCStackResult InProcClientWrapper::start()
@@ -65,6 +72,16 @@ namespace OC
         {
             if (false == m_threadRun)
             {
+                m_processEvent = oc_event_new();
+                if (!m_processEvent)
+                {
+                    return OC_STACK_NO_MEMORY;
+                }
+                if (OC_STACK_OK != OCRegisterProcessEvent(m_processEvent))
+                {
+                    OIC_LOG(WARNING, TAG, "process event not registered, falling back to polling");
+                }
+
                 m_threadRun = true;
                 m_listeningThread = std::thread(&InProcClientWrapper::listeningFunc, this);
             }
@@ -79,7 +96,12 @@ namespace OC
         if (m_threadRun && m_listeningThread.joinable())
         {
             m_threadRun = false;
+            oc_event_signal(m_processEvent);
             m_listeningThread.join();
+
+            OCUnregisterProcessEvent(m_processEvent);
+            oc_event_free(m_processEvent);
+            m_processEvent = nullptr;
         }
         return OC_STACK_OK;
     }
@@ -89,11 +111,12 @@ namespace OC
         while(m_threadRun)
         {
             OCStackResult result;
+            uint32_t nextEventTime = 10;
             auto cLock = m_csdkLock.lock();
             if (cLock)
             {
                 std::lock_guard<std::recursive_mutex> lock(*cLock);
-                result = OCProcess();
+                result = OCProcessEvent(&nextEventTime);
             }
             else
             {
@@ -105,13 +128,65 @@ namespace OC
                 // TODO: do something with result if failed?
             }
 
-            // To minimize CPU utilization we may wish to do this with sleep
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Sleep until a message arrives or the next stack timer is due.
+            oc_event_wait_for(m_processEvent, nextEventTime);
+        }
+    }
+
+    std::vector<OCRepresentation> parseRawPayload(const OCSecurityPayload* payload)
+    {
+        std::vector<OCRepresentation> reps;
+        if (RepresentationCbor::decode(payload->securityData, payload->payloadSize, reps))
+        {
+            return reps;
+        }
+
+        // Whatever the direct decoder leaves out goes through OCRepPayload as before.
+        OCPayload* parsed = nullptr;
+        if (OC_STACK_OK != OCParsePayload(&parsed, OC_FORMAT_CBOR, PAYLOAD_TYPE_REPRESENTATION,
+                                          payload->securityData, payload->payloadSize))
+        {
+            throw OCException(OC::Exception::MALFORMED_STACK_RESPONSE,
+                              OC_STACK_MALFORMED_RESPONSE);
+        }
+
+        MessageContainer oc;
+        try
+        {
+            oc.setPayload(parsed);
+        }
+        catch (...)
+        {
+            OCPayloadDestroy(parsed);
+            throw;
         }
+        OCPayloadDestroy(parsed);
+        return oc.representations();
     }
 
-    OCRepresentation parseGetSetCallback(OCClientResponse* clientResponse)
+    OCRepresentation parseGetSetCallback(OCClientResponse* clientResponse,
+                                         bool rawPayload = false)
     {
+        if (rawPayload && clientResponse->payload &&
+            clientResponse->payload->type == PAYLOAD_TYPE_SECURITY)
+        {
+            std::vector<OCRepresentation> reps =
+                parseRawPayload(reinterpret_cast<OCSecurityPayload*>(clientResponse->payload));
+            if (reps.empty())
+            {
+                return OCRepresentation();
+            }
+
+            OCRepresentation root = std::move(reps[0]);
+            root.setDevAddr(clientResponse->devAddr);
+            root.setUri(clientResponse->resourceUri);
+            for (size_t i = 1; i < reps.size(); ++i)
+            {
+                root.addChild(reps[i]);
+            }
+            return root;
+        }
+
         if (clientResponse->payload == nullptr ||
                 (
                     clientResponse->payload->type != PAYLOAD_TYPE_REPRESENTATION
@@ -215,8 +290,7 @@ namespace OC
 
             for(auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                context->executor->post(std::bind(context->callback, resource));
             }
         }
         catch (std::exception &e)
@@ -267,16 +341,14 @@ namespace OC
             // loop to ensure valid construction of all resources
             for (auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                context->executor->post(std::bind(context->callback, resource));
             }
             return OC_STACK_KEEP_TRANSACTION;
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
         std::string resourceURI = clientResponse->resourceUri;
-        std::thread exec(context->errorCallback, resourceURI, result);
-        exec.detach();
+        context->executor->post(std::bind(context->errorCallback, resourceURI, result));
         return OC_STACK_KEEP_TRANSACTION;
     }
 
@@ -296,7 +368,7 @@ namespace OC
         resourceUri << serviceUrl << resourceType;
 
         ClientCallbackContext::ListenContext* context =
-            new ClientCallbackContext::ListenContext(callback, shared_from_this());
+            new ClientCallbackContext::ListenContext(callback, shared_from_this(), m_executor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(context),
         cbdata.cb      = listenCallback;
@@ -338,7 +410,7 @@ namespace OC
 
         ClientCallbackContext::ListenErrorContext* context =
             new ClientCallbackContext::ListenErrorContext(callback, errorCallback,
-                                                          shared_from_this());
+                                                          shared_from_this(), m_executor);
         if (!context)
         {
             return OC_STACK_ERROR;
@@ -415,8 +487,7 @@ namespace OC
                     reinterpret_cast< OCDiscoveryPayload* >(clientResponse->payload));
 
             OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-            std::thread exec(context->callback, container.Resources());
-            exec.detach();
+            context->executor->post(std::bind(context->callback, container.Resources()));
         }
         catch (std::exception &e)
         {
@@ -443,7 +514,8 @@ namespace OC
         resourceUri << serviceUrl << resourceType;
 
         ClientCallbackContext::ListenResListContext* context =
-            new ClientCallbackContext::ListenResListContext(callback, shared_from_this());
+            new ClientCallbackContext::ListenResListContext(callback, shared_from_this(),
+                                                            m_executor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(context),
         cbdata.cb      = listenResListCallback;
@@ -487,8 +559,7 @@ namespace OC
 
             //send the error callback
             std::string uri = clientResponse->resourceUri;
-            std::thread exec(context->errorCallback, uri, result);
-            exec.detach();
+            context->executor->post(std::bind(context->errorCallback, uri, result));
             return OC_STACK_KEEP_TRANSACTION;
         }
 
@@ -517,8 +588,7 @@ namespace OC
                     reinterpret_cast< OCDiscoveryPayload* >(clientResponse->payload));
 
             OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-            std::thread exec(context->callback, container.Resources());
-            exec.detach();
+            context->executor->post(std::bind(context->callback, container.Resources()));
         }
         catch (std::exception &e)
         {
@@ -547,7 +617,7 @@ namespace OC
 
         ClientCallbackContext::ListenResListWithErrorContext* context =
             new ClientCallbackContext::ListenResListWithErrorContext(callback, errorCallback,
-                                                          shared_from_this());
+                                                          shared_from_this(), m_executor);
         if (!context)
         {
             return OC_STACK_ERROR;
@@ -596,9 +666,8 @@ namespace OC
                     << clientResponse->result
                     << std::flush;
 
-            std::thread exec(context->callback, clientResponse->result,
-                             resourceURI, nullptr);
-            exec.detach();
+            context->executor->post(std::bind(context->callback, clientResponse->result,
+                                              resourceURI, nullptr));
 
             return OC_STACK_DELETE_TRANSACTION;
         }
@@ -619,9 +688,8 @@ namespace OC
             // loop to ensure valid construction of all resources
             for (auto resource : container.Resources())
             {
-                std::thread exec(context->callback, clientResponse->result,
-                                 resourceURI, resource);
-                exec.detach();
+                context->executor->post(std::bind(context->callback, clientResponse->result,
+                                                  resourceURI, resource));
             }
         }
         catch (std::exception &e)
@@ -648,7 +716,7 @@ namespace OC
         }
 
         ClientCallbackContext::MQTopicContext* context =
-            new ClientCallbackContext::MQTopicContext(callback, shared_from_this());
+            new ClientCallbackContext::MQTopicContext(callback, shared_from_this(), m_executor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(context),
         cbdata.cb      = listenMQCallback;
@@ -692,8 +760,7 @@ namespace OC
         {
             OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
             OCRepresentation rep = parseGetSetCallback(clientResponse);
-            std::thread exec(context->callback, rep);
-            exec.detach();
+            context->executor->post(std::bind(context->callback, rep));
         }
         catch(OC::OCException& e)
         {
@@ -720,7 +787,8 @@ namespace OC
         deviceUri << serviceUrl << deviceURI;
 
         ClientCallbackContext::DeviceListenContext* context =
-            new ClientCallbackContext::DeviceListenContext(callback, shared_from_this());
+            new ClientCallbackContext::DeviceListenContext(callback, shared_from_this(),
+                                                           m_executor);
         OCCallbackData cbdata;
 
         cbdata.context = static_cast<void*>(context),
@@ -804,19 +872,17 @@ namespace OC
                                             createdUri);
                 for (auto resource : container.Resources())
                 {
-                    std::thread exec(context->callback, result,
-                                     createdUri,
-                                     resource);
-                    exec.detach();
+                    context->executor->post(std::bind(context->callback, result,
+                                                      createdUri,
+                                                      resource));
                 }
             }
             else
             {
                 OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-                std::thread exec(context->callback, result,
-                                 createdUri,
-                                 nullptr);
-                exec.detach();
+                context->executor->post(std::bind(context->callback, result,
+                                                  createdUri,
+                                                  nullptr));
             }
         }
         catch (std::exception &e)
@@ -840,7 +906,7 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::MQTopicContext* ctx =
-                new ClientCallbackContext::MQTopicContext(callback, shared_from_this());
+                new ClientCallbackContext::MQTopicContext(callback, shared_from_this(), m_executor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = createMQTopicCallback;
@@ -886,7 +952,7 @@ namespace OC
         parseServerHeaderOptions(clientResponse, serverHeaderOptions);
         try
         {
-            rep = parseGetSetCallback(clientResponse);
+            rep = parseGetSetCallback(clientResponse, context->rawPayload);
         }
         catch(OC::OCException& e)
         {
@@ -894,8 +960,7 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, rep, result);
-        exec.detach();
+        context->executor->post(std::bind(context->callback, serverHeaderOptions, rep, result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -913,7 +978,7 @@ namespace OC
 
         OCStackResult result;
         ClientCallbackContext::GetContext* ctx =
-            new ClientCallbackContext::GetContext(callback);
+            new ClientCallbackContext::GetContext(callback, m_executor);
 
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx);
@@ -929,8 +994,10 @@ namespace OC
             std::lock_guard<std::recursive_mutex> lock(*cLock);
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
+            OCDoHandle handle = nullptr;
+
             result = OCDoResource(
-                                  nullptr, OC_REST_GET,
+                                  &handle, OC_REST_GET,
                                   uri.c_str(),
                                   &devAddr, nullptr,
                                   connectivityType,
@@ -938,6 +1005,10 @@ namespace OC
                                   &cbdata,
                                   assembleHeaderOptions(options, headerOptions),
                                   (uint8_t)headerOptions.size());
+            if (OC_STACK_OK == result)
+            {
+                ctx->rawPayload = useDirectCbor(handle);
+            }
         }
         else
         {
@@ -962,7 +1033,7 @@ namespace OC
         parseServerHeaderOptions(clientResponse, serverHeaderOptions);
         try
         {
-            attrs = parseGetSetCallback(clientResponse);
+            attrs = parseGetSetCallback(clientResponse, context->rawPayload);
         }
         catch(OC::OCException& e)
         {
@@ -970,8 +1041,7 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, attrs, result);
-        exec.detach();
+        context->executor->post(std::bind(context->callback, serverHeaderOptions, attrs, result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -1056,6 +1126,19 @@ namespace OC
 
     OCPayload* InProcClientWrapper::assembleSetResourcePayload(const OCRepresentation& rep)
     {
+        if (m_cfg.directCborCodec)
+        {
+            std::vector<OCRepresentation> reps(1, rep);
+            reps.insert(reps.end(), rep.getChildren().begin(), rep.getChildren().end());
+
+            std::vector<uint8_t> cbor;
+            if (OC_STACK_OK == RepresentationCbor::encode(reps, cbor))
+            {
+                return reinterpret_cast<OCPayload*>(
+                        OCSecurityPayloadCreate(cbor.data(), cbor.size()));
+            }
+        }
+
         MessageContainer ocInfo;
         ocInfo.addRepresentation(rep);
         for(const OCRepresentation& r : rep.getChildren())
@@ -1066,6 +1149,13 @@ namespace OC
         return reinterpret_cast<OCPayload*>(ocInfo.getPayload());
     }
 
+    // Called with the stack lock held, before any response to the request is processed.
+    bool InProcClientWrapper::useDirectCbor(OCDoHandle handle)
+    {
+        return m_cfg.directCborCodec && handle &&
+               OC_STACK_OK == OCSetRawResponsePayload(handle, true);
+    }
+
     OCStackResult InProcClientWrapper::PostResourceRepresentation(
         const OCDevAddr& devAddr,
         const std::string& uri,
@@ -1080,7 +1170,8 @@ namespace OC
         }
 
         OCStackResult result;
-        ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        ClientCallbackContext::SetContext* ctx =
+            new ClientCallbackContext::SetContext(callback, m_executor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = setResourceCallback;
@@ -1096,7 +1187,9 @@ namespace OC
             std::lock_guard<std::recursive_mutex> lock(*cLock);
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
-            result = OCDoResource(nullptr, OC_REST_POST,
+            OCDoHandle handle = nullptr;
+
+            result = OCDoResource(&handle, OC_REST_POST,
                                   url.c_str(), &devAddr,
                                   assembleSetResourcePayload(rep),
                                   connectivityType,
@@ -1104,6 +1197,10 @@ namespace OC
                                   &cbdata,
                                   assembleHeaderOptions(options, headerOptions),
                                   (uint8_t)headerOptions.size());
+            if (OC_STACK_OK == result)
+            {
+                ctx->rawPayload = useDirectCbor(handle);
+            }
         }
         else
         {
@@ -1127,7 +1224,8 @@ namespace OC
         }
 
         OCStackResult result;
-        ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        ClientCallbackContext::SetContext* ctx =
+            new ClientCallbackContext::SetContext(callback, m_executor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = setResourceCallback;
@@ -1141,7 +1239,7 @@ namespace OC
         if (cLock)
         {
             std::lock_guard<std::recursive_mutex> lock(*cLock);
-            OCDoHandle handle;
+            OCDoHandle handle = nullptr;
             OCHeaderOption options[MAX_HEADER_OPTIONS];
 
             result = OCDoResource(&handle, OC_REST_PUT,
@@ -1152,6 +1250,10 @@ namespace OC
                                   &cbdata,
                                   assembleHeaderOptions(options, headerOptions),
                                   (uint8_t)headerOptions.size());
+            if (OC_STACK_OK == result)
+            {
+                ctx->rawPayload = useDirectCbor(handle);
+            }
         }
         else
         {
@@ -1173,8 +1275,8 @@ namespace OC
         parseServerHeaderOptions(clientResponse, serverHeaderOptions);
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, clientResponse->result);
-        exec.detach();
+        context->executor->post(std::bind(context->callback, serverHeaderOptions,
+                                          clientResponse->result));
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -1193,7 +1295,7 @@ namespace OC
 
         OCStackResult result;
         ClientCallbackContext::DeleteContext* ctx =
-            new ClientCallbackContext::DeleteContext(callback);
+            new ClientCallbackContext::DeleteContext(callback, m_executor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = deleteResourceCallback;
@@ -1240,7 +1342,7 @@ namespace OC
         parseServerHeaderOptions(clientResponse, serverHeaderOptions);
         try
         {
-            attrs = parseGetSetCallback(clientResponse);
+            attrs = parseGetSetCallback(clientResponse, context->rawPayload);
         }
         catch(OC::OCException& e)
         {
@@ -1248,9 +1350,11 @@ namespace OC
         }
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, serverHeaderOptions, attrs,
-                    result, sequenceNumber);
-        exec.detach();
+        // Notifications of one observation are delivered in order; under load the
+        // executor may drop them, but never the final response or an error.
+        bool droppable = (OC_STACK_OK == result) && (sequenceNumber <= MAX_SEQUENCE_NUMBER);
+        context->executor->post(std::bind(context->callback, serverHeaderOptions, attrs,
+                                          result, sequenceNumber), context, droppable);
         if (sequenceNumber == MAX_SEQUENCE_NUMBER + 1)
         {
             return OC_STACK_DELETE_TRANSACTION;
@@ -1273,7 +1377,7 @@ namespace OC
         OCStackResult result;
 
         ClientCallbackContext::ObserveContext* ctx =
-            new ClientCallbackContext::ObserveContext(callback);
+            new ClientCallbackContext::ObserveContext(callback, m_executor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = observeResourceCallback;
@@ -1307,6 +1411,10 @@ namespace OC
                                   &cbdata,
                                   assembleHeaderOptions(options, headerOptions),
                                   (uint8_t)headerOptions.size());
+            if (OC_STACK_OK == result && handle)
+            {
+                ctx->rawPayload = useDirectCbor(*handle);
+            }
         }
         else
         {
@@ -1366,10 +1474,8 @@ namespace OC
         std::string url = clientResponse->devAddr.addr;
 
         OIC_LOG_V(DEBUG, TAG, "%s: call response callback", __func__);
-        std::thread exec(context->callback, clientResponse->result,
-                    clientResponse->sequenceNumber, url);
-
-        exec.detach();
+        context->executor->post(std::bind(context->callback, clientResponse->result,
+                                          clientResponse->sequenceNumber, url), context);
 
         return OC_STACK_KEEP_TRANSACTION;
     }
@@ -1384,7 +1490,7 @@ namespace OC
         }
 
         ClientCallbackContext::SubscribePresenceContext* ctx =
-            new ClientCallbackContext::SubscribePresenceContext(presenceHandler);
+            new ClientCallbackContext::SubscribePresenceContext(presenceHandler, m_executor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = subscribePresenceCallback;
@@ -1445,7 +1551,7 @@ namespace OC
         OCStackResult result;
 
         ClientCallbackContext::ObserveContext* ctx =
-            new ClientCallbackContext::ObserveContext(callback);
+            new ClientCallbackContext::ObserveContext(callback, m_executor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = observeResourceCallback;
@@ -1484,6 +1590,12 @@ namespace OC
         return OC_STACK_OK;
     }
 
+    OCStackResult InProcClientWrapper::GetCallbackExecutorStats(CallbackExecutorStats& stats)
+    {
+        stats = m_executor->getStats();
+        return OC_STACK_OK;
+    }
+
     OCHeaderOption* InProcClientWrapper::assembleHeaderOptions(OCHeaderOption options[],
            const HeaderOptions& headerOptions)
     {
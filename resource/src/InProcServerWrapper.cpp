@@ -33,6 +33,7 @@
 #include <InitializeException.h>
 #include <OCResourceRequest.h>
 #include <OCResourceResponse.h>
+#include <OCRepresentationCbor.h>
 #include <ocstack.h>
 #include <ocpayload.h>
 
@@ -260,7 +261,7 @@ namespace OC
 {
     InProcServerWrapper::InProcServerWrapper(
         std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
-     : m_threadRun(false), m_csdkLock(csdkLock),
+     : m_threadRun(false), m_processEvent(nullptr), m_csdkLock(csdkLock),
        m_cfg { cfg }
     {
     }
@@ -271,6 +272,16 @@ namespace OC
 
         if (false == m_threadRun)
         {
+            m_processEvent = oc_event_new();
+            if (!m_processEvent)
+            {
+                return OC_STACK_NO_MEMORY;
+            }
+            if (OC_STACK_OK != OCRegisterProcessEvent(m_processEvent))
+            {
+                OIC_LOG(WARNING, TAG, "process event not registered, falling back to polling");
+            }
+
             m_threadRun = true;
             m_processThread = std::thread(&InProcServerWrapper::processFunc, this);
         }
@@ -284,7 +295,12 @@ namespace OC
         if(m_processThread.joinable())
         {
             m_threadRun = false;
+            oc_event_signal(m_processEvent);
             m_processThread.join();
+
+            OCUnregisterProcessEvent(m_processEvent);
+            oc_event_free(m_processEvent);
+            m_processEvent = nullptr;
         }
 
         return OC_STACK_OK;
@@ -296,10 +312,11 @@ namespace OC
         while(cLock && m_threadRun)
         {
             OCStackResult result;
+            uint32_t nextEventTime;
 
             {
                 std::lock_guard<std::recursive_mutex> lock(*cLock);
-                result = OCProcess();
+                result = OCProcessEvent(&nextEventTime);
             }
 
             if(OC_STACK_ERROR == result)
@@ -308,7 +325,8 @@ namespace OC
                 // ...the value of variable result is simply ignored for now.
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Sleep until a message arrives or the next stack timer is due.
+            oc_event_wait_for(m_processEvent, nextEventTime);
         }
     }
 
@@ -624,7 +642,20 @@ namespace OC
             response.requestHandle = pResponse->getRequestHandle();
             response.ehResult = pResponse->getResponseResult();
 
-            response.payload = reinterpret_cast<OCPayload*>(pResponse->getPayload());
+            if (m_cfg.directCborCodec)
+            {
+                std::vector<uint8_t> cbor;
+                if (OC_STACK_OK == RepresentationCbor::encode(pResponse->getRepresentations(),
+                                                              cbor))
+                {
+                    response.payload = reinterpret_cast<OCPayload*>(
+                            OCSecurityPayloadCreate(cbor.data(), cbor.size()));
+                }
+            }
+            if (!response.payload)
+            {
+                response.payload = reinterpret_cast<OCPayload*>(pResponse->getPayload());
+            }
 
             response.persistentBufferFlag = 0;
 
@@ -192,6 +192,11 @@ namespace OC
             return OCPlatform_impl::Instance().getSupportedTransportsInfo(supportedTps);
         }
 
+        OCStackResult getCallbackExecutorStats(CallbackExecutorStats& stats)
+        {
+            return OCPlatform_impl::Instance().getCallbackExecutorStats(stats);
+        }
+
         OCStackResult registerResource(OCResourceHandle& resourceHandle,
                                  std::string& resourceURI,
                                  const std::string& resourceTypeName,
@@ -436,6 +436,11 @@ namespace OC
         return checked_guard(m_server, &IServerWrapper::getSupportedTransportsInfo, supportedTps);
     }
 
+    OCStackResult OCPlatform_impl::getCallbackExecutorStats(CallbackExecutorStats& stats)
+    {
+        return checked_guard(m_client, &IClientWrapper::GetCallbackExecutorStats, stats);
+    }
+
     OCStackResult OCPlatform_impl::registerResource(OCResourceHandle& resourceHandle,
                                             std::string& resourceURI,
                                             const std::string& resourceTypeName,
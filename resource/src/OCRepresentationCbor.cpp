@@ -0,0 +1,970 @@
+//******************************************************************
+//
+// Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the conversion between CBOR representation payloads and
+ * OCRepresentation. It follows ocpayloadparse.c, OCRepresentation::setPayload,
+ * OCRepresentation::getPayload and ocpayloadconvert.c step by step, so both
+ * paths give the same representations and the same bytes.
+ */
+
+#include "OCRepresentationCbor.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <cbor.h>
+
+#include "octypes.h"
+
+namespace OC
+{
+    namespace RepresentationCbor
+    {
+        namespace
+        {
+            // First guess of the encoded size, as in OCConvertPayload.
+            const size_t INIT_SIZE = 255;
+
+            enum class ArrayShape
+            {
+                // Elements of one type, nested to at most MAX_REP_ARRAY_DEPTH.
+                Typed,
+                // Elements of different types; decoded as an object keyed by index.
+                Mixed,
+                Unsupported
+            };
+
+            bool decodeObject(CborValue* map, OCRepresentation& rep, bool isRoot);
+            bool decodeValue(CborValue* value, OCRepresentation& rep, const std::string& name);
+
+            bool readText(CborValue* value, std::string& out)
+            {
+                size_t len = 0;
+                if (CborNoError != cbor_value_calculate_string_length(value, &len))
+                {
+                    return false;
+                }
+
+                out.resize(len);
+                if (CborNoError != cbor_value_copy_text_string(value, &out[0], &len, value))
+                {
+                    return false;
+                }
+
+                // OCRepPayload keeps C strings, which end at the first NUL.
+                out.resize(strlen(out.c_str()));
+                return true;
+            }
+
+            bool readBytes(CborValue* value, std::vector<uint8_t>& out)
+            {
+                size_t len = 0;
+                if (CborNoError != cbor_value_calculate_string_length(value, &len))
+                {
+                    return false;
+                }
+
+                out.resize(len);
+                return CborNoError == cbor_value_copy_byte_string(value, out.data(), &len, value);
+            }
+
+            // Same splitting as OCParseStringLL; only the leading text strings count.
+            bool readStringList(const CborValue* array, std::vector<std::string>& out)
+            {
+                CborValue it;
+                if (CborNoError != cbor_value_enter_container(array, &it))
+                {
+                    return false;
+                }
+
+                std::string str;
+                while (cbor_value_is_text_string(&it))
+                {
+                    if (!readText(&it, str))
+                    {
+                        return false;
+                    }
+
+                    size_t start = 0;
+                    while (start < str.size())
+                    {
+                        size_t end = str.find(' ', start);
+                        if (std::string::npos == end)
+                        {
+                            end = str.size();
+                        }
+                        if (end > start)
+                        {
+                            out.push_back(str.substr(start, end - start));
+                        }
+                        start = end + 1;
+                    }
+                }
+                return true;
+            }
+
+            bool readItem(CborValue* value, int& out)
+            {
+                int64_t i = 0;
+                if (!cbor_value_is_integer(value) || CborNoError != cbor_value_get_int64(value, &i))
+                {
+                    return false;
+                }
+                out = static_cast<int>(i);
+                return CborNoError == cbor_value_advance_fixed(value);
+            }
+
+            bool readItem(CborValue* value, double& out)
+            {
+                if (cbor_value_is_double(value))
+                {
+                    if (CborNoError != cbor_value_get_double(value, &out))
+                    {
+                        return false;
+                    }
+                }
+                else
+                {
+                    float f = 0;
+                    if (!cbor_value_is_float(value) || CborNoError != cbor_value_get_float(value, &f))
+                    {
+                        return false;
+                    }
+                    out = f;
+                }
+                return CborNoError == cbor_value_advance_fixed(value);
+            }
+
+            bool readItem(CborValue* value, bool& out)
+            {
+                if (!cbor_value_is_boolean(value) || CborNoError != cbor_value_get_boolean(value, &out))
+                {
+                    return false;
+                }
+                return CborNoError == cbor_value_advance_fixed(value);
+            }
+
+            bool readItem(CborValue* value, std::string& out)
+            {
+                return cbor_value_is_text_string(value) && readText(value, out);
+            }
+
+            bool readItem(CborValue* value, OCRepresentation& out)
+            {
+                return cbor_value_is_map(value) && decodeObject(value, out, false);
+            }
+
+            template<typename T>
+            bool readArray(CborValue* array, std::vector<T>& out);
+
+            template<typename T>
+            bool readElement(CborValue* value, std::vector<T>& out, size_t index)
+            {
+                T item;
+                if (!readItem(value, item))
+                {
+                    return false;
+                }
+                out[index] = std::move(item);
+                return true;
+            }
+
+            template<typename T>
+            bool readElement(CborValue* value, std::vector<std::vector<T>>& out, size_t index)
+            {
+                return cbor_value_is_array(value) && readArray(value, out[index]);
+            }
+
+            // out is already sized to the array dimensions; missing and null elements
+            // keep their default value, as in OCRepresentation::payload_array_helper.
+            template<typename T>
+            bool readArray(CborValue* array, std::vector<T>& out)
+            {
+                CborValue it;
+                if (CborNoError != cbor_value_enter_container(array, &it))
+                {
+                    return false;
+                }
+
+                for (size_t i = 0; i < out.size() && cbor_value_is_valid(&it); ++i)
+                {
+                    if (cbor_value_is_null(&it))
+                    {
+                        if (CborNoError != cbor_value_advance_fixed(&it))
+                        {
+                            return false;
+                        }
+                    }
+                    else if (!readElement(&it, out, i))
+                    {
+                        return false;
+                    }
+                }
+
+                return cbor_value_at_end(&it) &&
+                       CborNoError == cbor_value_leave_container(array, &it);
+            }
+
+            template<typename T>
+            bool decodeTypedArray(CborValue* array, const size_t dims[MAX_REP_ARRAY_DEPTH],
+                                  OCRepresentation& rep, const std::string& name)
+            {
+                if (0 == dims[1])
+                {
+                    std::vector<T> val(dims[0]);
+                    if (!readArray(array, val))
+                    {
+                        return false;
+                    }
+                    rep.setValue(name, std::move(val));
+                }
+                else if (0 == dims[2])
+                {
+                    std::vector<std::vector<T>> val(dims[0], std::vector<T>(dims[1]));
+                    if (!readArray(array, val))
+                    {
+                        return false;
+                    }
+                    rep.setValue(name, std::move(val));
+                }
+                else
+                {
+                    std::vector<std::vector<std::vector<T>>> val(dims[0],
+                            std::vector<std::vector<T>>(dims[1], std::vector<T>(dims[2])));
+                    if (!readArray(array, val))
+                    {
+                        return false;
+                    }
+                    rep.setValue(name, std::move(val));
+                }
+                return true;
+            }
+
+            // Same result as OCParseArrayFindDimensionsAndType; moves array past itself.
+            ArrayShape scanArray(CborValue* array, size_t dims[MAX_REP_ARRAY_DEPTH],
+                                 OCRepPayloadPropType& type)
+            {
+                type = OCREP_PROP_NULL;
+                dims[0] = dims[1] = dims[2] = 0;
+
+                CborValue it;
+                if (CborNoError != cbor_value_enter_container(array, &it))
+                {
+                    return ArrayShape::Unsupported;
+                }
+
+                while (cbor_value_is_valid(&it))
+                {
+                    OCRepPayloadPropType itemType = OCREP_PROP_NULL;
+                    switch (cbor_value_get_type(&it))
+                    {
+                        case CborNullType:
+                            itemType = OCREP_PROP_NULL;
+                            break;
+                        case CborIntegerType:
+                            itemType = OCREP_PROP_INT;
+                            break;
+                        case CborDoubleType:
+                        case CborFloatType:
+                            itemType = OCREP_PROP_DOUBLE;
+                            break;
+                        case CborBooleanType:
+                            itemType = OCREP_PROP_BOOL;
+                            break;
+                        case CborTextStringType:
+                            itemType = OCREP_PROP_STRING;
+                            break;
+                        case CborByteStringType:
+                            itemType = OCREP_PROP_BYTE_STRING;
+                            break;
+                        case CborMapType:
+                            itemType = OCREP_PROP_OBJECT;
+                            break;
+                        case CborArrayType:
+                            {
+                                size_t subdims[MAX_REP_ARRAY_DEPTH];
+                                ArrayShape shape = scanArray(&it, subdims, itemType);
+                                if (ArrayShape::Typed != shape)
+                                {
+                                    return shape;
+                                }
+                                if (0 != subdims[2])
+                                {
+                                    return ArrayShape::Unsupported;
+                                }
+                                dims[1] = std::max(dims[1], subdims[0]);
+                                dims[2] = std::max(dims[2], subdims[1]);
+                                ++dims[0];
+                                if (OCREP_PROP_NULL == type)
+                                {
+                                    type = itemType;
+                                }
+                                else if (OCREP_PROP_NULL != itemType && type != itemType)
+                                {
+                                    return ArrayShape::Mixed;
+                                }
+                                continue;
+                            }
+                        default:
+                            return ArrayShape::Unsupported;
+                    }
+
+                    if (OCREP_PROP_NULL == type)
+                    {
+                        type = itemType;
+                    }
+                    else if (OCREP_PROP_NULL != itemType && type != itemType)
+                    {
+                        return ArrayShape::Mixed;
+                    }
+
+                    ++dims[0];
+                    if (CborNoError != cbor_value_advance(&it))
+                    {
+                        return ArrayShape::Unsupported;
+                    }
+                }
+
+                return (CborNoError == cbor_value_leave_container(array, &it)) ?
+                        ArrayShape::Typed : ArrayShape::Unsupported;
+            }
+
+            // The value names of an array OCParseArray rejects are the element indexes.
+            bool decodeIndexedObject(CborValue* array, OCRepresentation& rep,
+                                     const std::string& name)
+            {
+                CborValue it;
+                if (CborNoError != cbor_value_enter_container(array, &it))
+                {
+                    return false;
+                }
+
+                OCRepresentation obj;
+                for (size_t index = 0; cbor_value_is_valid(&it); ++index)
+                {
+                    if (!decodeValue(&it, obj, std::to_string(index)))
+                    {
+                        return false;
+                    }
+                }
+
+                if (CborNoError != cbor_value_leave_container(array, &it))
+                {
+                    return false;
+                }
+                rep.setValue(name, std::move(obj));
+                return true;
+            }
+
+            bool decodeArray(CborValue* array, OCRepresentation& rep, const std::string& name)
+            {
+                size_t dims[MAX_REP_ARRAY_DEPTH];
+                OCRepPayloadPropType type;
+                CborValue scan = *array;
+
+                switch (scanArray(&scan, dims, type))
+                {
+                    case ArrayShape::Typed:
+                        break;
+                    case ArrayShape::Mixed:
+                        return decodeIndexedObject(array, rep, name);
+                    default:
+                        return false;
+                }
+
+                switch (type)
+                {
+                    case OCREP_PROP_NULL:
+                        rep.setNULL(name);
+                        *array = scan;
+                        return true;
+                    case OCREP_PROP_INT:
+                        return decodeTypedArray<int>(array, dims, rep, name);
+                    case OCREP_PROP_DOUBLE:
+                        return decodeTypedArray<double>(array, dims, rep, name);
+                    case OCREP_PROP_BOOL:
+                        return decodeTypedArray<bool>(array, dims, rep, name);
+                    case OCREP_PROP_STRING:
+                        return decodeTypedArray<std::string>(array, dims, rep, name);
+                    case OCREP_PROP_OBJECT:
+                        return decodeTypedArray<OCRepresentation>(array, dims, rep, name);
+                    default:
+                        // Byte string arrays point into the OCRepPayload, leave them to it.
+                        return false;
+                }
+            }
+
+            bool decodeValue(CborValue* value, OCRepresentation& rep, const std::string& name)
+            {
+                switch (cbor_value_get_type(value))
+                {
+                    case CborNullType:
+                        rep.setNULL(name);
+                        return CborNoError == cbor_value_advance_fixed(value);
+                    case CborIntegerType:
+                        {
+                            int i = 0;
+                            if (!readItem(value, i))
+                            {
+                                return false;
+                            }
+                            rep.setValue(name, i);
+                            return true;
+                        }
+                    case CborDoubleType:
+                        {
+                            double d = 0;
+                            if (!readItem(value, d))
+                            {
+                                return false;
+                            }
+                            rep.setValue(name, d);
+                            return true;
+                        }
+                    case CborBooleanType:
+                        {
+                            bool b = false;
+                            if (!readItem(value, b))
+                            {
+                                return false;
+                            }
+                            rep.setValue(name, b);
+                            return true;
+                        }
+                    case CborTextStringType:
+                        {
+                            std::string str;
+                            if (!readText(value, str))
+                            {
+                                return false;
+                            }
+                            rep.setValue(name, std::move(str));
+                            return true;
+                        }
+                    case CborByteStringType:
+                        {
+                            std::vector<uint8_t> bytes;
+                            if (!readBytes(value, bytes))
+                            {
+                                return false;
+                            }
+                            rep.setValue(name, std::move(bytes));
+                            return true;
+                        }
+                    case CborMapType:
+                        {
+                            OCRepresentation obj;
+                            if (!decodeObject(value, obj, false))
+                            {
+                                return false;
+                            }
+                            rep.setValue(name, std::move(obj));
+                            return true;
+                        }
+                    case CborArrayType:
+                        return decodeArray(value, rep, name);
+                    default:
+                        // Single floats and other simple types fail OCParsePayload as well.
+                        return false;
+                }
+            }
+
+            bool decodeObject(CborValue* map, OCRepresentation& rep, bool isRoot)
+            {
+                CborValue it;
+                if (CborNoError != cbor_value_enter_container(map, &it))
+                {
+                    return false;
+                }
+
+                // At the root the first href, rt and if are properties of the resource.
+                bool seenHref = false;
+                bool seenTypes = false;
+                bool seenInterfaces = false;
+                std::string name;
+                while (cbor_value_is_valid(&it))
+                {
+                    if (!cbor_value_is_text_string(&it) || !readText(&it, name))
+                    {
+                        return false;
+                    }
+
+                    if (!isRoot ||
+                        (name != OC_RSRVD_HREF &&
+                         name != OC_RSRVD_RESOURCE_TYPE &&
+                         name != OC_RSRVD_INTERFACE))
+                    {
+                        if (!decodeValue(&it, rep, name))
+                        {
+                            return false;
+                        }
+                        continue;
+                    }
+
+                    if (name == OC_RSRVD_HREF && !seenHref)
+                    {
+                        seenHref = true;
+                        if (cbor_value_is_text_string(&it))
+                        {
+                            CborValue href = it;
+                            std::string uri;
+                            if (!readText(&href, uri))
+                            {
+                                return false;
+                            }
+                            rep.setUri(uri);
+                        }
+                    }
+                    else if ((name == OC_RSRVD_RESOURCE_TYPE && !seenTypes) ||
+                             (name == OC_RSRVD_INTERFACE && !seenInterfaces))
+                    {
+                        bool isTypes = (name == OC_RSRVD_RESOURCE_TYPE);
+                        (isTypes ? seenTypes : seenInterfaces) = true;
+
+                        std::vector<std::string> list;
+                        if (cbor_value_is_array(&it) && !readStringList(&it, list))
+                        {
+                            return false;
+                        }
+                        for (const std::string& str : list)
+                        {
+                            if (isTypes)
+                            {
+                                rep.addResourceType(str);
+                            }
+                            else
+                            {
+                                rep.addResourceInterface(str);
+                            }
+                        }
+                    }
+
+                    if (CborNoError != cbor_value_advance(&it))
+                    {
+                        return false;
+                    }
+                }
+
+                return CborNoError == cbor_value_leave_container(map, &it);
+            }
+
+            int64_t encodeText(CborEncoder* encoder, const std::string& str)
+            {
+                // Up to the first NUL, like the C strings of OCRepPayload.
+                return cbor_encode_text_string(encoder, str.c_str(), strlen(str.c_str()));
+            }
+
+            int64_t encodeObject(CborEncoder* parent, const OCRepresentation& rep);
+
+            int64_t encodeItem(CborEncoder* encoder, int value)
+            {
+                return cbor_encode_int(encoder, value);
+            }
+
+            int64_t encodeItem(CborEncoder* encoder, double value)
+            {
+                return cbor_encode_double(encoder, value);
+            }
+
+            int64_t encodeItem(CborEncoder* encoder, bool value)
+            {
+                return cbor_encode_boolean(encoder, value);
+            }
+
+            int64_t encodeItem(CborEncoder* encoder, const std::string& value)
+            {
+                return encodeText(encoder, value);
+            }
+
+            int64_t encodeItem(CborEncoder* encoder, const OCByteString& value)
+            {
+                return cbor_encode_byte_string(encoder, value.bytes, value.len);
+            }
+
+            int64_t encodeItem(CborEncoder* encoder, const OCRepresentation& value)
+            {
+                return encodeObject(encoder, value);
+            }
+
+            // What the zeroed cells getPayloadArray leaves behind short rows encode to.
+            template<typename T>
+            int64_t encodePadding(CborEncoder* encoder);
+
+            template<>
+            int64_t encodePadding<int>(CborEncoder* encoder)
+            {
+                return cbor_encode_int(encoder, 0);
+            }
+
+            template<>
+            int64_t encodePadding<double>(CborEncoder* encoder)
+            {
+                return cbor_encode_double(encoder, 0);
+            }
+
+            template<>
+            int64_t encodePadding<bool>(CborEncoder* encoder)
+            {
+                return cbor_encode_boolean(encoder, false);
+            }
+
+            template<>
+            int64_t encodePadding<std::string>(CborEncoder* encoder)
+            {
+                return cbor_encode_null(encoder);
+            }
+
+            template<>
+            int64_t encodePadding<OCByteString>(CborEncoder* encoder)
+            {
+                return cbor_encode_byte_string(encoder, nullptr, 0);
+            }
+
+            template<>
+            int64_t encodePadding<OCRepresentation>(CborEncoder* encoder)
+            {
+                return cbor_encode_null(encoder);
+            }
+
+            template<typename T>
+            int64_t encodeArray(CborEncoder* parent, const std::vector<T>& arr)
+            {
+                CborEncoder array;
+                int64_t err = cbor_encoder_create_array(parent, &array, arr.size());
+                for (size_t i = 0; i < arr.size(); ++i)
+                {
+                    err |= encodeItem(&array, arr[i]);
+                }
+                err |= cbor_encoder_close_container(parent, &array);
+                return err;
+            }
+
+            // Rows are padded to the longest one; without any column the array is
+            // encoded one level shallower, as OCConvertArray reads the dimensions.
+            template<typename T>
+            int64_t encodeArray(CborEncoder* parent, const std::vector<std::vector<T>>& arr)
+            {
+                size_t columns = 0;
+                for (const auto& row : arr)
+                {
+                    columns = std::max(columns, row.size());
+                }
+
+                CborEncoder array;
+                int64_t err = cbor_encoder_create_array(parent, &array, arr.size());
+                for (const auto& row : arr)
+                {
+                    if (0 == columns)
+                    {
+                        err |= encodePadding<T>(&array);
+                        continue;
+                    }
+
+                    CborEncoder array2;
+                    err |= cbor_encoder_create_array(&array, &array2, columns);
+                    for (size_t j = 0; j < columns; ++j)
+                    {
+                        err |= (j < row.size()) ? encodeItem(&array2, row[j]) :
+                                                  encodePadding<T>(&array2);
+                    }
+                    err |= cbor_encoder_close_container(&array, &array2);
+                }
+                err |= cbor_encoder_close_container(parent, &array);
+                return err;
+            }
+
+            template<typename T>
+            int64_t encodeArray(CborEncoder* parent,
+                                const std::vector<std::vector<std::vector<T>>>& arr)
+            {
+                size_t columns = 0;
+                size_t depth = 0;
+                for (const auto& row : arr)
+                {
+                    columns = std::max(columns, row.size());
+                    for (const auto& col : row)
+                    {
+                        depth = std::max(depth, col.size());
+                    }
+                }
+
+                CborEncoder array;
+                int64_t err = cbor_encoder_create_array(parent, &array, arr.size());
+                for (const auto& row : arr)
+                {
+                    if (0 == columns)
+                    {
+                        err |= encodePadding<T>(&array);
+                        continue;
+                    }
+
+                    CborEncoder array2;
+                    err |= cbor_encoder_create_array(&array, &array2, columns);
+                    for (size_t j = 0; j < columns; ++j)
+                    {
+                        if (0 == depth)
+                        {
+                            err |= encodePadding<T>(&array2);
+                            continue;
+                        }
+
+                        CborEncoder array3;
+                        err |= cbor_encoder_create_array(&array2, &array3, depth);
+                        for (size_t k = 0; k < depth; ++k)
+                        {
+                            err |= (j < row.size() && k < row[j].size()) ?
+                                    encodeItem(&array3, row[j][k]) : encodePadding<T>(&array3);
+                        }
+                        err |= cbor_encoder_close_container(&array2, &array3);
+                    }
+                    err |= cbor_encoder_close_container(&array, &array2);
+                }
+                err |= cbor_encoder_close_container(parent, &array);
+                return err;
+            }
+
+            struct encode_value: boost::static_visitor<int64_t>
+            {
+                explicit encode_value(CborEncoder* encoder) : m_encoder(encoder) {}
+
+                int64_t operator()(const NullType&) const
+                {
+                    return cbor_encode_null(m_encoder);
+                }
+
+                int64_t operator()(int value) const
+                {
+                    return encodeItem(m_encoder, value);
+                }
+
+                int64_t operator()(double value) const
+                {
+                    return encodeItem(m_encoder, value);
+                }
+
+                int64_t operator()(bool value) const
+                {
+                    return encodeItem(m_encoder, value);
+                }
+
+                int64_t operator()(const std::string& value) const
+                {
+                    return encodeItem(m_encoder, value);
+                }
+
+                int64_t operator()(const OCRepresentation& value) const
+                {
+                    return encodeItem(m_encoder, value);
+                }
+
+                int64_t operator()(const OCByteString& value) const
+                {
+                    return encodeItem(m_encoder, value);
+                }
+
+                int64_t operator()(const std::vector<uint8_t>& value) const
+                {
+                    return cbor_encode_byte_string(m_encoder, value.data(), value.size());
+                }
+
+                template<typename T>
+                int64_t operator()(const std::vector<T>& value) const
+                {
+                    return encodeArray(m_encoder, value);
+                }
+
+                CborEncoder* m_encoder;
+            };
+
+            int64_t encodeStringList(CborEncoder* map, const char* tag,
+                                     const std::vector<std::string>& list)
+            {
+                if (list.empty())
+                {
+                    return CborNoError;
+                }
+
+                CborEncoder array;
+                int64_t err = cbor_encode_text_string(map, tag, strlen(tag));
+                err |= cbor_encoder_create_array(map, &array, list.size());
+                for (const std::string& str : list)
+                {
+                    err |= encodeText(&array, str);
+                }
+                err |= cbor_encoder_close_container(map, &array);
+                return err;
+            }
+
+            // OCConvertSingleRepPayload
+            int64_t encodeProperties(CborEncoder* map, const OCRepresentation& rep)
+            {
+                int64_t err = CborNoError;
+
+                std::string uri = rep.getUri();
+                if (uri.c_str()[0] != '\0')
+                {
+                    err |= cbor_encode_text_string(map, OC_RSRVD_HREF, strlen(OC_RSRVD_HREF));
+                    err |= encodeText(map, uri);
+                }
+                err |= encodeStringList(map, OC_RSRVD_RESOURCE_TYPE, rep.getResourceTypes());
+                err |= encodeStringList(map, OC_RSRVD_INTERFACE, rep.getResourceInterfaces());
+
+                for (const auto& val : rep.getValues())
+                {
+                    err |= encodeText(map, val.first);
+                    err |= boost::apply_visitor(encode_value(map), val.second);
+                }
+                return err;
+            }
+
+            // OCConvertRepMap: values named 0, 1, 2... go out as an array.
+            int64_t encodeObject(CborEncoder* parent, const OCRepresentation& rep)
+            {
+                const std::map<std::string, AttributeValue>& values = rep.getValues();
+
+                size_t arrayLength = 0;
+                bool indexed = true;
+                for (const auto& val : values)
+                {
+                    char* endp = nullptr;
+                    long i = strtol(val.first.c_str(), &endp, 0);
+                    if (*endp != '\0' || i < 0 || arrayLength != static_cast<size_t>(i))
+                    {
+                        indexed = false;
+                        break;
+                    }
+                    ++arrayLength;
+                }
+
+                CborEncoder encoder;
+                int64_t err = CborNoError;
+                if (indexed)
+                {
+                    err |= cbor_encoder_create_array(parent, &encoder, arrayLength);
+                    for (const auto& val : values)
+                    {
+                        err |= boost::apply_visitor(encode_value(&encoder), val.second);
+                    }
+                }
+                else
+                {
+                    err |= cbor_encoder_create_map(parent, &encoder, CborIndefiniteLength);
+                    err |= encodeProperties(&encoder, rep);
+                }
+                err |= cbor_encoder_close_container(parent, &encoder);
+                return err;
+            }
+
+            // OCConvertRepPayload
+            int64_t encodeRoot(CborEncoder* encoder, const std::vector<OCRepresentation>& reps)
+            {
+                int64_t err = CborNoError;
+                CborEncoder rootArray;
+                CborEncoder* parent = encoder;
+                if (reps.size() > 1)
+                {
+                    err |= cbor_encoder_create_array(encoder, &rootArray, reps.size());
+                    parent = &rootArray;
+                }
+
+                for (const OCRepresentation& rep : reps)
+                {
+                    CborEncoder rootMap;
+                    err |= cbor_encoder_create_map(parent, &rootMap, CborIndefiniteLength);
+                    err |= encodeProperties(&rootMap, rep);
+                    err |= cbor_encoder_close_container(parent, &rootMap);
+                }
+
+                if (reps.size() > 1)
+                {
+                    err |= cbor_encoder_close_container(encoder, &rootArray);
+                }
+                return err;
+            }
+        }
+
+        bool decode(const uint8_t* payload, size_t size, std::vector<OCRepresentation>& reps)
+        {
+            CborParser parser;
+            CborValue root;
+            if (!payload || CborNoError != cbor_parser_init(payload, size, 0, &parser, &root))
+            {
+                return false;
+            }
+
+            CborValue it = root;
+            if (cbor_value_is_array(&root) && CborNoError != cbor_value_enter_container(&root, &it))
+            {
+                return false;
+            }
+
+            std::vector<OCRepresentation> decoded;
+            while (cbor_value_is_valid(&it))
+            {
+                OCRepresentation rep;
+                if (cbor_value_is_map(&it))
+                {
+                    if (!decodeObject(&it, rep, true))
+                    {
+                        return false;
+                    }
+                }
+                else if (!cbor_value_is_array(&it) || CborNoError != cbor_value_advance(&it))
+                {
+                    return false;
+                }
+                decoded.push_back(std::move(rep));
+            }
+
+            reps.swap(decoded);
+            return true;
+        }
+
+        OCStackResult encode(const std::vector<OCRepresentation>& reps,
+                             std::vector<uint8_t>& payload)
+        {
+            std::vector<uint8_t> out(INIT_SIZE);
+            while (true)
+            {
+                CborEncoder encoder;
+                cbor_encoder_init(&encoder, out.data(), out.size(), 0);
+
+                // A buffer that is too small still yields the size needed.
+                int64_t err = encodeRoot(&encoder, reps);
+                if (CborErrorOutOfMemory == err)
+                {
+                    out.resize(out.size() + cbor_encoder_get_extra_bytes_needed(&encoder));
+                    continue;
+                }
+                if (CborNoError != err)
+                {
+                    return OC_STACK_ERROR;
+                }
+
+                out.resize(cbor_encoder_get_buffer_size(&encoder, out.data()));
+                payload.swap(out);
+                return OC_STACK_OK;
+            }
+        }
+    }
+}
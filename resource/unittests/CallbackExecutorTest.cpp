@@ -0,0 +1,250 @@
+//******************************************************************
+//
+// Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <CallbackExecutor.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+
+namespace CallbackExecutorTest
+{
+    using namespace OC;
+
+    CallbackExecutorConfig MakeConfig(unsigned int threads, size_t maxQueue,
+                                      CallbackOverflowPolicy policy)
+    {
+        CallbackExecutorConfig config;
+        config.threadCount = threads;
+        config.maxQueueSize = maxQueue;
+        config.overflowPolicy = policy;
+        return config;
+    }
+
+    TEST(CallbackExecutorTest, RunsEveryCallbackBeforeStop)
+    {
+        CallbackExecutor executor(CallbackExecutorConfig{});
+        std::atomic<int> count(0);
+        for (int i = 0; i < 1000; i++)
+        {
+            EXPECT_TRUE(executor.post([&count] { count++; }));
+        }
+        executor.stop();
+
+        EXPECT_EQ(1000, count);
+        EXPECT_FALSE(executor.post([&count] { count++; }));
+        EXPECT_EQ(1000u, executor.getStats().executed);
+    }
+
+    TEST(CallbackExecutorTest, KeepsOrderPerKey)
+    {
+        CallbackExecutor executor(MakeConfig(4, 0, CallbackOverflowPolicy::DropOldest));
+        const int keys = 4;
+        const int perKey = 500;
+        std::vector<int> seen[keys];
+        std::atomic<int> running[keys];
+        std::atomic<bool> overlapped(false);
+
+        for (int k = 0; k < keys; k++)
+        {
+            running[k] = 0;
+        }
+
+        for (int i = 0; i < perKey; i++)
+        {
+            for (int k = 0; k < keys; k++)
+            {
+                executor.post([&, k, i]
+                {
+                    if (1 != ++running[k])
+                    {
+                        overlapped = true;
+                    }
+                    seen[k].push_back(i);
+                    running[k]--;
+                }, &seen[k]);
+            }
+        }
+        executor.stop();
+
+        EXPECT_FALSE(overlapped);
+        for (int k = 0; k < keys; k++)
+        {
+            ASSERT_EQ((size_t)perKey, seen[k].size());
+            for (int i = 0; i < perKey; i++)
+            {
+                EXPECT_EQ(i, seen[k][i]);
+            }
+        }
+    }
+
+    TEST(CallbackExecutorTest, DropsOldestNotificationOfSameKey)
+    {
+        CallbackExecutor executor(MakeConfig(1, 2, CallbackOverflowPolicy::DropOldest));
+        std::promise<void> release;
+        std::shared_future<void> gate(release.get_future());
+        std::vector<int> seen;
+        int key;
+
+        // Hold the only thread so everything else stays queued.
+        std::promise<void> started;
+        executor.post([&started, gate] { started.set_value(); gate.wait(); });
+        started.get_future().wait();
+        for (int i = 0; i < 5; i++)
+        {
+            EXPECT_TRUE(executor.post([&seen, i] { seen.push_back(i); }, &key, true));
+        }
+        // Responses are never dropped, even over the limit.
+        EXPECT_TRUE(executor.post([&seen] { seen.push_back(100); }));
+
+        release.set_value();
+        executor.stop();
+
+        // The lane goes back to the end of the run queue after each callback.
+        std::vector<int> expected = {3, 100, 4};
+        EXPECT_EQ(expected, seen);
+        EXPECT_EQ(3u, executor.getStats().dropped);
+        EXPECT_LE(3u, executor.getStats().maxQueueDepth);
+    }
+
+    TEST(CallbackExecutorTest, DropOldestKeepsResponsesOfSameKey)
+    {
+        CallbackExecutor executor(MakeConfig(1, 3, CallbackOverflowPolicy::DropOldest));
+        std::promise<void> release;
+        std::shared_future<void> gate(release.get_future());
+        std::vector<int> seen;
+        int key;
+        int otherKey;
+
+        std::promise<void> started;
+        executor.post([&started, gate] { started.set_value(); gate.wait(); });
+        started.get_future().wait();
+
+        // An error or final response queued in each observation's lane.
+        EXPECT_TRUE(executor.post([&seen] { seen.push_back(100); }, &key));
+        EXPECT_TRUE(executor.post([&seen] { seen.push_back(300); }, &otherKey));
+
+        // A burst of notifications only replaces the notifications of its lane.
+        for (int i = 0; i < 5; i++)
+        {
+            EXPECT_TRUE(executor.post([&seen, i] { seen.push_back(i); }, &key, true));
+        }
+
+        // With no notification left to replace, the new one is discarded.
+        EXPECT_FALSE(executor.post([&seen] { seen.push_back(5); }, &otherKey, true));
+
+        release.set_value();
+        executor.stop();
+
+        std::vector<int> expected = {100, 300, 4};
+        EXPECT_EQ(expected, seen);
+        EXPECT_EQ(5u, executor.getStats().dropped);
+    }
+
+    TEST(CallbackExecutorTest, DropsNewestNotification)
+    {
+        CallbackExecutor executor(MakeConfig(1, 2, CallbackOverflowPolicy::DropNewest));
+        std::promise<void> release;
+        std::shared_future<void> gate(release.get_future());
+        std::vector<int> seen;
+        int key;
+
+        std::promise<void> started;
+        executor.post([&started, gate] { started.set_value(); gate.wait(); });
+        started.get_future().wait();
+        for (int i = 0; i < 5; i++)
+        {
+            executor.post([&seen, i] { seen.push_back(i); }, &key, true);
+        }
+
+        release.set_value();
+        executor.stop();
+
+        std::vector<int> expected = {0, 1};
+        EXPECT_EQ(expected, seen);
+        EXPECT_EQ(3u, executor.getStats().dropped);
+    }
+
+    TEST(CallbackExecutorTest, NeverExceedsThreadCount)
+    {
+        CallbackExecutor executor(MakeConfig(3, 0, CallbackOverflowPolicy::DropOldest));
+        std::atomic<int> running(0);
+        std::atomic<int> peak(0);
+
+        for (int i = 0; i < 200; i++)
+        {
+            executor.post([&]
+            {
+                int now = ++running;
+                int prev = peak;
+                while (now > prev && !peak.compare_exchange_weak(prev, now))
+                {
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                running--;
+            });
+        }
+        executor.stop();
+
+        EXPECT_GE(3, peak);
+    }
+
+    // Delivery of an observe stream through the executor compared with starting
+    // a detached thread per notification, as the client wrapper used to.
+    TEST(CallbackExecutorTest, NotificationThroughputBenchmark)
+    {
+        const int notifications = 20000;
+        std::atomic<int> count(0);
+        int key;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < notifications; i++)
+        {
+            std::thread exec([&count] { count++; });
+            exec.detach();
+        }
+        while (count < notifications)
+        {
+            std::this_thread::yield();
+        }
+        auto threadUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+        CallbackExecutor executor(MakeConfig(4, 0, CallbackOverflowPolicy::DropOldest));
+        count = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < notifications; i++)
+        {
+            executor.post([&count] { count++; }, &key, true);
+        }
+        executor.stop();
+        auto executorUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+        CallbackExecutorStats stats = executor.getStats();
+        std::cout << "[ BENCH    ] " << notifications << " notifications: thread per callback "
+                  << threadUs << " us, executor " << executorUs << " us (avg latency "
+                  << stats.averageLatencyUs << " us, max queue " << stats.maxQueueDepth << ")"
+                  << std::endl;
+        EXPECT_EQ(notifications, count);
+    }
+}
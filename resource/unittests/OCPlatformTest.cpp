@@ -22,7 +22,10 @@
 #include <OCApi.h>
 #include <oic_malloc.h>
 #include <iotivity_debug.h>
+#include <cainterface.h>
 #include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
 
 namespace OCPlatformTest
 {
@@ -1103,4 +1106,97 @@ namespace OCPlatformTest
         EXPECT_EQ(OC_STACK_OK, OCPlatform::unsubscribePresence(presenceHandle));
     }
 #endif
+
+    OCEntityHandlerResult latencyEntityHandler(std::shared_ptr<OCResourceRequest> request)
+    {
+        auto response = std::make_shared<OCResourceResponse>();
+        response->setRequestHandle(request->getRequestHandle());
+        response->setResourceHandle(request->getResourceHandle());
+        response->setResponseResult(OC_EH_OK);
+        response->setResourceRepresentation(OCRepresentation());
+        return (OC_STACK_OK == OCPlatform::sendResponse(response)) ? OC_EH_OK : OC_EH_ERROR;
+    }
+
+    uint16_t GetUnsecuredIPv4Port()
+    {
+        CAEndpoint_t *info = nullptr;
+        size_t size = 0;
+        uint16_t port = 0;
+        if (CA_STATUS_OK != CAGetNetworkInformation(&info, &size))
+        {
+            return 0;
+        }
+        for (size_t i = 0; i < size; i++)
+        {
+            if ((CA_ADAPTER_IP == info[i].adapter) && (info[i].flags & CA_IPV4) &&
+                !(info[i].flags & CA_SECURE))
+            {
+                port = info[i].port;
+                break;
+            }
+        }
+        OICFree(info);
+        return port;
+    }
+
+    // Round trip of a GET sent to our own server over loopback. The time is
+    // dominated by how soon the process thread notices each queued message.
+    TEST(ProcessEventTest, LoopbackRoundTripLatency)
+    {
+        Framework framework(OC::ServiceType::InProc, OC::ModeType::Both, &gps);
+        ASSERT_TRUE(OC_STACK_OK == framework.start());
+
+        OCResourceHandle handle = nullptr;
+        std::string uri = "/a/latency";
+        ASSERT_EQ(OC_STACK_OK, OCPlatform::registerResource(handle, uri, gResourceTypeName,
+                                gResourceInterface, latencyEntityHandler, OC_DISCOVERABLE));
+
+        uint16_t port = GetUnsecuredIPv4Port();
+        ASSERT_NE(0, port);
+
+        std::vector<std::string> types = {gResourceTypeName};
+        std::vector<std::string> ifaces = {gResourceInterface};
+        OCResource::Ptr resource = OCPlatform::constructResourceObject(
+                "coap://127.0.0.1:" + std::to_string(port), uri,
+                CT_ADAPTER_IP, false, types, ifaces);
+        ASSERT_TRUE(nullptr != resource);
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        int completed = 0;
+        auto onGet = [&](const HeaderOptions&, const OCRepresentation&, const int eCode)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (OC_STACK_OK == eCode)
+            {
+                completed++;
+            }
+            cv.notify_one();
+        };
+
+        const int requests = 100;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < requests; i++)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            int expected = completed + 1;
+            lock.unlock();
+            ASSERT_EQ(OC_STACK_OK, resource->get(QueryParamsMap(), onGet));
+            lock.lock();
+            if (!cv.wait_for(lock, std::chrono::seconds(5),
+                             [&] { return completed >= expected; }))
+            {
+                break;
+            }
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+        EXPECT_EQ(OC_STACK_OK, OCPlatform::unregisterResource(handle));
+
+        std::cout << "[ BENCH    ] " << completed << " loopback GETs in " << elapsed
+                  << " us (" << (completed ? (elapsed / completed) : 0)
+                  << " us per round trip)" << std::endl;
+        EXPECT_EQ(requests, completed);
+    }
 }
@@ -0,0 +1,354 @@
+//******************************************************************
+//
+// Copyright 2017 Open Connectivity Foundation, Inc. All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <OCApi.h>
+#include <OCRepresentation.h>
+#include <OCRepresentationCbor.h>
+#include <ocpayload.h>
+#include <ocpayloadcbor.h>
+#include <oic_malloc.h>
+#include <cbor.h>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+// these tests check that the direct CBOR codec gives what the conversions
+// through OCRepPayload give
+namespace OCRepresentationCborTest
+{
+    using namespace OC;
+
+    std::vector<uint8_t> LegacyEncode(const std::vector<OCRepresentation>& reps)
+    {
+        MessageContainer mc;
+        for (const OCRepresentation& rep : reps)
+        {
+            mc.addRepresentation(rep);
+        }
+
+        OCRepPayload* payload = mc.getPayload();
+        uint8_t* cborData = nullptr;
+        size_t cborSize = 0;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*)payload, OC_FORMAT_CBOR,
+                    &cborData, &cborSize));
+        OCPayloadDestroy((OCPayload*)payload);
+
+        std::vector<uint8_t> cbor(cborData, cborData + cborSize);
+        OICFree(cborData);
+        return cbor;
+    }
+
+    std::vector<OCRepresentation> LegacyDecode(const std::vector<uint8_t>& cbor)
+    {
+        OCPayload* payload = nullptr;
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&payload, OC_FORMAT_CBOR,
+                    PAYLOAD_TYPE_REPRESENTATION, cbor.data(), cbor.size()));
+
+        MessageContainer mc;
+        mc.setPayload(payload);
+        OCPayloadDestroy(payload);
+        return mc.representations();
+    }
+
+    // Decoded representations are compared by what they encode to.
+    void ExpectSameDecode(const std::vector<uint8_t>& cbor)
+    {
+        std::vector<OCRepresentation> direct;
+        ASSERT_TRUE(RepresentationCbor::decode(cbor.data(), cbor.size(), direct));
+
+        std::vector<OCRepresentation> legacy = LegacyDecode(cbor);
+        ASSERT_EQ(legacy.size(), direct.size());
+        for (size_t i = 0; i < legacy.size(); ++i)
+        {
+            EXPECT_EQ(legacy[i].getUri(), direct[i].getUri());
+            EXPECT_EQ(legacy[i].getResourceTypes(), direct[i].getResourceTypes());
+            EXPECT_EQ(legacy[i].getResourceInterfaces(), direct[i].getResourceInterfaces());
+            EXPECT_EQ(legacy[i].numberOfAttributes(), direct[i].numberOfAttributes());
+        }
+        EXPECT_EQ(LegacyEncode(legacy), LegacyEncode(direct));
+    }
+
+    void ExpectSameEncode(const std::vector<OCRepresentation>& reps)
+    {
+        std::vector<uint8_t> direct;
+        ASSERT_EQ(OC_STACK_OK, RepresentationCbor::encode(reps, direct));
+        EXPECT_EQ(LegacyEncode(reps), direct);
+    }
+
+    std::vector<uint8_t> BuildMap(std::function<void(CborEncoder*)> fill)
+    {
+        std::vector<uint8_t> cbor(256);
+        CborEncoder encoder;
+        CborEncoder map;
+        cbor_encoder_init(&encoder, cbor.data(), cbor.size(), 0);
+        EXPECT_EQ(CborNoError, cbor_encoder_create_map(&encoder, &map, CborIndefiniteLength));
+        fill(&map);
+        EXPECT_EQ(CborNoError, cbor_encoder_close_container(&encoder, &map));
+        cbor.resize(cbor_encoder_get_buffer_size(&encoder, cbor.data()));
+        return cbor;
+    }
+
+    OCRepresentation MakeNestedRep(int depth)
+    {
+        static uint8_t binval[] = {0x1, 0x2, 0x3, 0x4, 0x0, 0x6};
+
+        OCRepresentation rep;
+        rep.setValue("null", NullType());
+        rep.setValue("int", 77 + depth);
+        rep.setValue("double", 3.333);
+        rep.setValue("bool", true);
+        rep.setValue("string", std::string("a string value"));
+        rep.setValue("bytes", OCByteString{binval, sizeof(binval)});
+        if (depth > 0)
+        {
+            rep.setValue("child", MakeNestedRep(depth - 1));
+        }
+        return rep;
+    }
+
+    OCRepresentation MakeArrayRep()
+    {
+        OCRepresentation inner;
+        inner.setValue("x", 1);
+
+        OCRepresentation rep;
+        rep.setValue("iarr", std::vector<int>{1, -2, 300000});
+        rep.setValue("darr", std::vector<std::vector<double>>{{1.5}, {2.5, 3.5, 4.5}});
+        rep.setValue("barr", std::vector<std::vector<std::vector<bool>>>{
+                {{true, false}, {true}}, {{false}}});
+        rep.setValue("sarr", std::vector<std::vector<std::string>>{{"a", "b"}, {"c", "d"}});
+        rep.setValue("oarr", std::vector<OCRepresentation>{inner, inner});
+        rep.setValue("empty", std::vector<int>{});
+        rep.setValue("emptyRows", std::vector<std::vector<int>>{{}, {}});
+        return rep;
+    }
+
+    OCRepresentation MakeRootRep()
+    {
+        OCRepresentation rep = MakeNestedRep(2);
+        rep.setUri("/a/light");
+        rep.addResourceType("core.light");
+        rep.addResourceType("core.brightlight");
+        rep.addResourceInterface("oic.if.baseline");
+        return rep;
+    }
+
+    TEST(RepresentationCbor, EncodesLikeOCRepPayload)
+    {
+        ExpectSameEncode({MakeRootRep()});
+        ExpectSameEncode({MakeArrayRep()});
+        ExpectSameEncode({OCRepresentation()});
+    }
+
+    TEST(RepresentationCbor, EncodesRaggedAndIndexedLikeOCRepPayload)
+    {
+        OCRepresentation indexed;
+        indexed.setValue("0", 1);
+        indexed.setValue("1", std::string("two"));
+
+        OCRepresentation rep;
+        rep.setValue("ragged", std::vector<std::vector<std::string>>{{"a"}, {"b", "c"}});
+        rep.setValue("indexed", indexed);
+        rep.setValue("raw", std::vector<uint8_t>{0x1, 0x2});
+        ExpectSameEncode({rep});
+    }
+
+    TEST(RepresentationCbor, EncodesChildrenLikeOCRepPayload)
+    {
+        OCRepresentation child1 = MakeNestedRep(0);
+        child1.setUri("/a/child1");
+        OCRepresentation child2 = MakeArrayRep();
+        child2.setUri("/a/child2");
+        child2.addResourceType("core.child");
+
+        ExpectSameEncode({MakeRootRep(), child1, child2});
+    }
+
+    TEST(RepresentationCbor, DecodesLikeOCRepPayload)
+    {
+        ExpectSameDecode(LegacyEncode({MakeRootRep()}));
+        ExpectSameDecode(LegacyEncode({MakeArrayRep()}));
+
+        OCRepresentation child = MakeNestedRep(1);
+        child.setUri("/a/child");
+        ExpectSameDecode(LegacyEncode({MakeRootRep(), child, MakeArrayRep()}));
+    }
+
+    TEST(RepresentationCbor, DecodesValues)
+    {
+        std::vector<OCRepresentation> reps;
+        std::vector<uint8_t> cbor = LegacyEncode({MakeRootRep(), MakeArrayRep()});
+        ASSERT_TRUE(RepresentationCbor::decode(cbor.data(), cbor.size(), reps));
+        ASSERT_EQ(2u, reps.size());
+
+        const OCRepresentation& root = reps[0];
+        EXPECT_EQ("/a/light", root.getUri());
+        EXPECT_EQ(2u, root.getResourceTypes().size());
+        EXPECT_EQ("oic.if.baseline", root.getResourceInterfaces()[0]);
+        EXPECT_TRUE(root.isNULL("null"));
+        EXPECT_EQ(79, root.getValue<int>("int"));
+        EXPECT_EQ(3.333, root.getValue<double>("double"));
+        EXPECT_TRUE(root.getValue<bool>("bool"));
+        EXPECT_EQ("a string value", root.getValue<std::string>("string"));
+        EXPECT_EQ(78, root.getValue<OCRepresentation>("child").getValue<int>("int"));
+
+        const OCRepresentation& arrays = reps[1];
+        std::vector<std::vector<double>> darr =
+            arrays.getValue<std::vector<std::vector<double>>>("darr");
+        ASSERT_EQ(2u, darr.size());
+        ASSERT_EQ(3u, darr[0].size());
+        EXPECT_EQ(1.5, darr[0][0]);
+        EXPECT_EQ(0.0, darr[0][2]);
+        EXPECT_EQ(4.5, darr[1][2]);
+        EXPECT_EQ(1, arrays.getValue<std::vector<OCRepresentation>>("oarr")[1].getValue<int>("x"));
+    }
+
+    TEST(RepresentationCbor, DecodesNullAndMixedArrays)
+    {
+        // The mixed array goes last: OCParsePayload skips the value after one.
+        ExpectSameDecode(BuildMap([](CborEncoder* map)
+        {
+            CborEncoder array;
+            cbor_encode_text_stringz(map, "holes");
+            cbor_encoder_create_array(map, &array, 3);
+            cbor_encode_int(&array, 1);
+            cbor_encode_null(&array);
+            cbor_encode_int(&array, 3);
+            cbor_encoder_close_container(map, &array);
+
+            cbor_encode_text_stringz(map, "nulls");
+            cbor_encoder_create_array(map, &array, 2);
+            cbor_encode_null(&array);
+            cbor_encode_null(&array);
+            cbor_encoder_close_container(map, &array);
+
+            cbor_encode_text_stringz(map, "mixed");
+            cbor_encoder_create_array(map, &array, 3);
+            cbor_encode_int(&array, 1);
+            cbor_encode_text_stringz(&array, "two");
+            cbor_encode_boolean(&array, true);
+            cbor_encoder_close_container(map, &array);
+        }));
+
+        std::vector<OCRepresentation> reps;
+        std::vector<uint8_t> cbor = BuildMap([](CborEncoder* map)
+        {
+            CborEncoder array;
+            cbor_encode_text_stringz(map, "mixed");
+            cbor_encoder_create_array(map, &array, 2);
+            cbor_encode_int(&array, 1);
+            cbor_encode_text_stringz(&array, "two");
+            cbor_encoder_close_container(map, &array);
+        });
+        ASSERT_TRUE(RepresentationCbor::decode(cbor.data(), cbor.size(), reps));
+        ASSERT_EQ(1u, reps.size());
+        OCRepresentation mixed = reps[0].getValue<OCRepresentation>("mixed");
+        EXPECT_EQ(1, mixed.getValue<int>("0"));
+        EXPECT_EQ("two", mixed.getValue<std::string>("1"));
+    }
+
+    TEST(RepresentationCbor, LeavesUnsupportedPayloadsToOCParsePayload)
+    {
+        std::vector<OCRepresentation> reps;
+        std::vector<uint8_t> cbor = BuildMap([](CborEncoder* map)
+        {
+            static const uint8_t binval[] = {0x1, 0x2};
+            CborEncoder array;
+            cbor_encode_text_stringz(map, "bytesArray");
+            cbor_encoder_create_array(map, &array, 1);
+            cbor_encode_byte_string(&array, binval, sizeof(binval));
+            cbor_encoder_close_container(map, &array);
+        });
+        EXPECT_FALSE(RepresentationCbor::decode(cbor.data(), cbor.size(), reps));
+
+        cbor = LegacyEncode({MakeRootRep()});
+        cbor.resize(cbor.size() / 2);
+        EXPECT_FALSE(RepresentationCbor::decode(cbor.data(), cbor.size(), reps));
+        EXPECT_FALSE(RepresentationCbor::decode(nullptr, 0, reps));
+    }
+
+    // Representations to and from CBOR through OCRepPayload compared with the
+    // direct codec, on a nested and an array heavy payload.
+    TEST(RepresentationCbor, CodecBenchmark)
+    {
+        OCRepresentation arrays;
+        std::vector<std::vector<double>> samples(32, std::vector<double>(32));
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            for (size_t j = 0; j < samples[i].size(); ++j)
+            {
+                samples[i][j] = i * 0.5 + j;
+            }
+        }
+        arrays.setValue("samples", samples);
+        arrays.setValue("ids", std::vector<int>(256, 7));
+        arrays.setValue("names", std::vector<std::string>(64, "sensor"));
+
+        const int iterations = 500;
+        const std::vector<OCRepresentation> inputs[] = {{MakeRootRep()}, {arrays}};
+        const char* names[] = {"nested", "arrays"};
+        for (size_t n = 0; n < 2; ++n)
+        {
+            std::vector<uint8_t> cbor = LegacyEncode(inputs[n]);
+
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+            {
+                LegacyDecode(cbor);
+            }
+            auto legacyDecodeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+            {
+                std::vector<OCRepresentation> reps;
+                EXPECT_TRUE(RepresentationCbor::decode(cbor.data(), cbor.size(), reps));
+            }
+            auto directDecodeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+            {
+                LegacyEncode(inputs[n]);
+            }
+            auto legacyEncodeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i)
+            {
+                std::vector<uint8_t> out;
+                EXPECT_EQ(OC_STACK_OK, RepresentationCbor::encode(inputs[n], out));
+            }
+            auto directEncodeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+
+            std::cout << "[ BENCH    ] " << iterations << " x " << cbor.size() << " byte "
+                      << names[n] << " payload: decode via OCRepPayload " << legacyDecodeUs
+                      << " us, direct " << directDecodeUs << " us; encode via OCRepPayload "
+                      << legacyEncodeUs << " us, direct " << directEncodeUs << " us"
+                      << std::endl;
+        }
+    }
+}